@@ -3,37 +3,33 @@
 #include "datastructures/mml_array.hpp"
 
 template <typename T>
-array_mml<T>::array_mml(size_t size) : d_size(size) {
-#ifdef ALIGN_TENSORS
-  size_t alignment =
-      MEMORY_ALIGNMENT;  // Gets set during compilation based on GEMM impl.
-
-  void *ptr = nullptr;
-  if (posix_memalign(&ptr, alignment, size * sizeof(T)) != 0) {
-    throw std::bad_alloc();
-  }
-
-  data = std::shared_ptr<T[]>(static_cast<T *>(ptr), [](T *ptr) { free(ptr); });
-#else
-  data = std::shared_ptr<T[]>(new T[size]);
-#endif
+std::shared_ptr<T[]> array_mml<T>::allocate(size_t size) {
+  auto allocator = Allocator::global();
+  const size_t bytes = size * sizeof(T);
+  T *ptr = static_cast<T *>(allocator->allocate(bytes));
+  return std::shared_ptr<T[]>(ptr, [allocator, bytes](T *ptr) {
+    allocator->deallocate(ptr, bytes);
+  });
 }
 
+template <typename T>
+array_mml<T>::array_mml(size_t size) : data(allocate(size)), d_size(size) {}
+
 template <typename T>
 array_mml<T>::array_mml(std::initializer_list<T> data)
-    : data(std::make_shared<T[]>(data.size())), d_size(data.size()) {
+    : data(allocate(data.size())), d_size(data.size()) {
   std::ranges::copy(data, this->data.get());
 }
 
 template <typename T>
 array_mml<T>::array_mml(std::vector<T> &data)
-    : data(std::make_shared<T[]>(data.size())), d_size(data.size()) {
+    : data(allocate(data.size())), d_size(data.size()) {
   std::ranges::copy(data, this->data.get());
 }
 
 template <typename T>
 array_mml<T>::array_mml(const std::vector<T> &data)
-    : data(std::make_shared<T[]>(data.size())), d_size(data.size()) {
+    : data(allocate(data.size())), d_size(data.size()) {
   std::ranges::copy(data, this->data.get());
 }
 
@@ -43,7 +39,7 @@ array_mml<T>::array_mml(std::shared_ptr<T[]> data, size_t size)
 
 template <typename T>
 array_mml<T>::array_mml(const array_mml &other)
-    : data(std::make_shared<T[]>(other.d_size)), d_size(other.d_size) {
+    : data(allocate(other.d_size)), d_size(other.d_size) {
   std::copy(other.data.get(), other.data.get() + other.d_size,
             this->data.get());
 }
@@ -167,6 +163,21 @@ const T *array_mml<T>::get() const {
   return this->data.get();
 }
 
+template <typename T>
+array_mml<T> array_mml<T>::share() const {
+  return array_mml(this->data, this->d_size);
+}
+
+template <typename T>
+array_mml<T> array_mml<T>::share(size_t size) const {
+  if (size > this->d_size) {
+    throw std::out_of_range("Invalid array_mml share size: " +
+                            std::to_string(size) +
+                            ". Array size: " + std::to_string(this->d_size));
+  }
+  return array_mml(this->data, size);
+}
+
 template <typename T>
 void array_mml<T>::fill(const T &value) {
   std::ranges::fill(*this, value);
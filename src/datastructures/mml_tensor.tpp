@@ -3,111 +3,133 @@
 #include "datastructures/mml_tensor.hpp"
 #include "datastructures/tensor_concept.hpp"
 
+template <TensorConcept::Types T>
+Tensor_mml<T>::Tensor_mml(const std::initializer_list<size_t> shape)
+    : Tensor_mml(array_mml<size_t>(shape)) {}
+
 template <TensorConcept::Types T>
 Tensor_mml<T>::Tensor_mml(const std::initializer_list<size_t> shape,
-                          const size_t jump_indexes, const size_t jump_columns,
-                          const size_t jump_rows, const bool sliced)
-    : Tensor<T>(),
-      shape(shape),
-      jump_indexes(jump_indexes),
-      jump_columns(jump_columns),
-      jump_rows(jump_rows),
-      sliced(sliced) {
-  this->indices_offsets = compute_indices_offsets();
+                          const std::initializer_list<T> data)
+    : Tensor_mml(array_mml<size_t>(shape), array_mml<T>(data)) {}
+
+template <TensorConcept::Types T>
+Tensor_mml<T>::Tensor_mml(const array_mml<size_t> &shape)
+    : Tensor<T>(), shape(shape), storage_offset(0), contiguous_layout(true) {
+  this->indices_offsets = compute_indices_offsets(this->shape);
+  this->strides = array_mml<size_t>(this->indices_offsets);
   this->size = compute_size();
-  this->data = array_mml<T>(this->size);
-  this->data.fill(T(0));
+  this->buffer = array_mml<T>(this->size);
+  this->buffer.fill(T(0));
 }
 
 template <TensorConcept::Types T>
-Tensor_mml<T>::Tensor_mml(const std::initializer_list<size_t> shape,
-                          const std::initializer_list<T> data,
-                          const size_t jump_indexes, const size_t jump_columns,
-                          const size_t jump_rows, const bool sliced)
+Tensor_mml<T>::Tensor_mml(const array_mml<size_t> &shape,
+                          const array_mml<T> &data)
     : Tensor<T>(),
+      buffer(data),
       shape(shape),
-      data(data),
-      jump_indexes(jump_indexes),
-      jump_columns(jump_columns),
-      jump_rows(jump_rows),
-      sliced(sliced) {
-  this->indices_offsets = compute_indices_offsets();
+      storage_offset(0),
+      contiguous_layout(true) {
+  this->indices_offsets = compute_indices_offsets(this->shape);
+  this->strides = array_mml<size_t>(this->indices_offsets);
   this->size = compute_size();
 }
 
 template <TensorConcept::Types T>
-Tensor_mml<T>::Tensor_mml(const array_mml<size_t> &shape,
-                          const size_t jump_indexes, const size_t jump_columns,
-                          const size_t jump_rows, const bool sliced)
+Tensor_mml<T>::Tensor_mml(const array_mml<size_t> &shape, array_mml<T> &&data)
     : Tensor<T>(),
+      buffer(std::move(data)),
       shape(shape),
-      jump_indexes(jump_indexes),
-      jump_columns(jump_columns),
-      jump_rows(jump_rows),
-      sliced(sliced) {
-  this->indices_offsets = compute_indices_offsets();
+      storage_offset(0),
+      contiguous_layout(true) {
+  this->indices_offsets = compute_indices_offsets(this->shape);
+  this->strides = array_mml<size_t>(this->indices_offsets);
   this->size = compute_size();
-  this->data = array_mml<T>(this->size);
-  this->data.fill(T(0));
 }
 
 template <TensorConcept::Types T>
-Tensor_mml<T>::Tensor_mml(const array_mml<size_t> &shape,
-                          const array_mml<T> &data, const size_t jump_indexes,
-                          const size_t jump_columns, const size_t jump_rows,
-                          const bool sliced)
+Tensor_mml<T>::Tensor_mml(array_mml<T> &&buffer,
+                          const array_mml<size_t> &shape,
+                          const array_mml<size_t> &strides, size_t offset)
     : Tensor<T>(),
+      buffer(std::move(buffer)),
       shape(shape),
-      data(data),
-      jump_indexes(jump_indexes),
-      jump_columns(jump_columns),
-      jump_rows(jump_rows),
-      sliced(sliced) {
-  this->indices_offsets = compute_indices_offsets();
+      strides(strides),
+      storage_offset(offset) {
+  this->indices_offsets = compute_indices_offsets(this->shape);
   this->size = compute_size();
+  this->contiguous_layout = compute_contiguous_layout();
 }
 
 template <TensorConcept::Types T>
 Tensor_mml<T>::Tensor_mml(Tensor_mml &&other) noexcept : Tensor<T>(other) {
+  this->buffer = std::move(other.buffer);
   this->shape = std::move(other.shape);
   this->indices_offsets = std::move(other.indices_offsets);
+  this->strides = std::move(other.strides);
+  this->storage_offset = other.storage_offset;
+  this->contiguous_layout = other.contiguous_layout;
   this->size = other.size;
-  this->jump_indexes = other.jump_indexes;
-  this->jump_columns = other.jump_columns;
-  this->jump_rows = other.jump_rows;
-  this->sliced = other.sliced;
-  this->data = std::move(other.data);
 }
 
 template <TensorConcept::Types T>
 Tensor_mml<T>::Tensor_mml(const Tensor_mml &other) : Tensor<T>(other) {
   this->shape = array_mml<size_t>(other.shape);
   this->indices_offsets = array_mml<size_t>(other.indices_offsets);
-  this->data = array_mml<T>(other.data);
+  this->strides = array_mml<size_t>(other.indices_offsets);
+  this->storage_offset = 0;
+  this->contiguous_layout = true;
   this->size = other.size;
-  this->jump_indexes = other.jump_indexes;
-  this->jump_columns = other.jump_columns;
-  this->jump_rows = other.jump_rows;
-  this->sliced = other.sliced;
+  this->buffer = array_mml<T>(this->size);
+
+  // Only the elements of a view are copied, in row-major order
+  T *out = this->buffer.get();
+  if (other.contiguous_layout) {
+    std::copy(other.data(), other.data() + this->size, out);
+  } else {
+    const T *in = other.buffer.get();
+    other.for_each_offset([&](size_t position) { *out++ = in[position]; });
+  }
 }
 
 template <TensorConcept::Types T>
 const array_mml<T> &Tensor_mml<T>::get_data() const {
-  return this->data;
+  return this->buffer;
+}
+
+template <TensorConcept::Types T>
+T *Tensor_mml<T>::data() {
+  return this->buffer.get() + this->storage_offset;
+}
+
+template <TensorConcept::Types T>
+const T *Tensor_mml<T>::data() const {
+  return this->buffer.get() + this->storage_offset;
+}
+
+template <TensorConcept::Types T>
+const array_mml<size_t> &Tensor_mml<T>::get_strides() const {
+  return this->strides;
+}
+
+template <TensorConcept::Types T>
+bool Tensor_mml<T>::is_contiguous() const {
+  return this->contiguous_layout;
+}
+
+template <TensorConcept::Types T>
+std::shared_ptr<Tensor<T>> Tensor_mml<T>::contiguous() const {
+  if (this->contiguous_layout) {
+    return make_view(this->shape, this->strides, this->storage_offset);
+  }
+  return copy();
 }
 
 template <TensorConcept::Types T>
 Tensor<T> &Tensor_mml<T>::operator=(const Tensor<T> &other) {
   if (this != &other) {
-    auto other_cast = dynamic_cast<const Tensor_mml<T> &>(other);
-    this->shape = array_mml<size_t>(other_cast.shape);
-    this->indices_offsets = array_mml<size_t>(other_cast.indices_offsets);
-    this->data = array_mml<T>(other_cast.data);
-    this->size = other_cast.size;
-    this->jump_indexes = other_cast.jump_indexes;
-    this->jump_columns = other_cast.jump_columns;
-    this->jump_rows = other_cast.jump_rows;
-    this->sliced = other_cast.sliced;
+    Tensor_mml<T> other_copy(dynamic_cast<const Tensor_mml<T> &>(other));
+    *this = std::move(static_cast<Tensor<T> &>(other_copy));
   }
   return *this;
 }
@@ -115,15 +137,14 @@ Tensor<T> &Tensor_mml<T>::operator=(const Tensor<T> &other) {
 template <TensorConcept::Types T>
 Tensor<T> &Tensor_mml<T>::operator=(Tensor<T> &&other) noexcept {
   if (this != &other) {
-    auto other_cast = dynamic_cast<Tensor_mml<T> &&>(std::move(other));
-    this->data = std::move(other_cast.data);
+    auto &other_cast = dynamic_cast<Tensor_mml<T> &>(other);
+    this->buffer = std::move(other_cast.buffer);
     this->shape = std::move(other_cast.shape);
     this->indices_offsets = std::move(other_cast.indices_offsets);
+    this->strides = std::move(other_cast.strides);
+    this->storage_offset = other_cast.storage_offset;
+    this->contiguous_layout = other_cast.contiguous_layout;
     this->size = other_cast.size;
-    this->jump_indexes = other_cast.jump_indexes;
-    this->jump_columns = other_cast.jump_columns;
-    this->jump_rows = other_cast.jump_rows;
-    this->sliced = other_cast.sliced;
   }
   return *this;
 }
@@ -165,8 +186,14 @@ std::shared_ptr<Tensor<T>> Tensor_mml<T>::copy() const {
 template <TensorConcept::Types T>
 void Tensor_mml<T>::reshape(const array_mml<size_t> &new_shape) {
   if (!valid_shape(new_shape)) throw std::invalid_argument("Invalid shape");
+  if (!this->contiguous_layout) {
+    // Strides can not describe every reshape of a view, copy its elements
+    Tensor_mml<T> packed(*this);
+    *this = std::move(static_cast<Tensor<T> &>(packed));
+  }
   this->shape = array_mml<size_t>(new_shape);
-  this->indices_offsets = compute_indices_offsets();
+  this->indices_offsets = compute_indices_offsets(this->shape);
+  this->strides = array_mml<size_t>(this->indices_offsets);
 }
 
 template <TensorConcept::Types T>
@@ -174,16 +201,31 @@ void Tensor_mml<T>::reshape(std::initializer_list<size_t> new_shape) {
   reshape(array_mml<size_t>(new_shape));
 }
 
+template <TensorConcept::Types T>
+std::shared_ptr<Tensor<T>> Tensor_mml<T>::reshape_view(
+    const array_mml<size_t> &new_shape) const {
+  if (!valid_shape(new_shape)) throw std::invalid_argument("Invalid shape");
+  if (!this->contiguous_layout) {
+    auto reshaped = copy();
+    reshaped->reshape(new_shape);
+    return reshaped;
+  }
+  return make_view(new_shape, compute_indices_offsets(new_shape),
+                   this->storage_offset);
+}
+
 template <TensorConcept::Types T>
 void Tensor_mml<T>::reverse_buffer() {
-  size_t i = 0;
-  size_t j = this->size - 1;
-  while (i < j) {
-    T temp = this->data[i];
-    this->data[i] = this->data[j];
-    this->data[j] = temp;
-    i++;
-    j--;
+  if (this->contiguous_layout) {
+    std::reverse(data(), data() + this->size);
+    return;
+  }
+
+  std::vector<size_t> positions;
+  positions.reserve(this->size);
+  for_each_offset([&](size_t position) { positions.push_back(position); });
+  for (size_t i = 0, j = this->size - 1; i < j; i++, j--) {
+    std::swap(element(positions[i]), element(positions[j]));
   }
 }
 
@@ -200,42 +242,32 @@ std::shared_ptr<Tensor<T>> Tensor_mml<T>::slice(
   if (!valid_slice_indices(slice_indices))
     throw std::invalid_argument("Invalid slice indices");
 
-  // Find the value of jump indexes
-  size_t slice_jump_indexes = this->sliced ? this->jump_indexes : 0;
-
-  // Calculate the jump indexes, ignore tensors that are matrices
-  if (this->shape.size() > 2) {
-    size_t i = 0;
-    do {
-      slice_jump_indexes += this->indices_offsets[i] * slice_indices[i];
-    } while (i++, i < slice_indices.size() - 1);
-  }
-
-  // Create the buffer
-  std::shared_ptr<T[]> data_ptr(this->data.get(), [](T *) { /* NOOP */ });
-  auto shared_buffer = array_mml<T>(data_ptr, this->data.size());
-
-  // New shape and jump row/col for column slices.
-  array_mml<size_t> slice_shape(this->shape.size() - slice_indices.size());
-  size_t slice_jump_columns = 0;
-  size_t slice_jump_rows = 1;
-  // Is the slice a column slice?
-  if (slice_indices.size() == this->shape.size() - 1) {
-    slice_jump_columns = slice_indices[slice_indices.size() - 1];
-    slice_jump_rows = this->shape[this->shape.size() - 1];
-    slice_shape[0] = this->shape[this->shape.size() - 2];
-  } else {
-    // Create the slice shape
-    for (size_t i = 0; i < slice_shape.size(); i++) {
-      slice_shape[i] = this->shape[i + slice_indices.size()];
+  const size_t rank = this->shape.size();
+  const size_t count = slice_indices.size();
+  size_t slice_offset = this->storage_offset;
+
+  // A column slice fixes the leading indices and the last one, it keeps the
+  // second to last dimension
+  if (count == rank - 1) {
+    for (size_t i = 0; i + 1 < count; i++) {
+      slice_offset += slice_indices[i] * this->strides[i];
     }
+    slice_offset += slice_indices[count - 1] * this->strides[rank - 1];
+    return make_view(array_mml<size_t>{this->shape[rank - 2]},
+                     array_mml<size_t>{this->strides[rank - 2]}, slice_offset);
   }
 
-  auto sliced_tensor = std::make_shared<Tensor_mml<T>>(
-      slice_shape, shared_buffer, slice_jump_indexes, slice_jump_columns,
-      slice_jump_rows, true);
-
-  return sliced_tensor;
+  // Any other slice fixes the leading indices
+  array_mml<size_t> slice_shape(rank - count);
+  array_mml<size_t> slice_strides(rank - count);
+  for (size_t i = 0; i < count; i++) {
+    slice_offset += slice_indices[i] * this->strides[i];
+  }
+  for (size_t i = count; i < rank; i++) {
+    slice_shape[i - count] = this->shape[i];
+    slice_strides[i - count] = this->strides[i];
+  }
+  return make_view(slice_shape, slice_strides, slice_offset);
 }
 
 template <TensorConcept::Types T>
@@ -275,18 +307,14 @@ template <TensorConcept::Types T>
 const T &Tensor_mml<T>::operator[](array_mml<size_t> &indices) const {
   if (!valid_indices(indices))
     throw std::invalid_argument("Invalid Tensor indices");
-  if (this->sliced)
-    return this->data[index_to_offset_1d_index(indices_to_1d_index(indices))];
-  return this->data[indices_to_1d_index(indices)];
+  return element(indices_to_offset(indices));
 }
 
 template <TensorConcept::Types T>
 T &Tensor_mml<T>::operator[](array_mml<size_t> &indices) {
   if (!valid_indices(indices))
     throw std::invalid_argument("Invalid Tensor indices");
-  if (this->sliced)
-    return this->data[index_to_offset_1d_index(indices_to_1d_index(indices))];
-  return this->data[indices_to_1d_index(indices)];
+  return element(indices_to_offset(indices));
 }
 
 template <TensorConcept::Types T>
@@ -305,20 +333,23 @@ T &Tensor_mml<T>::operator[](std::initializer_list<size_t> indices) {
 template <TensorConcept::Types T>
 const T &Tensor_mml<T>::operator[](size_t index) const {
   if (!valid_index(index)) throw std::invalid_argument("Invalid Tensor index");
-  if (this->sliced) return this->data[index_to_offset_1d_index(index)];
-  return this->data[index];
+  return element(index_to_offset(index));
 }
 
 template <TensorConcept::Types T>
 T &Tensor_mml<T>::operator[](size_t index) {
   if (!valid_index(index)) throw std::invalid_argument("Invalid Tensor index");
-  if (this->sliced) return this->data[index_to_offset_1d_index(index)];
-  return this->data[index];
+  return element(index_to_offset(index));
 }
 
 template <TensorConcept::Types T>
 void Tensor_mml<T>::fill(T value) {
-  this->data.fill(value);
+  if (this->contiguous_layout) {
+    std::fill(data(), data() + this->size, value);
+    return;
+  }
+  T *out = this->buffer.get();
+  for_each_offset([&](size_t position) { out[position] = value; });
 }
 
 template <TensorConcept::Types T>
@@ -332,45 +363,13 @@ std::shared_ptr<Tensor<T>> Tensor_mml<T>::transpose(
     throw std::invalid_argument("Transpose dimensions out of range");
   }
 
-  if (d0 == d1) {
-    return this->copy();
-  }
-
-  array_mml<size_t> new_shape = this->shape;
+  array_mml<size_t> new_shape(this->shape);
+  array_mml<size_t> new_strides(this->strides);
   std::swap(new_shape[d0], new_shape[d1]);
+  std::swap(new_strides[d0], new_strides[d1]);
 
-  auto transposed = std::make_shared<Tensor_mml<T>>(new_shape);
-
-  if (rank == 2 && d0 == 0 && d1 == 1) {
-    // Optimize the common 2D matrix transpose case
-    for (size_t i = 0; i < this->shape[0]; i++) {
-      for (size_t j = 0; j < this->shape[1]; j++) {
-        (*transposed)[{j, i}] = (*this)[{i, j}];
-      }
-    }
-  } else {
-    std::function<void(array_mml<size_t> &, size_t)> transpose_recursive;
-    transpose_recursive = [&](array_mml<size_t> &indices, size_t dim) {
-      if (dim == rank) {
-        array_mml<size_t> transposed_indices = indices;
-        std::swap(transposed_indices[d0], transposed_indices[d1]);
-        (*transposed)[transposed_indices] = (*this)[indices];
-        return;
-      }
-
-      for (size_t i = 0; i < this->shape[dim]; ++i) {
-        indices[dim] = i;
-        transpose_recursive(indices, dim + 1);
-      }
-    };
-
-    array_mml<size_t> indices(rank);
-    indices.fill(0);
-    transpose_recursive(indices, 0);
-  }
-
-  return transposed;
-};
+  return make_view(new_shape, new_strides, this->storage_offset);
+}
 
 template <TensorConcept::Types T>
 std::shared_ptr<Tensor<T>> Tensor_mml<T>::transpose(
@@ -390,119 +389,141 @@ std::shared_ptr<Tensor<T>> Tensor_mml<T>::transpose(
     seen[p] = true;
   }
 
+  // Dimension i of the view is dimension perm[i] of the tensor
   array_mml<size_t> new_shape(perm.size());
-
+  array_mml<size_t> new_strides(perm.size());
   for (size_t i = 0; i < perm.size(); ++i) {
-    size_t val = shape[perm[i]];
-    new_shape[i] = val;
-  }
-
-  auto transposed = std::make_shared<Tensor_mml<T>>(new_shape);
-  // This recursive function remaps each element in the old tensor to the new
-  // permutation based in the perm vector
-  std::function<void(array_mml<size_t> &, size_t)> recurse;
-  recurse = [&](array_mml<size_t> &indices, size_t dim) {
-    if (dim == shape.size()) {
-      array_mml<size_t> transposed_indices(perm.size());
-
-      for (size_t i = 0; i < perm.size(); ++i) {
-        if (perm[i] >= indices.size()) {
-          std::cerr << "ERROR: perm[" << i << "] = " << perm[i]
-                    << " out of bounds for indices of size " << indices.size()
-                    << std::endl;
-          throw std::out_of_range("perm index out of bounds");
-        }
-        transposed_indices[i] = indices[perm[i]];
-      }
-
-      try {
-        auto val = (*this)[indices];
-        (*transposed)[transposed_indices] = val;
-      } catch (const std::exception &e) {
-        std::cerr << "Exception accessing tensor at ";
-        for (size_t idx : indices) std::cerr << idx << " ";
-        std::cerr << " or transposed at ";
-        for (size_t idx : transposed_indices) std::cerr << idx << " ";
-        std::cerr << ": " << e.what() << std::endl;
-        throw;
-      }
-
-      return;
-    }
-
-    for (size_t i = 0; i < shape[dim]; ++i) {
-      indices[dim] = i;
-      recurse(indices, dim + 1);
-    }
-  };
-
-  array_mml<size_t> indices(shape.size());
-  indices.fill(0);
-  recurse(indices, 0);
+    new_shape[i] = this->shape[perm[i]];
+    new_strides[i] = this->strides[perm[i]];
+  }
 
-  return transposed;
+  return make_view(new_shape, new_strides, this->storage_offset);
 }
 
 template <TensorConcept::Types T>
-bool Tensor_mml<T>::valid_broadcast_reshape_size(
+std::shared_ptr<Tensor<T>> Tensor_mml<T>::broadcast_reshape(
     const array_mml<size_t> &target_shape) const {
-  const array_mml<size_t> &current_shape = this->shape;
-
-  size_t i = current_shape.size();
-  size_t j = target_shape.size();
+  const size_t rank = this->shape.size();
+  const size_t target_rank = target_shape.size();
+
+  // Dimensions are matched from the last one, extra leading dimensions of
+  // the tensor must be 1
+  for (size_t i = 0; i + target_rank < rank; i++) {
+    if (this->shape[i] != 1)
+      throw std::invalid_argument("Cannot broadcast tensor to target shape");
+  }
 
-  while (i > 0 && j > 0) {
-    i--;
-    j--;
-    // Dimensions must either be equal or one must be 1
-    if (current_shape[i] != target_shape[j] && current_shape[i] != 1 &&
-        target_shape[j] != 1) {
-      return false;
+  // Broadcast dimensions repeat the same elements with a stride of 0
+  array_mml<size_t> broadcast_strides(target_rank);
+  for (size_t j = 0; j < target_rank; j++) {
+    if (j + rank < target_rank) {
+      broadcast_strides[j] = 0;
+      continue;
+    }
+    const size_t i = j + rank - target_rank;
+    if (this->shape[i] == target_shape[j]) {
+      broadcast_strides[j] = this->strides[i];
+    } else if (this->shape[i] == 1) {
+      broadcast_strides[j] = 0;
+    } else {
+      throw std::invalid_argument("Cannot broadcast tensor to target shape");
     }
   }
 
-  // If the current tensor has remaining dimensions, they must all be 1
-  while (i > 0) {
-    i--;
-    if (current_shape[i] != 1) return false;
+  return make_view(target_shape, broadcast_strides, this->storage_offset);
+}
+
+template <TensorConcept::Types T>
+std::shared_ptr<Tensor<T>> Tensor_mml<T>::unsqueeze(size_t axis) const {
+  const size_t rank = this->shape.size();
+  if (axis > rank) throw std::invalid_argument("Unsqueeze axis out of range");
+
+  array_mml<size_t> new_shape(rank + 1);
+  array_mml<size_t> new_strides(rank + 1);
+  for (size_t i = 0, j = 0; i <= rank; i++) {
+    if (i == axis) {
+      new_shape[i] = 1;
+      new_strides[i] =
+          axis < rank ? this->strides[axis] * this->shape[axis] : 1;
+    } else {
+      new_shape[i] = this->shape[j];
+      new_strides[i] = this->strides[j];
+      j++;
+    }
   }
 
-  return true;
-};
+  return make_view(new_shape, new_strides, this->storage_offset);
+}
 
 template <TensorConcept::Types T>
-std::shared_ptr<Tensor<T>> Tensor_mml<T>::broadcast_reshape(
-    const array_mml<size_t> &target_shape) const {
-  if (this->shape == target_shape) return this->copy();
+std::shared_ptr<Tensor<T>> Tensor_mml<T>::squeeze(
+    std::optional<size_t> axis) const {
+  const size_t rank = this->shape.size();
+  if (axis.has_value() && (*axis >= rank || this->shape[*axis] != 1)) {
+    throw std::invalid_argument("Squeeze axis must be a dimension of size 1");
+  }
+
+  auto removed = [&](size_t i) {
+    return axis.has_value() ? i == *axis : this->shape[i] == 1;
+  };
+  size_t new_rank = 0;
+  for (size_t i = 0; i < rank; i++) {
+    if (!removed(i)) new_rank++;
+  }
 
-  if (!valid_broadcast_reshape_size(target_shape))
-    throw std::invalid_argument("Cannot broadcast tensor to target shape");
+  array_mml<size_t> new_shape(new_rank);
+  array_mml<size_t> new_strides(new_rank);
+  for (size_t i = 0, j = 0; i < rank; i++) {
+    if (!removed(i)) {
+      new_shape[j] = this->shape[i];
+      new_strides[j] = this->strides[i];
+      j++;
+    }
+  }
 
-  if (this->sliced) throw std::logic_error("Cannot broadcast a sliced tensor");
+  return make_view(new_shape, new_strides, this->storage_offset);
+}
 
-  // Caclulate how many times we should repeat the tensor
-  size_t tensor_size = this->data.size();
-  size_t target_size = std::accumulate(target_shape.begin(), target_shape.end(),
-                                       1, std::multiplies<size_t>());
-  size_t repeat_count = target_size / tensor_size;
+template <TensorConcept::Types T>
+std::shared_ptr<Tensor<T>> Tensor_mml<T>::make_view(
+    const array_mml<size_t> &view_shape, const array_mml<size_t> &view_strides,
+    size_t view_offset) const {
+  return std::shared_ptr<Tensor<T>>(new Tensor_mml<T>(
+      this->buffer.share(), view_shape, view_strides, view_offset));
+}
 
-  // Create the new buffer
-  auto broadcasted_buffer = array_mml<T>(this->data.size() * repeat_count);
-  for (size_t i = 0; i < repeat_count; i++) {
-    for (size_t j = 0; j < tensor_size; j++) {
-      broadcasted_buffer[i * tensor_size + j] = this->data[j];
+template <TensorConcept::Types T>
+template <typename F>
+void Tensor_mml<T>::for_each_offset(F &&f) const {
+  if (this->size == 0) return;
+  if (this->contiguous_layout) {
+    for (size_t i = 0; i < this->size; i++) {
+      f(this->storage_offset + i);
     }
+    return;
   }
 
-  // Create the new tensor
-  auto broadcasted_tensor =
-      std::make_shared<Tensor_mml<T>>(target_shape, broadcasted_buffer);
-  return broadcasted_tensor;
-};
+  // Steps through the indices like an odometer, the last dimension fastest
+  const size_t rank = this->shape.size();
+  const size_t *shape_data = this->shape.get();
+  const size_t *strides_data = this->strides.get();
+  std::vector<size_t> indices(rank, 0);
+  size_t position = this->storage_offset;
+  for (size_t i = 0; i < this->size; i++) {
+    f(position);
+    for (size_t d = rank; d-- > 0;) {
+      position += strides_data[d];
+      if (++indices[d] < shape_data[d]) break;
+      position -= strides_data[d] * shape_data[d];
+      indices[d] = 0;
+    }
+  }
+}
 
 template <TensorConcept::Types T>
-array_mml<size_t> Tensor_mml<T>::compute_indices_offsets() const {
-  const size_t shape_size = this->shape.size();
+array_mml<size_t> Tensor_mml<T>::compute_indices_offsets(
+    const array_mml<size_t> &shape) {
+  const size_t shape_size = shape.size();
   array_mml<size_t> computed_offsets(shape_size);
 
   if (shape_size == 0) {
@@ -514,7 +535,7 @@ array_mml<size_t> Tensor_mml<T>::compute_indices_offsets() const {
 
   // Fill in offsets backwards
   for (int i = static_cast<int>(shape_size) - 2; i >= 0; --i) {
-    computed_offsets[i] = this->shape[i + 1] * computed_offsets[i + 1];
+    computed_offsets[i] = shape[i + 1] * computed_offsets[i + 1];
   }
 
   return computed_offsets;
@@ -526,13 +547,25 @@ size_t Tensor_mml<T>::compute_size() const {
     return 1;  // Scalar tensor has 1 value
   }
 
-  return std::accumulate(this->shape.begin(), this->shape.end(), 1,
+  return std::accumulate(this->shape.begin(), this->shape.end(), size_t(1),
                          std::multiplies<size_t>());
 }
 
+template <TensorConcept::Types T>
+bool Tensor_mml<T>::compute_contiguous_layout() const {
+  if (this->size == 0) return true;
+  // The stride of a dimension of size 1 is never used
+  for (size_t i = 0; i < this->shape.size(); i++) {
+    if (this->shape[i] != 1 && this->strides[i] != this->indices_offsets[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
 template <TensorConcept::Types T>
 bool Tensor_mml<T>::valid_shape(const array_mml<size_t> &new_shape) const {
-  return std::accumulate(new_shape.begin(), new_shape.end(), 1,
+  return std::accumulate(new_shape.begin(), new_shape.end(), size_t(1),
                          std::multiplies<size_t>()) == this->get_size();
 }
 
@@ -555,31 +588,62 @@ bool Tensor_mml<T>::valid_indices(const array_mml<size_t> &indices) const {
 }
 
 template <TensorConcept::Types T>
-size_t Tensor_mml<T>::indices_to_1d_index(array_mml<size_t> indices) const {
-  auto index = 0;
+size_t Tensor_mml<T>::indices_to_offset(
+    const array_mml<size_t> &indices) const {
+  size_t position = this->storage_offset;
   for (size_t i = 0; i < indices.size(); i++) {
-    index += (indices[i]) * this->indices_offsets[i];
+    position += indices[i] * this->strides[i];
   }
-  return index;
+  return position;
 }
 
 template <TensorConcept::Types T>
-size_t Tensor_mml<T>::index_to_offset_1d_index(size_t index) const {
-  if (!this->sliced) throw std::logic_error("Not a sliced tensor");
-  return this->jump_indexes + index * this->jump_rows + this->jump_columns;
+size_t Tensor_mml<T>::index_to_offset(size_t index) const {
+  if (this->contiguous_layout) return this->storage_offset + index;
+
+  // Splits the row-major index in indices, from the first dimension
+  const size_t *offsets_data = this->indices_offsets.get();
+  const size_t *strides_data = this->strides.get();
+  size_t position = this->storage_offset;
+  for (size_t i = 0; i < this->shape.size(); i++) {
+    position += index / offsets_data[i] * strides_data[i];
+    index %= offsets_data[i];
+  }
+  return position;
+}
+
+template <TensorConcept::Types T>
+T &Tensor_mml<T>::element(size_t position) {
+#ifdef MML_CHECKED_ACCESS
+  return this->buffer[position];
+#else
+  return this->buffer.get()[position];
+#endif
+}
+
+template <TensorConcept::Types T>
+const T &Tensor_mml<T>::element(size_t position) const {
+#ifdef MML_CHECKED_ACCESS
+  return this->buffer[position];
+#else
+  return this->buffer.get()[position];
+#endif
 }
 
 template <TensorConcept::Types T>
 bool Tensor_mml<T>::valid_slice_indices(
     const array_mml<size_t> &slice_indices) const {
-  if (slice_indices.size() >= this->shape.size()) {
+  const size_t rank = this->shape.size();
+  const size_t count = slice_indices.size();
+  if (count >= rank) {
     return false;
   }
-  size_t slice_shape_dif = this->shape.size() - slice_indices.size();
-  for (size_t i = 0; i < slice_indices.size(); i++) {
-    if (slice_indices[i] >= this->shape[i + slice_shape_dif]) {
+  for (size_t i = 0; i < count; i++) {
+    // The last index of a column slice is a column
+    const size_t dim = (count == rank - 1 && i == count - 1) ? rank - 1 : i;
+    if (slice_indices[i] >= this->shape[dim]) {
       return false;
     }
   }
   return true;
-}
\ No newline at end of file
+}
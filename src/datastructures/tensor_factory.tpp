@@ -70,4 +70,12 @@ std::shared_ptr<Tensor<T>> TensorFactory::random_tensor(
   }
 
   return nullptr;
-}
\ No newline at end of file
+}
+
+inline void TensorFactory::set_allocator(std::shared_ptr<Allocator> allocator) {
+  Allocator::set_global(std::move(allocator));
+}
+
+inline std::shared_ptr<Allocator> TensorFactory::get_allocator() {
+  return Allocator::global();
+}
@@ -2,6 +2,8 @@
 
 #include <cstdlib>
 #include <memory>
+#include <span>
+#include <stdexcept>
 
 #include "datastructures/mml_array.hpp"
 #include "datastructures/tensor_concept.hpp"
@@ -98,6 +100,63 @@ class Tensor {
   /// @return The total number of elements in the tensor.
   virtual size_t get_size() const = 0;
 
+  /// @brief Get a pointer to the first element of the tensor.
+  /// @details The element at some indices is at the dot product of the
+  /// indices and get_strides() from this pointer, element i of a contiguous
+  /// tensor is at data()[i]. Nothing is bounds checked.
+  /// @return A pointer to the first element of the tensor.
+  virtual T *data() = 0;
+
+  /// @brief Get a const pointer to the first element of the tensor.
+  /// @return A const pointer to the first element of the tensor.
+  virtual const T *data() const = 0;
+
+  /// @brief Get the strides of the tensor, in elements.
+  /// @details Broadcast dimensions have a stride of 0.
+  /// @return The distance between two consecutive indices of every dimension.
+  virtual const array_mml<size_t> &get_strides() const = 0;
+
+  /// @brief Check if the elements of the tensor are stored contiguously in
+  /// row-major order.
+  /// @return True if the elements are contiguous, false otherwise.
+  virtual bool is_contiguous() const = 0;
+
+  /// @brief Get the tensor with its elements stored contiguously.
+  /// @return A view of the tensor if it is contiguous, a contiguous copy
+  /// otherwise.
+  virtual std::shared_ptr<Tensor<T>> contiguous() const = 0;
+
+  /// @brief Check if kernels may loop over data() directly.
+  /// @details False for tensors that are not contiguous and always false when
+  /// built with MML_CHECKED_ACCESS, so that kernels take their indexed and
+  /// bounds checked path for debugging.
+  /// @return True if raw access is allowed, false otherwise.
+  bool raw_access() const {
+#ifdef MML_CHECKED_ACCESS
+    return false;
+#else
+    return is_contiguous();
+#endif
+  }
+
+  /// @brief Get the elements of a contiguous tensor.
+  /// @return A span over the elements of the tensor.
+  /// @throws std::logic_error If the tensor is not contiguous.
+  std::span<T> span() {
+    if (!is_contiguous())
+      throw std::logic_error("Cannot get a span of a non-contiguous tensor");
+    return std::span<T>(data(), get_size());
+  }
+
+  /// @brief Get the elements of a contiguous tensor.
+  /// @return A const span over the elements of the tensor.
+  /// @throws std::logic_error If the tensor is not contiguous.
+  std::span<const T> span() const {
+    if (!is_contiguous())
+      throw std::logic_error("Cannot get a span of a non-contiguous tensor");
+    return std::span<const T>(data(), get_size());
+  }
+
   /// @brief Fills the tensor with a given value.
   /// @param value The value to fill the tensor with.
   virtual void fill(T value) = 0;
@@ -127,6 +186,13 @@ class Tensor {
   /// integers.
   virtual void reshape(std::initializer_list<size_t> new_shape) = 0;
 
+  /// @brief Get the tensor with another shape of the same size.
+  /// @param new_shape The new shape of the tensor.
+  /// @return A view of the tensor if it is contiguous, a reshaped contiguous
+  /// copy otherwise.
+  virtual std::shared_ptr<Tensor<T>> reshape_view(
+      const array_mml<size_t> &new_shape) const = 0;
+
   /// @brief Display the tensor.
   /// @return A string representation of the tensor.
   virtual std::string to_string() const = 0;
@@ -135,7 +201,7 @@ class Tensor {
   /// @return True if the tensor is a matrix (has rank 2), false otherwise.
   virtual bool is_matrix() const = 0;
 
-  /// @brief Transpose the tensor along specified dimensions.
+  /// @brief Transpose the tensor along specified dimensions, as a view.
   /// @param dim0 First dimension to transpose (optional).
   /// @param dim1 Second dimension to transpose (optional).
   /// @return A shared pointer to the transposed tensor.
@@ -143,19 +209,32 @@ class Tensor {
       std::optional<size_t> dim0 = std::nullopt,
       std::optional<size_t> dim1 = std::nullopt) const = 0;
 
-  /// @brief Transpose the tensor according to the specified permutation.
+  /// @brief Transpose the tensor according to the specified permutation, as a
+  /// view.
   /// @param perm Vector defining the permutation of dimensions.
   /// @return A shared pointer to the transposed tensor.
   virtual std::shared_ptr<Tensor<T>> transpose(
       const std::vector<int> &perm) const = 0;
 
-  /// @brief Reshape and broadcast the tensor to a target shape.
+  /// @brief Reshape and broadcast the tensor to a target shape, as a view
+  /// whose broadcast dimensions have a stride of 0.
   /// @param target_shape The target shape for broadcasting.
   /// @return A shared pointer to the broadcasted tensor.
   virtual std::shared_ptr<Tensor<T>> broadcast_reshape(
       const array_mml<size_t> &target_shape) const = 0;
 
-  /// @brief Create a copy of the tensor.
+  /// @brief Insert a dimension of size 1.
+  /// @param axis The position of the new dimension.
+  /// @return A view of the tensor with the new dimension.
+  virtual std::shared_ptr<Tensor<T>> unsqueeze(size_t axis) const = 0;
+
+  /// @brief Remove dimensions of size 1.
+  /// @param axis The dimension to remove, all dimensions of size 1 if empty.
+  /// @return A view of the tensor without the dimensions.
+  virtual std::shared_ptr<Tensor<T>> squeeze(
+      std::optional<size_t> axis = std::nullopt) const = 0;
+
+  /// @brief Create a contiguous copy of the tensor.
   /// @return A shared pointer to the copied tensor.
   virtual std::shared_ptr<Tensor<T>> copy() const = 0;
 };
\ No newline at end of file
@@ -20,8 +20,13 @@
 #include <variant>
 #include <vector>  // IWYU pragma: keep
 
+#include "utility/allocator.hpp"
+
 /// @brief Array class mimicking the std::array class but without the size being
 /// a template parameter.
+///
+/// The memory of the arrays is allocated from Allocator::global() and aligned
+/// to Allocator::alignment bytes, the elements are not initialized.
 /// @tparam T the type of the array.
 template <typename T>
 class array_mml {
@@ -131,11 +136,25 @@ class array_mml {
   /// @return A const pointer to the underlying data.
   const T *get() const;
 
+  /// @brief Get an array sharing the memory of this array.
+  /// @return An array of the same elements, which are not copied.
+  array_mml share() const;
+
+  /// @brief Get an array sharing the first elements of this array.
+  /// @param size The number of shared elements, at most the size of the array.
+  /// @return An array of the first size elements, which are not copied.
+  array_mml share(size_t size) const;
+
   /// @brief Fill the array with a given value.
   /// @param value The value to fill the array with.
   void fill(const T &value);
 
  private:
+  /// @brief Allocate the memory of an array from the global allocator.
+  /// @param size The number of elements.
+  /// @return The memory, given back to the allocator when it is released.
+  static std::shared_ptr<T[]> allocate(size_t size);
+
   std::shared_ptr<T[]> data;
   size_t d_size;
 };
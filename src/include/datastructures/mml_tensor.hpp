@@ -26,8 +26,11 @@
 /*!
  * @class Tensor_mml
  * @brief A Tensor<T> implementation using an underlying
- * fixed size 1D array with row-major offsets for
+ * fixed size 1D array with per-dimension strides for
  * multi-dimensional indexing.
+ * @details Slices, transposes, broadcasts and reshapes of a contiguous tensor
+ * are views sharing its array, with their own shape, strides and offset of the
+ * first element. Writing to a view writes to the tensor it was taken from.
  * @tparam T The type of the data contained in the tensor.
  * Allows for arithmetic types.
  */
@@ -36,58 +39,29 @@ class Tensor_mml : public Tensor<T> {
  public:
   /// @brief Constructor for Tensor_mml class.
   /// @param shape The shape of the tensor.
-  /// @param jump_indexes The number of elements to skip when moving to the next
-  /// @param jump_columns The number of elements to skip when moving to the next
-  /// column.
-  /// @param jump_rows The number of elements to skip when moving to the next
-  /// row.
-  /// @param sliced Whether the tensor is sliced or not.
-  explicit Tensor_mml(const std::initializer_list<size_t> shape,
-                      const size_t jump_indexes = 0,
-                      const size_t jump_columns = 0, const size_t jump_rows = 0,
-                      const bool sliced = false);
+  explicit Tensor_mml(const std::initializer_list<size_t> shape);
 
   /// @brief Constructor for Tensor_mml class.
   /// @param shape The shape of the tensor.
   /// @param data The data to set in the tensor.
-  /// @param jump_indexes The number of elements to skip when moving to the next
-  /// @param jump_columns The number of elements to skip when moving to the next
-  /// column.
-  /// @param jump_rows The number of elements to skip when moving to the next
-  /// row.
-  /// @param sliced Whether the tensor is sliced or not.
   explicit Tensor_mml(const std::initializer_list<size_t> shape,
-                      const std::initializer_list<T> data,
-                      const size_t jump_indexes = 0,
-                      const size_t jump_columns = 0, const size_t jump_rows = 0,
-                      const bool sliced = false);
+                      const std::initializer_list<T> data);
 
   /// @brief Constructor for Tensor_mml class.
   /// @param shape The shape of the tensor.
-  /// @param jump_indexes The number of elements to skip when moving to the next
-  /// @param jump_columns The number of elements to skip when moving to the next
-  /// column.
-  /// @param jump_rows The number of elements to skip when moving to the next
-  /// row.
-  /// @param sliced Whether the tensor is sliced or not.
-  explicit Tensor_mml(const array_mml<size_t> &shape,
-                      const size_t jump_indexes = 0,
-                      const size_t jump_columns = 0, const size_t jump_rows = 0,
-                      const bool sliced = false);
+  explicit Tensor_mml(const array_mml<size_t> &shape);
 
   /// @brief Constructor for Tensor_mml class.
   /// @param shape The shape of the tensor.
   /// @param data The data to set in the tensor.
-  /// @param jump_indexes The number of elements to skip when moving to the next
-  /// @param jump_columns The number of elements to skip when moving to the next
-  /// column.
-  /// @param jump_rows The number of elements to skip when moving to the next
-  /// row.
-  /// @param sliced Whether the tensor is sliced or not.
-  explicit Tensor_mml(const array_mml<size_t> &shape, const array_mml<T> &data,
-                      const size_t jump_indexes = 0,
-                      const size_t jump_columns = 0, const size_t jump_rows = 0,
-                      const bool sliced = false);
+  explicit Tensor_mml(const array_mml<size_t> &shape, const array_mml<T> &data);
+
+  /// @brief Constructor for Tensor_mml class taking over the given buffer.
+  /// @details The buffer is not copied, a buffer sharing its memory with
+  /// another array (e.g. an activation arena) stays shared.
+  /// @param shape The shape of the tensor.
+  /// @param data The data buffer of the tensor.
+  explicit Tensor_mml(const array_mml<size_t> &shape, array_mml<T> &&data);
 
   /// @brief Destructor for Tensor_mml class.
   ~Tensor_mml() = default;
@@ -96,15 +70,17 @@ class Tensor_mml : public Tensor<T> {
   /// @param other The tensor to move.
   Tensor_mml(Tensor_mml &&other) noexcept;
 
-  /// @brief Copy constructor for Tensor_mml class.
+  /// @brief Copy constructor for Tensor_mml class, the copy is contiguous.
   /// @param other The tensor to copy.
   Tensor_mml(const Tensor_mml &other);
 
-  /// @brief Get the raw 1D data of the tensor.
-  /// @return The data of the tensor.
+  /// @brief Get the buffer holding the data of the tensor.
+  /// @details The buffer is shared with the views of the tensor, the elements
+  /// of a view start at data() and are laid out by get_strides().
+  /// @return The buffer of the tensor.
   const array_mml<T> &get_data() const;
 
-  /// @brief Get the offsets of the tensor.
+  /// @brief Get the row-major offsets of the shape of the tensor.
   /// @return The offsets of the tensor.
   const array_mml<size_t> &get_offsets() const;
 
@@ -119,10 +95,17 @@ class Tensor_mml : public Tensor<T> {
   std::shared_ptr<Tensor<T>> slice(array_mml<size_t> &slice_indices) override;
   void reshape(const array_mml<size_t> &new_shape) override;
   void reshape(std::initializer_list<size_t> new_shape) override;
+  std::shared_ptr<Tensor<T>> reshape_view(
+      const array_mml<size_t> &new_shape) const override;
   bool is_matrix() const override;
   bool operator==(const Tensor<T> &other) const override;
   const array_mml<size_t> &get_shape() const override;
   size_t get_size() const override;
+  T *data() override;
+  const T *data() const override;
+  const array_mml<size_t> &get_strides() const override;
+  bool is_contiguous() const override;
+  std::shared_ptr<Tensor<T>> contiguous() const override;
   const T &operator[](array_mml<size_t> &indices) const override;
   T &operator[](array_mml<size_t> &indices) override;
   const T &operator[](std::initializer_list<size_t> indices) const override;
@@ -140,27 +123,49 @@ class Tensor_mml : public Tensor<T> {
   std::shared_ptr<Tensor<T>> broadcast_reshape(
       const array_mml<size_t> &target_shape) const override;
 
+  std::shared_ptr<Tensor<T>> unsqueeze(size_t axis) const override;
+
+  std::shared_ptr<Tensor<T>> squeeze(
+      std::optional<size_t> axis = std::nullopt) const override;
+
  private:
-  array_mml<T> data;
-  array_mml<size_t> shape;
-  array_mml<size_t> indices_offsets;
-  bool sliced;
-  size_t jump_indexes;
-  size_t jump_rows;
-  size_t jump_columns;
+  /// @brief Constructor for a view of a buffer.
+  /// @param buffer The buffer, shared with the viewed tensor.
+  /// @param shape The shape of the view.
+  /// @param strides The strides of the view.
+  /// @param offset The position of the first element of the view in the
+  /// buffer.
+  Tensor_mml(array_mml<T> &&buffer, const array_mml<size_t> &shape,
+             const array_mml<size_t> &strides, size_t offset);
+
+  array_mml<T> buffer;                // Elements, shared with views
+  array_mml<size_t> shape;            // Size of every dimension
+  array_mml<size_t> indices_offsets;  // Row-major offsets of the shape
+  array_mml<size_t> strides;          // Strides of the elements in buffer
+  size_t storage_offset;              // Position of the first element
+  bool contiguous_layout;             // True if strides are indices_offsets
   size_t size;
 
   // Helper methods
   size_t compute_size() const;
-  array_mml<size_t> compute_indices_offsets() const;
+  static array_mml<size_t> compute_indices_offsets(
+      const array_mml<size_t> &shape);
+  bool compute_contiguous_layout() const;
+  std::shared_ptr<Tensor<T>> make_view(const array_mml<size_t> &view_shape,
+                                       const array_mml<size_t> &view_strides,
+                                       size_t view_offset) const;
+  template <typename F>
+  void for_each_offset(F &&f) const;
   bool valid_shape(const array_mml<size_t> &new_shape) const;
   bool valid_indices(const array_mml<size_t> &indices) const;
   bool valid_index(size_t index) const;
   bool valid_slice_indices(const array_mml<size_t> &slice_indices) const;
-  bool valid_broadcast_reshape_size(
-      const array_mml<size_t> &target_shape) const;
-  size_t indices_to_1d_index(array_mml<size_t> indices) const;
-  size_t index_to_offset_1d_index(size_t index) const;
+  size_t indices_to_offset(const array_mml<size_t> &indices) const;
+  size_t index_to_offset(size_t index) const;
+  // Element at an offset of the buffer, bounds checked with
+  // MML_CHECKED_ACCESS only since the indices were validated
+  T &element(size_t position);
+  const T &element(size_t position) const;
 };
 
 #include "../datastructures/mml_tensor.tpp"
@@ -27,6 +27,7 @@
 #include "tensor_concept.hpp"
 #include "tensor_factory_function_types.hpp"
 #include "tensor_factory_functions.hpp"
+#include "utility/allocator.hpp"
 
 /**
  * @brief A static utility factory class for creating tensors with different
@@ -125,6 +126,18 @@ class TensorFactory {
   static std::shared_ptr<Tensor<T>> random_tensor(
       const array_mml<size_t> &shape, T lo_v = T(0), T hi_v = T(1));
 
+  /**
+   * @brief Set the allocator the memory of new tensors is allocated from.
+   * @param allocator The allocator, nullptr for a new default PoolAllocator.
+   */
+  static void set_allocator(std::shared_ptr<Allocator> allocator);
+
+  /**
+   * @brief Get the allocator the memory of new tensors is allocated from.
+   * @return The global allocator.
+   */
+  static std::shared_ptr<Allocator> get_allocator();
+
  private:
   // Private constructor to prevent instantiation.
   TensorFactory() = default;
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+// IWYU pragma: no_include <__vector/vector.h>
+#include <vector>  // IWYU pragma: keep
+
+#include "nodes/a_node.hpp"
+#include "utility/allocator.hpp"
+
+/**
+ * @class MemoryPlan
+ * @brief Static placement of the intermediate tensors of a compiled graph in a
+ * single activation arena.
+ *
+ * The plan is built from the intermediate tensors observed during one
+ * inference call. Every planned tensor gets a fixed offset in the arena and
+ * tensors whose lifetimes do not overlap share the same bytes, so the arena is
+ * only as large as the largest set of tensors alive at the same time.
+ */
+class MemoryPlan {
+ public:
+  /**
+   * @brief Alignment in bytes of the arena and of every tensor placed in it.
+   */
+  static constexpr size_t alignment = Allocator::alignment;
+
+  /**
+   * @typedef ViewFactory
+   * @brief Creates the tensor of a planned slot on top of the arena memory
+   * starting at the given address.
+   */
+  using ViewFactory = std::function<GeneralDataTypes(
+      const std::shared_ptr<std::byte[]> &arena, std::byte *address)>;
+
+  /**
+   * @typedef HappensBefore
+   * @brief Tells if a step always finishes before another one starts.
+   */
+  using HappensBefore = std::function<bool(size_t, size_t)>;
+
+  /**
+   * @struct TensorUsage
+   * @brief Lifetime, size and type of one intermediate tensor.
+   */
+  struct TensorUsage {
+    size_t slot;                     // Slot of the tensor in the execution plan
+    size_t first_step;               // Step producing the tensor
+    std::vector<size_t> last_steps;  // Steps reading the tensor
+    size_t bytes;                    // Size of the tensor data in bytes
+    ViewFactory make_tensor;         // Creates the tensor on top of the arena
+  };
+
+  /**
+   * @brief Describes an observed tensor so it can be recreated in the arena.
+   *
+   * @param tensor The tensor observed for the slot
+   * @param slot Slot of the tensor in the execution plan
+   * @param first_step Step producing the tensor
+   * @param readers Steps reading the tensor
+   * @return The usage of the tensor, with the same type and shape
+   */
+  static TensorUsage describe(const GeneralDataTypes &tensor, size_t slot,
+                              size_t first_step,
+                              const std::vector<size_t> &readers);
+
+  /**
+   * @brief Gets the address of the data of a tensor.
+   *
+   * @param tensor The tensor
+   * @return The address of the first element, or nullptr if the tensor is not
+   * backed by a known buffer type
+   */
+  static const void *data_address(const GeneralDataTypes &tensor);
+
+  /**
+   * @brief Places the given tensors in the arena.
+   *
+   * The tensors are placed from the largest to the smallest, each one at the
+   * lowest offset that does not overlap a tensor it may be alive together
+   * with. Two tensors may only share bytes if every reader of one of them
+   * finishes before the producer of the other starts, which holds for any
+   * order the executor runs independent steps in.
+   *
+   * @param usages The intermediate tensors to place
+   * @param happens_before The dependency order of the steps
+   */
+  MemoryPlan(std::vector<TensorUsage> usages,
+             const HappensBefore &happens_before);
+
+  /**
+   * @brief Gets the size of the arena.
+   *
+   * @return The size of the arena in bytes
+   */
+  size_t get_arena_size() const { return arena_size; }
+
+  /**
+   * @brief Gets the offset of a planned slot in the arena.
+   *
+   * @param slot The slot
+   * @return The offset in bytes
+   * @throws std::out_of_range If the slot is not planned
+   */
+  size_t get_offset(size_t slot) const;
+
+  /**
+   * @brief Checks if a slot has a place in the arena.
+   *
+   * @param slot The slot
+   * @return True if the tensor of the slot lives in the arena
+   */
+  bool is_planned(size_t slot) const { return slot_usage.contains(slot); }
+
+  /**
+   * @brief Allocates an arena for this plan from the global allocator.
+   *
+   * @return The aligned, uninitialized arena
+   */
+  std::shared_ptr<std::byte[]> allocate_arena() const;
+
+  /**
+   * @brief Creates the tensor of a planned slot on top of an arena.
+   *
+   * The tensor shares ownership of the arena, so the arena is kept alive for as
+   * long as the tensor is.
+   *
+   * @param slot The planned slot
+   * @param arena An arena allocated by this plan
+   * @return The tensor, with the type and shape observed when planning
+   */
+  GeneralDataTypes make_tensor(size_t slot,
+                               const std::shared_ptr<std::byte[]> &arena) const;
+
+ private:
+  std::vector<TensorUsage> usages;                // The planned tensors
+  std::vector<size_t> offsets;                    // Offset of each usage
+  std::unordered_map<size_t, size_t> slot_usage;  // Slot to usage index
+  size_t arena_size = 0;                          // Size of the arena
+};
@@ -1,14 +1,22 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 // IWYU pragma: no_include <__vector/vector.h>
 #include <vector>  // IWYU pragma: keep
 
 #include "model/a_model.hpp"
+#include "model/memory_plan.hpp"
 #include "nodes/a_node.hpp"
+#include "utility/thread_pool.hpp"
 
 /**
  * @class Model_mml
@@ -21,6 +29,72 @@
  */
 class Model_mml : public Model {
  public:
+  /**
+   * @typedef WeightStore
+   * @brief Map of tensor names to the constant tensors of the model.
+   */
+  using WeightStore = std::unordered_map<std::string, GeneralDataTypes>;
+
+  /**
+   * @struct ExecutionPlan
+   * @brief Immutable description of how to run the graph, built once by
+   * compile().
+   *
+   * Every tensor name referenced by the graph is given an integer slot, so an
+   * inference call can keep its tensors in a flat vector instead of a map
+   * keyed by strings.
+   */
+  struct ExecutionPlan {
+    /**
+     * @struct Step
+     * @brief A single node of the graph together with its resolved slots.
+     */
+    struct Step {
+      std::shared_ptr<Node> node;             // The node to run
+      std::vector<std::string> input_names;   // Names of the node inputs
+      std::vector<std::string> output_names;  // Names of the node outputs
+      std::vector<size_t> input_slots;        // Slots of the node inputs
+      std::vector<size_t> output_slots;       // Slots of the node outputs
+      std::vector<size_t> successors;  // Steps consuming one of the outputs
+      size_t predecessor_count = 0;    // Steps producing one of the inputs
+    };
+
+    std::vector<Step> steps;  // Steps in topological order
+
+    // Indexes into steps, grouped by topological level. Steps in the same
+    // level do not depend on each other.
+    std::vector<std::vector<size_t>> layers;
+
+    std::unordered_map<std::string, size_t> slot_ids;  // Name to slot
+    std::vector<std::string> slot_names;                // Slot to name
+
+    // The weights bound to their slots, empty for non constant slots
+    std::vector<std::optional<GeneralDataTypes>> constants;
+
+    std::vector<size_t> input_slots;   // Slots of the model inputs
+    std::vector<size_t> output_slots;  // Slots of the model outputs
+
+    // Steps reading each slot, once per input referencing the slot
+    std::vector<std::vector<size_t>> slot_readers;
+
+    // Slots kept alive until the end of the call: the model inputs, outputs
+    // and weights
+    std::vector<bool> keep_alive;
+
+    // reachable[a][b] is true if step b (transitively) depends on step a
+    std::vector<std::vector<bool>> reachable;
+
+    /**
+     * @brief Checks if a step always finishes before another one starts,
+     * whatever order the executor picks.
+     *
+     * @param a The index of the first step
+     * @param b The index of the second step
+     * @return True if step b depends on step a
+     */
+    bool happensBefore(size_t a, size_t b) const { return reachable[a][b]; }
+  };
+
   /**
    * @brief Default constructor for Model_mml.
    *
@@ -33,17 +107,35 @@ class Model_mml : public Model {
    *
    * @param initialNodes A vector of shared pointers to Node objects that form
    * the computational graph
-   * @param iomap A map of tensor names to their corresponding tensor objects
-   * for storing intermediate values
+   * @param weights A map of tensor names to the constant tensors (initializers)
+   * of the model. The map is moved into a read-only store that is shared by
+   * every call to infer.
+   * @param inputs A vector of input tensor names that the model expects
+   * @param outputs A vector of output tensor names that the model produces
+   */
+  explicit Model_mml(std::vector<std::shared_ptr<Node>> initialNodes,
+                     std::unordered_map<std::string, GeneralDataTypes> weights,
+                     std::vector<std::string> inputs,
+                     std::vector<std::string> outputs)
+      : Model_mml(std::move(initialNodes),
+                  std::make_shared<const WeightStore>(std::move(weights)),
+                  std::move(inputs), std::move(outputs)) {}
+
+  /**
+   * @brief Constructor for Model_mml sharing an already loaded weight store.
+   *
+   * @param initialNodes A vector of shared pointers to Node objects that form
+   * the computational graph
+   * @param weights A read-only store of the constant tensors of the model
    * @param inputs A vector of input tensor names that the model expects
    * @param outputs A vector of output tensor names that the model produces
    */
   explicit Model_mml(std::vector<std::shared_ptr<Node>> initialNodes,
-                     std::unordered_map<std::string, GeneralDataTypes> iomap,
+                     std::shared_ptr<const WeightStore> weights,
                      std::vector<std::string> inputs,
                      std::vector<std::string> outputs)
       : nodes(std::move(initialNodes)),
-        iomap(std::move(iomap)),
+        weights(std::move(weights)),
         inputs(std::move(inputs)),
         outputs(std::move(outputs)) {}
 
@@ -56,17 +148,192 @@ class Model_mml : public Model {
    *
    * @param node A shared pointer to a Node object to be added to the graph
    */
-  void addNode(std::shared_ptr<Node> node) { nodes.push_back(std::move(node)); }
+  void addNode(std::shared_ptr<Node> node) {
+    nodes.push_back(std::move(node));
+    resetPlan();
+  }
+
+  /**
+   * @brief Builds the execution plan of the model.
+   *
+   * Sorts the nodes topologically and rewrites the graph: BatchNormalization
+   * is folded into weights, activations are fused into their producers and
+   * the graph is blocked, as enabled. Then assigns an integer slot to every
+   * tensor name of the graph and resolves the input and output slots of each
+   * node. The plan runs copies of the nodes prepared for the weights, see
+   * Node::prepared_copy, so inference calls still running a previous plan are
+   * not affected. The plan is only rebuilt when the graph changes, infer calls
+   * compile itself if needed. Concurrent first calls to infer compile the plan
+   * once.
+   *
+   * @throws std::runtime_error If the graph has no nodes or has a cycle
+   */
+  void compile();
+
+  /**
+   * @brief Gets the execution plan of the model, compiling it if needed.
+   *
+   * @return The execution plan
+   */
+  const ExecutionPlan &getPlan() { return *currentPlan(); }
+
+  /**
+   * @brief Sets the maximum number of nodes run at the same time.
+   *
+   * Nodes whose inputs are all available are dispatched to the global thread
+   * pool as soon as their producers are done, up to this many at once. Results
+   * do not depend on the setting.
+   *
+   * @param max_nodes The maximum number of concurrent nodes, 1 runs the nodes
+   * one by one on the calling thread
+   */
+  void setMaxConcurrency(size_t max_nodes) {
+    max_concurrency = std::max<size_t>(max_nodes, 1);
+  }
+
+  /**
+   * @brief Gets the maximum number of nodes run at the same time.
+   *
+   * @return The maximum number of concurrent nodes
+   */
+  size_t getMaxConcurrency() const { return max_concurrency; }
+
+  /**
+   * @brief Enables or disables the progress log of infer.
+   *
+   * When enabled, infer prints every node it runs to std::cout. The log is
+   * written outside the scheduling of the nodes but still slows down
+   * inference, so it is disabled by default. Errors are always reported to
+   * std::cerr.
+   *
+   * @param enabled True to print the progress of inference calls
+   */
+  void setVerbose(bool enabled) { verbose = enabled; }
+
+  /**
+   * @brief Checks if infer prints its progress.
+   *
+   * @return True if the progress log is enabled
+   */
+  bool getVerbose() const { return verbose; }
+
+  /**
+   * @brief Enables or disables the blocked NCHWc layout.
+   *
+   * When enabled, compile replaces the nodes that support it by copies running
+   * in the blocked layout of operations/nchwc.hpp, see Node::blocked_copy. The
+   * convolutions start the blocked regions of the graph, the nodes consuming
+   * their outputs join them. ReorderNode steps are only inserted where a
+   * region starts, before nodes that only run plain and before the model
+   * outputs, which always are plain. Disabled by default.
+   *
+   * @param enabled True to run the graph in the blocked layout where possible
+   */
+  void setChannelBlocking(bool enabled) {
+    if (enabled != channel_blocking) {
+      channel_blocking = enabled;
+      resetPlan();
+    }
+  }
+
+  /**
+   * @brief Checks if the graph runs in the blocked NCHWc layout where possible.
+   *
+   * @return True if channel blocking is enabled
+   */
+  bool getChannelBlocking() const { return channel_blocking; }
+
+  /**
+   * @brief Enables or disables the fusion of activations into the nodes
+   * producing their input.
+   *
+   * When enabled, compile replaces a node whose only output is read by a
+   * single elementwise activation, and is not a model output, by a copy
+   * applying the activation itself, see Node::fused_copy. The activation node
+   * is then left out of the plan. Enabled by default.
+   *
+   * @param enabled True to fuse activations where possible
+   */
+  void setActivationFusion(bool enabled) {
+    if (enabled != activation_fusion) {
+      activation_fusion = enabled;
+      resetPlan();
+    }
+  }
+
+  /**
+   * @brief Checks if activations are fused into the nodes producing their
+   * input.
+   *
+   * @return True if activation fusion is enabled
+   */
+  bool getActivationFusion() const { return activation_fusion; }
+
+  /**
+   * @brief Enables or disables folding BatchNormalization into the weights of
+   * the node producing its input.
+   *
+   * When enabled, compile replaces a Conv or Gemm node whose only output is
+   * read by a single BatchNormalization with constant parameters, and is not
+   * a model output, by a copy with the normalization folded into its weights
+   * and bias, see Node::affine_folded_copy. The BatchNormalization is then
+   * left out of the plan. The weight store itself is not modified, the folded
+   * weights only belong to the plan. Enabled by default.
+   *
+   * @param enabled True to fold BatchNormalization where possible
+   */
+  void setBatchNormFolding(bool enabled) {
+    if (enabled != batch_norm_folding) {
+      batch_norm_folding = enabled;
+      resetPlan();
+    }
+  }
+
+  /**
+   * @brief Checks if BatchNormalization is folded into the weights of the
+   * node producing its input.
+   *
+   * @return True if BatchNormalization folding is enabled
+   */
+  bool getBatchNormFolding() const { return batch_norm_folding; }
+
+  /**
+   * @brief Gets the memory plan used for the given input tensors.
+   *
+   * @param inputs A map of input tensor names to their corresponding tensor
+   * values
+   * @return The memory plan for the shapes of the inputs, or nullptr if no
+   * inference has been run with such inputs yet
+   */
+  std::shared_ptr<const MemoryPlan> getMemoryPlan(
+      const std::unordered_map<std::string, GeneralDataTypes> &inputs);
 
   /**
    * @brief Runs inference on the model's computational graph.
    *
    * This method performs the following steps:
-   * 1. Updates the internal iomap with the provided input tensors
-   * 2. Performs a topological sort of the nodes to determine execution order
-   * 3. Executes each node's forward method in the determined order
+   * 1. Compiles the execution plan if it has not been built yet
+   * 2. Creates a per-call slot vector holding the weights and the provided
+   * input tensors
+   * 3. Executes each node's forward method as soon as its producers are done,
+   * up to the maximum concurrency at once, resolving its inputs and outputs
+   * through their precomputed slots and releasing every intermediate tensor
+   * after its last use
    * 4. Returns the output tensors as specified in the model's outputs list
    *
+   * The first call for a given set of input shapes records the intermediate
+   * tensors and builds a MemoryPlan. Later calls with the same shapes hand the
+   * nodes preallocated outputs placed in a single activation arena, which is
+   * recycled between calls.
+   *
+   * Neither the weight store nor the input tensors are copied, nodes are
+   * required to treat their inputs as read-only. The slot vector only ever
+   * holds the inputs and the intermediate tensors of the current call.
+   *
+   * Any number of threads may call infer at the same time, the nodes must
+   * then not modify themselves in forward, see Node::prepare. Modifying the
+   * graph or its settings while a call runs is not supported.
+   *
    * @param inputs A map of input tensor names to their corresponding tensor
    * values
    * @return A map of output tensor names to their computed tensor values
@@ -81,10 +348,11 @@ class Model_mml : public Model {
   std::vector<std::shared_ptr<Node>> nodes;
 
   /**
-   * @brief Map of tensor names to tensor objects for storing intermediate
-   * values
+   * @brief Read-only store of the constant tensors (weights) of the model,
+   * loaded once and shared by every inference call
    */
-  std::unordered_map<std::string, GeneralDataTypes> iomap;
+  std::shared_ptr<const WeightStore> weights =
+      std::make_shared<const WeightStore>();
 
   /**
    * @brief Names of input tensors that the model expects
@@ -96,6 +364,80 @@ class Model_mml : public Model {
    */
   std::vector<std::string> outputs;
 
+  /**
+   * @brief The compiled execution plan, null until compile is called
+   */
+  std::shared_ptr<const ExecutionPlan> plan;
+
+  /**
+   * @brief Guards the execution plan, locked before memory_mutex when both
+   * are needed
+   */
+  std::mutex plan_mutex;
+
+  /**
+   * @struct PlannedMemory
+   * @brief A memory plan together with the arenas free to be reused.
+   */
+  struct PlannedMemory {
+    std::shared_ptr<const MemoryPlan> plan;                // The memory plan
+    std::vector<std::shared_ptr<std::byte[]>> free_arenas;  // Unused arenas
+  };
+
+  /**
+   * @brief Memory plans indexed by the types and shapes of the model inputs
+   */
+  std::map<std::vector<std::vector<size_t>>, PlannedMemory> memory_plans;
+
+  /**
+   * @brief Guards the memory plans and their arenas
+   */
+  std::mutex memory_mutex;
+
+  /**
+   * @brief Maximum number of nodes run at the same time
+   */
+  size_t max_concurrency =
+      std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+  /**
+   * @brief Whether infer prints its progress
+   */
+  bool verbose = false;
+
+  /**
+   * @brief Whether compile runs the graph in the blocked NCHWc layout
+   */
+  bool channel_blocking = false;
+
+  /**
+   * @brief Whether compile fuses activations into their producers
+   */
+  bool activation_fusion = true;
+
+  /**
+   * @brief Whether compile folds BatchNormalization into weights
+   */
+  bool batch_norm_folding = true;
+
+  /**
+   * @brief Builds the execution plan, see compile. plan_mutex must be held.
+   */
+  void buildPlan();
+
+  /**
+   * @brief Gets the execution plan, building it first if there is none.
+   *
+   * @return The execution plan
+   */
+  std::shared_ptr<const ExecutionPlan> currentPlan();
+
+  /**
+   * @brief Drops the execution plan, after a change of the graph or of the
+   * settings it was built for.
+   */
+  void resetPlan();
+
   /**
    * @brief Performs a topological sort of the model's nodes
    *
@@ -103,8 +445,107 @@ class Model_mml : public Model {
    * level can be executed in parallel, and nodes in later levels depend on
    * nodes in earlier levels.
    *
+   * @param nodes The nodes to sort
    * @return A vector of vectors, where each inner vector contains nodes that
    * can be executed in parallel
    */
-  std::vector<std::vector<std::shared_ptr<Node>>> topologicalSort();
+  static std::vector<std::vector<std::shared_ptr<Node>>> topologicalSort(
+      const std::vector<std::shared_ptr<Node>> &nodes);
+
+  /**
+   * @brief Folds the per channel affine transforms of the graph, like
+   * BatchNormalization, into the weights of the nodes producing their input,
+   * where possible.
+   *
+   * A transform is folded when its input is the only output of its producer,
+   * is read by no other node and is not a model output. The producer is
+   * replaced by its folded copy writing the output of the transform.
+   *
+   * @param layers The nodes of the graph sorted topologically
+   * @param plan_weights The weights of the plan, the folded weights are added
+   * to them
+   * @return The nodes of the rewritten graph
+   */
+  std::vector<std::shared_ptr<Node>> foldAffines(
+      const std::vector<std::vector<std::shared_ptr<Node>>> &layers,
+      WeightStore &plan_weights) const;
+
+  /**
+   * @brief Fuses the activations of the graph into the nodes producing their
+   * input, where possible.
+   *
+   * An activation is fused when its input is the only output of its producer,
+   * is read by no other node and is not a model output. The producer is
+   * replaced by its fused copy writing the output of the activation.
+   *
+   * @param layers The nodes of the graph sorted topologically
+   * @return The nodes of the rewritten graph
+   */
+  std::vector<std::shared_ptr<Node>> fuseActivations(
+      const std::vector<std::vector<std::shared_ptr<Node>>> &layers) const;
+
+  /**
+   * @brief Rewrites the graph to run in the blocked NCHWc layout where
+   * possible.
+   *
+   * Every node, in topological order, is replaced by its blocked copy if it
+   * starts a blocked region or if all the inputs the copy reads blocked
+   * already are. Reorders are inserted for the inputs of blocked copies that
+   * are plain, and for the plain consumers of blocked tensors and the model
+   * outputs, once per tensor.
+   *
+   * @param layers The nodes of the graph sorted topologically
+   * @param plan_weights The weights of the plan
+   * @return The nodes of the rewritten graph
+   */
+  std::vector<std::shared_ptr<Node>> blockChannels(
+      const std::vector<std::vector<std::shared_ptr<Node>>> &layers,
+      const WeightStore &plan_weights) const;
+
+  /**
+   * @brief Runs a single step of the plan against the slots of an inference
+   * call
+   *
+   * The input slots of the step are bound by reference into a node local map
+   * and the produced outputs are moved back into their slots. Outputs placed
+   * by the memory plan are handed to the node preallocated in the arena.
+   *
+   * @param step The step to run
+   * @param slots The tensors of the current inference call, indexed by slot
+   * @param memory The memory plan of the call, or nullptr if there is none
+   * @param arena The activation arena of the call
+   */
+  static void runStep(const ExecutionPlan::Step &step,
+                      std::vector<std::optional<GeneralDataTypes>> &slots,
+                      const MemoryPlan *memory,
+                      const std::shared_ptr<std::byte[]> &arena);
+
+  /**
+   * @brief Records the outputs of a step to build a memory plan.
+   *
+   * Outputs sharing their data with one of the step inputs are views, neither
+   * of them can be placed in the arena.
+   *
+   * @param plan The execution plan
+   * @param step_idx The index of the step that just ran
+   * @param slots The tensors of the current inference call, indexed by slot
+   * @param usages The recorded tensors
+   * @param unplannable The slots that must not be placed in the arena
+   */
+  static void recordStep(
+      const ExecutionPlan &plan, size_t step_idx,
+      const std::vector<std::optional<GeneralDataTypes>> &slots,
+      std::vector<MemoryPlan::TensorUsage> &usages,
+      std::vector<bool> &unplannable);
+
+  /**
+   * @brief Computes the key of the memory plan matching the given slots.
+   *
+   * @param plan The execution plan
+   * @param slots The tensors of an inference call with its inputs set
+   * @return The types and shapes of the model inputs
+   */
+  static std::vector<std::vector<size_t>> memoryKey(
+      const ExecutionPlan &plan,
+      const std::vector<std::optional<GeneralDataTypes>> &slots);
 };
\ No newline at end of file
@@ -23,6 +23,8 @@
 #include "datastructures/a_tensor.hpp"
 #include "datastructures/mml_tensor.hpp"
 #include "nodes/node_utils.hpp"
+#include "operations/activation.hpp"
+#include "operations/channel_affine.hpp"
 #include "operations/tensor_operations_module.hpp"
 
 /**
@@ -126,11 +128,165 @@ class Node {
    * implement the specific forward pass logic. It modifies the output(s)
    * in place.
    *
+   * The input tensors must be treated as read-only, they may be weights that
+   * are shared between inference calls or tensors owned by the caller. The
+   * node itself must not be modified either, a model runs the same node in
+   * every inference call, and these may run at the same time.
+   *
    * @param iomap Map containing input and output tensors indexed by name
    */
   virtual void forward(
       std::unordered_map<std::string, GeneralDataTypes> &iomap) = 0;
 
+  /**
+   * @brief Prepare the node for the constant tensors of its model.
+   *
+   * Called once when the model is compiled, before any inference. Nodes may
+   * transform their constant inputs here into the layout their kernels read,
+   * so that forward does not reshuffle them on every call. This is the only
+   * place a node may keep state between calls, models call it on a copy of
+   * the node, see prepared_copy. The default does nothing.
+   *
+   * @param weights Map containing the constant tensors indexed by name
+   */
+  virtual void prepare(
+      const std::unordered_map<std::string, GeneralDataTypes> & /*weights*/) {}
+
+  /**
+   * @brief Get a copy of the node prepared for the constant tensors of its
+   * model, see prepare.
+   *
+   * A model compiles its plans on prepared copies, so that compiling a new
+   * plan never modifies a node that inference calls of the previous plan are
+   * still running. The default returns nullptr, the node keeps no prepared
+   * state and is run as it is.
+   *
+   * @param weights Map containing the constant tensors indexed by name
+   * @return The prepared copy of the node, or nullptr if it has nothing to
+   * prepare
+   */
+  virtual std::shared_ptr<Node> prepared_copy(
+      const std::unordered_map<std::string, GeneralDataTypes> & /*weights*/) {
+    return nullptr;
+  }
+
+  /**
+   * @brief Get a copy of the node running in the blocked NCHWc layout.
+   *
+   * The copy reads and writes the blocked tensors named by blocked_name in
+   * place of the activations of the node, see operations/nchwc.hpp. Inputs
+   * that stay plain, like weights, keep their names. The default returns
+   * nullptr, the node only runs in the plain layout.
+   *
+   * @param block Number of channels in a block
+   * @param weights Map containing the constant tensors indexed by name
+   * @param blocked_name Gets the name of the blocked copy of a tensor
+   * @return The blocked copy of the node, or nullptr if it has none for these
+   * weights and block
+   */
+  virtual std::shared_ptr<Node> blocked_copy(
+      size_t /*block*/,
+      const std::unordered_map<std::string, GeneralDataTypes> & /*weights*/,
+      const std::function<std::string(const std::string &)> &
+      /*blocked_name*/) {
+    return nullptr;
+  }
+
+  /**
+   * @brief Checks if the blocked copy of the node is worth reordering plain
+   * inputs for.
+   *
+   * Nodes whose blocked kernels are much faster than their plain ones, the
+   * convolutions, start regions of the graph running in the blocked layout.
+   * The other nodes only run blocked when their inputs already are.
+   *
+   * @return True if plain inputs are reordered for the blocked copy
+   */
+  virtual bool starts_blocked_region() const { return false; }
+
+  /**
+   * @brief Checks if the node writes its outputs into the tensors already in
+   * the iomap when they have the right type and shape.
+   *
+   * Only such outputs are placed in the activation arena of the model, see
+   * model/memory_plan.hpp. Nodes handing out a tensor they hold, like a
+   * constant or a view of their input, return false so that no arena space is
+   * reserved for outputs they would replace.
+   *
+   * @return True if planned outputs are written in place
+   */
+  virtual bool writes_outputs_in_place() const { return true; }
+
+  /**
+   * @brief Get the activation the node computes, if another node can apply it
+   * instead.
+   *
+   * Elementwise activations return their function, so that the model can fuse
+   * them into the node producing their input, see operations/activation.hpp.
+   * The default returns nullopt, the node is not fused.
+   *
+   * @return The activation of the node, or nullopt
+   */
+  virtual std::optional<Activation> fusable_activation() const {
+    return std::nullopt;
+  }
+
+  /**
+   * @brief Get a copy of the node applying an activation to its output.
+   *
+   * The copy writes the activation of its result to output in place of its
+   * own output, which makes the activation node reading that output
+   * redundant. The default returns nullptr, the node does not fuse
+   * activations.
+   *
+   * @param activation The activation to apply
+   * @param output Name of the output of the copy
+   * @return The fused copy of the node, or nullptr if it can not apply the
+   * activation
+   */
+  virtual std::shared_ptr<Node> fused_copy(const Activation & /*activation*/,
+                                           const std::string & /*output*/) {
+    return nullptr;
+  }
+
+  /**
+   * @brief Get the per channel affine transform the node computes, if it can
+   * be folded into the weights of the node producing its input.
+   *
+   * Nodes like an inference BatchNormalization, whose scale and shift only
+   * depend on constant tensors, return them. The default returns nullopt.
+   *
+   * @param weights Map containing the constant tensors indexed by name
+   * @return The transform of channel axis 1, or nullopt
+   */
+  virtual std::optional<ChannelAffine> foldable_affine(
+      const std::unordered_map<std::string, GeneralDataTypes> & /*weights*/)
+      const {
+    return std::nullopt;
+  }
+
+  /**
+   * @brief Get a copy of the node whose output channels are transformed by an
+   * affine transform folded into its weights.
+   *
+   * The copy writes to output the result of the node with every channel c
+   * multiplied by scale[c] and shifted by shift[c], at no extra cost. The
+   * folded weights are added to weights under new names, the existing ones
+   * are left as they are. The default returns nullptr, the node has no
+   * weights to fold into.
+   *
+   * @param affine The transform of the output channels
+   * @param output Name of the output of the copy
+   * @param weights Map containing the constant tensors indexed by name
+   * @return The folded copy of the node, or nullptr if the transform can not
+   * be folded into its weights
+   */
+  virtual std::shared_ptr<Node> affine_folded_copy(
+      const ChannelAffine & /*affine*/, const std::string & /*output*/,
+      std::unordered_map<std::string, GeneralDataTypes> & /*weights*/) {
+    return nullptr;
+  }
+
   /**
    * @brief Get the names of input tensors required by this node.
    *
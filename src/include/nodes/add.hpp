@@ -17,7 +17,7 @@
  * addition of two tensors in a computational graph. It performs the forward
  * pass computation by adding the elements of two input tensors and storing the
  * result in an output tensor. It supports broadcasting for tensors with
- * compatible shapes.
+ * compatible shapes, run by the kernels of operations/binary.hpp.
  */
 class AddNode : public Node {
  public:
@@ -54,6 +54,10 @@ class AddNode : public Node {
   /**
    * @brief Performs element-wise binary addition in the two input tensors and
    * stores the result in the output tensor.
+   *
+   * @param iomap Map containing input and output tensors indexed by name
+   * @throws std::runtime_error If an input is missing, the types differ or the
+   * shapes can not be broadcast together.
    */
   void forward(
       std::unordered_map<std::string, GeneralDataTypes> &iomap) override;
@@ -72,21 +76,22 @@ class AddNode : public Node {
    */
   std::vector<std::string> getOutputs() override;
 
+  /**
+   * @brief Get a copy of the node on the blocked tensors, see
+   * Node::blocked_copy. Blocked tensors broadcast like the plain ones, except
+   * along the channels which they never do, since they cannot be blocked.
+   *
+   * @return The copy, or nullptr if A or B is a weight, which stays plain.
+   */
+  std::shared_ptr<Node> blocked_copy(
+      size_t block,
+      const std::unordered_map<std::string, GeneralDataTypes> &weights,
+      const std::function<std::string(const std::string &)> &blocked_name)
+      override;
+
  private:
   // tensors
   std::string A;  // Input tensor A
   std::string B;  // Input tensor B
   std::string C;  // Output tensor C
-
-  /**
-   * @brief Helper std::function used when broadcasting addition is required.
-   * Likely only temporary to be replaced with something that can be used in
-   * multiple nodes instead.
-   *
-   * @param a_ptr Shared pointer to the first input tensor
-   * @param b_ptr Shared pointer to the second input tensor
-   * @param c_ptr Shared pointer to the output tensor
-   */
-  void broadcast_addition(const TensorT &a_ptr, const TensorT &b_ptr,
-                          const TensorT &c_ptr) const;
 };
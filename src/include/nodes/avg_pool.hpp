@@ -83,6 +83,18 @@ class AvgPoolNode : public Node {
    */
   std::vector<std::string> getOutputs() override;
 
+  /**
+   * @brief Get a copy of the node on the blocked tensors, see
+   * Node::blocked_copy.
+   *
+   * @return The copy, or nullptr if the pooling is not 2D.
+   */
+  std::shared_ptr<Node> blocked_copy(
+      size_t block,
+      const std::unordered_map<std::string, GeneralDataTypes>& weights,
+      const std::function<std::string(const std::string&)>& blocked_name)
+      override;
+
  private:
   /**
    * @brief Input tensor name
@@ -131,4 +143,10 @@ class AvgPoolNode : public Node {
    * @brief Stride values for each spatial dimension
    */
   std::vector<int> strides;
+
+  /**
+   * @brief Channels in a block of the blocked input and output, 0 if they are
+   * plain
+   */
+  size_t channel_block = 0;
 };
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <variant>
+// IWYU pragma: no_include <__vector/vector.h>
+#include <vector>  // IWYU pragma: keep
+
+#include "nlohmann/json_fwd.hpp"
+#include "nodes/a_node.hpp"
+
+/**
+ * @class BatchNormalizationNode
+ * @brief A class implementing the inference mode of BatchNormalization.
+ *
+ * Every channel c of the input, axis 1, is normalized with the statistics
+ * computed during training: Y = (X - mean[c]) / sqrt(var[c] + epsilon) *
+ * scale[c] + B[c]. This is the per channel affine transform of
+ * operations/channel_affine.hpp, which Model_mml folds into the weights of the
+ * Conv or Gemm producing X when the parameters are constant.
+ */
+class BatchNormalizationNode : public Node {
+ public:
+  /**
+   * @typedef T
+   * @brief Type alias for supported floating-point types in BatchNormalization
+   */
+  using T = std::variant<float, double>;
+
+  /**
+   * @brief Constructor for BatchNormalizationNode.
+   *
+   * @param X Name of the input tensor, of shape [batch, channels, ...].
+   * @param scale Name of the scale tensor, of shape [channels].
+   * @param B Name of the bias tensor, of shape [channels].
+   * @param mean Name of the running mean tensor, of shape [channels].
+   * @param var Name of the running variance tensor, of shape [channels].
+   * @param Y Name of the output tensor.
+   * @param epsilon Added to the variance to avoid dividing by zero.
+   */
+  BatchNormalizationNode(const std::string &X, const std::string &scale,
+                         const std::string &B, const std::string &mean,
+                         const std::string &var, const std::string &Y,
+                         float epsilon = 1e-5f);
+
+  /**
+   * @brief Constructor for BatchNormalizationNode from JSON.
+   *
+   * @param node JSON object representing the BatchNormalization node.
+   * @throws std::runtime_error If the node is in training mode.
+   */
+  explicit BatchNormalizationNode(const nlohmann::json &node);
+
+  /**
+   * @brief Perform the forward pass computation of BatchNormalization.
+   */
+  void forward(
+      std::unordered_map<std::string, GeneralDataTypes> &iomap) override;
+
+  /**
+   * @brief Get inputs.
+   *
+   * @return The names of the inputs to the node.
+   */
+  std::vector<std::string> getInputs() override;
+
+  /**
+   * @brief Get outputs.
+   *
+   * @return The names of the outputs to the node.
+   */
+  std::vector<std::string> getOutputs() override;
+
+  /**
+   * @brief Get the transform of the node, see Node::foldable_affine.
+   *
+   * @return The scale and shift of every channel, or nullopt unless all the
+   * parameters are weights of the same type and size.
+   */
+  std::optional<ChannelAffine> foldable_affine(
+      const std::unordered_map<std::string, GeneralDataTypes> &weights)
+      const override;
+
+ private:
+  // Inputs
+  std::string X;      // Input tensor X.
+  std::string scale;  // Scale of every channel.
+  std::string B;      // Bias of every channel.
+  std::string mean;   // Running mean of every channel.
+  std::string var;    // Running variance of every channel.
+
+  // Output
+  std::string Y;  // Output tensor Y.
+
+  // Attributes
+  float epsilon;  // Added to the variance.
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <variant>
+// IWYU pragma: no_include <__vector/vector.h>
+#include <vector>  // IWYU pragma: keep
+
+#include "nlohmann/json_fwd.hpp"
+#include "nodes/a_node.hpp"
+#include "operations/binary.hpp"
+
+/**
+ * @class BinaryNode
+ * @brief A class implementing Sub, Mul, Div, Pow, Min and Max.
+ *
+ * The inputs are broadcast together following the numpy rules and combined by
+ * the kernels of operations/binary.hpp, without replicating the broadcast
+ * ones. Sub, Mul, Div and Pow take two inputs, Min and Max any number of
+ * them, which are combined from left to right. All inputs must have the same
+ * type.
+ */
+class BinaryNode : public Node {
+ public:
+  /**
+   * @typedef T
+   * @brief Type alias for supported numeric types in binary operations
+   */
+  using T = std::variant<double, float, int32_t, int64_t>;
+
+  /**
+   * @brief Constructor for BinaryNode.
+   *
+   * @param kind The operation computed.
+   * @param inputs Names of the input tensors.
+   * @param output Name of the output tensor.
+   * @throws std::invalid_argument If the number of inputs does not fit the
+   * operation.
+   */
+  BinaryNode(BinaryKind kind, const std::vector<std::string> &inputs,
+             const std::string &output);
+
+  /**
+   * @brief Constructor for BinaryNode from JSON, the operation is given by
+   * its opType.
+   *
+   * @param node JSON object representing the node.
+   * @throws std::runtime_error If the opType is not a supported operation.
+   */
+  explicit BinaryNode(const nlohmann::json &node);
+
+  /**
+   * @brief Perform the forward pass computation of the operation.
+   *
+   * @param iomap Map containing input and output tensors indexed by name
+   * @throws std::runtime_error If an input is missing, the types differ or are
+   * not supported, or the shapes can not be broadcast together.
+   */
+  void forward(
+      std::unordered_map<std::string, GeneralDataTypes> &iomap) override;
+
+  /**
+   * @brief Get inputs.
+   *
+   * @return The names of the inputs to the node.
+   */
+  std::vector<std::string> getInputs() override;
+
+  /**
+   * @brief Get outputs.
+   *
+   * @return The names of the outputs to the node.
+   */
+  std::vector<std::string> getOutputs() override;
+
+ private:
+  BinaryKind kind;                  // The operation computed.
+  std::vector<std::string> inputs;  // Input tensors.
+  std::string output;               // Output tensor.
+};
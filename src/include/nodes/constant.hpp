@@ -61,6 +61,13 @@ class ConstantNode : public Node {
    */
   std::vector<std::string> getOutputs() override;
 
+  /**
+   * @brief Checks if the node writes its output in place.
+   *
+   * @return False, the output is the constant value itself
+   */
+  bool writes_outputs_in_place() const override { return false; }
+
  private:
   /**
    * @brief The name of the output tensor
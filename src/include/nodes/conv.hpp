@@ -2,13 +2,17 @@
 
 #include <stddef.h>
 
+#include <array>
+#include <memory>
 #include <optional>
 #include <string>
 #include <variant>
+#include <vector>
 
 #include "datastructures/mml_array.hpp"
 #include "nlohmann/json_fwd.hpp"
 #include "nodes/a_node.hpp"
+#include "operations/packed_gemm.hpp"
 
 /**
  * @class ConvNode
@@ -93,6 +97,9 @@ class ConvNode : public Node {
    * 5. **Store Result in Output Tensor**: The final result of the convolution
    * operation, after the std::optional bias addition, is stored in the output
    * tensor `Y`, which represents the convolved feature maps.
+   *
+   * The node is not modified, weights that have not been prepared are
+   * transformed again on every call.
    */
   void forward(
       std::unordered_map<std::string, GeneralDataTypes> &iomap) override;
@@ -111,6 +118,98 @@ class ConvNode : public Node {
    */
   std::vector<std::string> getOutputs() override;
 
+  /**
+   * @brief Transforms constant weights ahead of the first inference.
+   *
+   * If W is one of the weights, it is packed for the GEMM, transformed for
+   * the Winograd path or reordered for the blocked convolution, whichever the
+   * convolution runs. The Winograd weights are computed for both output
+   * tiles, since the tile depends on the input size, which is not known yet.
+   *
+   * @param weights Map containing the constant tensors indexed by name.
+   */
+  void prepare(const std::unordered_map<std::string, GeneralDataTypes> &weights)
+      override;
+
+  /**
+   * @brief Get a copy of the node prepared for the constant tensors, see
+   * Node::prepared_copy.
+   *
+   * @param weights Map containing the constant tensors indexed by name.
+   * @return The copy, with prepare called on it.
+   */
+  std::shared_ptr<Node> prepared_copy(
+      const std::unordered_map<std::string, GeneralDataTypes> &weights)
+      override;
+
+  /**
+   * @brief Get a copy of the node on the blocked tensors, see
+   * Node::blocked_copy.
+   *
+   * The copy runs the direct convolution of operations/nchwc.hpp, with the
+   * bias fused into it.
+   *
+   * @return The copy, or nullptr unless W is a float weight of a single group
+   * whose input and output channels are multiples of the block.
+   */
+  std::shared_ptr<Node> blocked_copy(
+      size_t block,
+      const std::unordered_map<std::string, GeneralDataTypes> &weights,
+      const std::function<std::string(const std::string &)> &blocked_name)
+      override;
+
+  /**
+   * @brief Checks if the blocked copy is worth reordering plain inputs for.
+   *
+   * @return True, the direct convolution beats im2col and the GEMM.
+   */
+  bool starts_blocked_region() const override;
+
+  /**
+   * @brief Get a copy of the node applying an activation, see
+   * Node::fused_copy.
+   *
+   * Every convolution path applies the activation right after the bias, to
+   * the values it has just written.
+   *
+   * @return The copy, or nullptr if the node already applies one.
+   */
+  std::shared_ptr<Node> fused_copy(const Activation &activation,
+                                   const std::string &output) override;
+
+  /**
+   * @brief Get a copy of the node with an affine transform of its output
+   * channels folded into W and B, see Node::affine_folded_copy.
+   *
+   * @return The copy, or nullptr unless W, and B if any, are floating point
+   * weights and the node applies no activation.
+   */
+  std::shared_ptr<Node> affine_folded_copy(
+      const ChannelAffine &affine, const std::string &output,
+      std::unordered_map<std::string, GeneralDataTypes> &weights) override;
+
+  /**
+   * @brief Enables or disables the Winograd path of all convolution nodes.
+   *
+   * Convolutions with 3x3 kernels, stride 1, dilation 1 and a single group run
+   * the Winograd F(4x4, 3x3) or F(2x2, 3x3) convolution when it is enabled, the
+   * default, and im2col followed by a GEMM otherwise.
+   *
+   * @param enabled True to run the Winograd path on eligible convolutions.
+   */
+  static void set_winograd_enabled(bool enabled);
+
+  /**
+   * @brief Checks if eligible convolutions run the Winograd path.
+   *
+   * @return True if the Winograd path is enabled.
+   */
+  static bool is_winograd_enabled();
+
+  /// @brief Largest im2col column matrix, in bytes, each thread keeps for the
+  /// next convolutions it runs. Larger ones are allocated for the call.
+  static constexpr size_t im2col_scratch_max_bytes = size_t(1) << 24;
+
  private:
   // Inputs
   /**
@@ -192,62 +291,97 @@ class ConvNode : public Node {
    *
    * If set to 1, a standard convolution is performed. If greater than 1, the
    * input channels are divided into groups, and a grouped convolution is
-   * performed. Grouped convolutions can reduce computational complexity.
+   * performed. Grouped convolutions can reduce computational complexity. With
+   * one group per input channel, a depthwise convolution, a direct kernel is
+   * run instead of im2col and GEMM.
    */
   size_t group;
 
   /**
-   * @brief Height of the kernel (filter).
+   * @brief Dimensions of a convolution, inferred from the shapes of its input
+   * and weight tensors.
    *
-   * Kernel height determines the vertical size of the region in the input
-   * tensor to be convolved.
+   * They are computed by forward on every call, so that the node itself is
+   * not modified and may run in concurrent inference calls.
    */
-  size_t kernel_height;
+  struct ConvDims {
+    /// @brief Number of examples in the batch.
+    size_t batch_size = 0;
 
-  /**
-   * @brief Width of the kernel (filter).
-   *
-   * Kernel width determines the horizontal size of the region in the input
-   * tensor to be convolved.
-   */
-  size_t kernel_width;
+    /// @brief Number of input channels.
+    size_t in_channels = 0;
 
-  /**
-   * @brief Number of examples in the batch.
-   *
-   * The batch size represents how many input tensors will be processed at once.
-   */
-  size_t batch_size;
+    /// @brief Height of the input feature map(s).
+    size_t in_height = 0;
+
+    /// @brief Width of the input feature map(s).
+    size_t in_width = 0;
+
+    /// @brief Number of output channels, the number of filters.
+    size_t out_channels = 0;
+
+    /// @brief Height of the kernel (filter).
+    size_t kernel_height = 0;
+
+    /// @brief Width of the kernel (filter).
+    size_t kernel_width = 0;
+
+    /// @brief Height of the output feature map(s).
+    size_t out_height = 0;
+
+    /// @brief Width of the output feature map(s).
+    size_t out_width = 0;
+  };
 
   /**
-   * @brief Number of input channels.
+   * @brief Winograd transformed weights for output tiles of 2 and of 4,
+   * [tile_size^2, out_channels, in_channels].
    *
-   * The input channels correspond to the depth of the input tensor, typically 3
-   * for RGB images.
+   * The tile depends on the output size, which is only known once the input
+   * is, so prepare computes both. They are used while the weight tensor
+   * stays the same, updating the values of the weight tensor in place is not
+   * detected.
    */
-  size_t in_channels;
+  std::array<TensorT, 2> winograd_weights;
+
+  /// @brief Weight tensor the Winograd weights were computed from.
+  std::shared_ptr<const void> winograd_source;
 
   /**
-   * @brief The height of the input tensor.
+   * @brief Weights of the GEMM paths packed ahead of time, a PackedWeights of
+   * the element type of the weights.
    *
-   * This is the height of the input feature map(s).
+   * Like the Winograd weights, they are computed by prepare and used while
+   * the weight tensor stays the same.
    */
-  size_t in_height;
+  std::shared_ptr<const void> packed_weights;
+
+  /// @brief Weight tensor the packed weights were computed from.
+  std::shared_ptr<const void> packed_source;
 
   /**
-   * @brief Width of the input tensor.
-   *
-   * This is the width of the input feature map(s).
+   * @brief Channels in a block of the blocked input and output, 0 if they are
+   * plain.
    */
-  size_t in_width;
+  size_t channel_block = 0;
 
   /**
-   * @brief Number of output channels.
-   *
-   * The number of output channels corresponds to the number of filters used in
-   * the convolution.
+   * @brief Weights reordered for the blocked convolution by prepare, used
+   * while the weight tensor stays the same.
    */
-  size_t out_channels;
+  TensorT blocked_weights;
+
+  /// @brief Weight tensor the blocked weights were computed from.
+  std::shared_ptr<const void> blocked_source;
+
+  /// @brief Activation applied to the output, fused by the model.
+  Activation activation;
+
+  /// @brief Packed [out_channels / group, in_channels / group * kernel_size]
+  /// weights of every group.
+  template <typename ValueType>
+  using PackedWeights =
+      std::vector<std::shared_ptr<const PackedGemmOperand<ValueType>>>;
 
   /**
    * @brief Performs the im2col transformation on the input tensor.
@@ -255,43 +389,171 @@ class ConvNode : public Node {
    * This method extracts patches from the input tensor and flattens them into
    * columns, preparing the data for efficient matrix multiplication in
    * convolution operations. The im2col operation unrolls local patches (based
-   * on kernel size, stride, and padding) into column vectors, making
+   * on kernel size, stride, dilation and padding) into column vectors, making
    * convolutions computationally more efficient.
    *
-   * @param input A shared pointer to the input tensor, typically of shape
-   *              [batch_size, height, width, channels]. This is the data to be
-   * transformed into columns by extracting patches for the convolution.
+   * The rows of the column matrices are filled in parallel. Padding is written
+   * as whole zero runs and the input rows are copied with memcpy when the
+   * horizontal stride is 1.
    *
-   * @param output A shared pointer to the output tensor, where the transformed
-   * data will be stored. It will have shape [batch_size, output_height *
-   * output_width, kernel_height * kernel_width * channels], representing the
-   * flattened patches ready for matrix multiplication.
+   * @param dims The dimensions of the convolution.
+   * @param input The contiguous input data, of shape [batch_size, channels,
+   * height, width].
+   *
+   * @param columns The contiguous column matrices, of shape [batch_size,
+   * channels * kernel_height * kernel_width, output_height * output_width].
+   * Row (c, kh, kw) of an image holds the input values kernel element (kh, kw)
+   * of channel c is multiplied with at every output pixel.
    *
    * @note The im2col operation prepares the input for matrix multiplication
    * with kernel weights during convolution but does not compute the convolution
    * itself.
    */
-  void im2col(const TensorT &input_variant, const TensorT &output_variant);
+  template <typename ValueType>
+  void im2col(const ConvDims &dims, const ValueType *input,
+              ValueType *columns) const;
+
+  /**
+   * @brief Computes the convolution with im2col followed by one GEMM per
+   * image and group.
+   *
+   * @param dims The dimensions of the convolution.
+   * @param input The contiguous input tensor.
+   * @param weights The weight tensor.
+   * @param result The contiguous output tensor.
+   * @param bias The bias of every output channel, nullptr for none.
+   */
+  template <typename ValueType>
+  void im2col_gemm(const ConvDims &dims,
+                   const std::shared_ptr<Tensor<ValueType>> &input,
+                   const std::shared_ptr<Tensor<ValueType>> &weights,
+                   const std::shared_ptr<Tensor<ValueType>> &result,
+                   const ValueType *bias) const;
+
+  /**
+   * @brief Computes a 1x1 convolution with one GEMM per image and group
+   * straight on the input, which already is its im2col matrix.
+   *
+   * @param dims The dimensions of the convolution.
+   * @param input The contiguous input tensor.
+   * @param weights The weight tensor.
+   * @param result The contiguous output tensor.
+   * @param bias The bias of every output channel, nullptr for none.
+   */
+  template <typename ValueType>
+  void pointwise_gemm(const ConvDims &dims,
+                      const std::shared_ptr<Tensor<ValueType>> &input,
+                      const std::shared_ptr<Tensor<ValueType>> &weights,
+                      const std::shared_ptr<Tensor<ValueType>> &result,
+                      const ValueType *bias) const;
+
+  /**
+   * @brief Multiplies the weights of every group with the column matrices of
+   * every image, with the packed weights when the packed GEMM runs. The bias
+   * and the activation are applied to the result as the epilogue of the GEMMs.
+   *
+   * @param dims The dimensions of the convolution.
+   * @param weights The weight tensor.
+   * @param columns The [batch_size, group, in_channels / group * kernel_size,
+   * output_height * output_width] column matrices.
+   * @param result The contiguous output tensor.
+   * @param bias The bias of every output channel, nullptr for none.
+   */
+  template <typename ValueType>
+  void group_gemm(const ConvDims &dims,
+                  const std::shared_ptr<Tensor<ValueType>> &weights,
+                  const std::shared_ptr<Tensor<ValueType>> &columns,
+                  const std::shared_ptr<Tensor<ValueType>> &result,
+                  const ValueType *bias) const;
+
+  /**
+   * @brief Gets the GEMM weights packed for the packed GEMM, the ones cached
+   * by prepare or else packed for this call.
+   *
+   * @param weights The weight tensor.
+   * @return The packed weights, nullptr if another GEMM has been set.
+   */
+  template <typename ValueType>
+  std::shared_ptr<const PackedWeights<ValueType>> packed_gemm_weights(
+      const std::shared_ptr<Tensor<ValueType>> &weights) const;
+
+  /**
+   * @brief Gets the Winograd transformed weights, the ones cached by prepare
+   * or else transformed for this call.
+   *
+   * @param weights The weight tensor.
+   * @param tile The size of the output tiles.
+   * @return The transformed weights.
+   */
+  template <typename ValueType>
+  std::shared_ptr<Tensor<ValueType>> transformed_winograd_weights(
+      const std::shared_ptr<Tensor<ValueType>> &weights, int tile) const;
+
+  /**
+   * @brief Gets the weights reordered for the blocked convolution, the ones
+   * cached by prepare or else reordered for this call.
+   *
+   * @param weights The weight tensor.
+   * @return The [out_channels / block, in_channels / block, kernel_height,
+   * kernel_width, block, block] weights.
+   */
+  template <typename ValueType>
+  std::shared_ptr<Tensor<ValueType>> nchwc_weights(
+      const std::shared_ptr<Tensor<ValueType>> &weights) const;
+
+  /**
+   * @brief Checks if the convolution runs the 1x1 path, without im2col.
+   *
+   * @param dims The dimensions of the convolution.
+   * @return True for 1x1 kernels with stride 1 and no padding.
+   */
+  bool use_pointwise(const ConvDims &dims) const;
+
+  /**
+   * @brief Checks if the convolution runs the direct depthwise kernel.
+   *
+   * @param dims The dimensions of the convolution.
+   * @return True if there is one group per input channel.
+   */
+  bool use_depthwise(const ConvDims &dims) const;
 
   /**
-   * @brief Performs the addition of the bias to the result.
+   * @brief Checks if the convolution runs the Winograd path.
    *
-   * @param result_ptr The tensor to which the bias will be added.
+   * @param dims The dimensions of the convolution, only the kernel is read.
+   * @return True if it is enabled and the kernel, stride, dilation and group
+   * qualify.
    */
-  void add_bias(const TensorT &result_variant, const TensorT &bias_variant);
+  bool use_winograd(const ConvDims &dims) const;
 
-  // Getters for input tensor dimensions
-  size_t get_batch_size() const;
-  size_t get_in_channels() const;
-  size_t get_in_height() const;
-  size_t get_in_width() const;
+  /**
+   * @brief Gets the size of the Winograd output tiles.
+   *
+   * @param dims The dimensions of the convolution.
+   * @return 4 for outputs of at least 8x8, 2 otherwise.
+   */
+  static int winograd_tile(const ConvDims &dims);
 
-  // Weight tensor getters
-  size_t get_kernel_height() const;
-  size_t get_kernel_width() const;
-  size_t get_out_channels() const;
+  /**
+   * @brief Gets a tensor of the given shape on top of the im2col scratch area
+   * of the calling thread.
+   *
+   * The scratch area is reused by every convolution the thread runs and only
+   * grows when a larger column matrix is needed, so the tensor is overwritten
+   * by the next call on the same thread. It is bounded by
+   * im2col_scratch_max_bytes, larger tensors are allocated from
+   * Allocator::global() and given back once they are released.
+   *
+   * @param shape The shape of the tensor.
+   * @return An uninitialized tensor sharing the scratch area.
+   */
+  template <typename ValueType>
+  static std::shared_ptr<Tensor<ValueType>> im2col_scratch(
+      const array_mml<size_t> &shape);
 
   // Getters for the other parameters
+  size_t get_dilation_height() const;
+  size_t get_dilation_width() const;
   size_t get_stride_height() const;
   size_t get_stride_width() const;
 
@@ -301,16 +563,8 @@ class ConvNode : public Node {
   size_t get_padding_left() const;
   size_t get_padding_right() const;
 
-  // Getter for getting the output height and width
-  size_t get_out_height();
-  size_t get_out_width();
-
-  // Checks the inputs to the convolution node
-  void validate_inputs();
-
-  // Updates parameters based on the content of the input and weight tensor
-  // This method is executed before forward so that we get the correct
-  // parameters.
-  void update_parameters(const array_mml<size_t> &input_shape,
-                         const array_mml<size_t> &weight_shape);
+  // Gets the dimensions of the convolution of an input and weight tensor,
+  // after checking that they fit each other
+  ConvDims conv_dims(const array_mml<size_t> &input_shape,
+                     const array_mml<size_t> &weight_shape) const;
 };
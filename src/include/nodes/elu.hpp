@@ -1,65 +1,81 @@
-#pragma once
-
-#include <string>
-#include <variant>
-
-#include "nlohmann/json_fwd.hpp"
-#include "nodes/a_node.hpp"
-
-/**
- * @class ELUNode
- * @brief A class that implements a tensor std::function for the ELU
- * (Exponential Linear Unit) std::function.
- */
-class ELUNode : public Node {
- public:
-  /**
-   * @typedef T
-   * @brief Type alias for supported floating-point types in ELU operations
-   */
-  using T = std::variant<float, double>;
-
-  /**
-   * @brief Constructor for ELUNode.
-   *
-   * @param X Unique std::string key to the input tensor.
-   * @param Y Unique std::string key to the output tensor.
-   * @param alpha Coefficient of ELU.
-   */
-  ELUNode(const std::string &X, const std::string &Y, float alpha = 1.0f);
-
-  /**
-   * @brief Constructor for ELUNode from JSON.
-   *
-   * @param node JSON object representing the ELU node.
-   */
-  explicit ELUNode(const nlohmann::json &node);
-
-  /**
-   * @brief Perform the forward pass computation using the ELU std::function.
-   */
-  void forward(
-      std::unordered_map<std::string, GeneralDataTypes> &iomap) override;
-
-  /**
-   * @brief Get inputs.
-   *
-   * @return The names of the inputs to the node.
-   */
-  std::vector<std::string> getInputs() override;
-
-  /**
-   * @brief Get outputs.
-   *
-   * @return The names of the outputs to the node.
-   */
-  std::vector<std::string> getOutputs() override;
-
- private:
-  ///@brief Unique std::string key to input tensor
-  std::string X;
-  ///@brief Unique std::string key to output tensor
-  std::string Y;
-  ///@brief Coefficient of ELU
-  float alpha;
-};
+#pragma once
+
+#include <optional>
+#include <string>
+#include <variant>
+
+#include "nlohmann/json_fwd.hpp"
+#include "nodes/a_node.hpp"
+
+/**
+ * @class ELUNode
+ * @brief A class that implements a tensor std::function for the ELU
+ * (Exponential Linear Unit) std::function.
+ */
+class ELUNode : public Node {
+ public:
+  /**
+   * @typedef T
+   * @brief Type alias for supported floating-point types in ELU operations
+   */
+  using T = std::variant<float, double>;
+
+  /**
+   * @brief Constructor for ELUNode.
+   *
+   * @param X Unique std::string key to the input tensor.
+   * @param Y Unique std::string key to the output tensor.
+   * @param alpha Coefficient of ELU.
+   */
+  ELUNode(const std::string &X, const std::string &Y, float alpha = 1.0f);
+
+  /**
+   * @brief Constructor for ELUNode from JSON.
+   *
+   * @param node JSON object representing the ELU node.
+   */
+  explicit ELUNode(const nlohmann::json &node);
+
+  /**
+   * @brief Perform the forward pass computation using the ELU std::function.
+   */
+  void forward(
+      std::unordered_map<std::string, GeneralDataTypes> &iomap) override;
+
+  /**
+   * @brief Get inputs.
+   *
+   * @return The names of the inputs to the node.
+   */
+  std::vector<std::string> getInputs() override;
+
+  /**
+   * @brief Get outputs.
+   *
+   * @return The names of the outputs to the node.
+   */
+  std::vector<std::string> getOutputs() override;
+
+  /**
+   * @brief Get a copy of the node on the blocked tensors, see
+   * Node::blocked_copy. The activation is elementwise, so any layout works.
+   */
+  std::shared_ptr<Node> blocked_copy(
+      size_t block,
+      const std::unordered_map<std::string, GeneralDataTypes> &weights,
+      const std::function<std::string(const std::string &)> &blocked_name)
+      override;
+
+  /**
+   * @brief Get the activation of the node, see Node::fusable_activation.
+   */
+  std::optional<Activation> fusable_activation() const override;
+
+ private:
+  ///@brief Unique std::string key to input tensor
+  std::string X;
+  ///@brief Unique std::string key to output tensor
+  std::string Y;
+  ///@brief Coefficient of ELU
+  float alpha;
+};
@@ -73,6 +73,13 @@ class FlattenNode : public Node {
    */
   std::vector<std::string> getOutputs() override;
 
+  /**
+   * @brief Checks if the node writes its output in place.
+   *
+   * @return False, the output is a view of the input when it can be
+   */
+  bool writes_outputs_in_place() const override { return false; }
+
  private:
   /**
    * @brief Input data tensor for the node.
@@ -2,6 +2,7 @@
 
 #include <stdint.h>
 
+#include <memory>
 #include <optional>
 #include <string>
 #include <variant>
@@ -72,6 +73,40 @@ class GemmNode : public Node {
    */
   std::vector<std::string> getOutputs() override;
 
+  /**
+   * @brief Packs B ahead of the first inference if it is constant.
+   *
+   * B is packed once for the packed GEMM, transposed if transB is set, and
+   * every forward pass then reads the packed panels instead of packing B
+   * again. Updating the values of B in place is not detected.
+   *
+   * @param weights Map containing the constant tensors indexed by name.
+   */
+  void prepare(const std::unordered_map<std::string, GeneralDataTypes> &weights)
+      override;
+
+  /**
+   * @brief Get a copy of the node prepared for the constant tensors, see
+   * Node::prepared_copy.
+   *
+   * @param weights Map containing the constant tensors indexed by name.
+   * @return The copy, with prepare called on it.
+   */
+  std::shared_ptr<Node> prepared_copy(
+      const std::unordered_map<std::string, GeneralDataTypes> &weights)
+      override;
+
+  /**
+   * @brief Get a copy of the node with an affine transform of the columns of
+   * Y folded into B and C, see Node::affine_folded_copy.
+   *
+   * @return The copy, or nullptr unless B, and C if any, are floating point
+   * weights and C holds a single row.
+   */
+  std::shared_ptr<Node> affine_folded_copy(
+      const ChannelAffine &affine, const std::string &output,
+      std::unordered_map<std::string, GeneralDataTypes> &weights) override;
+
  private:
   // Inputs
   std::string A;                 // Input tensor A.
@@ -86,4 +121,10 @@ class GemmNode : public Node {
   float beta;   // Scalar multiplier for C.
   int transA;   // Whether to transpose A (0: no, non-zero: yes).
   int transB;   // Whether to transpose B (0: no, non-zero: yes).
+
+  // B packed by prepare, a PackedGemmOperand of its element type.
+  std::shared_ptr<const void> packed_b;
+
+  // Tensor B was packed from.
+  std::shared_ptr<const void> packed_source;
 };
@@ -1,70 +1,86 @@
-#pragma once
-
-#include <string>
-#include <variant>
-
-#include "nlohmann/json_fwd.hpp"
-#include "nodes/a_node.hpp"
-
-/**
- * @class LeakyReLUNode
- * @brief A class representing a LeakyReLU node in a computational graph.
- *
- * This class inherits from the Node class and represents the rectified linear
- * std::function (LeakyReLU) node in a computational graph. It performs the
- * forward pass computation applying ReLU elementwise.
- */
-class LeakyReLUNode : public Node {
- public:
-  /**
-   * @typedef T
-   * @brief Type alias for supported numeric types in LeakyReLU operations
-   */
-  using T = std::variant<float, double>;
-
-  /**
-   * @brief Constructor for LeakyReLUNode.
-   *
-   * @param X Unique std::string key to the input tensor.
-   * @param Y Unique std::string key to the output tensor.
-   * @param alpha Coefficient of leakage. Default = 0.01
-   */
-  LeakyReLUNode(const std::string &X, const std::string &Y,
-                float alpha = 0.01f);
-
-  /**
-   * @brief Constructor for LeakyReLUNode from JSON.
-   *
-   * @param node JSON object representing the LeakyReLU node.
-   */
-  explicit LeakyReLUNode(const nlohmann::json &node);
-
-  /**
-   * @brief Perform the forward pass computation using LeakyReLUNode activation
-   * std::function.
-   */
-  void forward(
-      std::unordered_map<std::string, GeneralDataTypes> &iomap) override;
-
-  /**
-   * @brief Get inputs.
-   *
-   * @return The names of the inputs to the node.
-   */
-  std::vector<std::string> getInputs() override;
-
-  /**
-   * @brief Get outputs.
-   *
-   * @return The names of the outputs to the node.
-   */
-  std::vector<std::string> getOutputs() override;
-
- private:
-  ///@brief Pointer to input tensor
-  std::string X;
-  ///@brief Pointer to output tensor
-  std::string Y;
-  ///@brief Coefficient of leakage
-  float alpha;
-};
+#pragma once
+
+#include <optional>
+#include <string>
+#include <variant>
+
+#include "nlohmann/json_fwd.hpp"
+#include "nodes/a_node.hpp"
+
+/**
+ * @class LeakyReLUNode
+ * @brief A class representing a LeakyReLU node in a computational graph.
+ *
+ * This class inherits from the Node class and represents the rectified linear
+ * std::function (LeakyReLU) node in a computational graph. It performs the
+ * forward pass computation applying ReLU elementwise.
+ */
+class LeakyReLUNode : public Node {
+ public:
+  /**
+   * @typedef T
+   * @brief Type alias for supported numeric types in LeakyReLU operations
+   */
+  using T = std::variant<float, double>;
+
+  /**
+   * @brief Constructor for LeakyReLUNode.
+   *
+   * @param X Unique std::string key to the input tensor.
+   * @param Y Unique std::string key to the output tensor.
+   * @param alpha Coefficient of leakage. Default = 0.01
+   */
+  LeakyReLUNode(const std::string &X, const std::string &Y,
+                float alpha = 0.01f);
+
+  /**
+   * @brief Constructor for LeakyReLUNode from JSON.
+   *
+   * @param node JSON object representing the LeakyReLU node.
+   */
+  explicit LeakyReLUNode(const nlohmann::json &node);
+
+  /**
+   * @brief Perform the forward pass computation using LeakyReLUNode activation
+   * std::function.
+   */
+  void forward(
+      std::unordered_map<std::string, GeneralDataTypes> &iomap) override;
+
+  /**
+   * @brief Get inputs.
+   *
+   * @return The names of the inputs to the node.
+   */
+  std::vector<std::string> getInputs() override;
+
+  /**
+   * @brief Get outputs.
+   *
+   * @return The names of the outputs to the node.
+   */
+  std::vector<std::string> getOutputs() override;
+
+  /**
+   * @brief Get a copy of the node on the blocked tensors, see
+   * Node::blocked_copy. The activation is elementwise, so any layout works.
+   */
+  std::shared_ptr<Node> blocked_copy(
+      size_t block,
+      const std::unordered_map<std::string, GeneralDataTypes> &weights,
+      const std::function<std::string(const std::string &)> &blocked_name)
+      override;
+
+  /**
+   * @brief Get the activation of the node, see Node::fusable_activation.
+   */
+  std::optional<Activation> fusable_activation() const override;
+
+ private:
+  ///@brief Pointer to input tensor
+  std::string X;
+  ///@brief Pointer to output tensor
+  std::string Y;
+  ///@brief Coefficient of leakage
+  float alpha;
+};
@@ -27,9 +27,14 @@
  * @brief A node that performs matrix multiplication in a computational graph.
  *
  * The MatMulNode represents the mathematical operation of matrix multiplication
- * between two tensors. For 2D tensors, it performs the standard matrix product.
- * For higher-dimensional tensors, it applies batch matrix multiplication
- * according to broadcasting rules.
+ * between two tensors, following numpy matmul. For 2D tensors, it performs the
+ * standard matrix product. For higher-dimensional tensors, it multiplies the
+ * matrices of the last two dimensions, with the dimensions before them
+ * broadcast together. A 1D A is multiplied as a row vector and a 1D B as a
+ * column vector, and that dimension is removed from the output.
+ *
+ * All the products run as one strided batched GEMM that reads the inputs in
+ * place, a broadcast matrix being reused rather than replicated.
  *
  * @author Tim Carlsson (timca@chalmers.se)
  */
@@ -68,9 +73,17 @@ class MatMulNode : public Node {
    *
    * The operation follows standard matrix multiplication rules:
    * - For 2D tensors: C = A * B where A has shape (M, K) and B has shape (K, N)
-   * - For higher dimensions: batch multiplication with broadcasting
+   * - For higher dimensions: batch multiplication with broadcasting, e.g.
+   *   (2, 1, M, K) times (3, K, N) gives (2, 3, M, N)
+   * - For 1D tensors: (K) times (K, N) gives (N) and (M, K) times (K) gives
+   *   (M)
+   *
+   * An existing output tensor of the right shape is written in place.
    *
    * @param iomap Map containing input and output tensors indexed by name
+   * @throws std::runtime_error If an input is missing or a scalar, the types
+   * differ or are not supported, the inner dimensions differ or the batch
+   * dimensions can not be broadcast together.
    */
   void forward(
       std::unordered_map<std::string, GeneralDataTypes> &iomap) override;
@@ -93,21 +106,21 @@ class MatMulNode : public Node {
   /**
    * @brief Name of the first input tensor A
    *
-   * For 2D tensors, A should have shape (M, K)
+   * A should have shape (..., M, K), or (K)
    */
   std::string A;
 
   /**
    * @brief Name of the second input tensor B
    *
-   * For 2D tensors, B should have shape (K, N)
+   * B should have shape (..., K, N), or (K)
    */
   std::string B;
 
   /**
    * @brief Name of the output tensor Y
    *
-   * For 2D tensors, Y will have shape (M, N)
+   * Y will have the broadcast batch dimensions followed by (M, N)
    */
   std::string Y;
 };
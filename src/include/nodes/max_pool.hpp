@@ -72,6 +72,18 @@ class MaxPoolNode : public Node {
    */
   std::vector<std::string> getOutputs() override;
 
+  /**
+   * @brief Get a copy of the node on the blocked tensors, see
+   * Node::blocked_copy.
+   *
+   * @return The copy, or nullptr if the pooling is not 2D or has indices.
+   */
+  std::shared_ptr<Node> blocked_copy(
+      size_t block,
+      const std::unordered_map<std::string, GeneralDataTypes>& weights,
+      const std::function<std::string(const std::string&)>& blocked_name)
+      override;
+
  private:
   // Inputs
   std::string X;
@@ -88,4 +100,7 @@ class MaxPoolNode : public Node {
   std::vector<int> pads;
   int storage_order;
   std::vector<int> strides;
+
+  // Channels in a block of the blocked input and output, 0 if they are plain
+  size_t channel_block = 0;
 };
\ No newline at end of file
@@ -1,9 +1,81 @@
 #pragma once
 
+#include <array>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <variant>
+// IWYU pragma: no_include <__vector/vector.h>
+#include <vector>  // IWYU pragma: keep
+
 #include "datastructures/mml_array.hpp"
+#include "datastructures/tensor_factory.hpp"
+#include "operations/pooling.hpp"
 
 namespace NodeUtils {
 
+// Gets the tensor a node writes its output of the given shape into. An
+// existing output in the iomap, like the ones planned in the activation arena
+// of a model, is written in place when it has the element type and shape of
+// the result and is contiguous. Otherwise a new tensor is created, which the
+// node stores in the iomap in place of the existing one.
+template <typename T, typename IoMap>
+std::shared_ptr<Tensor<T>> reusable_output(const IoMap& iomap,
+                                           const std::string& name,
+                                           const array_mml<size_t>& shape) {
+  auto it = iomap.find(name);
+  if (it != iomap.end()) {
+    auto existing = std::get_if<std::shared_ptr<Tensor<T>>>(&it->second);
+    if (existing && *existing && (*existing)->get_shape() == shape &&
+        (*existing)->is_contiguous()) {
+      return *existing;
+    }
+  }
+  return TensorFactory::create_tensor<T>(shape);
+}
+
+// Gets the elements of a contiguous tensor for the kernels looping over raw
+// pointers. When they may not access it directly, always when built with
+// MML_CHECKED_ACCESS, the elements are gathered into values through the bounds
+// checked indexed access instead.
+template <typename T>
+const T* kernel_input(const std::shared_ptr<Tensor<T>>& tensor,
+                      std::vector<T>& values) {
+  if (tensor->raw_access()) {
+    return tensor->data();
+  }
+  values.resize(tensor->get_size());
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = (*tensor)[i];
+  }
+  return values.data();
+}
+
+// Gets the buffer the kernels write the elements of a contiguous tensor into,
+// values when they may not access the tensor directly. Gathered values start
+// out as the elements of the tensor, so kernels may also update them in place.
+// write_kernel_output then stores them in the tensor through the bounds
+// checked indexed access.
+template <typename T>
+T* kernel_output(const std::shared_ptr<Tensor<T>>& tensor,
+                 std::vector<T>& values) {
+  if (tensor->raw_access()) {
+    return tensor->data();
+  }
+  kernel_input(tensor, values);
+  return values.data();
+}
+
+// Stores the elements kernel_output gathered in values, if any, in the tensor.
+template <typename T>
+void write_kernel_output(const std::vector<T>& values,
+                         const std::shared_ptr<Tensor<T>>& tensor) {
+  for (size_t i = 0; i < values.size(); ++i) {
+    (*tensor)[i] = values[i];
+  }
+}
+
 inline void compute_pool_attributes(std::string& auto_pad,
                                     std::vector<int>& kernel_shape,
                                     std::vector<int>& strides,
@@ -118,4 +190,53 @@ inline std::vector<std::pair<int, int>> compute_pool_pad_begin_end(
   return pad_pairs;
 }
 
-}  // namespace NodeUtils
\ No newline at end of file
+// Gets the shape of the pooling kernels, operations/pooling.hpp, of an input
+// with 1 to 3 spatial dimensions. The missing leading ones are of size 1.
+inline PoolShape compute_pool_shape(
+    const array_mml<size_t>& input_shape, const array_mml<size_t>& output_shape,
+    const std::vector<int>& kernel_shape, const std::vector<int>& strides,
+    const std::vector<int>& dilations,
+    const std::vector<std::pair<int, int>>& pads) {
+  const size_t spatial_rank = kernel_shape.size();
+  if (spatial_rank < 1 || spatial_rank > 3 ||
+      input_shape.size() != spatial_rank + 2) {
+    throw std::invalid_argument(
+        "Pooling supports 1 to 3 spatial dimensions matching the kernel.");
+  }
+
+  // The 3D dimensions, the missing leading ones are of size 1 without padding
+  auto expand = [spatial_rank](auto get, size_t missing) {
+    std::array<size_t, 3> dims{missing, missing, missing};
+    for (size_t d = 0; d < spatial_rank; ++d) {
+      dims[3 - spatial_rank + d] = static_cast<size_t>(get(d));
+    }
+    return dims;
+  };
+  auto in = expand([&](size_t d) { return input_shape[d + 2]; }, 1);
+  auto out = expand([&](size_t d) { return output_shape[d + 2]; }, 1);
+  auto kernel = expand([&](size_t d) { return kernel_shape[d]; }, 1);
+  auto stride = expand([&](size_t d) { return strides[d]; }, 1);
+  auto dilation = expand([&](size_t d) { return dilations[d]; }, 1);
+  auto pad = expand([&](size_t d) { return pads[d].first; }, 0);
+  return PoolShape{input_shape[0] * input_shape[1],
+                   in[0],
+                   in[1],
+                   in[2],
+                   out[0],
+                   out[1],
+                   out[2],
+                   kernel[0],
+                   kernel[1],
+                   kernel[2],
+                   stride[0],
+                   stride[1],
+                   stride[2],
+                   dilation[0],
+                   dilation[1],
+                   dilation[2],
+                   pad[0],
+                   pad[1],
+                   pad[2]};
+}
+
+}  // namespace NodeUtils
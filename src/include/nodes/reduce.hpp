@@ -0,0 +1,92 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <optional>
+#include <string>
+#include <variant>
+// IWYU pragma: no_include <__vector/vector.h>
+#include <vector>  // IWYU pragma: keep
+
+#include "nlohmann/json_fwd.hpp"
+#include "nodes/a_node.hpp"
+#include "operations/reduction.hpp"
+
+/**
+ * @class ReduceNode
+ * @brief A class implementing ReduceSum, ReduceMean, ReduceMax, ReduceMin and
+ * ReduceL2.
+ *
+ * The axes are reduced by the kernels of operations/reduction.hpp. Reduced
+ * axes are kept with size 1 when keepdims is set and removed otherwise. The
+ * axes are an attribute in older opsets and an optional int64 input in newer
+ * ones, both are supported.
+ */
+class ReduceNode : public Node {
+ public:
+  /**
+   * @typedef T
+   * @brief Type alias for supported numeric types in reductions
+   */
+  using T = std::variant<double, float, int32_t, int64_t, uint32_t, uint64_t>;
+
+  /**
+   * @brief Constructor for ReduceNode.
+   *
+   * @param kind The reduction computed.
+   * @param data Name of the input tensor.
+   * @param reduced Name of the output tensor.
+   * @param axes Axes to reduce, negative ones count from the last axis.
+   * @param keepdims Keeps the reduced axes with size 1 if not 0.
+   * @param noop_with_empty_axes When no axes are given, the input is passed
+   * through if not 0 and every axis is reduced otherwise.
+   * @param axes_input Name of an int64 tensor holding the axes, used in place
+   * of axes when given.
+   */
+  ReduceNode(ReductionKind kind, const std::string &data,
+             const std::string &reduced, const std::vector<int> &axes = {},
+             int keepdims = 1, int noop_with_empty_axes = 0,
+             const std::optional<std::string> &axes_input = std::nullopt);
+
+  /**
+   * @brief Constructor for ReduceNode from JSON, the reduction is given by its
+   * opType.
+   *
+   * @param node JSON object representing the Reduce node.
+   * @throws std::runtime_error If the opType is not a supported reduction.
+   */
+  explicit ReduceNode(const nlohmann::json &node);
+
+  /**
+   * @brief Perform the forward pass computation of the reduction.
+   *
+   * @param iomap Map containing input and output tensors indexed by name
+   * @throws std::runtime_error If an input is missing, has an unsupported type
+   * or an axis is out of range.
+   */
+  void forward(
+      std::unordered_map<std::string, GeneralDataTypes> &iomap) override;
+
+  /**
+   * @brief Get inputs.
+   *
+   * @return The names of the inputs to the node.
+   */
+  std::vector<std::string> getInputs() override;
+
+  /**
+   * @brief Get outputs.
+   *
+   * @return The names of the outputs to the node.
+   */
+  std::vector<std::string> getOutputs() override;
+
+ private:
+  ReductionKind kind;                     // The reduction computed.
+  std::string data;                       // Input tensor.
+  std::string reduced;                    // Output tensor.
+  std::vector<int> axes;                  // Axes to reduce.
+  int keepdims;                           // Keeps the reduced axes.
+  int noop_with_empty_axes;               // Passes the input through.
+  std::optional<std::string> axes_input;  // Tensor holding the axes.
+};
@@ -2,6 +2,7 @@
 
 #include <stdint.h>
 
+#include <optional>
 #include <string>
 #include <variant>
 
@@ -59,6 +60,21 @@ class ReLUNode : public Node {
    */
   std::vector<std::string> getOutputs() override;
 
+  /**
+   * @brief Get a copy of the node on the blocked tensors, see
+   * Node::blocked_copy. The activation is elementwise, so any layout works.
+   */
+  std::shared_ptr<Node> blocked_copy(
+      size_t block,
+      const std::unordered_map<std::string, GeneralDataTypes> &weights,
+      const std::function<std::string(const std::string &)> &blocked_name)
+      override;
+
+  /**
+   * @brief Get the activation of the node, see Node::fusable_activation.
+   */
+  std::optional<Activation> fusable_activation() const override;
+
  private:
   std::string X;  // Input tensor X.
   std::string Y;  // Output tensor Y.
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <string>
+#include <variant>
+// IWYU pragma: no_include <__vector/vector.h>
+#include <vector>  // IWYU pragma: keep
+
+#include "nodes/a_node.hpp"
+
+/**
+ * @class ReorderNode
+ * @brief A class converting a tensor between the plain NCHW layout and the
+ * blocked NCHWc layout.
+ *
+ * The node is not part of ONNX, Model_mml inserts it around the nodes running
+ * in the blocked layout when channel blocking is enabled. A [batch, channels,
+ * height, width] tensor is blocked into [batch, channels / block, height,
+ * width, block], see operations/nchwc.hpp.
+ */
+class ReorderNode : public Node {
+ public:
+  /**
+   * @typedef T
+   * @brief Type alias for supported numeric types in reorder operations
+   */
+  using T = std::variant<double, float>;
+
+  /**
+   * @brief Constructor for ReorderNode.
+   *
+   * @param X Name of the input tensor.
+   * @param Y Name of the output tensor.
+   * @param block Number of channels in a block, the channels of a plain input
+   * must be a multiple of it.
+   * @param to_blocked True to block a plain input, false to unblock a blocked
+   * input.
+   */
+  ReorderNode(const std::string &X, const std::string &Y, size_t block,
+              bool to_blocked);
+
+  /**
+   * @brief Perform the forward pass computation of the reorder.
+   */
+  void forward(
+      std::unordered_map<std::string, GeneralDataTypes> &iomap) override;
+
+  /**
+   * @brief Get inputs.
+   *
+   * @return The names of the inputs to the node.
+   */
+  std::vector<std::string> getInputs() override;
+
+  /**
+   * @brief Get outputs.
+   *
+   * @return The names of the outputs to the node.
+   */
+  std::vector<std::string> getOutputs() override;
+
+ private:
+  std::string X;    // Input tensor X.
+  std::string Y;    // Output tensor Y.
+  size_t block;     // Channels in a block.
+  bool to_blocked;  // Direction of the reorder.
+};
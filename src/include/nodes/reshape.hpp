@@ -95,6 +95,13 @@ class reshapeNode : public Node {
    */
   std::vector<std::string> getOutputs() override;
 
+  /**
+   * @brief Checks if the node writes its output in place.
+   *
+   * @return False, the output is a view of the input when it can be
+   */
+  bool writes_outputs_in_place() const override { return false; }
+
  private:
   /**
    * @brief Name of the input tensor containing the data to be reshaped
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <string>
+#include <variant>
+
+#include "nlohmann/json_fwd.hpp"
+#include "nodes/a_node.hpp"
+#include "operations/softmax.hpp"
+
+/**
+ * @class SoftMaxNode
+ * @brief A class implementing Softmax and LogSoftmax.
+ *
+ * This class inherits from the Node class and applies SoftMax, or SoftMax and
+ * Logarithm, along the specified axis, of an input of any rank, with the
+ * kernels of operations/softmax.hpp.
+ */
+class SoftMaxNode : public Node {
+ public:
+  /**
+   * @typedef T
+   * @brief Type alias for supported floating-point types in SoftMax
+   * operations
+   */
+  using T = std::variant<float, double>;
+
+  /**
+   * @brief Constructor for SoftMaxNode.
+   *
+   * @param X Shared pointer to the tensor X.
+   * @param Y Shared pointer to the output tensor.
+   * @param axis Integer representing along which axis SoftMax is applied to,
+   * negative values count from the last axis. (default -1)
+   * @param kind The operation computed. (default Softmax)
+   */
+  SoftMaxNode(const std::string &X, const std::string &Y, int axis = -1,
+              SoftmaxKind kind = SoftmaxKind::Softmax);
+
+  /**
+   * @brief Constructor for SoftMaxNode from JSON, the operation is given by
+   * its opType.
+   *
+   * @param node JSON object representing the Softmax or LogSoftmax node.
+   * @throws std::runtime_error If the opType is not Softmax or LogSoftmax.
+   */
+  explicit SoftMaxNode(const nlohmann::json &node);
+
+  /**
+   * @brief Perform the forward pass computation using SoftMax activation
+   * std::function.
+   *
+   * @param iomap Map containing input and output tensors indexed by name
+   * @throws std::runtime_error If the input is missing, has an unsupported
+   * type or the axis is out of range.
+   */
+  void forward(
+      std::unordered_map<std::string, GeneralDataTypes> &iomap) override;
+
+  /**
+   * @brief Get inputs.
+   *
+   * @return The names of the inputs to the node.
+   */
+  std::vector<std::string> getInputs() override;
+
+  /**
+   * @brief Get outputs.
+   *
+   * @return The names of the outputs to the node.
+   */
+  std::vector<std::string> getOutputs() override;
+
+ protected:
+  /**
+   * @brief Constructor for SoftMaxNode from JSON computing the given
+   * operation, whatever its opType.
+   *
+   * @param node JSON object representing the node.
+   * @param kind The operation computed.
+   */
+  SoftMaxNode(const nlohmann::json &node, SoftmaxKind kind);
+
+ private:
+  std::string X;     // Input tensor X.
+  std::string Y;     // Output tensor Y.
+  int axis;          // Axis SoftMax is applied along.
+  SoftmaxKind kind;  // The operation computed.
+};
@@ -64,6 +64,13 @@ class TransposeNode : public Node {
    */
   std::vector<std::string> getOutputs() override;
 
+  /**
+   * @brief Checks if the node writes its output in place.
+   *
+   * @return False, the output is a view of the input
+   */
+  bool writes_outputs_in_place() const override { return false; }
+
  private:
   /**
    * @brief Input tensor A.
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include "datastructures/a_tensor.hpp"
+#include "datastructures/tensor_concept.hpp"
+
+/**
+ * Activations fused into the epilogue of the convolution and GEMM kernels.
+ *
+ * A kernel that knows the activation following it applies it to the values it
+ * has just written, a row or a tile at a time while they are still in cache,
+ * instead of a separate node reading and writing the whole tensor again. The
+ * functions are the ones of the activation nodes, so fusing them does not
+ * change the results.
+ */
+
+/**
+ * The activation nodes that can be fused.
+ */
+enum class ActivationKind {
+  Identity,   // No activation
+  Relu,       // max(x, 0)
+  LeakyRelu,  // x < 0 ? alpha * x : x
+  Elu,        // x < 0 ? alpha * (exp(x) - 1) : x
+  Sigmoid,    // 1 / (1 + exp(-x))
+  Swish,      // x * sigmoid(x)
+  TanH,       // tanh(x)
+  Gelu,       // 0.5 * x * (1 + erf(x / sqrt(2)))
+  GeluTanh    // The tanh approximation of Gelu
+};
+
+/**
+ * An activation and its parameter.
+ */
+struct Activation {
+  ActivationKind kind = ActivationKind::Identity;  // Function applied
+  float alpha = 0.0f;  // Slope of LeakyRelu and scale of Elu
+
+  /**
+   * Checks if the activation leaves the values unchanged.
+   */
+  bool is_identity() const { return kind == ActivationKind::Identity; }
+};
+
+/**
+ * Calls visit with a functor computing the activation of a value of type T.
+ * Every activation has its own functor type, so the loops of visit are
+ * instantiated and vectorized per activation. The functors call the scalar
+ * functions of <cmath>, and Gelu is computed with tanh in the Fast accuracy
+ * tier of VectorMath.
+ *
+ * @throws std::invalid_argument If the activation needs a floating point T.
+ */
+template <TensorConcept::Types T, typename Visitor>
+static void mml_visit_activation(const Activation &activation,
+                                 Visitor &&visit);
+
+/**
+ * Adds the bias to count consecutive values and applies the activation to
+ * them, in place, on the calling thread. The activations built on exp, tanh
+ * and erf of float and double run on the vectorized math functions of
+ * vector_math.hpp.
+ */
+template <TensorConcept::Types T>
+static void mml_bias_activate(const Activation &activation, T bias, T *values,
+                              size_t count);
+
+/**
+ * Writes the activation of every element of x to y, see mml_map. This is the
+ * forward pass of the activation nodes. Contiguous tensors are split over the
+ * thread pool and go through the vectorized math functions like
+ * mml_bias_activate, views through the scalar functors.
+ */
+template <TensorConcept::Types T>
+static void mml_activate(const Activation &activation,
+                         const std::shared_ptr<const Tensor<T>> x,
+                         const std::shared_ptr<Tensor<T>> y);
+
+#include "../operations/activation.tpp"
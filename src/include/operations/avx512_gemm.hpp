@@ -11,5 +11,5 @@ static void mml_gemm_avx512(int TA, int TB, int M, int N, int K, T ALPHA,
                             std::shared_ptr<Tensor<T>> A, int lda,
                             std::shared_ptr<Tensor<T>> B, int ldb, T BETA,
                             std::shared_ptr<Tensor<T>> C, int ldc);
-#include "../operations/avx_gemm.tpp"
+#include "../operations/avx512_gemm.tpp"
 #endif
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include "datastructures/a_tensor.hpp"
+#include "datastructures/mml_array.hpp"
+#include "datastructures/tensor_concept.hpp"
+
+/**
+ * Elementwise binary operations with multidirectional broadcasting.
+ *
+ * Every input is read through its strides over the output shape, with a
+ * stride of 0 along the dimensions it is broadcast in, so nothing is
+ * replicated. Neighbouring dimensions that are laid out one after the other in
+ * every tensor are merged first, which turns most broadcasts into a few
+ * dimensions: a per channel scale of an NCHW tensor becomes [N, C, H * W], a
+ * bias over the last axis a single run. The innermost run is a contiguous
+ * loop, with the broadcast operand hoisted out of it when its step is 0, and
+ * the outer dimensions are split over the thread pool. Like mml_map, the
+ * function is a template parameter inlined into those loops.
+ */
+
+/**
+ * The binary operations, as in the ONNX operators of the same names.
+ */
+enum class BinaryKind {
+  Add,  // a + b
+  Sub,  // a - b
+  Mul,  // a * b
+  Div,  // a / b
+  Pow,  // a to the power of b
+  Min,  // The smaller of a and b
+  Max   // The larger of a and b
+};
+
+/**
+ * Gets the shape a and b broadcast to, following the numpy rules: the shapes
+ * are aligned on their last dimensions, and the sizes of every dimension must
+ * be equal or one of them 1.
+ *
+ * @throws std::invalid_argument If the shapes can not be broadcast together.
+ */
+static inline array_mml<size_t> mml_broadcast_shape(
+    const array_mml<size_t> &a, const array_mml<size_t> &b);
+
+/**
+ * Writes f(a, b) of the elements of a and b broadcast to the shape of c to
+ * the elements of c. c may be a view, and may be a or b when it has their
+ * shape.
+ *
+ * @throws std::invalid_argument If a and b do not broadcast to the shape of c.
+ */
+template <TensorConcept::Types T, typename F>
+static void mml_map_binary(const std::shared_ptr<const Tensor<T>> a,
+                           const std::shared_ptr<const Tensor<T>> b, F f,
+                           const std::shared_ptr<Tensor<T>> c);
+
+/**
+ * Computes the binary operation of a and b broadcast to the shape of c into c.
+ * Pow of integers is computed in double and truncated.
+ */
+template <TensorConcept::Types T>
+static void mml_binary(BinaryKind kind,
+                       const std::shared_ptr<const Tensor<T>> a,
+                       const std::shared_ptr<const Tensor<T>> b,
+                       const std::shared_ptr<Tensor<T>> c);
+
+#include "../operations/binary.tpp"
@@ -4,6 +4,7 @@
 
 #include "datastructures/a_tensor.hpp"
 #include "datastructures/tensor_concept.hpp"
+#include "utility/thread_pool.hpp"
 
 #ifdef USE_OPENBLAS_GEMM
 template <TensorConcept::Types T>
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+// IWYU pragma: no_include <__vector/vector.h>
+#include <vector>  // IWYU pragma: keep
+
+#include "datastructures/tensor_concept.hpp"
+
+/**
+ * Per channel affine transform, y = x * scale[c] + shift[c], the inference
+ * form of BatchNormalization.
+ *
+ * Every [batch, channel] plane is a single run of multiply-adds with the two
+ * constants of its channel, which the compiler vectorizes. The planes are
+ * transformed in parallel.
+ */
+
+/**
+ * Scale and shift of every channel, kept in double so that folding them into
+ * the weights of another node rounds once, in the type of those weights.
+ */
+struct ChannelAffine {
+  std::vector<double> scale;  // Multiplies channel c
+  std::vector<double> shift;  // Added to channel c after the scale
+};
+
+/**
+ * Transforms a contiguous [batch, channels, spatial] input into the output of
+ * the same shape, which may be the input itself.
+ */
+template <TensorConcept::Types T>
+static void mml_channel_affine(size_t batch, size_t channels, size_t spatial,
+                               const T *input, const T *scale, const T *shift,
+                               T *output);
+
+#include "../operations/channel_affine.tpp"
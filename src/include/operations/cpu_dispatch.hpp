@@ -0,0 +1,132 @@
+#pragma once
+
+#include <string>
+
+// Kernels for x86 instruction set extensions are built into the library with
+// per-function target attributes, whatever flags the rest of it is built with
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define MML_X86_KERNELS 1
+#define MML_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define MML_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#define MML_FLATTEN __attribute__((flatten))
+#else
+#define MML_X86_KERNELS 0
+#define MML_TARGET_AVX2
+#define MML_TARGET_AVX512
+#define MML_FLATTEN
+#endif
+
+/**
+ * @enum SimdTier
+ * @brief Instruction set tiers the hot kernels are built for, from the most
+ * portable to the widest.
+ */
+enum class SimdTier {
+  Scalar = 0,  // Portable code, whatever the compiler targets by default
+  AVX2 = 1,    // AVX2 with FMA
+  AVX512 = 2   // AVX-512 Foundation
+};
+
+/**
+ * @class CpuDispatch
+ * @brief Selects at runtime which tier of the kernels TensorOperations runs.
+ *
+ * The tier defaults to the widest one the CPU supports. It can be lowered for
+ * benchmarking with set_tier or with the MML_SIMD_TIER environment variable
+ * (scalar, avx2 or avx512), read when the tier is first needed.
+ */
+class CpuDispatch {
+ public:
+  /**
+   * @brief Detects the widest tier supported by the CPU and the OS.
+   *
+   * @return The widest supported tier
+   */
+  static SimdTier detect_tier();
+
+  /**
+   * @brief Gets the tier the kernels currently run.
+   *
+   * @return The current tier
+   */
+  static SimdTier get_tier();
+
+  /**
+   * @brief Forces the tier the kernels run.
+   *
+   * @param tier The tier to run
+   * @throws std::invalid_argument If the CPU does not support the tier
+   */
+  static void set_tier(SimdTier tier);
+
+  /**
+   * @brief Goes back to the tier selected at startup, the detected one unless
+   * MML_SIMD_TIER overrides it.
+   */
+  static void reset_tier();
+
+  /**
+   * @brief Gets the name of a tier, as accepted by MML_SIMD_TIER.
+   *
+   * @param tier The tier
+   * @return The name of the tier
+   */
+  static std::string tier_name(SimdTier tier);
+
+  /**
+   * @brief Parses the name of a tier, case insensitive.
+   *
+   * @param name The name of the tier
+   * @return The tier
+   * @throws std::invalid_argument If the name is not a known tier
+   */
+  static SimdTier parse_tier(const std::string &name);
+
+ private:
+  /**
+   * @brief Gets the tier selected at startup.
+   *
+   * @return The detected tier, or the one requested through MML_SIMD_TIER if
+   * the CPU supports it
+   */
+  static SimdTier startup_tier();
+};
+
+#if MML_X86_KERNELS
+template <typename F, typename... Args>
+MML_TARGET_AVX512 MML_FLATTEN static void mml_dispatch_avx512(F &loop,
+                                                              Args... args) {
+  loop(args...);
+}
+
+template <typename F, typename... Args>
+MML_TARGET_AVX2 MML_FLATTEN static void mml_dispatch_avx2(F &loop,
+                                                          Args... args) {
+  loop(args...);
+}
+#endif
+
+/**
+ * Runs loop with the given arguments, built for the tier the kernels currently
+ * run. The tiered wrappers are flattened, so the loops of loop and of
+ * everything it calls inline are compiled, and vectorized, with the
+ * instruction set of the tier. Meant for the body of a parallel chunk, calls
+ * that can not be inlined run their portable code.
+ */
+template <typename F, typename... Args>
+static void mml_dispatch_tier(F &&loop, Args... args) {
+#if MML_X86_KERNELS
+  switch (CpuDispatch::get_tier()) {
+    case SimdTier::AVX512:
+      mml_dispatch_avx512(loop, args...);
+      return;
+    case SimdTier::AVX2:
+      mml_dispatch_avx2(loop, args...);
+      return;
+    default:
+      break;
+  }
+#endif
+  loop(args...);
+}
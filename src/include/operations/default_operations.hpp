@@ -6,6 +6,7 @@
 #include <initializer_list>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <nlohmann/json.hpp>
 #include <numeric>
 #include <optional>
@@ -22,6 +23,9 @@
 #include "datastructures/a_tensor.hpp"
 #include "datastructures/tensor_concept.hpp"
 #include "datastructures/tensor_factory.hpp"
+#include "operations/binary.hpp"
+#include "operations/elementwise.hpp"
+#include "utility/thread_pool.hpp"
 
 /**
  * Standard Tensor operation functions that gets shipped with ModularML as
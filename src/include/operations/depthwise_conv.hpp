@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+
+#include "datastructures/tensor_concept.hpp"
+#include "operations/activation.hpp"
+
+/**
+ * Direct depthwise convolution, the convolution with one group per input
+ * channel. Output channel k only reads input channel k / multiplier.
+ *
+ * Im2col and a GEMM would multiply [multiplier, kernel_size] matrices, so the
+ * kernel is computed directly instead. Every output row is accumulated from
+ * the input rows under the kernel, one kernel element at a time over the whole
+ * row. The columns reading the padding are cut from each pass instead of being
+ * tested per element, so the inner loops are plain multiply-adds the compiler
+ * vectorizes along the row. The rows of the output are computed in parallel.
+ */
+
+/**
+ * Dimensions of a depthwise convolution, padding is only needed at the top and
+ * on the left since the output size is given.
+ */
+struct DepthwiseConvShape {
+  size_t batch;            // Number of images
+  size_t channels;         // Input channels, also the number of groups
+  size_t height;           // Input height
+  size_t width;            // Input width
+  size_t multiplier;       // Output channels per input channel
+  size_t out_height;       // Output height
+  size_t out_width;        // Output width
+  size_t kernel_height;    // Kernel height
+  size_t kernel_width;     // Kernel width
+  size_t stride_height;    // Vertical stride
+  size_t stride_width;     // Horizontal stride
+  size_t dilation_height;  // Vertical dilation
+  size_t dilation_width;   // Horizontal dilation
+  size_t pad_top;          // Zero rows above the input
+  size_t pad_left;         // Zero columns left of the input
+};
+
+/**
+ * Convolves a contiguous [batch, channels, height, width] input with
+ * contiguous [channels * multiplier, 1, kernel_height, kernel_width] weights,
+ * writing the contiguous [batch, channels * multiplier, out_height, out_width]
+ * output. The bias, of channels * multiplier values or null, and the
+ * activation are applied to every output row as soon as it is computed.
+ */
+template <TensorConcept::Types T>
+static void mml_depthwise_conv(const DepthwiseConvShape &shape, const T *input,
+                               const T *weights, const T *bias,
+                               const Activation &activation, T *output);
+
+#include "../operations/depthwise_conv.tpp"
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include "datastructures/a_tensor.hpp"
+#include "datastructures/tensor_concept.hpp"
+
+/**
+ * Elementwise map of a function over a tensor.
+ *
+ * The function is a template parameter, a lambda or functor, so the compiler
+ * inlines it into the loops and vectorizes them when it can, unlike a
+ * std::function called for every element. Contiguous tensors are one flat
+ * loop. Views are walked a row of the last dimension at a time, with the
+ * offsets of both tensors advanced by their strides, so no element goes
+ * through the virtual indexed access. Large tensors are split over the thread
+ * pool.
+ */
+
+/**
+ * Writes f of every element of a to the element of c at the same position.
+ * c must hold as many elements as a, and has the same shape when either is a
+ * view. c may be a itself.
+ */
+template <TensorConcept::Types T, typename F>
+static void mml_map(const std::shared_ptr<const Tensor<T>> a, F f,
+                    const std::shared_ptr<Tensor<T>> c);
+
+/**
+ * Replaces every element of a by f of itself.
+ */
+template <TensorConcept::Types T, typename F>
+static void mml_map_in_place(const std::shared_ptr<Tensor<T>> a, F f);
+
+#include "../operations/elementwise.tpp"
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include "datastructures/a_tensor.hpp"
+#include "datastructures/tensor_concept.hpp"
+#include "operations/activation.hpp"
+
+/**
+ * Kernels of the blocked NCHWc activation layout.
+ *
+ * A [batch, channels, height, width] tensor is stored as [batch, channels /
+ * block, height, width, block], the channels are cut into blocks that are
+ * innermost. A SIMD register then holds a pixel of a whole block of channels.
+ * The direct convolution broadcasts one input value and multiplies it with a
+ * register of weights for block output channels, so it needs neither im2col
+ * nor gathers. Pooling and elementwise kernels work on whole registers too.
+ *
+ * The block is the number of floats in a register of the selected tier, 16
+ * for AVX-512 and 8 otherwise, and the channels must be a multiple of it.
+ * Kernels for another block or element type fall back to portable loops.
+ */
+
+/**
+ * Dimensions of a convolution in the blocked layout, padding is only needed
+ * at the top and on the left since the output size is given.
+ */
+struct NchwcConvShape {
+  size_t batch;            // Number of images
+  size_t channels;         // Input channels, a multiple of the block
+  size_t height;           // Input height
+  size_t width;            // Input width
+  size_t out_channels;     // Output channels, a multiple of the block
+  size_t out_height;       // Output height
+  size_t out_width;        // Output width
+  size_t kernel_height;    // Kernel height
+  size_t kernel_width;     // Kernel width
+  size_t stride_height;    // Vertical stride
+  size_t stride_width;     // Horizontal stride
+  size_t dilation_height;  // Vertical dilation
+  size_t dilation_width;   // Horizontal dilation
+  size_t pad_top;          // Zero rows above the input
+  size_t pad_left;         // Zero columns left of the input
+};
+
+/**
+ * Dimensions of a pooling in the blocked layout, the windows are clipped to
+ * the input.
+ */
+struct NchwcPoolShape {
+  size_t batch;            // Number of images
+  size_t channels;         // Channels, a multiple of the block
+  size_t height;           // Input height
+  size_t width;            // Input width
+  size_t out_height;       // Output height
+  size_t out_width;        // Output width
+  size_t kernel_height;    // Window height
+  size_t kernel_width;     // Window width
+  size_t stride_height;    // Vertical stride
+  size_t stride_width;     // Horizontal stride
+  size_t dilation_height;  // Vertical dilation
+  size_t dilation_width;   // Horizontal dilation
+  size_t pad_top;          // Padding rows above the input
+  size_t pad_left;         // Padding columns left of the input
+};
+
+/**
+ * Gets the channel block of the blocked layout for an element type and the
+ * selected tier.
+ */
+template <TensorConcept::Types T>
+static size_t mml_nchwc_block();
+
+/**
+ * Reorders a contiguous [batch, channels, spatial] input into the contiguous
+ * [batch, channels / block, spatial, block] output.
+ */
+template <TensorConcept::Types T>
+static void mml_nchw_to_nchwc(size_t block, size_t batch, size_t channels,
+                              size_t spatial, const T *input, T *output);
+
+/**
+ * Reorders a contiguous [batch, channels / block, spatial, block] input into
+ * the contiguous [batch, channels, spatial] output.
+ */
+template <TensorConcept::Types T>
+static void mml_nchwc_to_nchw(size_t block, size_t batch, size_t channels,
+                              size_t spatial, const T *input, T *output);
+
+/**
+ * Reorders [out_channels, channels, kernel_height, kernel_width] weights into
+ * the [out_channels / block, channels / block, kernel_height, kernel_width,
+ * block, block] weights of mml_nchwc_conv, input channel before output
+ * channel. The reorder only depends on the weights, it is meant to be done
+ * once and reused by every call.
+ */
+template <TensorConcept::Types T>
+static std::shared_ptr<Tensor<T>> mml_nchwc_conv_weights(
+    size_t block, const std::shared_ptr<Tensor<T>> &weights);
+
+/**
+ * Convolves a contiguous blocked input with weights reordered by
+ * mml_nchwc_conv_weights for the same block, writing the contiguous blocked
+ * output. The output starts from the bias, of out_channels values, or from
+ * zero if it is null. The activation is applied to every tile of the output
+ * right after it is stored.
+ */
+template <TensorConcept::Types T>
+static void mml_nchwc_conv(size_t block, const NchwcConvShape &shape,
+                           const T *input, const T *weights, const T *bias,
+                           const Activation &activation, T *output);
+
+/**
+ * Max pooling of a contiguous blocked input into the contiguous blocked
+ * output.
+ */
+template <TensorConcept::Types T>
+static void mml_nchwc_max_pool(size_t block, const NchwcPoolShape &shape,
+                               const T *input, T *output);
+
+/**
+ * Average pooling of a contiguous blocked input into the contiguous blocked
+ * output. The sums are divided by the window size if count_include_pad is
+ * set, by the number of values inside the input otherwise.
+ */
+template <TensorConcept::Types T>
+static void mml_nchwc_avg_pool(size_t block, const NchwcPoolShape &shape,
+                               bool count_include_pad, const T *input,
+                               T *output);
+
+#include "../operations/nchwc.tpp"
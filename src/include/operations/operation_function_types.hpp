@@ -20,6 +20,22 @@ using gemm_func = std::function<void(
     int lda, std::shared_ptr<Tensor<T>> B, int ldb, T BETA,
     std::shared_ptr<Tensor<T>> C, int ldc)>;
 
+/**
+ * @typedef gemm_strided_batched_func
+ * @brief Function signature for strided batched general matrix multiplication
+ *
+ * @tparam T The numeric type of the tensor elements
+ */
+template <TensorConcept::Types T>
+using gemm_strided_batched_func = std::function<void(
+    int TA, int TB, int M, int N, int K, T ALPHA, std::shared_ptr<Tensor<T>> A,
+    int lda, const std::vector<size_t>& a_batch_strides,
+    std::shared_ptr<Tensor<T>> B, int ldb,
+    const std::vector<size_t>& b_batch_strides, T BETA,
+    std::shared_ptr<Tensor<T>> C, int ldc,
+    const std::vector<size_t>& c_batch_strides,
+    const std::vector<size_t>& batch_shape)>;
+
 /**
  * @typedef gemm_onnx_func
  * @brief Function signature for ONNX-style general matrix multiplication
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+// IWYU pragma: no_include <__vector/vector.h>
+#include <vector>  // IWYU pragma: keep
+
+#include "datastructures/a_tensor.hpp"
+#include "datastructures/mml_array.hpp"
+#include "datastructures/tensor_concept.hpp"
+#include "operations/activation.hpp"
+#include "operations/cpu_dispatch.hpp"
+#include "utility/thread_pool.hpp"
+
+/**
+ * Packed, cache blocked GEMM in the style of GotoBLAS/BLIS.
+ *
+ * Panels of A and B are packed into aligned scratch buffers so that an MR x NR
+ * micro-kernel streams through contiguous memory. The loops around the
+ * micro-kernel are blocked by NC (L3), KC (L1/L2 panel depth) and MC (L2) and
+ * the MC x NR tiles of a packed block are computed in parallel on the global
+ * thread pool. Transposed A and B are handled while packing.
+ *
+ * The micro-kernels of every SimdTier are built into the library,
+ * mml_gemm_packed runs the ones of the tier selected by CpuDispatch.
+ */
+template <TensorConcept::Types T>
+static void mml_gemm_packed(int TA, int TB, int M, int N, int K, T ALPHA,
+                            std::shared_ptr<Tensor<T>> A, int lda,
+                            std::shared_ptr<Tensor<T>> B, int ldb, T BETA,
+                            std::shared_ptr<Tensor<T>> C, int ldc);
+
+/**
+ * Strided batched packed GEMM: C_i := ALPHA * op(A_i) * op(B_i) + BETA * C_i
+ * for every index i of batch_shape. The matrices of a batch start at the dot
+ * product of i with the batch strides of their tensor, counted in elements of
+ * its contiguous layout like the leading dimensions, and a stride of 0 reuses
+ * the same matrix along a dimension, which is how broadcast batch dimensions
+ * are read without replicating them. The tensors are read in place when they
+ * are contiguous, A and B also when they are views of contiguous tensors with
+ * their last two dimensions transposed, like the transposed weights of a
+ * MatMul.
+ *
+ * Batches that all multiply the same B with their A and C rows stacked one
+ * after the other, like a batch of sequences through a weight matrix, run as
+ * a single GEMM with taller A and C. Other batches are computed in parallel,
+ * each GEMM also splitting its tiles over the threads left.
+ */
+template <TensorConcept::Types T>
+static void mml_gemm_strided_batched(
+    int TA, int TB, int M, int N, int K, T ALPHA, std::shared_ptr<Tensor<T>> A,
+    int lda, const std::vector<size_t>& a_batch_strides,
+    std::shared_ptr<Tensor<T>> B, int ldb,
+    const std::vector<size_t>& b_batch_strides, T BETA,
+    std::shared_ptr<Tensor<T>> C, int ldc,
+    const std::vector<size_t>& c_batch_strides,
+    const std::vector<size_t>& batch_shape);
+
+/**
+ * Packed GEMM running the micro-kernels of the given tier, the CPU must
+ * support it.
+ */
+template <TensorConcept::Types T, SimdTier tier>
+static void mml_gemm_packed_tier(int TA, int TB, int M, int N, int K, T ALPHA,
+                                 std::shared_ptr<Tensor<T>> A, int lda,
+                                 std::shared_ptr<Tensor<T>> B, int ldb, T BETA,
+                                 std::shared_ptr<Tensor<T>> C, int ldc);
+
+/**
+ * Operand of the packed GEMM packed ahead of time, for a matrix such as a
+ * weight tensor that is multiplied many times. The panels follow the blocking
+ * of the tier they were packed for, so they are only valid while that tier
+ * is the one CpuDispatch selects.
+ */
+template <TensorConcept::Types T>
+struct PackedGemmOperand {
+  SimdTier tier;        // Tier whose blocking the panels follow
+  int rows;             // Rows of the packed op(A) or op(B)
+  int cols;             // Columns of the packed op(A) or op(B)
+  array_mml<T> panels;  // The packed panels
+};
+
+/**
+ * Work the packed GEMM does on the rows of C once they hold their final
+ * value, while the tile is still in cache: C(i, j) becomes the activation of
+ * C(i, j) + row_bias[i].
+ */
+template <TensorConcept::Types T>
+struct GemmEpilogue {
+  const T* row_bias = nullptr;  // Bias of every row of C, or null for none
+  Activation activation;        // Applied after the bias
+};
+
+/**
+ * Applies an epilogue to the M x N matrix C computed by another GEMM, the
+ * rows in parallel.
+ */
+template <TensorConcept::Types T>
+static void mml_gemm_apply_epilogue(const GemmEpilogue<T>& epilogue, int M,
+                                    int N, T* C, int ldc);
+
+/**
+ * Gets the tier the packed GEMM runs for an element type, the only one the
+ * operands it uses may be packed for.
+ */
+template <TensorConcept::Types T>
+static SimdTier mml_gemm_tier();
+
+/**
+ * Packs the M x K matrix op(A) as the left operand of mml_gemm_prepacked_a.
+ */
+template <TensorConcept::Types T>
+static std::shared_ptr<const PackedGemmOperand<T>> mml_gemm_prepack_a(
+    int TA, int M, int K, std::shared_ptr<Tensor<T>> A, int lda);
+
+/**
+ * Packs the K x N matrix op(B) as the right operand of mml_gemm_prepacked_b.
+ */
+template <TensorConcept::Types T>
+static std::shared_ptr<const PackedGemmOperand<T>> mml_gemm_prepack_b(
+    int TB, int K, int N, std::shared_ptr<Tensor<T>> B, int ldb);
+
+/**
+ * Packed GEMM C := ALPHA * A * op(B) + BETA * C with A packed ahead of time,
+ * which gives M and K. The epilogue, if any, is applied to C afterwards.
+ */
+template <TensorConcept::Types T>
+static void mml_gemm_prepacked_a(const PackedGemmOperand<T>& A, int TB, int N,
+                                 T ALPHA, std::shared_ptr<Tensor<T>> B,
+                                 int ldb, T BETA, std::shared_ptr<Tensor<T>> C,
+                                 int ldc,
+                                 const GemmEpilogue<T>* epilogue = nullptr);
+
+/**
+ * Packed GEMM C := ALPHA * op(A) * B + BETA * C with B packed ahead of time,
+ * which gives K and N.
+ */
+template <TensorConcept::Types T>
+static void mml_gemm_prepacked_b(int TA, int M, T ALPHA,
+                                 std::shared_ptr<Tensor<T>> A, int lda,
+                                 const PackedGemmOperand<T>& B, T BETA,
+                                 std::shared_ptr<Tensor<T>> C, int ldc);
+
+template <TensorConcept::Types T>
+static std::shared_ptr<Tensor<T>> mml_onnx_gemm_packed(
+    std::shared_ptr<Tensor<T>> A = nullptr,
+    std::shared_ptr<Tensor<T>> B = nullptr, float alpha = 1.0, float beta = 1.0,
+    int transA = 0, int transB = 0,
+    std::optional<std::shared_ptr<Tensor<T>>> C = std::nullopt);
+
+#include "../operations/packed_gemm.tpp"
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "datastructures/tensor_concept.hpp"
+
+/**
+ * Max and average pooling of plain [batch, channels, spatial...] inputs with
+ * one to three spatial dimensions, the missing ones being of size 1.
+ *
+ * The window positions inside the input are computed analytically: per output
+ * row the depth and height positions of the window are clipped once, and for
+ * every width position of the window the output columns reading inside the
+ * input are cut from the pass instead of being tested per element. The inner
+ * loops therefore run along the row without branches, which the compiler
+ * vectorizes when the horizontal stride is 1. The rows of the output are
+ * pooled in parallel.
+ */
+
+/**
+ * Dimensions of a pooling, padding is only needed at the front, top and left
+ * since the output size is given.
+ */
+struct PoolShape {
+  size_t planes;           // Batch times channels
+  size_t depth;            // Input depth
+  size_t height;           // Input height
+  size_t width;            // Input width
+  size_t out_depth;        // Output depth
+  size_t out_height;       // Output height
+  size_t out_width;        // Output width
+  size_t kernel_depth;     // Window depth
+  size_t kernel_height;    // Window height
+  size_t kernel_width;     // Window width
+  size_t stride_depth;     // Depth stride
+  size_t stride_height;    // Vertical stride
+  size_t stride_width;     // Horizontal stride
+  size_t dilation_depth;   // Depth dilation
+  size_t dilation_height;  // Vertical dilation
+  size_t dilation_width;   // Horizontal dilation
+  size_t pad_front;        // Padding planes before the input
+  size_t pad_top;          // Padding rows above the input
+  size_t pad_left;         // Padding columns left of the input
+};
+
+/**
+ * Checks if the window of an output element lies entirely in the padding,
+ * which leaves it without a value.
+ */
+static inline bool mml_pool_has_empty_window(const PoolShape &shape);
+
+/**
+ * Max pools a contiguous [planes, depth, height, width] input into the
+ * contiguous [planes, out_depth, out_height, out_width] output. If indices is
+ * not null, it receives the row-major flat index in the input of the maximum
+ * of every window, the first one on ties.
+ */
+template <TensorConcept::Types T>
+static void mml_max_pool(const PoolShape &shape, const T *input, T *output,
+                         int64_t *indices);
+
+/**
+ * Average pools a contiguous [planes, depth, height, width] input into the
+ * contiguous [planes, out_depth, out_height, out_width] output. The sums are
+ * divided by the size of the window if count_include_pad is set and by the
+ * number of its values inside the input otherwise.
+ */
+template <TensorConcept::Types T>
+static void mml_avg_pool(const PoolShape &shape, bool count_include_pad,
+                         const T *input, T *output);
+
+#include "../operations/pooling.tpp"
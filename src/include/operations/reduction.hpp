@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+// IWYU pragma: no_include <__vector/vector.h>
+#include <vector>  // IWYU pragma: keep
+
+#include "datastructures/tensor_concept.hpp"
+
+/**
+ * Reductions over any set of axes of a contiguous tensor.
+ *
+ * Neighbouring axes that are both reduced or both kept are merged, so every
+ * reduction is a sequence of passes over an [outer, count, inner] view, one
+ * per run of reduced axes. A pass with inner 1 reduces contiguous rows into
+ * several independent accumulators that the compiler keeps in SIMD
+ * registers, the others combine whole rows of inner values at a time. Both
+ * split the outer dimension over the thread pool.
+ */
+
+/**
+ * The reductions, as in the ONNX Reduce operators.
+ */
+enum class ReductionKind {
+  Sum,   // Sum of the values
+  Mean,  // Sum divided by the number of values
+  Max,   // Largest value
+  Min,   // Smallest value
+  L2     // Square root of the sum of the squares
+};
+
+/**
+ * Reduces the axes of a contiguous input of the given shape whose flag in
+ * reduced is set. The output holds the product of the kept axes, in the
+ * order of the input. Reducing no values gives 0 for Sum, Mean and L2, and
+ * the lowest or largest value of T for Max and Min.
+ */
+template <TensorConcept::Types T>
+static void mml_reduce(ReductionKind kind, const std::vector<size_t> &shape,
+                       const std::vector<bool> &reduced, const T *input,
+                       T *output);
+
+#include "../operations/reduction.tpp"
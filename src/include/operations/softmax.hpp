@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+// IWYU pragma: no_include <__vector/vector.h>
+#include <vector>  // IWYU pragma: keep
+
+/**
+ * Softmax and LogSoftmax along one axis of a contiguous tensor.
+ *
+ * The axis splits the tensor into an [outer, count, inner] view whose count
+ * values at a fixed outer and inner index form one row. A contiguous row
+ * (inner 1) is read once: every block of it is shifted by its own maximum and
+ * exponentiated with mml_vexp, and the running maximum and sum are rescaled
+ * whenever a later block has a larger maximum. The normalization then only
+ * touches the output, which is still in cache for all but very long rows.
+ * Strided rows (inner above 1) are processed a tile of inner values at a
+ * time, so the maxima, exponentials and sums are vectorized across the rows.
+ * Independent rows and tiles are split over the thread pool.
+ */
+
+/**
+ * The functions computed along the axis.
+ */
+enum class SoftmaxKind {
+  Softmax,    // exp(x - max) / sum(exp(x - max))
+  LogSoftmax  // x - max - log(sum(exp(x - max)))
+};
+
+/**
+ * Computes the softmax of a contiguous float or double input of the given
+ * shape along axis, writing an output of the same shape. A row whose values
+ * are all -infinity, or that holds +infinity or NaN, gives NaN.
+ */
+template <typename T>
+static void mml_softmax(SoftmaxKind kind, const std::vector<size_t> &shape,
+                        size_t axis, const T *input, T *output);
+
+#include "../operations/softmax.tpp"
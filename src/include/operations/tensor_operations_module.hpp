@@ -23,6 +23,7 @@
 #include "datastructures/tensor_concept.hpp"
 #include "default_operations.hpp"
 #include "operation_function_types.hpp"
+#include "packed_gemm.hpp"
 
 /**
  * A module for performing arithmetic operations on tensor structures. Your
@@ -67,6 +68,66 @@ class TensorOperations {
   template <TensorConcept::Types... Ts>
   static void set_gemm_ptr(toft::gemm_func<Ts>... ptr);
 
+  /**
+   * @brief Restores the default packed GEMM as the gemm std::function.
+   */
+  template <TensorConcept::Types... Ts>
+  static void reset_gemm_ptr();
+
+  /**
+   * @brief Checks if gemm runs the default packed GEMM, the only one able to
+   * use operands packed ahead of time by mml_gemm_prepack_a and
+   * mml_gemm_prepack_b.
+   * @return False once another implementation has been set.
+   */
+  template <TensorConcept::Types T>
+  static bool has_packed_gemm();
+
+  /**
+   * @brief Strided batched general matrix multiplication std::function.
+   * Performs operation C_i := alpha*op( A_i )*op( B_i ) + beta*C_i for every
+   * index i of batch_shape, the matrices of A, B and C starting at the dot
+   * product of i with their batch strides. A batch stride of 0 multiplies the
+   * same matrix along that dimension, for broadcast batch dimensions.
+   * @param TA True if the matrices of A are transposed.
+   * @param TB True if the matrices of B are transposed.
+   * @param M Number of rows in the matrices of A and C.
+   * @param N Number of columns in the matrices of B and C.
+   * @param K Number of columns in the matrices of A and rows in those of B.
+   * @param ALPHA Scalar alpha.
+   * @param A Tensor holding the matrices of A.
+   * @param lda Specifies the first dimension of the matrices of A.
+   * @param a_batch_strides Elements between the matrices of A along every
+   * batch dimension.
+   * @param B Tensor holding the matrices of B.
+   * @param ldb Specifies the first dimension of the matrices of B.
+   * @param b_batch_strides Elements between the matrices of B along every
+   * batch dimension.
+   * @param BETA Scalar beta.
+   * @param C Tensor holding the result matrices.
+   * @param ldc Specifies the first dimension of the matrices of C.
+   * @param c_batch_strides Elements between the matrices of C along every
+   * batch dimension, none of them 0.
+   * @param batch_shape Sizes of the batch dimensions. */
+  template <TensorConcept::Types T>
+  static void gemm_strided_batched(
+      int TA, int TB, int M, int N, int K, T ALPHA,
+      std::shared_ptr<Tensor<T>> A, int lda,
+      const std::vector<size_t>& a_batch_strides,
+      std::shared_ptr<Tensor<T>> B, int ldb,
+      const std::vector<size_t>& b_batch_strides, T BETA,
+      std::shared_ptr<Tensor<T>> C, int ldc,
+      const std::vector<size_t>& c_batch_strides,
+      const std::vector<size_t>& batch_shape);
+
+  /**
+   * @brief Sets the gemm_strided_batched std::function pointer.
+   * @param ptr Function pointer to the gemm_strided_batched implementation.
+   */
+  template <TensorConcept::Types... Ts>
+  static void set_gemm_strided_batched_ptr(
+      toft::gemm_strided_batched_func<Ts>... ptr);
+
   /**
    * @brief General matrix multiplication (GEMM) std::function using the ONNX
    * standard. Performs operation Y := alpha * A * B + beta * C
@@ -254,12 +315,20 @@ class TensorOperations {
 
   // Pointer to the gemm std::function.
   template <TensorConcept::Types T>
-  static inline toft::gemm_func<T> gemm_ptr = mml_gemm_inner_product<T>;
+  static inline toft::gemm_func<T> gemm_ptr = mml_gemm_packed<T>;
+
+  // Whether gemm_ptr is the default packed GEMM.
+  template <TensorConcept::Types T>
+  static inline bool packed_gemm = true;
+
+  // Pointer to the gemm_strided_batched std::function.
+  template <TensorConcept::Types T>
+  static inline toft::gemm_strided_batched_func<T> gemm_strided_batched_ptr =
+      mml_gemm_strided_batched<T>;
 
   // Pointer to the gemm_onnx std::function.
   template <TensorConcept::Types T>
-  static inline toft::gemm_onnx_func<T> gemm_onnx_ptr =
-      mml_onnx_gemm_inner_product<T>;
+  static inline toft::gemm_onnx_func<T> gemm_onnx_ptr = mml_onnx_gemm_packed<T>;
 
   // Pointer to the add std::function.
   template <TensorConcept::Types T>
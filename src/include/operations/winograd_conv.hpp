@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include "datastructures/a_tensor.hpp"
+#include "datastructures/tensor_concept.hpp"
+#include "operations/activation.hpp"
+
+/**
+ * Winograd convolution F(m x m, 3 x 3) for 3x3 kernels with stride and
+ * dilation 1, with output tiles of m = 2 or m = 4.
+ *
+ * The input is cut into overlapping (m + 2) x (m + 2) tiles which are
+ * transformed, then every one of the (m + 2)^2 transform-domain positions is
+ * a [out_channels, channels] x [channels, tiles] GEMM run by TensorOperations
+ * over the tiles of the whole batch. The products are transformed back into
+ * m x m output tiles. The tile transforms work on blocks of
+ * mml_winograd_lanes tiles with the tile innermost, so that their fixed size
+ * loops are vectorized by the compiler.
+ *
+ * F(4x4, 3x3) does 4 times fewer multiplications than a direct convolution
+ * and F(2x2, 3x3) 2.25 times, at the price of a slightly larger rounding
+ * error.
+ */
+
+/**
+ * Dimensions of a Winograd convolution, padding is only needed at the top and
+ * on the left since the output size is given.
+ */
+struct WinogradConvShape {
+  size_t batch;         // Number of images
+  size_t channels;      // Input channels
+  size_t height;        // Input height
+  size_t width;         // Input width
+  size_t out_channels;  // Output channels
+  size_t out_height;    // Output height
+  size_t out_width;     // Output width
+  size_t pad_top;       // Zero rows above the input
+  size_t pad_left;      // Zero columns left of the input
+};
+
+/**
+ * Transforms 3x3 weights of shape [out_channels, channels, 3, 3] into the
+ * [(m + 2)^2, out_channels, channels] weights of mml_winograd_conv. The
+ * transform only depends on the weights, it is meant to be computed once and
+ * reused by every call.
+ */
+template <TensorConcept::Types T>
+static std::shared_ptr<Tensor<T>> mml_winograd_weights(
+    int m, const std::shared_ptr<Tensor<T>> &weights);
+
+/**
+ * Convolves a contiguous [batch, channels, height, width] input with weights
+ * transformed by mml_winograd_weights for the same m, writing the contiguous
+ * [batch, out_channels, out_height, out_width] output. The bias, of
+ * out_channels values or null, and the activation are applied to the output
+ * tiles as they are scattered.
+ */
+template <TensorConcept::Types T>
+static void mml_winograd_conv(int m, const WinogradConvShape &shape,
+                              const T *input,
+                              const std::shared_ptr<Tensor<T>> &weights,
+                              const T *bias, const Activation &activation,
+                              T *output);
+
+#include "../operations/winograd_conv.tpp"
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+// IWYU pragma: no_include <__vector/vector.h>
+#include <vector>  // IWYU pragma: keep
+
+/// @brief Source of the memory of the tensor buffers.
+///
+/// Every block is aligned to Allocator::alignment bytes. The library allocates
+/// through one global allocator, a PoolAllocator unless it is replaced with
+/// set_global.
+class Allocator {
+ public:
+  /// @brief Alignment in bytes of every block, a cache line and the width of
+  /// the widest registers the dispatched kernels use.
+  static constexpr size_t alignment = 64;
+
+  /// @brief Counters of the allocations served by an allocator.
+  struct Stats {
+    size_t hits = 0;    // Allocations served from memory already held
+    size_t misses = 0;  // Allocations that asked the system for memory
+  };
+
+  Allocator() = default;
+  Allocator(const Allocator &) = delete;
+  Allocator &operator=(const Allocator &) = delete;
+  virtual ~Allocator() = default;
+
+  /**
+   * @brief Allocates an aligned block.
+   *
+   * @param bytes The size of the block, may be 0
+   * @return The block, never nullptr
+   * @throws std::bad_alloc If the memory can not be allocated
+   */
+  virtual void *allocate(size_t bytes) = 0;
+
+  /**
+   * @brief Gives a block back to the allocator it was allocated from.
+   *
+   * @param ptr The block
+   * @param bytes The size the block was allocated with
+   */
+  virtual void deallocate(void *ptr, size_t bytes) noexcept = 0;
+
+  /**
+   * @brief Gets the hit and miss counters of the allocator.
+   *
+   * @return The counters since the allocator was created or last reset
+   */
+  Stats get_stats() const;
+
+  /**
+   * @brief Resets the hit and miss counters to zero.
+   */
+  void reset_stats();
+
+  /**
+   * @brief Gets the allocator used by the library.
+   *
+   * @return The global allocator
+   */
+  static std::shared_ptr<Allocator> global();
+
+  /**
+   * @brief Replaces the allocator used by the library.
+   *
+   * Blocks keep the allocator they were allocated from alive, so they are
+   * still given back to it after it was replaced.
+   *
+   * @param allocator The new global allocator
+   */
+  static void set_global(std::shared_ptr<Allocator> allocator);
+
+ protected:
+  void count_hit() { hits.fetch_add(1, std::memory_order_relaxed); }
+  void count_miss() { misses.fetch_add(1, std::memory_order_relaxed); }
+
+  // Aligned allocation from the system, freed with system_deallocate
+  static void *system_allocate(size_t bytes);
+  static void system_deallocate(void *ptr) noexcept;
+
+ private:
+  std::atomic<size_t> hits = 0;
+  std::atomic<size_t> misses = 0;
+};
+
+/// @brief Allocator asking the system for every block, every allocation is a
+/// miss.
+class AlignedAllocator : public Allocator {
+ public:
+  void *allocate(size_t bytes) override;
+  void deallocate(void *ptr, size_t bytes) noexcept override;
+};
+
+/// @brief Allocator recycling freed blocks.
+///
+/// Sizes are rounded up to size classes, four per power of two, and freed
+/// blocks are kept in per-class free lists to serve later allocations of the
+/// same class. Blocks of up to thread_cache_max_bytes are first cached by the
+/// thread freeing them, so repeated allocations of the same shapes rarely
+/// take a lock. The cache shared by the threads holds at most max_cached_bytes,
+/// larger blocks and blocks freed when it is full go back to the system.
+class PoolAllocator : public Allocator {
+ public:
+  /// @brief Default limit of the bytes cached by the shared cache.
+  static constexpr size_t default_max_cached_bytes = size_t(1) << 30;
+
+  /// @brief Largest block cached by the threads themselves.
+  static constexpr size_t thread_cache_max_bytes = size_t(1) << 18;
+
+  /// @brief Blocks of each size class cached by every thread.
+  static constexpr size_t thread_cache_blocks = 8;
+
+  /**
+   * @brief Creates an empty pool.
+   *
+   * @param max_cached_bytes Limit of the bytes held by the shared cache
+   */
+  explicit PoolAllocator(size_t max_cached_bytes = default_max_cached_bytes);
+
+  void *allocate(size_t bytes) override;
+  void deallocate(void *ptr, size_t bytes) noexcept override;
+
+  /**
+   * @brief Frees the blocks cached by the calling thread and by the shared
+   * cache.
+   */
+  void release();
+
+  /**
+   * @brief Gets the size of the blocks held by the shared cache.
+   *
+   * @return The cached bytes, without the blocks cached by the threads
+   */
+  size_t get_cached_bytes() const;
+
+  struct Shared;
+
+ private:
+  std::shared_ptr<Shared> shared;  // Cache shared by the threads
+};
+
+/// @brief Allocator bumping a pointer through large chunks.
+///
+/// Blocks are never given back one by one, reset makes the whole memory
+/// available again once none of the blocks is used anymore. Meant for
+/// short-lived tensors of a bounded computation, e.g. one inference.
+class ArenaAllocator : public Allocator {
+ public:
+  /// @brief Default size of the chunks.
+  static constexpr size_t default_chunk_bytes = size_t(1) << 26;
+
+  /**
+   * @brief Creates an empty arena.
+   *
+   * @param chunk_bytes The size of the chunks, larger blocks get a chunk of
+   * their own
+   */
+  explicit ArenaAllocator(size_t chunk_bytes = default_chunk_bytes);
+
+  /**
+   * @brief Frees the chunks.
+   */
+  ~ArenaAllocator() override;
+
+  void *allocate(size_t bytes) override;
+  void deallocate(void *ptr, size_t bytes) noexcept override;
+
+  /**
+   * @brief Makes all the chunks available again, the blocks allocated so far
+   * must not be used anymore.
+   */
+  void reset();
+
+  /**
+   * @brief Gets the size of the chunks held by the arena.
+   *
+   * @return The reserved bytes
+   */
+  size_t get_reserved_bytes() const;
+
+ private:
+  struct Chunk {
+    std::byte *data;  // Aligned memory of the chunk
+    size_t bytes;     // Size of the chunk
+  };
+
+  mutable std::mutex mutex;   // Guards the fields below
+  std::vector<Chunk> chunks;  // Chunks in the order they are bumped through
+  size_t current = 0;         // Chunk allocations are bumped from
+  size_t used = 0;            // Bytes used in the current chunk
+  size_t chunk_bytes;         // Size of new chunks
+};
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+// IWYU pragma: no_include <__vector/vector.h>
+#include <vector>  // IWYU pragma: keep
+
+/// @brief A fixed size pool of worker threads running submitted tasks in FIFO
+/// order.
+///
+/// The library shares one global pool, used both to run independent nodes of
+/// a model and to split the work of a single kernel with parallel_for.
+class ThreadPool {
+ public:
+  /**
+   * @brief Starts the worker threads.
+   *
+   * @param thread_count The number of worker threads, at least one thread is
+   * always started
+   * @param pin_threads Pins worker i to CPU i modulo the number of CPUs, only
+   * supported on Linux and ignored elsewhere
+   */
+  explicit ThreadPool(size_t thread_count, bool pin_threads = false);
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /**
+   * @brief Stops the pool, the tasks already submitted are run before the
+   * worker threads are joined.
+   */
+  ~ThreadPool();
+
+  /**
+   * @brief Queues a task to be run by one of the worker threads.
+   *
+   * The task must not throw, exceptions have to be handed back to the
+   * submitter by the task itself.
+   *
+   * @param task The task to run
+   */
+  void submit(std::function<void()> task);
+
+  /**
+   * @brief Runs a function over a range of indices, split in chunks run in
+   * parallel.
+   *
+   * The range is cut into contiguous chunks of at least grain indices. The
+   * calling thread works on the chunks together with the worker threads and
+   * never waits on a chunk nobody has started, so parallel_for may be called
+   * from inside a task of the same pool without deadlocking. The first
+   * exception thrown by a chunk is rethrown once every started chunk is done,
+   * the chunks not started yet are skipped.
+   *
+   * @param begin First index of the range
+   * @param end One past the last index of the range
+   * @param grain Minimum number of indices per chunk
+   * @param fn Function called with the bounds [chunk_begin, chunk_end) of each
+   * chunk, possibly concurrently
+   */
+  void parallel_for(size_t begin, size_t end, size_t grain,
+                    const std::function<void(size_t, size_t)> &fn);
+
+  /**
+   * @brief Gets the number of worker threads.
+   *
+   * @return The number of worker threads
+   */
+  size_t get_thread_count() const { return workers.size(); }
+
+  /**
+   * @brief Checks if the worker threads are pinned to CPUs.
+   *
+   * @return True if the workers were pinned
+   */
+  bool is_pinned() const { return pinned; }
+
+  /**
+   * @brief Gets the pool shared by the whole library.
+   *
+   * The pool is created on first use with one thread per hardware thread,
+   * unless configure_global was called before.
+   *
+   * @return The global pool
+   */
+  static std::shared_ptr<ThreadPool> global();
+
+  /**
+   * @brief Replaces the pool shared by the whole library.
+   *
+   * The previous pool is stopped once nobody uses it anymore, so this must not
+   * be called while the library is running work on the global pool.
+   *
+   * @param thread_count The number of worker threads, 0 uses one thread per
+   * hardware thread
+   * @param pin_threads Pins the worker threads to CPUs
+   */
+  static void configure_global(size_t thread_count, bool pin_threads = false);
+
+ private:
+  /**
+   * @brief The loop run by every worker thread
+   */
+  void work();
+
+  std::vector<std::thread> workers;         // The worker threads
+  std::deque<std::function<void()>> tasks;  // Tasks waiting for a worker
+  std::mutex tasks_mutex;                   // Guards tasks and stopping
+  std::condition_variable tasks_cv;         // Signals new tasks or stopping
+  bool stopping = false;                    // Set when the pool is destroyed
+  bool pinned = false;                      // Set if the workers are pinned
+};
+
+/**
+ * @brief Runs a function over a range of indices on the global thread pool.
+ *
+ * @see ThreadPool::parallel_for
+ *
+ * @param begin First index of the range
+ * @param end One past the last index of the range
+ * @param grain Minimum number of indices per chunk
+ * @param fn Function called with the bounds of each chunk
+ */
+void parallel_for(size_t begin, size_t end, size_t grain,
+                  const std::function<void(size_t, size_t)> &fn);
@@ -0,0 +1,130 @@
+#include "../include/model/memory_plan.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+MemoryPlan::TensorUsage MemoryPlan::describe(
+    const GeneralDataTypes &tensor, size_t slot, size_t first_step,
+    const std::vector<size_t> &readers) {
+  return std::visit(
+      [&](const auto &tensor_ptr) -> TensorUsage {
+        using ValueType = typename std::decay_t<
+            decltype(tensor_ptr)>::element_type::value_type;
+
+        array_mml<size_t> shape = tensor_ptr->get_shape();
+        size_t size = tensor_ptr->get_size();
+
+        ViewFactory make_tensor =
+            [shape, size](const std::shared_ptr<std::byte[]> &arena,
+                          std::byte *address) -> GeneralDataTypes {
+          // Share ownership of the arena, but point into it
+          std::shared_ptr<ValueType[]> buffer(
+              arena, reinterpret_cast<ValueType *>(address));
+          return std::make_shared<Tensor_mml<ValueType>>(
+              shape, array_mml<ValueType>(buffer, size));
+        };
+
+        // A tensor nobody reads only lives during its producer
+        std::vector<size_t> last_steps = readers;
+        if (last_steps.empty()) {
+          last_steps.push_back(first_step);
+        }
+
+        return {slot, first_step, std::move(last_steps),
+                size * sizeof(ValueType), std::move(make_tensor)};
+      },
+      tensor);
+}
+
+const void *MemoryPlan::data_address(const GeneralDataTypes &tensor) {
+  return std::visit(
+      [](const auto &tensor_ptr) -> const void * {
+        using ValueType = typename std::decay_t<
+            decltype(tensor_ptr)>::element_type::value_type;
+
+        auto mml_ptr =
+            std::dynamic_pointer_cast<const Tensor_mml<ValueType>>(tensor_ptr);
+        if (!mml_ptr) {
+          return nullptr;
+        }
+        return mml_ptr->get_data().get();
+      },
+      tensor);
+}
+
+MemoryPlan::MemoryPlan(std::vector<TensorUsage> usages,
+                       const HappensBefore &happens_before)
+    : usages(std::move(usages)) {
+  // True if every reader of a finishes before b is produced
+  auto released_before = [&](const TensorUsage &a, const TensorUsage &b) {
+    return std::ranges::all_of(a.last_steps, [&](size_t reader) {
+      return reader != b.first_step && happens_before(reader, b.first_step);
+    });
+  };
+
+  offsets.resize(this->usages.size());
+
+  // Place the largest tensors first, they are the hardest to fit
+  std::vector<size_t> order(this->usages.size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::ranges::stable_sort(order, [&](size_t a, size_t b) {
+    return this->usages[a].bytes > this->usages[b].bytes;
+  });
+
+  std::vector<size_t> placed;
+  for (size_t index : order) {
+    const TensorUsage &usage = this->usages[index];
+    size_t bytes = (usage.bytes + alignment - 1) / alignment * alignment;
+
+    // Collect the placed tensors alive at the same time, sorted by offset
+    std::vector<std::pair<size_t, size_t>> conflicts;
+    for (size_t other : placed) {
+      const TensorUsage &other_usage = this->usages[other];
+      if (!released_before(usage, other_usage) &&
+          !released_before(other_usage, usage)) {
+        size_t other_bytes =
+            (other_usage.bytes + alignment - 1) / alignment * alignment;
+        conflicts.emplace_back(offsets[other], offsets[other] + other_bytes);
+      }
+    }
+    std::ranges::sort(conflicts);
+
+    // First gap large enough to hold the tensor
+    size_t offset = 0;
+    for (const auto &[begin, end] : conflicts) {
+      if (offset + bytes <= begin) {
+        break;
+      }
+      offset = std::max(offset, end);
+    }
+
+    offsets[index] = offset;
+    arena_size = std::max(arena_size, offset + bytes);
+    slot_usage[usage.slot] = index;
+    placed.push_back(index);
+  }
+}
+
+size_t MemoryPlan::get_offset(size_t slot) const {
+  return offsets[slot_usage.at(slot)];
+}
+
+std::shared_ptr<std::byte[]> MemoryPlan::allocate_arena() const {
+  auto allocator = Allocator::global();
+  const size_t bytes = std::max(arena_size, alignment);
+  auto *ptr = static_cast<std::byte *>(allocator->allocate(bytes));
+  return std::shared_ptr<std::byte[]>(ptr, [allocator, bytes](std::byte *ptr) {
+    allocator->deallocate(ptr, bytes);
+  });
+}
+
+GeneralDataTypes MemoryPlan::make_tensor(
+    size_t slot, const std::shared_ptr<std::byte[]> &arena) const {
+  size_t index = slot_usage.at(slot);
+  return usages[index].make_tensor(arena, arena.get() + offsets[index]);
+}
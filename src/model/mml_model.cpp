@@ -1,108 +1,716 @@
 #include "../include/model/mml_model.hpp"
 
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
 #include <iostream>
+#include <mutex>
+#include <optional>
 // IWYU pragma: no_include <__ostream/basic_ostream.h>
 #include <ostream>  // IWYU pragma: keep
 #include <queue>
 #include <stdexcept>
 #include <typeinfo>
+#include <unordered_set>
 #include <variant>
 
+#include "nodes/reorder.hpp"
+#include "operations/nchwc.hpp"
+
 std::unordered_map<std::string, GeneralDataTypes> Model_mml::infer(
     const std::unordered_map<std::string, GeneralDataTypes> &inputs) {
-  std::cout << "==== Starting inference ====" << std::endl;
+  const bool log = verbose;
+  if (log) {
+    std::cout << "==== Starting inference ====" << std::endl;
+  }
 
   if (nodes.empty()) {
     throw std::runtime_error("ComputeGraph has no nodes.");
   }
 
-  // Perform topological sort
+  // Keep the plan alive for the whole call, even if the graph is modified
+  std::shared_ptr<const ExecutionPlan> current_plan = currentPlan();
+  if (log) {
+    std::cout << "Topological layers: " << current_plan->layers.size()
+              << std::endl;
+  }
+
+  // The slots only hold the weights, inputs and intermediate tensors of this
+  // call, the weights are shared with the weight store
+  std::vector<std::optional<GeneralDataTypes>> slots = current_plan->constants;
+  for (const auto &[name, tensor] : inputs) {
+    auto slot_it = current_plan->slot_ids.find(name);
+    if (slot_it == current_plan->slot_ids.end()) {
+      continue;  // Not referenced by the graph
+    }
+    if (log) {
+      std::cout << "Setting input: " << name << std::endl;
+    }
+    slots[slot_it->second] = tensor;
+  }
+
+  // Take an arena of the memory plan for these input shapes, the first call
+  // with new shapes records the intermediate tensors to build the plan instead
+  std::vector<std::vector<size_t>> memory_key =
+      memoryKey(*current_plan, slots);
+  std::shared_ptr<const MemoryPlan> memory;
+  std::shared_ptr<std::byte[]> arena;
+  {
+    std::lock_guard<std::mutex> lock(memory_mutex);
+    auto memory_it = memory_plans.find(memory_key);
+    if (memory_it != memory_plans.end()) {
+      memory = memory_it->second.plan;
+      if (!memory_it->second.free_arenas.empty()) {
+        arena = std::move(memory_it->second.free_arenas.back());
+        memory_it->second.free_arenas.pop_back();
+      }
+    }
+  }
+  if (memory && !arena) {
+    arena = memory->allocate_arena();
+  }
+
+  std::vector<MemoryPlan::TensorUsage> usages;
+  std::vector<bool> unplannable(current_plan->slot_names.size(), false);
+
+  const size_t concurrency = max_concurrency;
+  std::shared_ptr<ThreadPool> current_pool;
+  if (concurrency > 1) {
+    current_pool = ThreadPool::global();
+  }
+
+  // Scheduling state, guarded by state_mutex
+  const size_t step_count = current_plan->steps.size();
+  std::vector<size_t> pending(step_count);
+  for (size_t step_idx = 0; step_idx < step_count; ++step_idx) {
+    pending[step_idx] = current_plan->steps[step_idx].predecessor_count;
+  }
+  std::vector<size_t> readers_left(current_plan->slot_readers.size());
+  for (size_t slot = 0; slot < readers_left.size(); ++slot) {
+    readers_left[slot] = current_plan->slot_readers[slot].size();
+  }
+  // Ready steps are dispatched lowest index first, so a concurrency of one
+  // runs the steps in the order of the plan
+  std::priority_queue<size_t, std::vector<size_t>, std::greater<>> ready;
+  for (size_t step_idx = 0; step_idx < step_count; ++step_idx) {
+    if (pending[step_idx] == 0) {
+      ready.push(step_idx);
+    }
+  }
+  std::mutex state_mutex;
+  std::condition_variable state_cv;
+  // Keeps the lines of concurrent steps apart, the log is never written under
+  // state_mutex
+  std::mutex log_mutex;
+  size_t running = 0;
+  std::exception_ptr error;
+
+  // Runs a step and makes the steps depending on it ready
+  auto run = [&](size_t step_idx) {
+    const auto &step = current_plan->steps[step_idx];
+    if (log) {
+      std::lock_guard<std::mutex> lock(log_mutex);
+      std::cout << "  Processing node " << step_idx
+                << " (type: " << typeid(*step.node).name() << ")" << std::endl;
+    }
+
+    std::exception_ptr step_error;
+    try {
+      runStep(step, slots, memory.get(), arena);
+    } catch (const std::out_of_range &e) {
+      std::string nodeType = typeid(*step.node).name();  // Get node type
+      std::lock_guard<std::mutex> lock(log_mutex);
+      std::cerr << "*** Out of range error in node " << step_idx
+                << " (type: " << nodeType << "): " << e.what() << std::endl;
+
+      // Print node inputs and outputs
+      std::cout << "  Node inputs: ";
+      for (const auto &input : step.input_names) {
+        std::cout << input << " ";
+      }
+      std::cout << std::endl;
+
+      std::cout << "  Node outputs: ";
+      for (const auto &output : step.output_names) {
+        std::cout << output << " ";
+      }
+      std::cout << std::endl;
+
+      step_error = std::current_exception();
+    } catch (const std::exception &e) {
+      std::string nodeType = typeid(*step.node).name();  // Get node type
+      std::lock_guard<std::mutex> lock(log_mutex);
+      std::cerr << "*** Error in node " << step_idx << " (type: " << nodeType
+                << "): " << e.what() << std::endl;
+      step_error = std::current_exception();
+    } catch (...) {
+      step_error = std::current_exception();
+    }
+
+    if (log && !step_error) {
+      std::lock_guard<std::mutex> lock(log_mutex);
+      std::cout << "  Node " << step_idx << " processed successfully"
+                << std::endl;
+    }
+
+    std::lock_guard<std::mutex> lock(state_mutex);
+    if (step_error) {
+      // Keep the first error, later steps are not dispatched anymore
+      if (!error) {
+        error = step_error;
+      }
+    } else if (!error) {
+      if (!memory) {
+        recordStep(*current_plan, step_idx, slots, usages, unplannable);
+      }
+
+      // Release the intermediate tensors that are no longer needed
+      for (size_t slot : step.input_slots) {
+        if (--readers_left[slot] == 0 && !current_plan->keep_alive[slot]) {
+          slots[slot].reset();
+        }
+      }
+      for (size_t slot : step.output_slots) {
+        if (readers_left[slot] == 0 && !current_plan->keep_alive[slot]) {
+          slots[slot].reset();
+        }
+      }
+
+      for (size_t successor : step.successors) {
+        if (--pending[successor] == 0) {
+          ready.push(successor);
+        }
+      }
+    }
+    --running;
+    // Notify while holding the lock, the waiting call owns the state
+    state_cv.notify_all();
+  };
+
+  {
+    std::unique_lock<std::mutex> lock(state_mutex);
+    while (true) {
+      state_cv.wait(lock, [&] {
+        return running == 0 ||
+               (!error && !ready.empty() && running < concurrency);
+      });
+      if (error || ready.empty()) {
+        if (running == 0) {
+          break;  // Done, or failed and every running step has finished
+        }
+        continue;
+      }
+
+      size_t step_idx = ready.top();
+      ready.pop();
+      ++running;
+      if (!current_pool || (ready.empty() && running == 1)) {
+        // Nothing else can run meanwhile, skip the hand-off to the pool
+        lock.unlock();
+        run(step_idx);
+        lock.lock();
+      } else {
+        current_pool->submit([&run, step_idx] { run(step_idx); });
+      }
+    }
+  }
+
+  if (error) {
+    try {
+      std::rethrow_exception(error);
+    } catch (const std::exception &e) {
+      std::cerr << "Exception during inference: " << e.what() << std::endl;
+      throw;
+    }
+  }
+
+  {
+    std::scoped_lock lock(plan_mutex, memory_mutex);
+    if (memory) {
+      // Give the arena back for the next call with the same shapes
+      auto memory_it = memory_plans.find(memory_key);
+      if (memory_it != memory_plans.end() &&
+          memory_it->second.plan == memory) {
+        memory_it->second.free_arenas.push_back(std::move(arena));
+      }
+    } else if (plan == current_plan) {
+      std::erase_if(usages, [&](const MemoryPlan::TensorUsage &usage) {
+        return unplannable[usage.slot];
+      });
+      memory_plans.try_emplace(
+          memory_key, std::make_shared<const MemoryPlan>(
+                          std::move(usages), [&](size_t a, size_t b) {
+                            return current_plan->happensBefore(a, b);
+                          }));
+    }
+  }
+
+  // Get output(s)
+  std::unordered_map<std::string, GeneralDataTypes> returnMap;
+  for (size_t slot : current_plan->output_slots) {
+    if (slots[slot].has_value()) {
+      returnMap[current_plan->slot_names[slot]] = *slots[slot];
+    }
+  }
+
+  return returnMap;
+}
+
+void Model_mml::compile() {
+  std::lock_guard<std::mutex> lock(plan_mutex);
+  buildPlan();
+}
+
+std::shared_ptr<const Model_mml::ExecutionPlan> Model_mml::currentPlan() {
+  std::lock_guard<std::mutex> lock(plan_mutex);
+  if (!plan) {
+    buildPlan();
+  }
+  return plan;
+}
+
+void Model_mml::resetPlan() {
+  std::lock_guard<std::mutex> lock(plan_mutex);
+  plan.reset();
+}
+
+void Model_mml::buildPlan() {
+  // The weights of the plan, with the ones rewritten by the passes
+  WeightStore plan_weights = *weights;
+
   std::vector<std::vector<std::shared_ptr<Node>>> topoLayers =
-      topologicalSort();
-  std::cout << "Topological layers: " << topoLayers.size() << std::endl;
+      topologicalSort(nodes);
+  if (batch_norm_folding) {
+    topoLayers = topologicalSort(foldAffines(topoLayers, plan_weights));
+  }
+  if (activation_fusion) {
+    topoLayers = topologicalSort(fuseActivations(topoLayers));
+  }
+  if (channel_blocking) {
+    topoLayers = topologicalSort(blockChannels(topoLayers, plan_weights));
+  }
+
+  auto new_plan = std::make_shared<ExecutionPlan>();
+
+  // Assign a slot to a tensor name, reusing the slot if it already has one
+  auto slot_of = [&](const std::string &name) -> size_t {
+    auto [it, inserted] =
+        new_plan->slot_ids.emplace(name, new_plan->slot_names.size());
+    if (inserted) {
+      new_plan->slot_names.push_back(name);
+    }
+    return it->second;
+  };
+
+  for (const auto &name : inputs) {
+    new_plan->input_slots.push_back(slot_of(name));
+  }
+
+  for (const auto &layer : topoLayers) {
+    std::vector<size_t> layer_steps;
+    layer_steps.reserve(layer.size());
+    for (const auto &node : layer) {
+      ExecutionPlan::Step step;
+      // The nodes transform their weights once, ahead of every inference, on
+      // a copy, inference calls of the previous plan may still run the node
+      step.node = node->prepared_copy(plan_weights);
+      if (!step.node) {
+        step.node = node;
+      }
+      step.input_names = node->getInputs();
+      step.output_names = node->getOutputs();
+      for (const auto &input : step.input_names) {
+        step.input_slots.push_back(slot_of(input));
+      }
+      for (const auto &output : step.output_names) {
+        step.output_slots.push_back(slot_of(output));
+      }
+      layer_steps.push_back(new_plan->steps.size());
+      new_plan->steps.push_back(std::move(step));
+    }
+    new_plan->layers.push_back(std::move(layer_steps));
+  }
+
+  for (const auto &name : outputs) {
+    new_plan->output_slots.push_back(slot_of(name));
+  }
+
+  // Bind the weights to their slots, unreferenced weights are left out
+  new_plan->constants.resize(new_plan->slot_names.size());
+  for (const auto &[name, tensor] : plan_weights) {
+    auto slot_it = new_plan->slot_ids.find(name);
+    if (slot_it != new_plan->slot_ids.end()) {
+      new_plan->constants[slot_it->second] = tensor;
+    }
+  }
+
+  // Dependencies between the steps
+  std::unordered_map<size_t, size_t> producers;
+  for (size_t step_idx = 0; step_idx < new_plan->steps.size(); ++step_idx) {
+    for (size_t slot : new_plan->steps[step_idx].output_slots) {
+      producers[slot] = step_idx;
+    }
+  }
+  new_plan->slot_readers.resize(new_plan->slot_names.size());
+  for (size_t step_idx = 0; step_idx < new_plan->steps.size(); ++step_idx) {
+    auto &step = new_plan->steps[step_idx];
+    std::vector<size_t> step_producers;
+    for (size_t slot : step.input_slots) {
+      new_plan->slot_readers[slot].push_back(step_idx);
+      auto producer_it = producers.find(slot);
+      if (producer_it != producers.end() && producer_it->second != step_idx) {
+        step_producers.push_back(producer_it->second);
+      }
+    }
+    std::ranges::sort(step_producers);
+    auto duplicates = std::ranges::unique(step_producers);
+    step_producers.erase(duplicates.begin(), duplicates.end());
+    step.predecessor_count = step_producers.size();
+    for (size_t producer : step_producers) {
+      new_plan->steps[producer].successors.push_back(step_idx);
+    }
+  }
 
-  // Create a deep copy of iomap
-  std::unordered_map<std::string, GeneralDataTypes> local_iomap;
-  for (const auto &[name, tensor] : iomap) {
-    std::visit(
-        [&](auto &&arg) {
-          // Deep copy
-          local_iomap[name] = arg->copy();
-        },
-        tensor);
+  // The steps are in topological order, so every successor of a step comes
+  // after it and its reachable set is already complete
+  const size_t step_count = new_plan->steps.size();
+  new_plan->reachable.assign(step_count, std::vector<bool>(step_count, false));
+  for (size_t step_idx = step_count; step_idx-- > 0;) {
+    auto &reachable = new_plan->reachable[step_idx];
+    for (size_t successor : new_plan->steps[step_idx].successors) {
+      reachable[successor] = true;
+      const auto &successor_reachable = new_plan->reachable[successor];
+      for (size_t other = successor + 1; other < step_count; ++other) {
+        if (successor_reachable[other]) {
+          reachable[other] = true;
+        }
+      }
+    }
   }
 
-  // Set input tensors
+  new_plan->keep_alive.assign(new_plan->slot_names.size(), false);
+  for (size_t slot : new_plan->input_slots) {
+    new_plan->keep_alive[slot] = true;
+  }
+  for (size_t slot : new_plan->output_slots) {
+    new_plan->keep_alive[slot] = true;
+  }
+  for (size_t slot = 0; slot < new_plan->constants.size(); ++slot) {
+    if (new_plan->constants[slot].has_value()) {
+      new_plan->keep_alive[slot] = true;
+    }
+  }
+
+  plan = std::move(new_plan);
+
+  // The slots of the memory plans belong to the previous execution plan
+  std::lock_guard<std::mutex> lock(memory_mutex);
+  memory_plans.clear();
+}
+
+std::shared_ptr<const MemoryPlan> Model_mml::getMemoryPlan(
+    const std::unordered_map<std::string, GeneralDataTypes> &inputs) {
+  const ExecutionPlan &current_plan = getPlan();
+
+  std::vector<std::optional<GeneralDataTypes>> slots(
+      current_plan.slot_names.size());
   for (const auto &[name, tensor] : inputs) {
-    std::cout << "Setting input: " << name << std::endl;
-    std::visit(
-        [&](auto &&arg) {
-          // Deep copy
-          local_iomap[name] = arg->copy();
-        },
-        tensor);
-  }
-
-  // Process each layer
-  try {
-    for (size_t layer_idx = 0; layer_idx < topoLayers.size(); ++layer_idx) {
-      const auto &layer = topoLayers[layer_idx];
-      std::cout << "Processing layer " << layer_idx << " with " << layer.size()
-                << " nodes" << std::endl;
-
-      for (size_t node_idx = 0; node_idx < layer.size(); ++node_idx) {
-        const auto &node = layer[node_idx];
-        std::string nodeType = typeid(*node).name();  // Get node type
-        std::cout << "  Processing node " << node_idx << " (type: " << nodeType
-                  << ")" << std::endl;
-
-        try {
-          node->forward(local_iomap);
-          std::cout << "  Node " << node_idx << " processed successfully"
-                    << std::endl;
-        } catch (const std::out_of_range &e) {
-          std::cerr << "*** Out of range error in node " << node_idx
-                    << " (type: " << nodeType << "): " << e.what() << std::endl;
-
-          // Print node inputs and outputs
-          std::cout << "  Node inputs: ";
-          for (const auto &input : node->getInputs()) {
-            std::cout << input << " ";
+    auto slot_it = current_plan.slot_ids.find(name);
+    if (slot_it != current_plan.slot_ids.end()) {
+      slots[slot_it->second] = tensor;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(memory_mutex);
+  auto memory_it = memory_plans.find(memoryKey(current_plan, slots));
+  if (memory_it == memory_plans.end()) {
+    return nullptr;
+  }
+  return memory_it->second.plan;
+}
+
+std::vector<std::vector<size_t>> Model_mml::memoryKey(
+    const ExecutionPlan &plan,
+    const std::vector<std::optional<GeneralDataTypes>> &slots) {
+  std::vector<std::vector<size_t>> key;
+  key.reserve(plan.input_slots.size());
+  for (size_t slot : plan.input_slots) {
+    std::vector<size_t> entry;
+    if (slots[slot].has_value()) {
+      // The type of the tensor followed by its shape
+      entry.push_back(slots[slot]->index());
+      std::visit(
+          [&](const auto &tensor_ptr) {
+            const auto &shape = tensor_ptr->get_shape();
+            entry.insert(entry.end(), shape.begin(), shape.end());
+          },
+          *slots[slot]);
+    }
+    key.push_back(std::move(entry));
+  }
+  return key;
+}
+
+void Model_mml::recordStep(
+    const ExecutionPlan &plan, size_t step_idx,
+    const std::vector<std::optional<GeneralDataTypes>> &slots,
+    std::vector<MemoryPlan::TensorUsage> &usages,
+    std::vector<bool> &unplannable) {
+  const auto &step = plan.steps[step_idx];
+  for (size_t output_slot : step.output_slots) {
+    const auto &output = slots[output_slot];
+    if (!output.has_value()) {
+      continue;
+    }
+
+    const void *address = MemoryPlan::data_address(*output);
+    if (address == nullptr) {
+      unplannable[output_slot] = true;
+      continue;
+    }
+
+    for (size_t input_slot : step.input_slots) {
+      const auto &input = slots[input_slot];
+      if (input.has_value() && MemoryPlan::data_address(*input) == address) {
+        unplannable[output_slot] = true;
+        unplannable[input_slot] = true;
+      }
+    }
+
+    if (!step.node->writes_outputs_in_place()) {
+      // The node would replace the tensor handed to it
+      unplannable[output_slot] = true;
+      continue;
+    }
+
+    if (plan.keep_alive[output_slot]) {
+      continue;  // Model outputs are handed to the caller
+    }
+
+    usages.push_back(MemoryPlan::describe(*output, output_slot, step_idx,
+                                          plan.slot_readers[output_slot]));
+  }
+}
+
+void Model_mml::runStep(const ExecutionPlan::Step &step,
+                        std::vector<std::optional<GeneralDataTypes>> &slots,
+                        const MemoryPlan *memory,
+                        const std::shared_ptr<std::byte[]> &arena) {
+  std::unordered_map<std::string, GeneralDataTypes> node_iomap;
+  for (size_t i = 0; i < step.input_slots.size(); ++i) {
+    const auto &tensor = slots[step.input_slots[i]];
+    if (tensor.has_value()) {
+      node_iomap.emplace(step.input_names[i], *tensor);
+    }
+  }
+
+  // Hand the node its preallocated outputs
+  if (memory != nullptr) {
+    for (size_t i = 0; i < step.output_slots.size(); ++i) {
+      if (memory->is_planned(step.output_slots[i])) {
+        node_iomap.insert_or_assign(
+            step.output_names[i],
+            memory->make_tensor(step.output_slots[i], arena));
+      }
+    }
+  }
+
+  step.node->forward(node_iomap);
+
+  for (size_t i = 0; i < step.output_slots.size(); ++i) {
+    auto it = node_iomap.find(step.output_names[i]);
+    if (it != node_iomap.end()) {
+      slots[step.output_slots[i]] = std::move(it->second);
+    }
+  }
+}
+
+std::vector<std::shared_ptr<Node>> Model_mml::foldAffines(
+    const std::vector<std::vector<std::shared_ptr<Node>>> &layers,
+    WeightStore &plan_weights) const {
+  // Number of nodes reading each tensor, and the transform reading it
+  std::unordered_map<std::string, size_t> readers;
+  std::unordered_map<std::string,
+                     std::pair<std::shared_ptr<Node>, ChannelAffine>>
+      affines;
+  for (const auto &layer : layers) {
+    for (const auto &node : layer) {
+      std::vector<std::string> node_inputs = node->getInputs();
+      for (const auto &input : node_inputs) {
+        ++readers[input];
+      }
+      if (node->getOutputs().size() != 1) {
+        continue;
+      }
+      if (auto affine = node->foldable_affine(plan_weights)) {
+        affines.try_emplace(node_inputs.front(), node, std::move(*affine));
+      }
+    }
+  }
+  std::unordered_set<std::string> model_outputs(outputs.begin(),
+                                                outputs.end());
+
+  std::vector<std::shared_ptr<Node>> graph;
+  // Transforms folded into their producer
+  std::unordered_set<std::shared_ptr<Node>> folded;
+  for (const auto &layer : layers) {
+    for (const auto &node : layer) {
+      if (folded.contains(node)) {
+        continue;
+      }
+
+      std::vector<std::string> node_outputs = node->getOutputs();
+      std::shared_ptr<Node> copy;
+      if (node_outputs.size() == 1) {
+        const std::string &output = node_outputs.front();
+        auto affine_it = affines.find(output);
+        if (affine_it != affines.end() && readers[output] == 1 &&
+            !model_outputs.contains(output)) {
+          const auto &[affine_node, affine] = affine_it->second;
+          copy = node->affine_folded_copy(
+              affine, affine_node->getOutputs().front(), plan_weights);
+          if (copy) {
+            folded.insert(affine_node);
           }
-          std::cout << std::endl;
+        }
+      }
+      graph.push_back(copy ? std::move(copy) : node);
+    }
+  }
+  return graph;
+}
+
+std::vector<std::shared_ptr<Node>> Model_mml::fuseActivations(
+    const std::vector<std::vector<std::shared_ptr<Node>>> &layers) const {
+  // Number of nodes reading each tensor, and the activation reading it
+  std::unordered_map<std::string, size_t> readers;
+  std::unordered_map<std::string, std::shared_ptr<Node>> activations;
+  for (const auto &layer : layers) {
+    for (const auto &node : layer) {
+      std::vector<std::string> node_inputs = node->getInputs();
+      for (const auto &input : node_inputs) {
+        ++readers[input];
+      }
+      if (node_inputs.size() == 1 && node->getOutputs().size() == 1 &&
+          node->fusable_activation()) {
+        activations[node_inputs.front()] = node;
+      }
+    }
+  }
+  std::unordered_set<std::string> model_outputs(outputs.begin(),
+                                                outputs.end());
 
-          std::cout << "  Node outputs: ";
-          for (const auto &output : node->getOutputs()) {
-            std::cout << output << " ";
+  std::vector<std::shared_ptr<Node>> graph;
+  // Activations applied by their producer
+  std::unordered_set<std::shared_ptr<Node>> fused;
+  for (const auto &layer : layers) {
+    for (const auto &node : layer) {
+      if (fused.contains(node)) {
+        continue;
+      }
+
+      std::vector<std::string> node_outputs = node->getOutputs();
+      std::shared_ptr<Node> copy;
+      if (node_outputs.size() == 1) {
+        const std::string &output = node_outputs.front();
+        auto activation_it = activations.find(output);
+        if (activation_it != activations.end() && readers[output] == 1 &&
+            !model_outputs.contains(output)) {
+          const auto &activation = activation_it->second;
+          copy = node->fused_copy(*activation->fusable_activation(),
+                                  activation->getOutputs().front());
+          if (copy) {
+            fused.insert(activation);
           }
-          std::cout << std::endl;
-
-          // Rethrow so the test catches it
-          throw;
-        } catch (const std::exception &e) {
-          std::cerr << "*** Error in node " << node_idx
-                    << " (type: " << nodeType << "): " << e.what() << std::endl;
-          throw;
         }
       }
+      graph.push_back(copy ? std::move(copy) : node);
     }
-  } catch (const std::exception &e) {
-    std::cerr << "Exception during inference: " << e.what() << std::endl;
-    throw;
   }
+  return graph;
+}
 
-  // Get output(s)
-  std::unordered_map<std::string, GeneralDataTypes> returnMap;
-  for (const auto &name : outputs) {
-    if (local_iomap.find(name) != local_iomap.end()) {
-      returnMap[name] = local_iomap[name];
+std::vector<std::shared_ptr<Node>> Model_mml::blockChannels(
+    const std::vector<std::vector<std::shared_ptr<Node>>> &layers,
+    const WeightStore &plan_weights) const {
+  const size_t block = mml_nchwc_block<float>();
+  auto blocked_name = [](const std::string &name) { return name + "#nchwc"; };
+
+  std::vector<std::shared_ptr<Node>> graph;
+  // Tensors produced blocked, under their blocked name
+  std::unordered_set<std::string> blocked;
+  // Tensors available under both names, through a reorder
+  std::unordered_set<std::string> reordered;
+
+  auto to_blocked = [&](const std::string &name) {
+    if (!blocked.contains(name) && reordered.insert(name).second) {
+      graph.push_back(std::make_shared<ReorderNode>(name, blocked_name(name),
+                                                    block, true));
+    }
+  };
+  auto to_plain = [&](const std::string &name) {
+    if (blocked.contains(name) && reordered.insert(name).second) {
+      graph.push_back(std::make_shared<ReorderNode>(blocked_name(name), name,
+                                                    block, false));
+    }
+  };
+
+  for (const auto &layer : layers) {
+    for (const auto &node : layer) {
+      std::vector<std::string> node_inputs = node->getInputs();
+      std::shared_ptr<Node> copy =
+          node->blocked_copy(block, plan_weights, blocked_name);
+
+      // Inputs the copy reads blocked, the others keep their name
+      std::vector<std::string> blocked_inputs;
+      if (copy) {
+        std::vector<std::string> copy_inputs = copy->getInputs();
+        for (size_t i = 0; i < node_inputs.size(); ++i) {
+          if (copy_inputs[i] != node_inputs[i]) {
+            blocked_inputs.push_back(node_inputs[i]);
+          }
+        }
+        bool joins_region =
+            !blocked_inputs.empty() &&
+            std::ranges::all_of(blocked_inputs, [&](const std::string &name) {
+              return blocked.contains(name);
+            });
+        if (blocked_inputs.empty() ||
+            !(joins_region || node->starts_blocked_region())) {
+          copy.reset();
+        }
+      }
+
+      if (copy) {
+        for (const auto &input : blocked_inputs) {
+          to_blocked(input);
+        }
+        std::vector<std::string> copy_outputs = copy->getOutputs();
+        std::vector<std::string> node_outputs = node->getOutputs();
+        for (size_t i = 0; i < node_outputs.size(); ++i) {
+          if (copy_outputs[i] != node_outputs[i]) {
+            blocked.insert(node_outputs[i]);
+          }
+        }
+        graph.push_back(std::move(copy));
+      } else {
+        for (const auto &input : node_inputs) {
+          to_plain(input);
+        }
+        graph.push_back(node);
+      }
     }
   }
 
-  return returnMap;
+  for (const auto &output : outputs) {
+    to_plain(output);
+  }
+  return graph;
 }
 
-std::vector<std::vector<std::shared_ptr<Node>>> Model_mml::topologicalSort() {
+std::vector<std::vector<std::shared_ptr<Node>>> Model_mml::topologicalSort(
+    const std::vector<std::shared_ptr<Node>> &nodes) {
   if (nodes.empty()) {
     throw std::runtime_error("ComputeGraph has no nodes.");
   }
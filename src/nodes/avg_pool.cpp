@@ -9,12 +9,15 @@
 #include <stdexcept>
 #include <type_traits>
 #include <unordered_map>
+// IWYU pragma: no_include <__vector/vector.h>
+#include <vector>  // IWYU pragma: keep
 
 #include "datastructures/mml_array.hpp"
 #include "datastructures/tensor_factory.hpp"
 #include "nlohmann/json.hpp"
 #include "nodes/node_utils.hpp"
-#include "operations/tensor_operations_module.hpp"
+#include "operations/nchwc.hpp"
+#include "operations/pooling.hpp"
 
 AvgPoolNode::AvgPoolNode(const std::string& X, const std::string& Y,
                          const std::vector<int>& kernel_shape,
@@ -31,7 +34,12 @@ AvgPoolNode::AvgPoolNode(const std::string& X, const std::string& Y,
       dilations(dilations),
       kernel_shape(kernel_shape),
       pads(pads),
-      strides(strides) {}
+      strides(strides) {
+  // The defaults are resolved once, forward must not modify the node
+  NodeUtils::compute_pool_attributes(this->auto_pad, this->kernel_shape,
+                                     this->strides, this->pads,
+                                     this->dilations);
+}
 
 AvgPoolNode::AvgPoolNode(const nlohmann::json& node) {
   if (node.contains("input") && node["input"].is_array()) {
@@ -83,6 +91,8 @@ AvgPoolNode::AvgPoolNode(const nlohmann::json& node) {
       }
     }
   }
+  NodeUtils::compute_pool_attributes(auto_pad, kernel_shape, strides, pads,
+                                     dilations);
 }
 
 void AvgPoolNode::forward(
@@ -104,6 +114,15 @@ void AvgPoolNode::forward(
               "AvgPoolNode: Unsupported data type for tensor X");
         } else {
           array_mml<size_t> x_shape = x_ptr->get_shape();
+          if (channel_block != 0) {
+            // Blocked inputs are pooled as their logical NCHW shape
+            if (x_shape.size() != 5 || x_shape[4] != channel_block) {
+              throw std::runtime_error(
+                  "AvgPoolNode: Blocked input tensor must have 5 dimensions");
+            }
+            x_shape = array_mml<size_t>({x_shape[0], x_shape[1] * x_shape[4],
+                                         x_shape[2], x_shape[3]});
+          }
           size_t total_rank = x_shape.size();
 
           if (total_rank < 3) {
@@ -111,9 +130,6 @@ void AvgPoolNode::forward(
                 "AvgPoolNode: Input tensor must be at least NCL");
           }
 
-          NodeUtils::compute_pool_attributes(auto_pad, kernel_shape, strides,
-                                             pads, dilations);
-
           array_mml<size_t> output_shape = NodeUtils::compute_pool_output_shape(
               x_shape, auto_pad, ceil_mode, dilations, kernel_shape, pads,
               strides);
@@ -122,37 +138,59 @@ void AvgPoolNode::forward(
               x_shape, auto_pad, ceil_mode, dilations, kernel_shape, pads,
               strides);
 
-          auto y_ptr = TensorFactory::create_tensor<ValueType>(output_shape);
-
-          // Perform pooling operation
-          TensorOperations::sliding_window<ValueType>(
-              x_shape, output_shape, kernel_shape, strides, dilations, pad_pair,
-              [this, x_ptr, y_ptr](
-                  const std::vector<std::vector<size_t>>& window_in_idx,
-                  const std::vector<size_t>& out_idx) -> void {
-                if (window_in_idx.empty()) {
-                  throw std::runtime_error("AvgPoolNode: Empty window values");
-                }
-
-                ValueType sum = 0;
-                for (const auto& in_idx : window_in_idx) {
-                  array_mml<size_t> curr_idx(in_idx);
-                  sum += (*x_ptr)[curr_idx];
-                }
-
-                int kernel_volume = 1;
-                for (auto k : kernel_shape) {
-                  kernel_volume *= k;
-                }
-
-                int denominator = count_include_pad
-                                      ? kernel_volume
-                                      : static_cast<int>(window_in_idx.size());
-
-                array_mml<size_t> out_idx_array(out_idx);
-                (*y_ptr)[out_idx_array] =
-                    sum / static_cast<ValueType>(denominator);
-              });
+          // Blocked outputs keep the layout of their input
+          array_mml<size_t> y_shape =
+              channel_block != 0
+                  ? array_mml<size_t>({output_shape[0],
+                                       output_shape[1] / channel_block,
+                                       output_shape[2], output_shape[3],
+                                       channel_block})
+                  : output_shape;
+
+          // An output of the right shape, like one planned in the arena, is
+          // written in place
+          auto y_ptr = NodeUtils::reusable_output<ValueType>(iomap, Y, y_shape);
+          auto input = x_ptr->is_contiguous() ? x_ptr : x_ptr->contiguous();
+          std::vector<ValueType> x_values;
+          std::vector<ValueType> y_values;
+
+          // A window entirely in the padding has no value in either layout
+          PoolShape shape = NodeUtils::compute_pool_shape(
+              x_shape, output_shape, kernel_shape, strides, dilations,
+              pad_pair);
+          if (mml_pool_has_empty_window(shape)) {
+            throw std::runtime_error("AvgPoolNode: Empty window values");
+          }
+
+          if (channel_block != 0) {
+            NchwcPoolShape blocked_shape{
+                x_shape[0],
+                x_shape[1],
+                x_shape[2],
+                x_shape[3],
+                output_shape[2],
+                output_shape[3],
+                static_cast<size_t>(kernel_shape[0]),
+                static_cast<size_t>(kernel_shape[1]),
+                static_cast<size_t>(strides[0]),
+                static_cast<size_t>(strides[1]),
+                static_cast<size_t>(dilations[0]),
+                static_cast<size_t>(dilations[1]),
+                static_cast<size_t>(pad_pair[0].first),
+                static_cast<size_t>(pad_pair[1].first)};
+            mml_nchwc_avg_pool<ValueType>(
+                channel_block, blocked_shape, count_include_pad != 0,
+                NodeUtils::kernel_input(input, x_values),
+                NodeUtils::kernel_output(y_ptr, y_values));
+            NodeUtils::write_kernel_output(y_values, y_ptr);
+            iomap[Y] = y_ptr;
+            return;
+          }
+
+          mml_avg_pool<ValueType>(shape, count_include_pad != 0,
+                                  NodeUtils::kernel_input(input, x_values),
+                                  NodeUtils::kernel_output(y_ptr, y_values));
+          NodeUtils::write_kernel_output(y_values, y_ptr);
 
           iomap[Y] = y_ptr;
         }
@@ -162,4 +200,18 @@ void AvgPoolNode::forward(
 
 std::vector<std::string> AvgPoolNode::getInputs() { return {X}; }
 
-std::vector<std::string> AvgPoolNode::getOutputs() { return {Y}; }
\ No newline at end of file
+std::vector<std::string> AvgPoolNode::getOutputs() { return {Y}; }
+
+std::shared_ptr<Node> AvgPoolNode::blocked_copy(
+    size_t block,
+    const std::unordered_map<std::string, GeneralDataTypes>& /*weights*/,
+    const std::function<std::string(const std::string&)>& blocked_name) {
+  if (kernel_shape.size() != 2) {
+    return nullptr;
+  }
+  auto copy = std::make_shared<AvgPoolNode>(*this);
+  copy->X = blocked_name(X);
+  copy->Y = blocked_name(Y);
+  copy->channel_block = block;
+  return copy;
+}
@@ -0,0 +1,209 @@
+#include "nodes/batch_norm.hpp"
+
+#include <stddef.h>
+
+#include <array>
+// IWYU pragma: no_include <__math/roots.h>
+#include <cmath>  // IWYU pragma: keep
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+// IWYU pragma: no_include <__vector/vector.h>
+#include <vector>  // IWYU pragma: keep
+
+#include "nlohmann/json.hpp"
+#include "nodes/node_utils.hpp"
+#include "operations/channel_affine.hpp"
+
+namespace {
+
+// Gets a contiguous parameter of the node, nullptr if it is missing, of
+// another type or not of the given size
+template <typename ValueType>
+std::shared_ptr<Tensor<ValueType>> find_parameter(
+    const std::unordered_map<std::string, GeneralDataTypes> &tensors,
+    const std::string &name, size_t channels) {
+  auto it = tensors.find(name);
+  if (it == tensors.end()) {
+    return nullptr;
+  }
+  auto typed = std::get_if<std::shared_ptr<Tensor<ValueType>>>(&it->second);
+  if (!typed || (*typed)->get_size() != channels) {
+    return nullptr;
+  }
+  return (*typed)->is_contiguous() ? *typed : (*typed)->contiguous();
+}
+
+}  // namespace
+
+BatchNormalizationNode::BatchNormalizationNode(
+    const std::string &X, const std::string &scale, const std::string &B,
+    const std::string &mean, const std::string &var, const std::string &Y,
+    float epsilon)
+    : X(X),
+      scale(scale),
+      B(B),
+      mean(mean),
+      var(var),
+      Y(Y),
+      epsilon(epsilon) {}
+
+BatchNormalizationNode::BatchNormalizationNode(const nlohmann::json &node) {
+  if (node.contains("input") && node["input"].is_array()) {
+    X = node["input"][0];
+    scale = node["input"][1];
+    B = node["input"][2];
+    mean = node["input"][3];
+    var = node["input"][4];
+  }
+
+  if (node.contains("output") && node["output"].is_array()) {
+    Y = node["output"][0];
+  }
+
+  epsilon = 1e-5f;
+  if (node.contains("attribute") && node["attribute"].is_array()) {
+    for (const auto &attr : node["attribute"]) {
+      if (attr["name"] == "epsilon") {
+        epsilon = attr["f"];
+      } else if (attr["name"] == "training_mode" &&
+                 std::stoi(attr["i"].get<std::string>()) != 0) {
+        throw std::runtime_error(
+            "BatchNormalizationNode: Training mode is not supported.");
+      }
+    }
+  }
+}
+
+void BatchNormalizationNode::forward(
+    std::unordered_map<std::string, GeneralDataTypes> &iomap) {
+  auto x_it = iomap.find(X);
+  if (x_it == iomap.end()) {
+    throw std::runtime_error(
+        "BatchNormalizationNode: Input tensor X not found in iomap");
+  }
+
+  std::visit(
+      [&](const auto &x_ptr) {
+        using ValueType =
+            typename std::decay_t<decltype(x_ptr)>::element_type::value_type;
+
+        if constexpr (!is_in_variant_v<ValueType, T>) {
+          throw std::runtime_error(
+              "BatchNormalizationNode: Unsupported data type for tensor X");
+        } else {
+          const auto &x_shape = x_ptr->get_shape();
+          if (x_shape.size() < 2) {
+            throw std::runtime_error(
+                "BatchNormalizationNode: Input must have at least 2 "
+                "dimensions.");
+          }
+          const size_t batch = x_shape[0];
+          const size_t channels = x_shape[1];
+          const size_t planes = batch * channels;
+          const size_t spatial = planes == 0 ? 0 : x_ptr->get_size() / planes;
+
+          std::vector<std::shared_ptr<Tensor<ValueType>>> parameters;
+          for (const auto *name : {&scale, &B, &mean, &var}) {
+            auto parameter = find_parameter<ValueType>(iomap, *name, channels);
+            if (!parameter) {
+              throw std::runtime_error(
+                  "BatchNormalizationNode: Parameter " + *name +
+                  " must be a tensor of " + std::to_string(channels) +
+                  " values of the type of X.");
+            }
+            parameters.push_back(parameter);
+          }
+
+          // The normalization reduces to a scale and a shift per channel
+          std::array<std::vector<ValueType>, 4> values;
+          const ValueType *gamma =
+              NodeUtils::kernel_input(parameters[0], values[0]);
+          const ValueType *beta =
+              NodeUtils::kernel_input(parameters[1], values[1]);
+          const ValueType *mu =
+              NodeUtils::kernel_input(parameters[2], values[2]);
+          const ValueType *sigma2 =
+              NodeUtils::kernel_input(parameters[3], values[3]);
+          std::vector<ValueType> channel_scale(channels);
+          std::vector<ValueType> channel_shift(channels);
+          const ValueType eps = static_cast<ValueType>(epsilon);
+          for (size_t c = 0; c < channels; c++) {
+            channel_scale[c] = gamma[c] / std::sqrt(sigma2[c] + eps);
+            channel_shift[c] = beta[c] - mu[c] * channel_scale[c];
+          }
+
+          // An output of the right shape, like one planned in the arena, is
+          // written in place
+          auto y_ptr = NodeUtils::reusable_output<ValueType>(iomap, Y, x_shape);
+          iomap[Y] = y_ptr;
+
+          auto input = x_ptr->is_contiguous() ? x_ptr : x_ptr->contiguous();
+          std::vector<ValueType> x_values;
+          std::vector<ValueType> y_values;
+          mml_channel_affine<ValueType>(
+              batch, channels, spatial,
+              NodeUtils::kernel_input(input, x_values), channel_scale.data(),
+              channel_shift.data(),
+              NodeUtils::kernel_output(y_ptr, y_values));
+          NodeUtils::write_kernel_output(y_values, y_ptr);
+        }
+      },
+      x_it->second);
+}
+
+std::vector<std::string> BatchNormalizationNode::getInputs() {
+  return {X, scale, B, mean, var};
+}
+
+std::vector<std::string> BatchNormalizationNode::getOutputs() { return {Y}; }
+
+std::optional<ChannelAffine> BatchNormalizationNode::foldable_affine(
+    const std::unordered_map<std::string, GeneralDataTypes> &weights) const {
+  auto scale_it = weights.find(scale);
+  if (scale_it == weights.end()) {
+    return std::nullopt;
+  }
+
+  return std::visit(
+      [&](const auto &scale_ptr) -> std::optional<ChannelAffine> {
+        using ValueType = typename std::decay_t<
+            decltype(scale_ptr)>::element_type::value_type;
+
+        if constexpr (!is_in_variant_v<ValueType, T>) {
+          return std::nullopt;
+        } else {
+          const size_t channels = scale_ptr->get_size();
+          std::vector<std::shared_ptr<Tensor<ValueType>>> parameters;
+          for (const auto *name : {&scale, &B, &mean, &var}) {
+            auto parameter =
+                find_parameter<ValueType>(weights, *name, channels);
+            if (!parameter) {
+              return std::nullopt;
+            }
+            parameters.push_back(parameter);
+          }
+
+          std::array<std::vector<ValueType>, 4> values;
+          const ValueType *gamma =
+              NodeUtils::kernel_input(parameters[0], values[0]);
+          const ValueType *beta =
+              NodeUtils::kernel_input(parameters[1], values[1]);
+          const ValueType *mu =
+              NodeUtils::kernel_input(parameters[2], values[2]);
+          const ValueType *sigma2 =
+              NodeUtils::kernel_input(parameters[3], values[3]);
+          ChannelAffine affine;
+          affine.scale.resize(channels);
+          affine.shift.resize(channels);
+          const double eps = epsilon;
+          for (size_t c = 0; c < channels; c++) {
+            affine.scale[c] = gamma[c] / std::sqrt(sigma2[c] + eps);
+            affine.shift[c] = beta[c] - mu[c] * affine.scale[c];
+          }
+          return affine;
+        }
+      },
+      scale_it->second);
+}
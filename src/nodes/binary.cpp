@@ -0,0 +1,126 @@
+#include "nodes/binary.hpp"
+
+#include <stddef.h>
+
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+// IWYU pragma: no_include <__vector/vector.h>
+#include <vector>  // IWYU pragma: keep
+
+#include "datastructures/mml_array.hpp"
+#include "datastructures/tensor_factory.hpp"
+#include "nlohmann/json.hpp"
+#include "nodes/node_utils.hpp"
+#include "operations/binary.hpp"
+#include "operations/elementwise.hpp"
+
+BinaryNode::BinaryNode(BinaryKind kind, const std::vector<std::string> &inputs,
+                       const std::string &output)
+    : kind(kind), inputs(inputs), output(output) {
+  const bool variadic = kind == BinaryKind::Min || kind == BinaryKind::Max;
+  if (variadic ? inputs.empty() : inputs.size() != 2) {
+    throw std::invalid_argument("BinaryNode: Wrong number of inputs");
+  }
+}
+
+BinaryNode::BinaryNode(const nlohmann::json &node) {
+  const std::string op_type = node["opType"];
+  if (op_type == "Add") {
+    kind = BinaryKind::Add;
+  } else if (op_type == "Sub") {
+    kind = BinaryKind::Sub;
+  } else if (op_type == "Mul") {
+    kind = BinaryKind::Mul;
+  } else if (op_type == "Div") {
+    kind = BinaryKind::Div;
+  } else if (op_type == "Pow") {
+    kind = BinaryKind::Pow;
+  } else if (op_type == "Min") {
+    kind = BinaryKind::Min;
+  } else if (op_type == "Max") {
+    kind = BinaryKind::Max;
+  } else {
+    throw std::runtime_error("BinaryNode: Unsupported operation " + op_type);
+  }
+
+  if (node.contains("input") && node["input"].is_array()) {
+    for (const auto &input : node["input"]) {
+      inputs.push_back(input);
+    }
+  }
+
+  if (node.contains("output") && node["output"].is_array()) {
+    output = node["output"][0];
+  }
+}
+
+void BinaryNode::forward(
+    std::unordered_map<std::string, GeneralDataTypes> &iomap) {
+  std::vector<GeneralDataTypes> tensors;
+  for (const auto &input : inputs) {
+    auto it = iomap.find(input);
+    if (it == iomap.end()) {
+      throw std::runtime_error("BinaryNode: Input tensor " + input +
+                               " not found in iomap");
+    }
+    tensors.push_back(it->second);
+  }
+  if (tensors.empty()) {
+    throw std::runtime_error("BinaryNode: No input tensors");
+  }
+
+  std::visit(
+      [&](const auto &first_ptr) {
+        using ValueType = typename std::decay_t<
+            decltype(first_ptr)>::element_type::value_type;
+        using TensorPtr = std::shared_ptr<Tensor<ValueType>>;
+
+        if constexpr (!is_in_variant_v<ValueType, T>) {
+          throw std::runtime_error(
+              "BinaryNode: Unsupported data type for the input tensors");
+        } else {
+          std::vector<TensorPtr> operands;
+          array_mml<size_t> shape = first_ptr->get_shape();
+          for (const auto &tensor : tensors) {
+            auto operand = std::get_if<TensorPtr>(&tensor);
+            if (!operand) {
+              throw std::runtime_error(
+                  "BinaryNode: The input tensors must have the same type");
+            }
+            try {
+              shape = mml_broadcast_shape(shape, (*operand)->get_shape());
+            } catch (const std::invalid_argument &) {
+              throw std::runtime_error(
+                  "BinaryNode: Incompatible shapes, broadcasting impossible.");
+            }
+            operands.push_back(*operand);
+          }
+
+          // An output of the right shape, like one planned in the arena, is
+          // written in place
+          auto result =
+              NodeUtils::reusable_output<ValueType>(iomap, output, shape);
+
+          if (operands.size() == 1) {
+            // Min or Max of a single input is a copy of it
+            mml_map<ValueType>(
+                operands[0], [](ValueType x) { return x; }, result);
+          } else {
+            mml_binary<ValueType>(kind, operands[0], operands[1], result);
+            // Further inputs of Min and Max are combined into the result, which
+            // already has the shape of all the inputs broadcast together
+            for (size_t i = 2; i < operands.size(); i++) {
+              mml_binary<ValueType>(kind, result, operands[i], result);
+            }
+          }
+          iomap[output] = result;
+        }
+      },
+      tensors[0]);
+}
+
+std::vector<std::string> BinaryNode::getInputs() { return inputs; }
+
+std::vector<std::string> BinaryNode::getOutputs() { return {output}; }
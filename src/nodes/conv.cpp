@@ -1,6 +1,9 @@
 #include "nodes/conv.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
 #include <map>
 #include <memory>
 #include <stdexcept>
@@ -11,6 +14,22 @@
 #include <vector>  // IWYU pragma: keep
 
 #include "nlohmann/json.hpp"
+#include "nodes/node_utils.hpp"
+#include "operations/cpu_dispatch.hpp"
+#include "operations/depthwise_conv.hpp"
+#include "operations/nchwc.hpp"
+#include "operations/winograd_conv.hpp"
+#include "utility/thread_pool.hpp"
+
+namespace {
+
+// Minimum number of column matrix elements im2col writes per parallel chunk
+constexpr size_t im2col_grain = 16384;
+
+// Whether eligible convolutions run the Winograd path
+std::atomic<bool> winograd_enabled = true;
+
+}  // namespace
 
 ConvNode::ConvNode(const std::string &X, const std::string &W,
                    const std::string &Y, const array_mml<size_t> &dilations,
@@ -25,7 +44,8 @@ ConvNode::ConvNode(const std::string &X, const std::string &W,
       dilations(dilations),
       padding(padding),
       kernel_shape(kernel_shape),
-      stride(stride) {
+      stride(stride),
+      group(group) {
   if (dilations.size() != 2) {
     throw std::invalid_argument(
         "Invalid dilations size. Expected a std::vector of size 2, but got: " +
@@ -134,13 +154,34 @@ void ConvNode::forward(
                 "(Features x Channels x Height x Width).");
           }
 
+          // infer the dimensions first, blocked inputs have the dimensions of
+          // their logical NCHW shape
+          array_mml<size_t> x_shape = x_ptr->get_shape();
+          if (channel_block != 0) {
+            if (x_shape.size() != 5 || x_shape[4] != channel_block) {
+              throw std::runtime_error(
+                  "ConvNode: Blocked input tensor must have 5 dimensions.");
+            }
+            x_shape = array_mml<size_t>({x_shape[0], x_shape[1] * x_shape[4],
+                                         x_shape[2], x_shape[3]});
+          }
+          const ConvDims dims = conv_dims(x_shape, w_ptr->get_shape());
+
+          const size_t batch = dims.batch_size;
+          array_mml<size_t> y_shape(
+              {batch, dims.out_channels, dims.out_height, dims.out_width});
+          if (channel_block != 0) {
+            y_shape = array_mml<size_t>(
+                {batch, dims.out_channels / channel_block, dims.out_height,
+                 dims.out_width, channel_block});
+          }
+
           auto y_it = iomap.find(Y);
           if (y_it == iomap.end()) {
-            // Create output tensor if it doesn't exist
-            auto y_ptr = x_ptr->copy();
-            // No need to fill with zeros as the convolution std::function will
-            // overwrite the values
-            iomap[Y] = y_ptr;
+            // Create the output tensor if it doesn't exist, the convolution
+            // overwrites all of its values
+            iomap[Y] = std::static_pointer_cast<Tensor<ValueTypeX>>(
+                std::make_shared<Tensor_mml<ValueTypeX>>(y_shape));
             y_it = iomap.find(Y);
           } else if (!std::holds_alternative<
                          std::shared_ptr<Tensor<ValueTypeX>>>(y_it->second)) {
@@ -151,58 +192,112 @@ void ConvNode::forward(
           auto y_ptr =
               std::get<std::shared_ptr<Tensor<ValueTypeX>>>(y_it->second);
 
-          // infer and update attributes first
-          update_parameters(x_ptr->get_shape(), w_ptr->get_shape());
-
-          // Create a std::copy of the input
-          auto input_copy = x_ptr->copy();
-
-          auto im2col_output_shape = array_mml<size_t>(
-              {get_in_channels() * get_kernel_height() * get_kernel_width(),
-               get_batch_size() * get_out_height() * get_out_width()});
-
-          auto im2col_output =
-              std::make_shared<Tensor_mml<ValueTypeX>>(im2col_output_shape);
-
-          im2col(input_copy, im2col_output);
-
-          // Flatten the weight tensor to prepare for GEMM
-          size_t flattened_size =
-              get_in_channels() * get_kernel_height() * get_kernel_width();
-          w_ptr->reshape({get_out_channels(), flattened_size});
-
-          // Prepare the result tensor
-          array_mml<size_t> result_shape(
-              {w_ptr->get_shape()[0], im2col_output->get_shape()[1]});
-          auto result_ptr =
-              std::make_shared<Tensor_mml<ValueTypeX>>(result_shape);
-
-          TensorOperations::gemm<ValueTypeX>(
-              0, 0, w_ptr->get_shape()[0], im2col_output->get_shape()[1],
-              w_ptr->get_shape()[1], 1.0f, w_ptr, w_ptr->get_shape()[1],
-              im2col_output, im2col_output->get_shape()[1], 0.0f, result_ptr,
-              result_ptr->get_shape()[1]);
-
-          result_ptr->reshape({get_batch_size(), get_out_channels(),
-                               get_out_height(), get_out_width()});
+          // The result is written straight into Y when it already has the
+          // right shape and layout
+          std::shared_ptr<Tensor<ValueTypeX>> result_ptr = y_ptr;
+          if (y_ptr->get_shape() != y_shape || !y_ptr->raw_access()) {
+            result_ptr = std::make_shared<Tensor_mml<ValueTypeX>>(y_shape);
+          }
 
-          // Provided a bias, add it to the result tensor across each output
-          // feature
+          std::shared_ptr<Tensor<ValueTypeX>> b_ptr;
           if (B.has_value()) {
             auto b_it = iomap.find(B.value());
             if (b_it == iomap.end()) {
               throw std::runtime_error(
                   "ConvNode: Input tensor B not found in iomap");
             }
-            auto b_ptr =
-                std::get<std::shared_ptr<Tensor<ValueTypeX>>>(b_it->second);
+            b_ptr = std::get<std::shared_ptr<Tensor<ValueTypeX>>>(b_it->second);
+            if (!b_ptr->is_contiguous()) {
+              b_ptr = b_ptr->contiguous();
+            }
+          }
 
-            add_bias(result_ptr, b_ptr);
+          // Every path adds the bias and applies the fused activation to the
+          // values it has just written
+          std::vector<ValueTypeX> b_values;
+          const ValueTypeX *bias =
+              b_ptr ? NodeUtils::kernel_input(b_ptr, b_values) : nullptr;
+
+          // Only strided views of the input are copied
+          auto input_ptr =
+              x_ptr->is_contiguous() ? x_ptr : x_ptr->contiguous();
+          std::vector<ValueTypeX> x_values;
+          std::vector<ValueTypeX> w_values;
+          std::vector<ValueTypeX> y_values;
+
+          if (channel_block != 0) {
+            auto weights = nchwc_weights(w_ptr);
+            NchwcConvShape shape{batch,
+                                 dims.in_channels,
+                                 dims.in_height,
+                                 dims.in_width,
+                                 dims.out_channels,
+                                 dims.out_height,
+                                 dims.out_width,
+                                 dims.kernel_height,
+                                 dims.kernel_width,
+                                 get_stride_height(),
+                                 get_stride_width(),
+                                 get_dilation_height(),
+                                 get_dilation_width(),
+                                 get_padding_top(),
+                                 get_padding_left()};
+            mml_nchwc_conv<ValueTypeX>(
+                channel_block, shape,
+                NodeUtils::kernel_input(input_ptr, x_values),
+                NodeUtils::kernel_input(weights, w_values), bias, activation,
+                NodeUtils::kernel_output(result_ptr, y_values));
+          } else if (use_depthwise(dims)) {
+            auto weights_ptr =
+                w_ptr->is_contiguous() ? w_ptr : w_ptr->contiguous();
+            DepthwiseConvShape shape{batch,
+                                     dims.in_channels,
+                                     dims.in_height,
+                                     dims.in_width,
+                                     dims.out_channels / dims.in_channels,
+                                     dims.out_height,
+                                     dims.out_width,
+                                     dims.kernel_height,
+                                     dims.kernel_width,
+                                     get_stride_height(),
+                                     get_stride_width(),
+                                     get_dilation_height(),
+                                     get_dilation_width(),
+                                     get_padding_top(),
+                                     get_padding_left()};
+            mml_depthwise_conv<ValueTypeX>(
+                shape, NodeUtils::kernel_input(input_ptr, x_values),
+                NodeUtils::kernel_input(weights_ptr, w_values), bias,
+                activation, NodeUtils::kernel_output(result_ptr, y_values));
+          } else if (use_pointwise(dims)) {
+            pointwise_gemm(dims, input_ptr, w_ptr, result_ptr, bias);
+          } else if (use_winograd(dims)) {
+            const int tile = winograd_tile(dims);
+            auto weights = transformed_winograd_weights(w_ptr, tile);
+
+            WinogradConvShape shape{batch,
+                                    dims.in_channels,
+                                    dims.in_height,
+                                    dims.in_width,
+                                    dims.out_channels,
+                                    dims.out_height,
+                                    dims.out_width,
+                                    get_padding_top(),
+                                    get_padding_left()};
+            mml_winograd_conv<ValueTypeX>(
+                tile, shape, NodeUtils::kernel_input(input_ptr, x_values),
+                weights, bias, activation,
+                NodeUtils::kernel_output(result_ptr, y_values));
+          } else {
+            im2col_gemm(dims, input_ptr, w_ptr, result_ptr, bias);
           }
+          NodeUtils::write_kernel_output(y_values, result_ptr);
 
           // Write over the content of the output with the result of the
           // convolution
-          *y_ptr = *result_ptr;
+          if (result_ptr != y_ptr) {
+            *y_ptr = *result_ptr;
+          }
         }
       },
       x_tensor, w_tensor);
@@ -218,110 +313,451 @@ std::vector<std::string> ConvNode::getInputs() {
 
 std::vector<std::string> ConvNode::getOutputs() { return {Y}; }
 
-void ConvNode::im2col(const TensorT &input_variant,
-                      const TensorT &output_variant) {
+void ConvNode::prepare(
+    const std::unordered_map<std::string, GeneralDataTypes> &weights) {
+  auto w_it = weights.find(W);
+  if (w_it == weights.end()) {
+    return;  // Computed by the graph
+  }
+
   std::visit(
-      [this](auto &input, auto &output) {
-        // Iterate over each image in the batch
-        for (size_t n = 0; n < get_batch_size(); ++n) {
-          for (size_t h = 0; h < get_out_height(); ++h) {
-            for (size_t w = 0; w < get_out_width();
-                 ++w) {  // Traverse into each batch
-
-              size_t col_index =
-                  h * get_out_width() + w;  // Column index in im2col matrix
-
-              for (size_t c = 0; c < get_in_channels();
-                   ++c) {  // If the input has multiple channels, iterate over
-                           // each one
-
-                // Here we loop over the kernel's height and width, simulating
-                // how the kernel moves across the input tensor. For each
-                // position of the kernel, the corresponding input values are
-                // extracted and stored in the output tensor. If the kernel
-                // extends beyond the boundaries of the input (due to padding or
-                // stride), zero padding is added instead of the input values.
-                for (size_t kh = 0; kh < get_kernel_height(); ++kh) {
-                  for (size_t kw = 0; kw < get_kernel_width(); ++kw) {
-                    size_t input_h =
-                        h * get_stride_height() - get_padding_top() + kh;
-                    size_t input_w =
-                        w * get_stride_width() - get_padding_left() + kw;
-
-                    if (input_h < 0 ||
-                        input_h >= get_in_height() + get_padding_bottom() ||
-                        input_w < 0 ||
-                        input_w >= get_in_width() + get_padding_right()) {
-                      (*output)[col_index] = 0;  // Padding
-                    } else {
-                      size_t row_index =
-                          c * get_kernel_height() * get_kernel_width() +
-                          kh * get_kernel_width() + kw;
-
-                      size_t output_index =
-                          row_index * (get_out_height() * get_out_width()) +
-                          col_index;
-
-                      size_t input_index =
-                          n * (get_in_channels() * get_in_height() *
-                               get_in_width()) +
-                          c * (get_in_height() * get_in_width()) +
-                          input_h * get_in_width() + input_w;
-
-                      // Check if input index is valid
-                      if (input_index >= 0 &&
-                          input_index < get_in_channels() * get_in_height() *
-                                            get_in_width()) {
-                        (*output)[output_index] = (*input)[input_index];
-                      }
-                    }
-                  }
-                }
-              }
-            }
+      [this](const auto &w_ptr) {
+        using ValueType =
+            typename std::decay_t<decltype(w_ptr)>::element_type::value_type;
+
+        if constexpr (is_in_variant_v<ValueType, T>) {
+          // Invalid weights are reported by forward
+          const auto &shape = w_ptr->get_shape();
+          if (shape.size() != 4 || group == 0 || shape[0] % group != 0) {
+            return;
+          }
+
+          // The dimensions choosing the path only depend on the weights
+          ConvDims dims;
+          dims.kernel_height = shape[2];
+          dims.kernel_width = shape[3];
+          dims.out_channels = shape[0];
+          if (channel_block != 0) {
+            blocked_weights = nchwc_weights(w_ptr);
+            blocked_source = w_ptr;
+            return;
+          }
+          if (group > 1 && shape[1] == 1) {
+            return;  // Depthwise, the weights are read as they are
+          }
+
+          if (use_winograd(dims)) {
+            // The tile forward picks depends on the output size, which is
+            // not known yet
+            std::array<TensorT, 2> transformed = {
+                transformed_winograd_weights(w_ptr, 2),
+                transformed_winograd_weights(w_ptr, 4)};
+            winograd_weights = transformed;
+            winograd_source = w_ptr;
+          } else {
+            packed_weights = packed_gemm_weights(w_ptr);
+            packed_source = w_ptr;
           }
         }
       },
-      input_variant, output_variant);
+      w_it->second);
 }
 
-void ConvNode::add_bias(const TensorT &result_variant,
-                        const TensorT &bias_variant) {
-  std::visit(
-      [this](auto &result, auto &bias) {
-        for (size_t b = 0; b < get_batch_size(); b++) {
-          for (size_t i = 0; i < get_out_channels(); ++i) {
-            for (size_t h = 0; h < get_out_height(); ++h) {
-              for (size_t w = 0; w < get_out_width(); ++w) {
-                size_t index =
-                    ((b * get_out_channels() + i) * get_out_height() + h) *
-                        get_out_width() +
-                    w;
-
-                // Each value in bias std::vector is added to one entire out
-                // feature at a time
-                (*result)[index] += (*bias)[i];
-              }
+std::shared_ptr<Node> ConvNode::prepared_copy(
+    const std::unordered_map<std::string, GeneralDataTypes> &weights) {
+  auto copy = std::make_shared<ConvNode>(*this);
+  copy->prepare(weights);
+  return copy;
+}
+
+template <typename ValueType>
+void ConvNode::pointwise_gemm(const ConvDims &dims,
+                              const std::shared_ptr<Tensor<ValueType>> &input,
+                              const std::shared_ptr<Tensor<ValueType>> &weights,
+                              const std::shared_ptr<Tensor<ValueType>> &result,
+                              const ValueType *bias) const {
+  const size_t batch = dims.batch_size;
+  const size_t group_channels = dims.in_channels / group;
+  const size_t spatial = dims.out_height * dims.out_width;
+
+  // The input of an image already is the [group_channels, spatial] column
+  // matrix of each group
+  auto group_inputs =
+      input->reshape_view({batch, group, group_channels, spatial});
+
+  group_gemm(dims, weights, group_inputs, result, bias);
+}
+
+template <typename ValueType>
+void ConvNode::im2col_gemm(const ConvDims &dims,
+                           const std::shared_ptr<Tensor<ValueType>> &input,
+                           const std::shared_ptr<Tensor<ValueType>> &weights,
+                           const std::shared_ptr<Tensor<ValueType>> &result,
+                           const ValueType *bias) const {
+  const size_t batch = dims.batch_size;
+  const size_t group_channels = dims.in_channels / group;
+  const size_t flattened_size =
+      group_channels * dims.kernel_height * dims.kernel_width;
+  const size_t spatial = dims.out_height * dims.out_width;
+
+  // The column matrices of the whole batch, [batch, group, flattened_size,
+  // spatial], in the scratch area of the calling thread. The rows of the
+  // channels of a group are consecutive
+  auto columns =
+      im2col_scratch<ValueType>({batch, group, flattened_size, spatial});
+  std::vector<ValueType> input_values;
+  im2col(dims, NodeUtils::kernel_input(input, input_values), columns->data());
+
+  group_gemm(dims, weights, columns, result, bias);
+}
+
+template <typename ValueType>
+void ConvNode::group_gemm(const ConvDims &dims,
+                          const std::shared_ptr<Tensor<ValueType>> &weights,
+                          const std::shared_ptr<Tensor<ValueType>> &columns,
+                          const std::shared_ptr<Tensor<ValueType>> &result,
+                          const ValueType *bias) const {
+  const size_t batch = dims.batch_size;
+  const size_t group_out_channels = dims.out_channels / group;
+  const size_t flattened_size = columns->get_shape()[2];
+  const size_t spatial = columns->get_shape()[3];
+
+  // One GEMM per image and group, [group_out_channels, flattened_size]
+  // weights times its [flattened_size, spatial] columns. The weight tensor is
+  // shared between inference calls and is therefore never reshaped in place
+  auto packed = packed_gemm_weights(weights);
+  auto group_weights =
+      weights->reshape_view({group, group_out_channels, flattened_size});
+  auto group_results =
+      result->reshape_view({batch, group, group_out_channels, spatial});
+  for (size_t n = 0; n < batch; ++n) {
+    for (size_t g = 0; g < group; ++g) {
+      // The bias and activation of the output channels of the group, applied
+      // by the packed GEMM to each tile as it is finished
+      GemmEpilogue<ValueType> epilogue{
+          bias ? bias + g * group_out_channels : nullptr, activation};
+      auto group_result = group_results->slice({n, g});
+      if (packed) {
+        mml_gemm_prepacked_a<ValueType>(*(*packed)[g], 0, spatial, 1,
+                                        columns->slice({n, g}), spatial, 0,
+                                        group_result, spatial, &epilogue);
+      } else {
+        TensorOperations::gemm<ValueType>(
+            0, 0, group_out_channels, spatial, flattened_size, 1,
+            group_weights->slice({g}), flattened_size, columns->slice({n, g}),
+            spatial, 0, group_result, spatial);
+        std::vector<ValueType> values;
+        mml_gemm_apply_epilogue(
+            epilogue, static_cast<int>(group_out_channels),
+            static_cast<int>(spatial),
+            NodeUtils::kernel_output(group_result, values),
+            static_cast<int>(spatial));
+        NodeUtils::write_kernel_output(values, group_result);
+      }
+    }
+  }
+}
+
+template <typename ValueType>
+std::shared_ptr<const ConvNode::PackedWeights<ValueType>>
+ConvNode::packed_gemm_weights(
+    const std::shared_ptr<Tensor<ValueType>> &weights) const {
+  if (!TensorOperations::has_packed_gemm<ValueType>()) {
+    return nullptr;
+  }
+
+  auto packed =
+      std::static_pointer_cast<const PackedWeights<ValueType>>(packed_weights);
+  if (packed && packed_source == weights &&
+      (packed->empty() ||
+       packed->front()->tier == mml_gemm_tier<ValueType>())) {
+    return packed;
+  }
+
+  const auto &shape = weights->get_shape();
+  const size_t group_out_channels = shape[0] / group;
+  const size_t flattened_size = shape[1] * shape[2] * shape[3];
+  auto group_weights =
+      weights->reshape_view({group, group_out_channels, flattened_size});
+  auto new_packed = std::make_shared<PackedWeights<ValueType>>();
+  for (size_t g = 0; g < group; ++g) {
+    new_packed->push_back(mml_gemm_prepack_a<ValueType>(
+        0, group_out_channels, flattened_size, group_weights->slice({g}),
+        flattened_size));
+  }
+  return new_packed;
+}
+
+template <typename ValueType>
+std::shared_ptr<Tensor<ValueType>> ConvNode::transformed_winograd_weights(
+    const std::shared_ptr<Tensor<ValueType>> &weights, int tile) const {
+  if (winograd_source == weights) {
+    const TensorT &cached = winograd_weights[tile == 4 ? 1 : 0];
+    auto transformed =
+        std::get_if<std::shared_ptr<Tensor<ValueType>>>(&cached);
+    if (transformed && *transformed) {
+      return *transformed;
+    }
+  }
+
+  return mml_winograd_weights<ValueType>(tile, weights);
+}
+
+template <typename ValueType>
+std::shared_ptr<Tensor<ValueType>> ConvNode::nchwc_weights(
+    const std::shared_ptr<Tensor<ValueType>> &weights) const {
+  auto reordered = std::get_if<std::shared_ptr<Tensor<ValueType>>>(
+      &blocked_weights);
+  if (reordered && *reordered && blocked_source == weights) {
+    return *reordered;
+  }
+
+  const auto &shape = weights->get_shape();
+  if (shape[0] % channel_block != 0 || shape[1] % channel_block != 0) {
+    throw std::runtime_error(
+        "ConvNode: Channels must be a multiple of the block " +
+        std::to_string(channel_block) + ".");
+  }
+  return mml_nchwc_conv_weights<ValueType>(channel_block, weights);
+}
+
+std::shared_ptr<Node> ConvNode::blocked_copy(
+    size_t block,
+    const std::unordered_map<std::string, GeneralDataTypes> &weights,
+    const std::function<std::string(const std::string &)> &blocked_name) {
+  // The blocked kernel is only run on float, where it pays off
+  auto w_it = weights.find(W);
+  if (w_it == weights.end() || group != 1 ||
+      !std::holds_alternative<std::shared_ptr<Tensor<float>>>(w_it->second)) {
+    return nullptr;
+  }
+  const auto &shape =
+      std::get<std::shared_ptr<Tensor<float>>>(w_it->second)->get_shape();
+  if (shape.size() != 4 || shape[0] % block != 0 || shape[1] % block != 0) {
+    return nullptr;
+  }
+
+  auto copy = std::make_shared<ConvNode>(*this);
+  copy->X = blocked_name(X);
+  copy->Y = blocked_name(Y);
+  copy->channel_block = block;
+  return copy;
+}
+
+bool ConvNode::starts_blocked_region() const { return true; }
+
+std::shared_ptr<Node> ConvNode::fused_copy(const Activation &activation,
+                                           const std::string &output) {
+  if (!this->activation.is_identity()) {
+    return nullptr;
+  }
+
+  auto copy = std::make_shared<ConvNode>(*this);
+  copy->Y = output;
+  copy->activation = activation;
+  return copy;
+}
+
+std::shared_ptr<Node> ConvNode::affine_folded_copy(
+    const ChannelAffine &affine, const std::string &output,
+    std::unordered_map<std::string, GeneralDataTypes> &weights) {
+  auto w_it = weights.find(W);
+  if (w_it == weights.end() || !activation.is_identity()) {
+    return nullptr;
+  }
+  const GeneralDataTypes *bias = nullptr;
+  if (B.has_value()) {
+    auto b_it = weights.find(B.value());
+    if (b_it == weights.end()) {
+      return nullptr;
+    }
+    bias = &b_it->second;
+  }
+
+  return std::visit(
+      [&](const auto &w_ptr) -> std::shared_ptr<Node> {
+        using ValueType =
+            typename std::decay_t<decltype(w_ptr)>::element_type::value_type;
+
+        if constexpr (!std::is_floating_point_v<ValueType>) {
+          return nullptr;
+        } else {
+          const auto &shape = w_ptr->get_shape();
+          const size_t channels = affine.scale.size();
+          if (shape.size() != 4 || shape[0] != channels) {
+            return nullptr;
+          }
+          std::shared_ptr<Tensor<ValueType>> b_ptr;
+          if (bias) {
+            auto typed = std::get_if<std::shared_ptr<Tensor<ValueType>>>(bias);
+            if (!typed || (*typed)->get_size() != channels) {
+              return nullptr;
             }
+            b_ptr = (*typed)->is_contiguous() ? *typed : (*typed)->contiguous();
           }
+
+          // Output channel m of the copy is the one of the node times
+          // scale[m], plus shift[m]
+          auto w_values = w_ptr->is_contiguous() ? w_ptr : w_ptr->contiguous();
+          auto folded_w = TensorFactory::create_tensor<ValueType>(shape);
+          auto folded_b = TensorFactory::create_tensor<ValueType>({channels});
+          const ValueType *w_data = w_values->span().data();
+          ValueType *fw = folded_w->data();
+          ValueType *fb = folded_b->data();
+          const size_t channel_size = w_ptr->get_size() / channels;
+          for (size_t m = 0; m < channels; ++m) {
+            const double s = affine.scale[m];
+            for (size_t i = m * channel_size; i < (m + 1) * channel_size; ++i) {
+              fw[i] = static_cast<ValueType>(w_data[i] * s);
+            }
+            const double b = b_ptr ? b_ptr->span()[m] : ValueType(0);
+            fb[m] = static_cast<ValueType>(b * s + affine.shift[m]);
+          }
+
+          auto copy = std::make_shared<ConvNode>(*this);
+          copy->W = output + "#W";
+          copy->B = output + "#B";
+          copy->Y = output;
+          weights[copy->W] = folded_w;
+          weights[copy->B.value()] = folded_b;
+          return copy;
         }
       },
-      result_variant, bias_variant);
+      w_it->second);
+}
+
+bool ConvNode::use_pointwise(const ConvDims &dims) const {
+  return dims.kernel_height == 1 && dims.kernel_width == 1 &&
+         get_stride_height() == 1 && get_stride_width() == 1 &&
+         get_padding_top() == 0 && get_padding_bottom() == 0 &&
+         get_padding_left() == 0 && get_padding_right() == 0;
+}
+
+bool ConvNode::use_depthwise(const ConvDims &dims) const {
+  return group > 1 && group == dims.in_channels;
+}
+
+bool ConvNode::use_winograd(const ConvDims &dims) const {
+  return winograd_enabled.load(std::memory_order_relaxed) && group == 1 &&
+         dims.kernel_height == 3 && dims.kernel_width == 3 &&
+         get_stride_height() == 1 && get_stride_width() == 1 &&
+         get_dilation_height() == 1 && get_dilation_width() == 1;
+}
+
+int ConvNode::winograd_tile(const ConvDims &dims) {
+  // Larger tiles waste less work but only pay off on large enough outputs
+  return dims.out_height >= 8 && dims.out_width >= 8 ? 4 : 2;
 }
 
-size_t ConvNode::get_batch_size() const { return batch_size; }
+void ConvNode::set_winograd_enabled(bool enabled) {
+  winograd_enabled.store(enabled, std::memory_order_relaxed);
+}
 
-size_t ConvNode::get_in_channels() const { return in_channels; }
+bool ConvNode::is_winograd_enabled() {
+  return winograd_enabled.load(std::memory_order_relaxed);
+}
 
-size_t ConvNode::get_in_height() const { return in_height; }
+template <typename ValueType>
+std::shared_ptr<Tensor<ValueType>> ConvNode::im2col_scratch(
+    const array_mml<size_t> &shape) {
+  // Grows to the largest column matrix the thread has needed so far, up to
+  // the limit, so pool workers do not pin the largest batch for good
+  thread_local array_mml<ValueType> scratch;
+  size_t size = 1;
+  for (size_t dim : shape) {
+    size *= dim;
+  }
+  if (size * sizeof(ValueType) > im2col_scratch_max_bytes) {
+    return std::make_shared<Tensor_mml<ValueType>>(shape,
+                                                   array_mml<ValueType>(size));
+  }
+  if (scratch.size() < size) {
+    scratch = array_mml<ValueType>(size);
+  }
+  return std::make_shared<Tensor_mml<ValueType>>(shape, scratch.share(size));
+}
 
-size_t ConvNode::get_in_width() const { return in_width; }
+template <typename ValueType>
+void ConvNode::im2col(const ConvDims &dims, const ValueType *input,
+                      ValueType *columns) const {
+  const size_t in_height = dims.in_height;
+  const size_t in_width = dims.in_width;
+  const size_t kernel_height = dims.kernel_height;
+  const size_t kernel_width = dims.kernel_width;
+  const size_t out_height = dims.out_height;
+  const size_t out_width = dims.out_width;
+  const size_t stride_height = get_stride_height();
+  const size_t stride_width = get_stride_width();
+  const size_t rows = dims.in_channels * kernel_height * kernel_width;
+  const size_t spatial = out_height * out_width;
+
+  // One task per row of the column matrix of each image, a row holds the
+  // input values one kernel element is multiplied with at every output pixel
+  const size_t tasks = dims.batch_size * rows;
+  const size_t grain =
+      std::max<size_t>(1, im2col_grain / std::max<size_t>(spatial, 1));
+  // The strided rows are gathered by code built for the current SIMD tier
+  auto chunk = [&](size_t begin, size_t end) {
+    for (size_t task = begin; task < end; ++task) {
+      const size_t image_channel = task / (kernel_height * kernel_width);
+      const size_t kh = task / kernel_width % kernel_height;
+      const size_t kw = task % kernel_width;
+      const ValueType *plane = input + image_channel * in_height * in_width;
+      ValueType *row = columns + task * spatial;
+
+      // Input column of output column ow is ow * stride_width + w_offset, the
+      // output columns [ow_begin, ow_end) read inside the input
+      const ptrdiff_t w_offset =
+          static_cast<ptrdiff_t>(kw * get_dilation_width()) -
+          static_cast<ptrdiff_t>(get_padding_left());
+      const ptrdiff_t sw = static_cast<ptrdiff_t>(stride_width);
+      size_t ow_begin =
+          w_offset >= 0 ? 0 : static_cast<size_t>((-w_offset + sw - 1) / sw);
+      size_t ow_end =
+          static_cast<ptrdiff_t>(in_width) <= w_offset
+              ? 0
+              : static_cast<size_t>(
+                    (static_cast<ptrdiff_t>(in_width) - 1 - w_offset) / sw + 1);
+      ow_begin = std::min(ow_begin, out_width);
+      ow_end = std::clamp(ow_end, ow_begin, out_width);
+
+      for (size_t oh = 0; oh < out_height; ++oh) {
+        ValueType *out = row + oh * out_width;
+        const ptrdiff_t ih =
+            static_cast<ptrdiff_t>(oh * stride_height +
+                                   kh * get_dilation_height()) -
+            static_cast<ptrdiff_t>(get_padding_top());
+        if (ih < 0 || ih >= static_cast<ptrdiff_t>(in_height)) {
+          std::memset(out, 0, out_width * sizeof(ValueType));  // Padding row
+          continue;
+        }
 
-size_t ConvNode::get_kernel_height() const { return kernel_height; }
+        const ValueType *in = plane + ih * in_width;
+        std::memset(out, 0, ow_begin * sizeof(ValueType));
+        if (stride_width == 1) {
+          std::memcpy(out + ow_begin, in + (ow_begin + w_offset),
+                      (ow_end - ow_begin) * sizeof(ValueType));
+        } else {
+          for (size_t ow = ow_begin; ow < ow_end; ++ow) {
+            out[ow] = in[static_cast<ptrdiff_t>(ow) * sw + w_offset];
+          }
+        }
+        std::memset(out + ow_end, 0, (out_width - ow_end) * sizeof(ValueType));
+      }
+    }
+  };
+  parallel_for(0, tasks, grain, [&](size_t begin, size_t end) {
+    mml_dispatch_tier(chunk, begin, end);
+  });
+}
 
-size_t ConvNode::get_kernel_width() const { return kernel_width; }
+size_t ConvNode::get_dilation_height() const {
+  return dilations.size() == 2 ? dilations[0] : 1;
+}
 
-size_t ConvNode::get_out_channels() const { return out_channels; }
+size_t ConvNode::get_dilation_width() const {
+  return dilations.size() == 2 ? dilations[1] : 1;
+}
 
 size_t ConvNode::get_stride_height() const { return stride[0]; }
 
@@ -335,28 +771,41 @@ size_t ConvNode::get_padding_left() const { return padding[2]; }
 
 size_t ConvNode::get_padding_right() const { return padding[3]; }
 
-size_t ConvNode::get_out_height() {
-  return (get_in_height() + get_padding_top() + get_padding_bottom() -
-          get_kernel_height()) /
-             get_stride_height() +
-         1;
-}
-
-size_t ConvNode::get_out_width() {
-  return (get_in_width() + get_padding_left() + get_padding_right() -
-          get_kernel_width()) /
-             get_stride_width() +
-         1;
-}
-
-void ConvNode::update_parameters(const array_mml<size_t> &input_shape,
-                                 const array_mml<size_t> &weight_shape) {
-  kernel_height = weight_shape[2];
-  kernel_width = weight_shape[3];
-  batch_size = input_shape[0];
-  in_channels = input_shape[1];
+ConvNode::ConvDims ConvNode::conv_dims(
+    const array_mml<size_t> &input_shape,
+    const array_mml<size_t> &weight_shape) const {
+  if (input_shape.size() != 4 || weight_shape.size() != 4) {
+    throw std::runtime_error(
+        "ConvNode: Input and weight tensors must have 4 dimensions.");
+  }
+  if (group == 0 || input_shape[1] % group != 0 ||
+      weight_shape[0] % group != 0 ||
+      weight_shape[1] * group != input_shape[1]) {
+    throw std::runtime_error(
+        "ConvNode: Channels do not match group " + std::to_string(group) +
+        ", input channels: " + std::to_string(input_shape[1]) +
+        ", weight shape: [" + std::to_string(weight_shape[0]) + ", " +
+        std::to_string(weight_shape[1]) + ", ...].");
+  }
 
-  in_height = input_shape[2];
-  in_width = input_shape[3];
-  out_channels = weight_shape[0];
+  ConvDims dims;
+  dims.kernel_height = weight_shape[2];
+  dims.kernel_width = weight_shape[3];
+  dims.batch_size = input_shape[0];
+  dims.in_channels = input_shape[1];
+
+  dims.in_height = input_shape[2];
+  dims.in_width = input_shape[3];
+  dims.out_channels = weight_shape[0];
+
+  dims.out_height = (dims.in_height + get_padding_top() +
+                     get_padding_bottom() -
+                     get_dilation_height() * (dims.kernel_height - 1) - 1) /
+                        get_stride_height() +
+                    1;
+  dims.out_width = (dims.in_width + get_padding_left() + get_padding_right() -
+                    get_dilation_width() * (dims.kernel_width - 1) - 1) /
+                       get_stride_width() +
+                   1;
+  return dims;
 }
\ No newline at end of file
@@ -52,51 +52,24 @@ void FlattenNode::forward(
           throw std::runtime_error(
               "FlattenNode: Unsupported data type for tensor X");
         } else {
-          auto y_it = iomap.find(Y);
-          if (y_it == iomap.end()) {
-            // Create output tensor if it doesn't exist
-            auto y_ptr = x_ptr->copy();
-            // No need to fill with zeros as the flatten std::function will
-            // overwrite the values
-            iomap[Y] = y_ptr;
-            y_it = iomap.find(Y);
-          } else if (!std::holds_alternative<
-                         std::shared_ptr<Tensor<ValueType>>>(y_it->second)) {
-            throw std::runtime_error(
-                "FlattenNode: Output tensor Y has incorrect type");
-          }
-
-          auto y_ptr =
-              std::get<std::shared_ptr<Tensor<ValueType>>>(y_it->second);
-
-          auto input_copy = x_ptr->copy();
-
-          if (axis >= input_copy->get_shape().size()) {
+          const auto &x_shape = x_ptr->get_shape();
+          if (static_cast<size_t>(axis) > x_shape.size()) {
             throw std::invalid_argument("Flatten axis is out of range");
           }
 
-          size_t height_2d, width_2d;
-
-          if (get_axis() == 0) {
-            // This gives a warning, but when get_size() returns int in the
-            // future it will disappear
-            input_copy->reshape({input_copy->get_size()});
-          } else {
-            height_2d = 1;
-            width_2d = 1;
-
-            int i = 0;
-            for (i; i < axis; i++) {
-              height_2d *= input_copy->get_shape()[i];
-            }
-            for (i; i < input_copy->get_shape().size(); i++) {
-              width_2d *= input_copy->get_shape()[i];
+          // Dimensions before the axis make the rows, the others the columns
+          size_t height_2d = 1;
+          size_t width_2d = 1;
+          for (size_t i = 0; i < x_shape.size(); i++) {
+            if (i < static_cast<size_t>(axis)) {
+              height_2d *= x_shape[i];
+            } else {
+              width_2d *= x_shape[i];
             }
           }
 
-          input_copy->reshape({height_2d, width_2d});
-
-          *y_ptr = *input_copy;
+          // The output is a view of the input when it is contiguous
+          iomap[Y] = x_ptr->reshape_view({height_2d, width_2d});
         }
       },
       x_tensor);
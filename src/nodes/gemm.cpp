@@ -13,7 +13,10 @@
 #include <vector>  // IWYU pragma: keep
 
 #include "datastructures/mml_array.hpp"
+#include "datastructures/tensor_factory.hpp"
 #include "nlohmann/json.hpp"
+#include "nodes/node_utils.hpp"
+#include "operations/elementwise.hpp"
 
 GemmNode::GemmNode(const std::string &A, const std::string &B,
                    const std::string &Y, const std::optional<std::string> &C,
@@ -91,14 +94,9 @@ void GemmNode::forward(
                 "GemmNode: Input tensors must be 2D matrices");
           }
 
-          auto new_a_ptr = a_ptr->copy();
-          auto new_b_ptr = b_ptr->copy();
-          if (transA == 1) {
-            new_a_ptr = a_ptr->transpose();
-          }
-          if (transB == 1) {
-            new_b_ptr = b_ptr->transpose();
-          }
+          // Transposes are views, read in place by the GEMM
+          auto new_a_ptr = transA == 1 ? a_ptr->transpose() : a_ptr;
+          auto new_b_ptr = transB == 1 ? b_ptr->transpose() : b_ptr;
 
           array_mml<size_t> a_shape = new_a_ptr->get_shape();
           array_mml<size_t> b_shape = new_b_ptr->get_shape();
@@ -113,20 +111,23 @@ void GemmNode::forward(
                 "GemmNode: Inner dimensions of A and B must match");
           }
 
-          std::shared_ptr<Tensor<ValueTypeA>> new_c_ptr;
+          // An output of the right shape, like one planned in the arena, is
+          // written in place
+          auto new_c_ptr =
+              NodeUtils::reusable_output<ValueTypeA>(iomap, Y, {M, N});
+
           if (C.has_value()) {
             auto c_it = iomap.find(C.value());
             if (c_it == iomap.end()) {
               throw std::runtime_error(
                   "GemmNode: Output tensor C not found in iomap");
             }
-            auto raw_c_ptr =
+            // The output starts as a copy of C broadcast to M x N
+            mml_map<ValueTypeA>(
                 std::get<std::shared_ptr<Tensor<ValueTypeA>>>(c_it->second)
-                    ->copy();
-            new_c_ptr = raw_c_ptr->broadcast_reshape({M, N});
+                    ->broadcast_reshape({M, N}),
+                [](ValueTypeA x) { return x; }, new_c_ptr);
           } else {
-            new_c_ptr = std::make_shared<Tensor_mml<ValueTypeA>>(
-                array_mml<size_t>{M, N});
             new_c_ptr->fill(static_cast<ValueTypeA>(0));
           }
 
@@ -134,9 +135,21 @@ void GemmNode::forward(
           size_t ldb = N;
           size_t ldc = N;
 
-          TensorOperations::gemm<ValueTypeA>(
-              0, 0, M, N, K_a, static_cast<ValueTypeA>(alpha), new_a_ptr, lda,
-              new_b_ptr, ldb, static_cast<ValueTypeA>(beta), new_c_ptr, ldc);
+          // A constant B is read from the panels packed by prepare
+          auto packed = std::static_pointer_cast<
+              const PackedGemmOperand<ValueTypeA>>(packed_b);
+          if (packed && packed_source == b_ptr &&
+              TensorOperations::has_packed_gemm<ValueTypeA>() &&
+              packed->tier == mml_gemm_tier<ValueTypeA>()) {
+            mml_gemm_prepacked_b<ValueTypeA>(
+                0, M, static_cast<ValueTypeA>(alpha), new_a_ptr, lda, *packed,
+                static_cast<ValueTypeA>(beta), new_c_ptr, ldc);
+          } else {
+            TensorOperations::gemm<ValueTypeA>(
+                0, 0, M, N, K_a, static_cast<ValueTypeA>(alpha), new_a_ptr,
+                lda, new_b_ptr, ldb, static_cast<ValueTypeA>(beta), new_c_ptr,
+                ldc);
+          }
 
           iomap[Y] = new_c_ptr;
         }
@@ -152,4 +165,132 @@ std::vector<std::string> GemmNode::getInputs() {
   }
 }
 
-std::vector<std::string> GemmNode::getOutputs() { return {Y}; }
\ No newline at end of file
+std::vector<std::string> GemmNode::getOutputs() { return {Y}; }
+
+void GemmNode::prepare(
+    const std::unordered_map<std::string, GeneralDataTypes> &weights) {
+  auto b_it = weights.find(B);
+  if (b_it == weights.end()) {
+    return;  // Computed by the graph
+  }
+
+  std::visit(
+      [this](const auto &b_ptr) {
+        using ValueType =
+            typename std::decay_t<decltype(b_ptr)>::element_type::value_type;
+
+        if constexpr (is_in_variant_v<ValueType, T>) {
+          // Invalid operands are reported by forward
+          if (!b_ptr->is_matrix() ||
+              !TensorOperations::has_packed_gemm<ValueType>()) {
+            return;
+          }
+
+          auto packed = std::static_pointer_cast<
+              const PackedGemmOperand<ValueType>>(packed_b);
+          if (packed && packed_source == b_ptr &&
+              packed->tier == mml_gemm_tier<ValueType>()) {
+            return;  // Already packed
+          }
+
+          const auto &shape = b_ptr->get_shape();
+          const int rows = static_cast<int>(transB ? shape[1] : shape[0]);
+          const int cols = static_cast<int>(transB ? shape[0] : shape[1]);
+          packed_b = mml_gemm_prepack_b<ValueType>(
+              transB ? 1 : 0, rows, cols, b_ptr, static_cast<int>(shape[1]));
+          packed_source = b_ptr;
+        }
+      },
+      b_it->second);
+}
+
+std::shared_ptr<Node> GemmNode::prepared_copy(
+    const std::unordered_map<std::string, GeneralDataTypes> &weights) {
+  auto copy = std::make_shared<GemmNode>(*this);
+  copy->prepare(weights);
+  return copy;
+}
+
+std::shared_ptr<Node> GemmNode::affine_folded_copy(
+    const ChannelAffine &affine, const std::string &output,
+    std::unordered_map<std::string, GeneralDataTypes> &weights) {
+  auto b_it = weights.find(B);
+  if (b_it == weights.end()) {
+    return nullptr;
+  }
+  const GeneralDataTypes *c_tensor = nullptr;
+  if (C.has_value()) {
+    auto c_it = weights.find(C.value());
+    if (c_it == weights.end()) {
+      return nullptr;
+    }
+    c_tensor = &c_it->second;
+  }
+
+  return std::visit(
+      [&](const auto &b_ptr) -> std::shared_ptr<Node> {
+        using ValueType =
+            typename std::decay_t<decltype(b_ptr)>::element_type::value_type;
+
+        if constexpr (!std::is_floating_point_v<ValueType>) {
+          return nullptr;
+        } else {
+          const size_t N = affine.scale.size();
+          if (!b_ptr->is_matrix() || b_ptr->get_shape()[transB ? 0 : 1] != N) {
+            return nullptr;
+          }
+          // C is broadcast to every row, it must not differ between them
+          std::shared_ptr<Tensor<ValueType>> c_ptr;
+          if (c_tensor) {
+            auto typed =
+                std::get_if<std::shared_ptr<Tensor<ValueType>>>(c_tensor);
+            if (!typed || ((*typed)->get_size() != N &&
+                           (*typed)->get_size() != 1)) {
+              return nullptr;
+            }
+            const auto &c_shape = (*typed)->get_shape();
+            if (c_shape.size() > 2 ||
+                (c_shape.size() == 2 && c_shape[0] != 1)) {
+              return nullptr;
+            }
+            c_ptr = (*typed)->is_contiguous() ? *typed : (*typed)->contiguous();
+          }
+
+          // Column n of the copy is the one of the node times scale[n], plus
+          // shift[n]. It is row n of B when B is transposed
+          const auto &shape = b_ptr->get_shape();
+          auto b_values = b_ptr->is_contiguous() ? b_ptr : b_ptr->contiguous();
+          auto folded_b = TensorFactory::create_tensor<ValueType>(shape);
+          auto folded_c = TensorFactory::create_tensor<ValueType>({N});
+          const ValueType *b_data = b_values->span().data();
+          ValueType *fb = folded_b->data();
+          ValueType *fc = folded_c->data();
+          for (size_t i = 0; i < shape[0]; ++i) {
+            for (size_t j = 0; j < shape[1]; ++j) {
+              const double s = affine.scale[transB ? i : j];
+              fb[i * shape[1] + j] =
+                  static_cast<ValueType>(b_data[i * shape[1] + j] * s);
+            }
+          }
+          for (size_t n = 0; n < N; ++n) {
+            double c = 0;
+            if (c_ptr) {
+              c = static_cast<double>(beta) *
+                  c_ptr->span()[c_ptr->get_size() == 1 ? 0 : n];
+            }
+            fc[n] = static_cast<ValueType>(c * affine.scale[n] +
+                                           affine.shift[n]);
+          }
+
+          auto copy = std::make_shared<GemmNode>(*this);
+          copy->B = output + "#B";
+          copy->C = output + "#C";
+          copy->Y = output;
+          copy->beta = 1.0f;
+          weights[copy->B] = folded_b;
+          weights[copy->C.value()] = folded_c;
+          return copy;
+        }
+      },
+      b_it->second);
+}
@@ -2,19 +2,18 @@
 
 #include <stddef.h>
 
-#include <algorithm>
-#include <initializer_list>
-#include <map>
 #include <memory>
 #include <stdexcept>
 #include <type_traits>
 #include <unordered_map>
+// IWYU pragma: no_include <__vector/vector.h>
+#include <vector>  // IWYU pragma: keep
 
 #include "datastructures/mml_array.hpp"
 #include "datastructures/tensor_factory.hpp"
 #include "nlohmann/json.hpp"
 #include "nodes/node_utils.hpp"
-#include "operations/tensor_operations_module.hpp"
+#include "operations/reduction.hpp"
 
 GlobalAvgPoolNode::GlobalAvgPoolNode(const std::string& X, const std::string& Y)
     : X(X), Y(Y) {}
@@ -56,70 +55,28 @@ void GlobalAvgPoolNode::forward(
                 "dimensions (N, C, ...)");
           }
 
-          size_t batch = x_shape[0];
-          size_t channels = x_shape[1];
-
-          // total elements in each spatial slice
-          size_t spatial_size = 1;
-          for (size_t i = 2; i < rank; ++i) {
-            spatial_size *= x_shape[i];
-          }
-
           // build output shape [N, C, 1, 1, ...]
-          std::vector<size_t> y_shape_vec;
-          y_shape_vec.reserve(rank);
-          y_shape_vec.push_back(batch);
-          y_shape_vec.push_back(channels);
-          for (size_t i = 2; i < rank; ++i) {
-            y_shape_vec.push_back(1);
-          }
+          std::vector<size_t> y_shape_vec(rank, 1);
+          y_shape_vec[0] = x_shape[0];
+          y_shape_vec[1] = x_shape[1];
           array_mml<size_t> y_shape(y_shape_vec);
-          auto y_ptr = TensorFactory::create_tensor<ValueType>(y_shape);
-
-          // index buffers
-          std::vector<size_t> idx(rank, 0);
-          std::vector<size_t> spatial_idx(rank - 2, 0);
-
-          for (size_t n = 0; n < batch; ++n) {
-            idx[0] = n;
-            for (size_t c = 0; c < channels; ++c) {
-              idx[1] = c;
-              ValueType sum = 0;
-
-              // iterate through every spatial position
-              bool done = false;
-              while (!done) {
-                // fill idx[2..] from spatial_idx
-                for (size_t d = 0; d < spatial_idx.size(); ++d) {
-                  idx[d + 2] = spatial_idx[d];
-                }
-
-                // *** FIX: use a named array_mml to index ***
-                array_mml<size_t> in_index(idx);
-                sum += (*x_ptr)[in_index];
-
-                // increment spatial_idx
-                for (int d = (int)spatial_idx.size() - 1; d >= 0; --d) {
-                  if (++spatial_idx[d] < x_shape[d + 2]) {
-                    break;
-                  }
-                  spatial_idx[d] = 0;
-                  if (d == 0) done = true;
-                }
-              }
-
-              // write output at [n,c,0,...,0]
-              std::vector<size_t> out_idx_vec(rank, 0);
-              out_idx_vec[0] = n;
-              out_idx_vec[1] = c;
-              array_mml<size_t> out_index(out_idx_vec);
-
-              (*y_ptr)[out_index] = sum / static_cast<ValueType>(spatial_size);
-
-              // reset for next channel
-              std::fill(spatial_idx.begin(), spatial_idx.end(), 0);
-            }
-          }
+
+          // An output of the right shape, like one planned in the arena, is
+          // written in place
+          auto y_ptr = NodeUtils::reusable_output<ValueType>(iomap, Y, y_shape);
+
+          // average every [n, c] plane, the rows of a contiguous input
+          std::vector<size_t> shape(x_shape.begin(), x_shape.end());
+          std::vector<bool> reduced(rank, true);
+          reduced[0] = false;
+          reduced[1] = false;
+          auto input = x_ptr->is_contiguous() ? x_ptr : x_ptr->contiguous();
+          std::vector<ValueType> x_values;
+          std::vector<ValueType> y_values;
+          mml_reduce<ValueType>(ReductionKind::Mean, shape, reduced,
+                                NodeUtils::kernel_input(input, x_values),
+                                NodeUtils::kernel_output(y_ptr, y_values));
+          NodeUtils::write_kernel_output(y_values, y_ptr);
 
           iomap[Y] = y_ptr;
         }
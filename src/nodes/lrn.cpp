@@ -14,6 +14,7 @@
 
 #include "datastructures/mml_array.hpp"
 #include "nlohmann/json.hpp"
+#include "nodes/node_utils.hpp"
 
 LRNNode_mml::LRNNode_mml(const std::string &X, const std::string &Y,
                          size_t size, float alpha, float beta, float bias)
@@ -73,20 +74,11 @@ void LRNNode_mml::forward(
           throw std::runtime_error(
               "LRNNode_mml: Unsupported data type for tensor X");
         } else {
-          auto y_it = iomap.find(Y);
-          if (y_it == iomap.end()) {
-            // Create output tensor if it doesn't exist
-            auto y_ptr = x_ptr->copy();
-            iomap[Y] = y_ptr;
-            y_it = iomap.find(Y);
-          } else if (!std::holds_alternative<
-                         std::shared_ptr<Tensor<ValueTypeX>>>(y_it->second)) {
-            throw std::runtime_error(
-                "LRNNode_mml: Output tensor Y has incorrect type");
-          }
-
-          auto y_ptr =
-              std::get<std::shared_ptr<Tensor<ValueTypeX>>>(y_it->second);
+          // An output of the right shape, like one planned in the arena, is
+          // written in place
+          auto y_ptr = NodeUtils::reusable_output<ValueTypeX>(
+              iomap, Y, x_ptr->get_shape());
+          iomap[Y] = y_ptr;
 
           array_mml<size_t> shape = x_ptr->get_shape();
 
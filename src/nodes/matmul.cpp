@@ -1,5 +1,9 @@
 #include "nodes/matmul.hpp"
 
+#include "datastructures/tensor_factory.hpp"
+#include "nodes/node_utils.hpp"
+#include "operations/tensor_operations_module.hpp"
+
 MatMulNode::MatMulNode(const std::string &A, const std::string &B,
                        const std::string &Y)
     : A(A), B(B), Y(Y) {}
@@ -36,49 +40,88 @@ void MatMulNode::forward(
             std::decay_t<decltype(a_ptr)>::element_type::value_type;
         using ValueTypeB =
             std::decay_t<decltype(b_ptr)>::element_type::value_type;
+        using TensorPtr = std::shared_ptr<Tensor<ValueTypeA>>;
 
         if constexpr (!is_in_variant_v<ValueTypeA, T> ||
                       !std::is_same_v<ValueTypeA, ValueTypeB>) {
           throw std::runtime_error(
               "MatMul: Unsupported data type for tensor A");
         } else {
-          if (!a_ptr->is_matrix() || !b_ptr->is_matrix()) {
+          const array_mml<size_t> &a_shape = a_ptr->get_shape();
+          const array_mml<size_t> &b_shape = b_ptr->get_shape();
+          if (a_shape.size() == 0 || b_shape.size() == 0) {
             throw std::runtime_error(
-                "MatMul: Input tensors must be 2D matrices");
+                "MatMul: Input tensors must have at least one dimension");
           }
 
-          auto new_a_ptr = a_ptr->copy();
-          auto new_b_ptr = b_ptr->copy();
-
-          array_mml<size_t> a_shape = new_a_ptr->get_shape();
-          array_mml<size_t> b_shape = new_b_ptr->get_shape();
-
-          size_t M = a_shape[0];
-          size_t K_a = a_shape[1];
-          size_t K_b = b_shape[0];
-          size_t N = b_shape[1];
-
-          if (K_a != K_b) {
+          // A 1D A is the matrix [1, K] and a 1D B the matrix [K, 1], the
+          // dimension added is left out of the output
+          const bool a_vector = a_shape.size() == 1;
+          const bool b_vector = b_shape.size() == 1;
+          const size_t M = a_vector ? 1 : a_shape[a_shape.size() - 2];
+          const size_t K = a_shape[a_shape.size() - 1];
+          const size_t K_b =
+              b_vector ? b_shape[0] : b_shape[b_shape.size() - 2];
+          const size_t N = b_vector ? 1 : b_shape[b_shape.size() - 1];
+
+          if (K != K_b) {
             throw std::runtime_error(
                 "MatMul: Inner dimensions of A and B must match");
           }
 
-          size_t lda = K_a;
-          size_t ldb = N;
-          size_t ldc = N;
+          // The dimensions before the matrices are broadcast together, a
+          // matrix broadcast along a dimension has a batch stride of 0 there
+          const size_t a_batch_rank = a_vector ? 0 : a_shape.size() - 2;
+          const size_t b_batch_rank = b_vector ? 0 : b_shape.size() - 2;
+          const size_t rank = std::max(a_batch_rank, b_batch_rank);
+          std::vector<size_t> batch_shape(rank);
+          std::vector<size_t> a_strides(rank, 0);
+          std::vector<size_t> b_strides(rank, 0);
+          std::vector<size_t> c_strides(rank, 0);
+          size_t a_stride = M * K;
+          size_t b_stride = K * N;
+          size_t c_stride = M * N;
+          for (size_t d = rank; d-- > 0;) {
+            const size_t a_dim = d < rank - a_batch_rank
+                                     ? 1
+                                     : a_shape[d - (rank - a_batch_rank)];
+            const size_t b_dim = d < rank - b_batch_rank
+                                     ? 1
+                                     : b_shape[d - (rank - b_batch_rank)];
+            if (a_dim != b_dim && a_dim != 1 && b_dim != 1) {
+              throw std::runtime_error(
+                  "MatMul: Incompatible batch dimensions, broadcasting "
+                  "impossible.");
+            }
+            batch_shape[d] = a_dim == 1 ? b_dim : a_dim;
+            a_strides[d] = a_dim == 1 ? 0 : a_stride;
+            b_strides[d] = b_dim == 1 ? 0 : b_stride;
+            c_strides[d] = c_stride;
+            a_stride *= a_dim;
+            b_stride *= b_dim;
+            c_stride *= batch_shape[d];
+          }
+
+          std::vector<size_t> dims = batch_shape;
+          if (!a_vector) {
+            dims.push_back(M);
+          }
+          if (!b_vector) {
+            dims.push_back(N);
+          }
+          const array_mml<size_t> shape(dims);
 
-          std::shared_ptr<Tensor<ValueTypeA>> new_c_ptr;
-          auto c_it = iomap.find(Y);
-          auto raw_c_ptr =
-              std::get<std::shared_ptr<Tensor<ValueTypeA>>>(c_it->second)
-                  ->copy();
-          new_c_ptr = raw_c_ptr->broadcast_reshape({M, N});
+          // An output of the right shape, like one planned in the arena, is
+          // written in place
+          auto result = NodeUtils::reusable_output<ValueTypeA>(iomap, Y, shape);
 
-          TensorOperations::gemm<ValueTypeA>(0, 0, M, N, K_a, 1.0, new_a_ptr,
-                                             lda, new_b_ptr, ldb, 0.0,
-                                             new_c_ptr, ldc);
+          TensorOperations::gemm_strided_batched<ValueTypeA>(
+              0, 0, static_cast<int>(M), static_cast<int>(N),
+              static_cast<int>(K), ValueTypeA(1), a_ptr, static_cast<int>(K),
+              a_strides, b_ptr, static_cast<int>(N), b_strides, ValueTypeA(0),
+              result, static_cast<int>(N), c_strides, batch_shape);
 
-          iomap[Y] = new_c_ptr;
+          iomap[Y] = result;
         }
       },
       a_tensor, b_tensor);
@@ -86,4 +129,4 @@ void MatMulNode::forward(
 
 std::vector<std::string> MatMulNode::getInputs() { return {A, B}; }
 
-std::vector<std::string> MatMulNode::getOutputs() { return {Y}; }
\ No newline at end of file
+std::vector<std::string> MatMulNode::getOutputs() { return {Y}; }
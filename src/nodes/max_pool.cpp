@@ -4,20 +4,23 @@
 
 #include <algorithm>
 #include <initializer_list>
-#include <limits>
 #include <map>
 #include <memory>
+#include <span>
 #include <stdexcept>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
+// IWYU pragma: no_include <__vector/vector.h>
+#include <vector>  // IWYU pragma: keep
 
 #include "datastructures/a_tensor.hpp"
 #include "datastructures/mml_array.hpp"
 #include "datastructures/tensor_factory.hpp"
 #include "nlohmann/json.hpp"
 #include "nodes/node_utils.hpp"
-#include "operations/tensor_operations_module.hpp"
+#include "operations/nchwc.hpp"
+#include "operations/pooling.hpp"
 
 MaxPoolNode::MaxPoolNode(const std::string& X, const std::string& Y,
                          const std::vector<int>& kernel_shape,
@@ -35,7 +38,12 @@ MaxPoolNode::MaxPoolNode(const std::string& X, const std::string& Y,
       kernel_shape(kernel_shape),
       pads(pads),
       storage_order(storage_order),
-      strides(strides) {}
+      strides(strides) {
+  // The defaults are resolved once, forward must not modify the node
+  NodeUtils::compute_pool_attributes(this->auto_pad, this->kernel_shape,
+                                     this->strides, this->pads,
+                                     this->dilations);
+}
 
 MaxPoolNode::MaxPoolNode(const nlohmann::json& node) {
   if (node.contains("input") && node["input"].is_array()) {
@@ -91,6 +99,8 @@ MaxPoolNode::MaxPoolNode(const nlohmann::json& node) {
       }
     }
   }
+  NodeUtils::compute_pool_attributes(auto_pad, kernel_shape, strides, pads,
+                                     dilations);
 }
 
 void MaxPoolNode::forward(
@@ -112,6 +122,15 @@ void MaxPoolNode::forward(
               "MaxPoolNode: Unsupported data type for tensor X");
         } else {
           array_mml<size_t> x_shape = x_ptr->get_shape();
+          if (channel_block != 0) {
+            // Blocked inputs are pooled as their logical NCHW shape
+            if (x_shape.size() != 5 || x_shape[4] != channel_block) {
+              throw std::runtime_error(
+                  "MaxPoolNode: Blocked input tensor must have 5 dimensions");
+            }
+            x_shape = array_mml<size_t>({x_shape[0], x_shape[1] * x_shape[4],
+                                         x_shape[2], x_shape[3]});
+          }
           size_t total_rank = x_shape.size();
 
           if (total_rank < 3) {
@@ -119,9 +138,6 @@ void MaxPoolNode::forward(
                 "MaxPoolNode: Input tensor must be at least NCL");
           }
 
-          NodeUtils::compute_pool_attributes(auto_pad, kernel_shape, strides,
-                                             pads, dilations);
-
           array_mml<size_t> output_shape = NodeUtils::compute_pool_output_shape(
               x_shape, auto_pad, ceil_mode, dilations, kernel_shape, pads,
               strides);
@@ -130,64 +146,98 @@ void MaxPoolNode::forward(
               x_shape, auto_pad, ceil_mode, dilations, kernel_shape, pads,
               strides);
 
-          auto y_ptr = TensorFactory::create_tensor<ValueType>(output_shape);
+          // Blocked outputs keep the layout of their input
+          array_mml<size_t> y_shape =
+              channel_block != 0
+                  ? array_mml<size_t>({output_shape[0],
+                                       output_shape[1] / channel_block,
+                                       output_shape[2], output_shape[3],
+                                       channel_block})
+                  : output_shape;
+
+          // An output of the right shape, like one planned in the arena, is
+          // written in place
+          auto y_ptr = NodeUtils::reusable_output<ValueType>(iomap, Y, y_shape);
+          auto input = x_ptr->is_contiguous() ? x_ptr : x_ptr->contiguous();
+          std::vector<ValueType> x_values;
+          std::vector<ValueType> y_values;
+
+          // A window entirely in the padding has no value in either layout
+          PoolShape shape = NodeUtils::compute_pool_shape(
+              x_shape, output_shape, kernel_shape, strides, dilations,
+              pad_pair);
+          if (mml_pool_has_empty_window(shape)) {
+            throw std::runtime_error("MaxPoolNode: Empty window values");
+          }
+
+          if (channel_block != 0) {
+            NchwcPoolShape blocked_shape{
+                x_shape[0],
+                x_shape[1],
+                x_shape[2],
+                x_shape[3],
+                output_shape[2],
+                output_shape[3],
+                static_cast<size_t>(kernel_shape[0]),
+                static_cast<size_t>(kernel_shape[1]),
+                static_cast<size_t>(strides[0]),
+                static_cast<size_t>(strides[1]),
+                static_cast<size_t>(dilations[0]),
+                static_cast<size_t>(dilations[1]),
+                static_cast<size_t>(pad_pair[0].first),
+                static_cast<size_t>(pad_pair[1].first)};
+            mml_nchwc_max_pool<ValueType>(
+                channel_block, blocked_shape,
+                NodeUtils::kernel_input(input, x_values),
+                NodeUtils::kernel_output(y_ptr, y_values));
+            NodeUtils::write_kernel_output(y_values, y_ptr);
+            iomap[Y] = y_ptr;
+            return;
+          }
 
           std::optional<std::shared_ptr<Tensor<int64_t>>> indices_ptr =
               std::nullopt;
           if (indices.has_value()) {
-            indices_ptr = TensorFactory::create_tensor<int64_t>(output_shape);
+            indices_ptr = NodeUtils::reusable_output<int64_t>(
+                iomap, indices.value(), output_shape);
           }
 
-          // Perform pooling operation
-          TensorOperations::sliding_window<ValueType>(
-              x_shape, output_shape, kernel_shape, strides, dilations, pad_pair,
-              [this, x_ptr, y_ptr, indices_ptr, x_shape, total_rank](
-                  const std::vector<std::vector<size_t>>& window_in_idx,
-                  const std::vector<size_t>& out_idx) -> void {
-                if (window_in_idx.empty()) {
-                  throw std::runtime_error("MaxPoolNode: Empty window values");
-                }
-
-                ValueType max_val = std::numeric_limits<ValueType>::lowest();
-                int64_t max_idx = -1;
-
-                for (const auto& in_idx : window_in_idx) {
-                  array_mml<size_t> curr_idx(in_idx);
-                  ValueType curr_val = (*x_ptr)[curr_idx];
-
-                  if (curr_val > max_val) {
-                    max_val = curr_val;
-
-                    // Convert in_idx to flat index
-                    int64_t flat_index = 0;
-                    if (storage_order == 0) {  // Row-major
-                      for (size_t i = 0; i < total_rank; ++i) {
-                        int64_t stride = 1;
-                        for (size_t j = i + 1; j < total_rank; ++j) {
-                          stride *= x_shape[j];
-                        }
-                        flat_index += in_idx[i] * stride;
-                      }
-                    } else {  // Column-major
-                      int64_t stride = 1;
-                      for (size_t i = 0; i < total_rank; ++i) {
-                        flat_index += in_idx[i] * stride;
-                        stride *= x_shape[i];
-                      }
-                    }
-                    max_idx = flat_index;
-                  }
-                }
-
-                array_mml<size_t> out_idx_array(out_idx);
-                (*y_ptr)[out_idx_array] = max_val;
-                if (indices_ptr.has_value()) {
-                  (*indices_ptr.value())[out_idx_array] = max_idx;
-                }
-              });
+          std::vector<int64_t> index_values;
+          int64_t *index_data =
+              indices_ptr.has_value()
+                  ? NodeUtils::kernel_output(indices_ptr.value(), index_values)
+                  : nullptr;
+          mml_max_pool<ValueType>(shape,
+                                  NodeUtils::kernel_input(input, x_values),
+                                  NodeUtils::kernel_output(y_ptr, y_values),
+                                  index_data);
+          NodeUtils::write_kernel_output(y_values, y_ptr);
+
+          if (indices_ptr.has_value() && storage_order != 0) {
+            // The kernel gives row-major indices, convert them to column-major
+            for (int64_t &index :
+                 std::span(index_data, indices_ptr.value()->get_size())) {
+              if (index < 0) {
+                continue;
+              }
+              int64_t remaining = index;
+              std::vector<int64_t> coordinates(total_rank);
+              for (size_t i = total_rank; i-- > 0;) {
+                coordinates[i] = remaining % static_cast<int64_t>(x_shape[i]);
+                remaining /= static_cast<int64_t>(x_shape[i]);
+              }
+              int64_t stride = 1;
+              index = 0;
+              for (size_t i = 0; i < total_rank; ++i) {
+                index += coordinates[i] * stride;
+                stride *= static_cast<int64_t>(x_shape[i]);
+              }
+            }
+          }
 
           iomap[Y] = y_ptr;
           if (indices.has_value()) {
+            NodeUtils::write_kernel_output(index_values, indices_ptr.value());
             iomap[indices.value()] = indices_ptr.value();
           }
         }
@@ -203,4 +253,18 @@ std::vector<std::string> MaxPoolNode::getOutputs() {
   } else {
     return {Y};
   }
-}
\ No newline at end of file
+}
+
+std::shared_ptr<Node> MaxPoolNode::blocked_copy(
+    size_t block,
+    const std::unordered_map<std::string, GeneralDataTypes>& /*weights*/,
+    const std::function<std::string(const std::string&)>& blocked_name) {
+  if (kernel_shape.size() != 2 || indices.has_value()) {
+    return nullptr;
+  }
+  auto copy = std::make_shared<MaxPoolNode>(*this);
+  copy->X = blocked_name(X);
+  copy->Y = blocked_name(Y);
+  copy->channel_block = block;
+  return copy;
+}
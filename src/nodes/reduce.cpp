@@ -0,0 +1,166 @@
+#include "nodes/reduce.hpp"
+
+#include <stddef.h>
+
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+// IWYU pragma: no_include <__vector/vector.h>
+#include <vector>  // IWYU pragma: keep
+
+#include "datastructures/mml_array.hpp"
+#include "datastructures/tensor_factory.hpp"
+#include "nlohmann/json.hpp"
+#include "nodes/node_utils.hpp"
+#include "operations/reduction.hpp"
+
+ReduceNode::ReduceNode(ReductionKind kind, const std::string &data,
+                       const std::string &reduced, const std::vector<int> &axes,
+                       int keepdims, int noop_with_empty_axes,
+                       const std::optional<std::string> &axes_input)
+    : kind(kind),
+      data(data),
+      reduced(reduced),
+      axes(axes),
+      keepdims(keepdims),
+      noop_with_empty_axes(noop_with_empty_axes),
+      axes_input(axes_input) {}
+
+ReduceNode::ReduceNode(const nlohmann::json &node) {
+  const std::string op_type = node["opType"];
+  if (op_type == "ReduceSum") {
+    kind = ReductionKind::Sum;
+  } else if (op_type == "ReduceMean") {
+    kind = ReductionKind::Mean;
+  } else if (op_type == "ReduceMax") {
+    kind = ReductionKind::Max;
+  } else if (op_type == "ReduceMin") {
+    kind = ReductionKind::Min;
+  } else if (op_type == "ReduceL2") {
+    kind = ReductionKind::L2;
+  } else {
+    throw std::runtime_error("ReduceNode: Unsupported reduction " + op_type);
+  }
+
+  if (node.contains("input") && node["input"].is_array()) {
+    data = node["input"][0];
+    // An empty name is an omitted optional input
+    if (node["input"].size() > 1 && node["input"][1] != "") {
+      axes_input = node["input"][1];
+    }
+  }
+
+  if (node.contains("output") && node["output"].is_array()) {
+    reduced = node["output"][0];
+  }
+
+  keepdims = 1;
+  noop_with_empty_axes = 0;
+  if (node.contains("attribute") && node["attribute"].is_array()) {
+    for (const auto &attr : node["attribute"]) {
+      if (attr["name"] == "axes") {
+        for (const auto &axis : attr["ints"]) {
+          axes.push_back(std::stoi(axis.get<std::string>()));
+        }
+      } else if (attr["name"] == "keepdims") {
+        keepdims = std::stoi(attr["i"].get<std::string>());
+      } else if (attr["name"] == "noop_with_empty_axes") {
+        noop_with_empty_axes = std::stoi(attr["i"].get<std::string>());
+      }
+    }
+  }
+}
+
+void ReduceNode::forward(
+    std::unordered_map<std::string, GeneralDataTypes> &iomap) {
+  auto data_it = iomap.find(data);
+  if (data_it == iomap.end()) {
+    throw std::runtime_error(
+        "ReduceNode: Input tensor data not found in iomap");
+  }
+
+  std::vector<int64_t> requested(axes.begin(), axes.end());
+  if (axes_input.has_value()) {
+    auto axes_it = iomap.find(axes_input.value());
+    if (axes_it == iomap.end()) {
+      throw std::runtime_error(
+          "ReduceNode: Input tensor axes not found in iomap");
+    }
+    auto axes_ptr =
+        std::get_if<std::shared_ptr<Tensor<int64_t>>>(&axes_it->second);
+    if (!axes_ptr) {
+      throw std::runtime_error(
+          "ReduceNode: Tensor axes must be of type int64");
+    }
+    auto axes_tensor =
+        (*axes_ptr)->is_contiguous() ? *axes_ptr : (*axes_ptr)->contiguous();
+    std::vector<int64_t> values;
+    const int64_t *axes_data = NodeUtils::kernel_input(axes_tensor, values);
+    requested.assign(axes_data, axes_data + axes_tensor->get_size());
+  }
+
+  std::visit(
+      [&](const auto &data_ptr) {
+        using ValueType =
+            typename std::decay_t<decltype(data_ptr)>::element_type::value_type;
+
+        if constexpr (!is_in_variant_v<ValueType, T>) {
+          throw std::runtime_error(
+              "ReduceNode: Unsupported data type for tensor data");
+        } else {
+          if (requested.empty() && noop_with_empty_axes != 0) {
+            iomap[reduced] = data_ptr;
+            return;
+          }
+
+          const auto &data_shape = data_ptr->get_shape();
+          const int64_t rank = static_cast<int64_t>(data_shape.size());
+          std::vector<bool> flags(rank, requested.empty());
+          for (int64_t axis : requested) {
+            if (axis < -rank || axis >= rank) {
+              throw std::runtime_error("ReduceNode: Axis " +
+                                       std::to_string(axis) +
+                                       " is out of range.");
+            }
+            flags[axis < 0 ? axis + rank : axis] = true;
+          }
+
+          std::vector<size_t> shape(data_shape.begin(), data_shape.end());
+          std::vector<size_t> reduced_shape;
+          for (size_t i = 0; i < shape.size(); ++i) {
+            if (!flags[i]) {
+              reduced_shape.push_back(shape[i]);
+            } else if (keepdims != 0) {
+              reduced_shape.push_back(1);
+            }
+          }
+
+          array_mml<size_t> y_shape(reduced_shape);
+
+          // An output of the right shape, like one planned in the arena, is
+          // written in place
+          auto reduced_ptr =
+              NodeUtils::reusable_output<ValueType>(iomap, reduced, y_shape);
+          auto input =
+              data_ptr->is_contiguous() ? data_ptr : data_ptr->contiguous();
+          std::vector<ValueType> data_values;
+          std::vector<ValueType> reduced_values;
+          mml_reduce<ValueType>(
+              kind, shape, flags, NodeUtils::kernel_input(input, data_values),
+              NodeUtils::kernel_output(reduced_ptr, reduced_values));
+          NodeUtils::write_kernel_output(reduced_values, reduced_ptr);
+          iomap[reduced] = reduced_ptr;
+        }
+      },
+      data_it->second);
+}
+
+std::vector<std::string> ReduceNode::getInputs() {
+  if (axes_input.has_value()) {
+    return {data, axes_input.value()};
+  }
+  return {data};
+}
+
+std::vector<std::string> ReduceNode::getOutputs() { return {reduced}; }
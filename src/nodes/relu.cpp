@@ -11,6 +11,7 @@
 #include <vector>  // IWYU pragma: keep
 
 #include "nlohmann/json.hpp"
+#include "nodes/node_utils.hpp"
 
 ReLUNode::ReLUNode(const std::string &X, const std::string &Y) : X(X), Y(Y) {}
 
@@ -43,26 +44,13 @@ void ReLUNode::forward(
           throw std::runtime_error(
               "ReluNode: Unsupported data type for tensor X");
         } else {
-          auto y_it = iomap.find(Y);
-          if (y_it == iomap.end()) {
-            // Create output tensor if it doesn't exist
-            auto y_ptr = x_ptr->copy();
-            // No need to fill with zeros as the elementwise std::function will
-            // overwrite the values
-            iomap[Y] = y_ptr;
-            y_it = iomap.find(Y);
-          } else if (!std::holds_alternative<
-                         std::shared_ptr<Tensor<ValueType>>>(y_it->second)) {
-            throw std::runtime_error(
-                "ReluNode: Output tensor Y has incorrect type");
-          }
+          // An output of the right shape, like one planned in the arena, is
+          // written in place
+          auto y_ptr = NodeUtils::reusable_output<ValueType>(
+              iomap, Y, x_ptr->get_shape());
+          iomap[Y] = y_ptr;
 
-          auto y_ptr =
-              std::get<std::shared_ptr<Tensor<ValueType>>>(y_it->second);
-
-          TensorOperations::elementwise<ValueType>(
-              x_ptr, [](ValueType x) -> ValueType { return x > 0 ? x : 0; },
-              y_ptr);
+          mml_activate<ValueType>(*fusable_activation(), x_ptr, y_ptr);
         }
       },
       x_tensor);
@@ -70,4 +58,15 @@ void ReLUNode::forward(
 
 std::vector<std::string> ReLUNode::getInputs() { return {X}; }
 
-std::vector<std::string> ReLUNode::getOutputs() { return {Y}; }
\ No newline at end of file
+std::vector<std::string> ReLUNode::getOutputs() { return {Y}; }
+
+std::shared_ptr<Node> ReLUNode::blocked_copy(
+    size_t /*block*/,
+    const std::unordered_map<std::string, GeneralDataTypes> & /*weights*/,
+    const std::function<std::string(const std::string &)> &blocked_name) {
+  return std::make_shared<ReLUNode>(blocked_name(X), blocked_name(Y));
+}
+
+std::optional<Activation> ReLUNode::fusable_activation() const {
+  return Activation{ActivationKind::Relu};
+}
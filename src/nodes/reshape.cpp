@@ -69,24 +69,6 @@ void reshapeNode::forward(
           throw std::runtime_error(
               "ReshapeNode: Unsupported data type for tensor data");
         } else {
-          auto reshaped_it = iomap.find(reshaped);
-          if (reshaped_it == iomap.end()) {
-            // Create a new output tensor by copying the input tensor
-            auto new_reshaped_ptr = data_ptr->copy();
-            // No need to fill with zeros as the reshape std::function will
-            // overwrite the values
-            iomap[reshaped] = new_reshaped_ptr;
-            reshaped_it = iomap.find(reshaped);
-          } else if (!std::holds_alternative<
-                         std::shared_ptr<Tensor<ValueType>>>(
-                         reshaped_it->second)) {
-            throw std::runtime_error(
-                "ReshapeNode: Output tensor has incorrect type");
-          }
-
-          auto reshaped_ptr =
-              std::get<std::shared_ptr<Tensor<ValueType>>>(reshaped_it->second);
-
           // Determine the size of the shape tensor (number of dimensions for
           // the new shape)
           size_t shape_size = shape_ptr->get_size();
@@ -155,11 +137,9 @@ void reshapeNode::forward(
             computed_elements *= new_shape[inferred_dim_index];
           }
 
-          // Copy the data from the input tensor to the reshaped output tensor
-          *reshaped_ptr = *data_ptr;
-
-          // Apply reshape with the calculated new shape
-          reshaped_ptr->reshape(new_shape);
+          // The output is a view of the input, unless the input is a view
+          // whose elements have to be copied first
+          iomap[reshaped] = data_ptr->reshape_view(new_shape);
         }
       },
       data_tensor, shape_tensor);
@@ -0,0 +1,106 @@
+#include "nodes/softmax.hpp"
+
+#include <stddef.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+// IWYU pragma: no_include <__vector/vector.h>
+#include <vector>  // IWYU pragma: keep
+
+#include "datastructures/tensor_factory.hpp"
+#include "nlohmann/json.hpp"
+#include "nodes/node_utils.hpp"
+#include "operations/softmax.hpp"
+
+namespace {
+
+// Gets the operation of a Softmax or LogSoftmax node from its opType
+SoftmaxKind softmax_kind(const std::string &op_type) {
+  if (op_type == "Softmax") {
+    return SoftmaxKind::Softmax;
+  } else if (op_type == "LogSoftmax") {
+    return SoftmaxKind::LogSoftmax;
+  }
+  throw std::runtime_error("SoftMaxNode: Unsupported operation " + op_type);
+}
+
+}  // namespace
+
+SoftMaxNode::SoftMaxNode(const std::string &X, const std::string &Y, int axis,
+                         SoftmaxKind kind)
+    : X(X), Y(Y), axis(axis), kind(kind) {}
+
+SoftMaxNode::SoftMaxNode(const nlohmann::json &node)
+    : SoftMaxNode(node, softmax_kind(node["opType"])) {}
+
+SoftMaxNode::SoftMaxNode(const nlohmann::json &node, SoftmaxKind kind)
+    : kind(kind) {
+  if (node.contains("input") && node["input"].is_array()) {
+    X = node["input"][0];
+  }
+
+  if (node.contains("output") && node["output"].is_array()) {
+    Y = node["output"][0];
+  }
+
+  axis = -1;
+  if (node.contains("attribute") && node["attribute"].is_array()) {
+    for (const auto &attr : node["attribute"]) {
+      if (attr["name"] == "axis") {
+        axis = std::stoi(attr["i"].get<std::string>());
+      }
+    }
+  }
+}
+
+void SoftMaxNode::forward(
+    std::unordered_map<std::string, GeneralDataTypes> &iomap) {
+  auto x_it = iomap.find(X);
+  if (x_it == iomap.end()) {
+    throw std::runtime_error("SoftMaxNode: Input tensor X not found in iomap");
+  }
+
+  const GeneralDataTypes &x_tensor = x_it->second;
+
+  std::visit(
+      [&](const auto &x_ptr) {
+        using ValueTypeX =
+            typename std::decay_t<decltype(x_ptr)>::element_type::value_type;
+
+        if constexpr (!is_in_variant_v<ValueTypeX, T>) {
+          throw std::runtime_error(
+              "SoftMaxNode: Unsupported data type for tensor X");
+        } else {
+          const auto &x_shape = x_ptr->get_shape();
+          const int rank = static_cast<int>(x_shape.size());
+          if (axis < -rank || axis >= rank) {
+            throw std::runtime_error("SoftMaxNode: Axis " +
+                                     std::to_string(axis) +
+                                     " is out of range.");
+          }
+
+          // An output of the right shape, like one planned in the arena, is
+          // written in place
+          auto y_ptr =
+              NodeUtils::reusable_output<ValueTypeX>(iomap, Y, x_shape);
+          std::vector<size_t> shape(x_shape.begin(), x_shape.end());
+          auto input = x_ptr->is_contiguous() ? x_ptr : x_ptr->contiguous();
+          std::vector<ValueTypeX> x_values;
+          std::vector<ValueTypeX> y_values;
+          mml_softmax<ValueTypeX>(kind, shape, axis < 0 ? axis + rank : axis,
+                                  NodeUtils::kernel_input(input, x_values),
+                                  NodeUtils::kernel_output(y_ptr, y_values));
+          NodeUtils::write_kernel_output(y_values, y_ptr);
+
+          iomap[Y] = y_ptr;
+        }
+      },
+      x_tensor);
+}
+
+std::vector<std::string> SoftMaxNode::getInputs() { return {X}; }
+
+std::vector<std::string> SoftMaxNode::getOutputs() { return {Y}; }
\ No newline at end of file
@@ -13,6 +13,7 @@
 #include <vector>  // IWYU pragma: keep
 
 #include "nlohmann/json.hpp"
+#include "nodes/node_utils.hpp"
 
 TanHNode::TanHNode(const std::string &X, const std::string &Y) : X(X), Y(Y) {}
 
@@ -45,26 +46,13 @@ void TanHNode::forward(
           throw std::runtime_error(
               "TanHNode: Unsupported data type for tensor X");
         } else {
-          auto y_it = iomap.find(Y);
-          if (y_it == iomap.end()) {
-            // Create output tensor if it doesn't exist
-            auto y_ptr = x_ptr->copy();
-            // No need to fill with zeros as the elementwise std::function will
-            // overwrite the values
-            iomap[Y] = y_ptr;
-            y_it = iomap.find(Y);
-          } else if (!std::holds_alternative<
-                         std::shared_ptr<Tensor<ValueType>>>(y_it->second)) {
-            throw std::runtime_error(
-                "TanHNode: Output tensor Y has incorrect type");
-          }
+          // An output of the right shape, like one planned in the arena, is
+          // written in place
+          auto y_ptr = NodeUtils::reusable_output<ValueType>(
+              iomap, Y, x_ptr->get_shape());
+          iomap[Y] = y_ptr;
 
-          auto y_ptr =
-              std::get<std::shared_ptr<Tensor<ValueType>>>(y_it->second);
-
-          TensorOperations::elementwise<ValueType>(
-              x_ptr, [](ValueType x) -> ValueType { return std::tanh(x); },
-              y_ptr);
+          mml_activate<ValueType>(*fusable_activation(), x_ptr, y_ptr);
         }
       },
       x_tensor);
@@ -72,4 +60,15 @@ void TanHNode::forward(
 
 std::vector<std::string> TanHNode::getInputs() { return {X}; }
 
-std::vector<std::string> TanHNode::getOutputs() { return {Y}; }
\ No newline at end of file
+std::vector<std::string> TanHNode::getOutputs() { return {Y}; }
+
+std::shared_ptr<Node> TanHNode::blocked_copy(
+    size_t /*block*/,
+    const std::unordered_map<std::string, GeneralDataTypes> & /*weights*/,
+    const std::function<std::string(const std::string &)> &blocked_name) {
+  return std::make_shared<TanHNode>(blocked_name(X), blocked_name(Y));
+}
+
+std::optional<Activation> TanHNode::fusable_activation() const {
+  return Activation{ActivationKind::TanH};
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+
+#include "operations/activation.hpp"
+#include "operations/elementwise.hpp"
+#include "operations/vector_math.hpp"
+#include "utility/thread_pool.hpp"
+
+// Values per block of the vectorized activations, small enough to stay in L1
+static constexpr size_t mml_activation_block = 256;
+
+// Minimum number of values per parallel chunk of mml_activate
+static constexpr size_t mml_activation_grain = 16384;
+
+template <TensorConcept::Types T, typename Visitor>
+static void mml_visit_activation(const Activation &activation,
+                                 Visitor &&visit) {
+  const T alpha = static_cast<T>(activation.alpha);
+  switch (activation.kind) {
+    case ActivationKind::Identity:
+      visit([](T x) { return x; });
+      return;
+    case ActivationKind::Relu:
+      visit([](T x) { return x > 0 ? x : T(0); });
+      return;
+    case ActivationKind::LeakyRelu:
+      visit([alpha](T x) { return x < 0 ? alpha * x : x; });
+      return;
+    default:
+      break;
+  }
+
+  if constexpr (std::is_floating_point_v<T>) {
+    switch (activation.kind) {
+      case ActivationKind::Elu:
+        visit([alpha](T x) { return x < 0 ? alpha * (std::exp(x) - 1) : x; });
+        return;
+      case ActivationKind::Sigmoid:
+        visit([](T x) { return 1 / (1 + std::exp(-x)); });
+        return;
+      case ActivationKind::Swish:
+        visit([](T x) {
+          return x * (static_cast<T>(1) / (static_cast<T>(1) + std::exp(-x)));
+        });
+        return;
+      case ActivationKind::TanH:
+        visit([](T x) { return std::tanh(x); });
+        return;
+      case ActivationKind::Gelu:
+        if (VectorMath::get_accuracy() == MathAccuracy::Precise) {
+          visit([](T x) {
+            return static_cast<T>(0.5f * x *
+                                  (1.0f + std::erf(x / std::sqrt(2.0f))));
+          });
+          return;
+        }
+        // The fast tier computes Gelu with its tanh approximation
+        [[fallthrough]];
+      case ActivationKind::GeluTanh:
+        visit([](T x) {
+          return static_cast<T>(
+              0.5f * x *
+              (1.0f + std::tanh(std::sqrt(2.0f / M_PI) *
+                                (x + 0.044715f * std::pow(x, 3.0f)))));
+        });
+        return;
+      default:
+        break;
+    }
+  }
+  throw std::invalid_argument(
+      "mml_visit_activation: Activation not supported for this type.");
+}
+
+/**
+ * Checks if the activation goes through the vectorized math functions.
+ */
+static inline bool mml_is_transcendental(ActivationKind kind) {
+  switch (kind) {
+    case ActivationKind::Elu:
+    case ActivationKind::Sigmoid:
+    case ActivationKind::Swish:
+    case ActivationKind::TanH:
+    case ActivationKind::Gelu:
+    case ActivationKind::GeluTanh:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/**
+ * Writes the activation of count values plus the bias to out, which may be
+ * in. The activations of exp, tanh and erf run on the vectorized math
+ * functions a block at a time, the others on the scalar functors.
+ */
+template <TensorConcept::Types T>
+static void mml_activate_values(const Activation &activation, T bias,
+                                const T *in, T *out, size_t count) {
+  if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+    if (mml_is_transcendental(activation.kind)) {
+      const T alpha = static_cast<T>(activation.alpha);
+      const bool tanh_gelu =
+          activation.kind == ActivationKind::GeluTanh ||
+          (activation.kind == ActivationKind::Gelu &&
+           VectorMath::get_accuracy() == MathAccuracy::Fast);
+      T x[mml_activation_block];
+      T t[mml_activation_block];
+      for (size_t start = 0; start < count; start += mml_activation_block) {
+        const size_t n = std::min(mml_activation_block, count - start);
+        T *y = out + start;
+        for (size_t i = 0; i < n; i++) {
+          x[i] = in[start + i] + bias;
+        }
+
+        if (tanh_gelu) {
+          // sqrt(2 / pi) (x + 0.044715 x^3)
+          const T scale = static_cast<T>(0.797884560802865355880);
+          const T cubic = static_cast<T>(0.044715);
+          for (size_t i = 0; i < n; i++) {
+            t[i] = scale * (x[i] + cubic * x[i] * x[i] * x[i]);
+          }
+          mml_vtanh(t, t, n);
+          for (size_t i = 0; i < n; i++) {
+            y[i] = static_cast<T>(0.5) * x[i] * (1 + t[i]);
+          }
+          continue;
+        }
+
+        switch (activation.kind) {
+          case ActivationKind::Elu:
+            mml_vexpm1(x, t, n);
+            for (size_t i = 0; i < n; i++) {
+              y[i] = x[i] < 0 ? alpha * t[i] : x[i];
+            }
+            break;
+          case ActivationKind::Sigmoid:
+            mml_vsigmoid(x, y, n);
+            break;
+          case ActivationKind::Swish:
+            mml_vsigmoid(x, t, n);
+            for (size_t i = 0; i < n; i++) {
+              y[i] = x[i] * t[i];
+            }
+            break;
+          case ActivationKind::TanH:
+            mml_vtanh(x, y, n);
+            break;
+          default:  // Gelu, with erf of x / sqrt(2)
+            for (size_t i = 0; i < n; i++) {
+              t[i] = x[i] * static_cast<T>(0.707106781186547524401);
+            }
+            mml_verf(t, t, n);
+            for (size_t i = 0; i < n; i++) {
+              y[i] = static_cast<T>(0.5) * x[i] * (1 + t[i]);
+            }
+        }
+      }
+      return;
+    }
+  }
+
+  mml_visit_activation<T>(activation, [&](auto f) {
+    for (size_t i = 0; i < count; i++) {
+      out[i] = f(static_cast<T>(in[i] + bias));
+    }
+  });
+}
+
+template <TensorConcept::Types T>
+static void mml_bias_activate(const Activation &activation, T bias, T *values,
+                              size_t count) {
+  if (activation.is_identity() && bias == T(0)) {
+    return;
+  }
+  mml_activate_values<T>(activation, bias, values, values, count);
+}
+
+template <TensorConcept::Types T>
+static void mml_activate(const Activation &activation,
+                         const std::shared_ptr<const Tensor<T>> x,
+                         const std::shared_ptr<Tensor<T>> y) {
+  const size_t size = x->get_size();
+  if (x->raw_access() && y->raw_access() && y->get_size() >= size) {
+    const T *x_data = x->data();
+    T *y_data = y->data();
+    parallel_for(0, size, mml_activation_grain, [&](size_t begin, size_t end) {
+      mml_activate_values<T>(activation, T(0), x_data + begin, y_data + begin,
+                             end - begin);
+    });
+    return;
+  }
+  mml_visit_activation<T>(activation, [&](auto f) { mml_map<T>(x, f, y); });
+}
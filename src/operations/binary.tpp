@@ -0,0 +1,242 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+// IWYU pragma: no_include <__vector/vector.h>
+#include <vector>  // IWYU pragma: keep
+
+#include "operations/binary.hpp"
+#include "operations/cpu_dispatch.hpp"
+#include "utility/thread_pool.hpp"
+
+// Minimum number of elements per parallel chunk
+static constexpr size_t mml_binary_grain = 16384;
+
+static inline array_mml<size_t> mml_broadcast_shape(
+    const array_mml<size_t> &a, const array_mml<size_t> &b) {
+  const size_t rank = std::max(a.size(), b.size());
+  array_mml<size_t> shape(rank);
+  for (size_t i = 0; i < rank; i++) {
+    const size_t dim_a = i < a.size() ? a[a.size() - 1 - i] : 1;
+    const size_t dim_b = i < b.size() ? b[b.size() - 1 - i] : 1;
+    if (dim_a != dim_b && dim_a != 1 && dim_b != 1) {
+      throw std::invalid_argument("Incompatible shapes for broadcasting.");
+    }
+    shape[rank - 1 - i] = dim_a == 1 ? dim_b : dim_a;
+  }
+  return shape;
+}
+
+/**
+ * Gets the strides of a tensor over the broadcast shape, 0 along the
+ * dimensions it is broadcast in.
+ */
+template <typename T>
+static std::vector<size_t> mml_broadcast_strides(
+    const Tensor<T> &tensor, const array_mml<size_t> &shape) {
+  const auto &own_shape = tensor.get_shape();
+  const auto &own_strides = tensor.get_strides();
+  if (own_shape.size() > shape.size()) {
+    throw std::invalid_argument("Incompatible shapes for broadcasting.");
+  }
+  const size_t lead = shape.size() - own_shape.size();
+  std::vector<size_t> strides(shape.size(), 0);
+  for (size_t d = 0; d < own_shape.size(); d++) {
+    if (own_shape[d] == shape[lead + d]) {
+      strides[lead + d] = own_shape[d] == 1 ? 0 : own_strides[d];
+    } else if (own_shape[d] != 1) {
+      throw std::invalid_argument("Incompatible shapes for broadcasting.");
+    }
+  }
+  return strides;
+}
+
+/**
+ * Maps the runs of the last of the merged dimensions, every chunk finding the
+ * offsets of its first element once and carrying into the outer dimensions at
+ * the end of each run.
+ */
+template <typename T, typename F>
+static void mml_map_binary_strided(const std::vector<size_t> &shape,
+                                   const T *a,
+                                   const std::vector<size_t> &a_strides,
+                                   const T *b,
+                                   const std::vector<size_t> &b_strides, T *c,
+                                   const std::vector<size_t> &c_strides, F &f) {
+  const size_t rank = shape.size();
+  if (rank == 0) {
+    c[0] = f(a[0], b[0]);
+    return;
+  }
+  size_t size = 1;
+  for (size_t d = 0; d < rank; d++) {
+    size *= shape[d];
+  }
+  const size_t width = shape[rank - 1];
+  const size_t a_step = a_strides[rank - 1];
+  const size_t b_step = b_strides[rank - 1];
+  const size_t c_step = c_strides[rank - 1];
+
+  // Every chunk combines its runs with loops built for the current SIMD tier
+  auto chunk = [&](size_t begin, size_t end) {
+    std::vector<size_t> index(rank);
+    size_t a_offset = 0;
+    size_t b_offset = 0;
+    size_t c_offset = 0;
+    size_t remaining = begin;
+    for (size_t d = rank; d-- > 0;) {
+      index[d] = remaining % shape[d];
+      remaining /= shape[d];
+      a_offset += index[d] * a_strides[d];
+      b_offset += index[d] * b_strides[d];
+      c_offset += index[d] * c_strides[d];
+    }
+
+    for (size_t i = begin; i < end;) {
+      const size_t run = std::min(width - index[rank - 1], end - i);
+      const T *in_a = a + a_offset;
+      const T *in_b = b + b_offset;
+      T *out = c + c_offset;
+      if (c_step == 1 && a_step == 1 && b_step == 1) {
+        for (size_t j = 0; j < run; j++) {
+          out[j] = f(in_a[j], in_b[j]);
+        }
+      } else if (c_step == 1 && a_step == 1 && b_step == 0) {
+        const T y = *in_b;
+        for (size_t j = 0; j < run; j++) {
+          out[j] = f(in_a[j], y);
+        }
+      } else if (c_step == 1 && a_step == 0 && b_step == 1) {
+        const T x = *in_a;
+        for (size_t j = 0; j < run; j++) {
+          out[j] = f(x, in_b[j]);
+        }
+      } else {
+        for (size_t j = 0; j < run; j++) {
+          out[j * c_step] = f(in_a[j * a_step], in_b[j * b_step]);
+        }
+      }
+      i += run;
+
+      // Unsigned offsets wrap while carrying, their final values are exact
+      a_offset += run * a_step;
+      b_offset += run * b_step;
+      c_offset += run * c_step;
+      index[rank - 1] += run;
+      for (size_t d = rank - 1; d > 0 && index[d] == shape[d]; d--) {
+        a_offset += a_strides[d - 1] - shape[d] * a_strides[d];
+        b_offset += b_strides[d - 1] - shape[d] * b_strides[d];
+        c_offset += c_strides[d - 1] - shape[d] * c_strides[d];
+        index[d] = 0;
+        index[d - 1]++;
+      }
+    }
+  };
+  parallel_for(0, size, mml_binary_grain, [&](size_t begin, size_t end) {
+    mml_dispatch_tier(chunk, begin, end);
+  });
+}
+
+template <TensorConcept::Types T, typename F>
+static void mml_map_binary(const std::shared_ptr<const Tensor<T>> a,
+                           const std::shared_ptr<const Tensor<T>> b, F f,
+                           const std::shared_ptr<Tensor<T>> c) {
+  const array_mml<size_t> &shape = c->get_shape();
+  const size_t size = c->get_size();
+  if (size == 0) {
+    return;
+  }
+
+#ifndef MML_CHECKED_ACCESS
+  const std::vector<size_t> a_broadcast = mml_broadcast_strides(*a, shape);
+  const std::vector<size_t> b_broadcast = mml_broadcast_strides(*b, shape);
+  const auto &c_own = c->get_strides();
+
+  // Drop the dimensions of size 1 and merge every dimension into the previous
+  // one when all three tensors step over it as one longer dimension
+  std::vector<size_t> dims;
+  std::vector<size_t> a_strides;
+  std::vector<size_t> b_strides;
+  std::vector<size_t> c_strides;
+  for (size_t d = 0; d < shape.size(); d++) {
+    if (shape[d] == 1) {
+      continue;
+    }
+    if (!dims.empty() && a_strides.back() == a_broadcast[d] * shape[d] &&
+        b_strides.back() == b_broadcast[d] * shape[d] &&
+        c_strides.back() == c_own[d] * shape[d]) {
+      dims.back() *= shape[d];
+      a_strides.back() = a_broadcast[d];
+      b_strides.back() = b_broadcast[d];
+      c_strides.back() = c_own[d];
+    } else {
+      dims.push_back(shape[d]);
+      a_strides.push_back(a_broadcast[d]);
+      b_strides.push_back(b_broadcast[d]);
+      c_strides.push_back(c_own[d]);
+    }
+  }
+
+  mml_map_binary_strided(dims, a->data(), a_strides, b->data(), b_strides,
+                         c->data(), c_strides, f);
+#else
+  // Checked builds go through the bounds checked indexed access of broadcast
+  // views
+  const auto a_view = a->broadcast_reshape(shape);
+  const auto b_view = b->broadcast_reshape(shape);
+  parallel_for(0, size, mml_binary_grain, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      (*c)[i] = f((*a_view)[i], (*b_view)[i]);
+    }
+  });
+#endif
+}
+
+template <TensorConcept::Types T>
+static void mml_binary(BinaryKind kind,
+                       const std::shared_ptr<const Tensor<T>> a,
+                       const std::shared_ptr<const Tensor<T>> b,
+                       const std::shared_ptr<Tensor<T>> c) {
+  switch (kind) {
+    case BinaryKind::Add:
+      mml_map_binary<T>(
+          a, b, [](T x, T y) { return static_cast<T>(x + y); }, c);
+      return;
+    case BinaryKind::Sub:
+      mml_map_binary<T>(
+          a, b, [](T x, T y) { return static_cast<T>(x - y); }, c);
+      return;
+    case BinaryKind::Mul:
+      mml_map_binary<T>(
+          a, b, [](T x, T y) { return static_cast<T>(x * y); }, c);
+      return;
+    case BinaryKind::Div:
+      mml_map_binary<T>(
+          a, b, [](T x, T y) { return static_cast<T>(x / y); }, c);
+      return;
+    case BinaryKind::Pow:
+      if constexpr (std::is_floating_point_v<T>) {
+        mml_map_binary<T>(
+            a, b, [](T x, T y) { return std::pow(x, y); }, c);
+      } else {
+        mml_map_binary<T>(
+            a, b,
+            [](T x, T y) {
+              return static_cast<T>(std::pow(static_cast<double>(x),
+                                             static_cast<double>(y)));
+            },
+            c);
+      }
+      return;
+    case BinaryKind::Min:
+      mml_map_binary<T>(
+          a, b, [](T x, T y) { return std::min(x, y); }, c);
+      return;
+    case BinaryKind::Max:
+      mml_map_binary<T>(
+          a, b, [](T x, T y) { return std::max(x, y); }, c);
+      return;
+  }
+}
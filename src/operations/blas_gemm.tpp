@@ -4,8 +4,6 @@
 #if defined(USE_OPENBLAS_GEMM)
 #include <cblas.h>
 #include <openblas_config.h>
-
-#include <thread>
 #endif
 
 #ifdef USE_OPENBLAS_GEMM
@@ -19,7 +17,8 @@ static void mml_gemm_blas(int TA, int TB, int M, int N, int K, T ALPHA,
         "BLAS GEMM only supports non-transposed A/B in this wrapper.");
   }
 
-  int num_threads = std::thread::hardware_concurrency();
+  // Follow the thread count configured for the rest of the library
+  int num_threads = static_cast<int>(ThreadPool::global()->get_thread_count());
   openblas_set_num_threads(num_threads);
 
   // Build raw pointer buffers from your Tensor<T> objects
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <algorithm>
+
+#include "operations/channel_affine.hpp"
+#include "operations/cpu_dispatch.hpp"
+#include "utility/thread_pool.hpp"
+
+// Minimum number of elements per parallel chunk
+static constexpr size_t mml_channel_affine_grain = 16384;
+
+template <TensorConcept::Types T>
+static void mml_channel_affine(size_t batch, size_t channels, size_t spatial,
+                               const T *input, const T *scale, const T *shift,
+                               T *output) {
+  const size_t grain = std::max<size_t>(
+      1, mml_channel_affine_grain / std::max<size_t>(spatial, 1));
+  // Each plane is scaled and shifted by a loop built for the current tier
+  auto chunk = [&](size_t begin, size_t end) {
+    for (size_t plane = begin; plane < end; plane++) {
+      const T s = scale[plane % channels];
+      const T t = shift[plane % channels];
+      const T *in = input + plane * spatial;
+      T *out = output + plane * spatial;
+      for (size_t i = 0; i < spatial; i++) {
+        out[i] = in[i] * s + t;
+      }
+    }
+  };
+  parallel_for(0, batch * channels, grain, [&](size_t begin, size_t end) {
+    mml_dispatch_tier(chunk, begin, end);
+  });
+}
@@ -0,0 +1,99 @@
+#include "operations/cpu_dispatch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+// Current tier, -1 until it is first needed
+std::atomic<int> current_tier = -1;
+
+}  // namespace
+
+SimdTier CpuDispatch::detect_tier() {
+#if MML_X86_KERNELS
+  // Also checks that the OS saves the wider registers
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2") &&
+      __builtin_cpu_supports("fma")) {
+    return SimdTier::AVX512;
+  }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    return SimdTier::AVX2;
+  }
+#endif
+  return SimdTier::Scalar;
+}
+
+SimdTier CpuDispatch::get_tier() {
+  int tier = current_tier.load(std::memory_order_relaxed);
+  if (tier < 0) {
+    // Racing first calls all compute the same tier
+    tier = static_cast<int>(startup_tier());
+    current_tier.store(tier, std::memory_order_relaxed);
+  }
+  return static_cast<SimdTier>(tier);
+}
+
+void CpuDispatch::set_tier(SimdTier tier) {
+  if (tier > detect_tier()) {
+    throw std::invalid_argument("CpuDispatch: The CPU does not support " +
+                                tier_name(tier));
+  }
+  current_tier.store(static_cast<int>(tier), std::memory_order_relaxed);
+}
+
+void CpuDispatch::reset_tier() {
+  current_tier.store(static_cast<int>(startup_tier()),
+                     std::memory_order_relaxed);
+}
+
+std::string CpuDispatch::tier_name(SimdTier tier) {
+  switch (tier) {
+    case SimdTier::Scalar:
+      return "scalar";
+    case SimdTier::AVX2:
+      return "avx2";
+    case SimdTier::AVX512:
+      return "avx512";
+  }
+  throw std::invalid_argument("CpuDispatch: Unknown tier");
+}
+
+SimdTier CpuDispatch::parse_tier(const std::string &name) {
+  std::string lower = name;
+  std::transform(lower.begin(), lower.end(), lower.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  for (SimdTier tier : {SimdTier::Scalar, SimdTier::AVX2, SimdTier::AVX512}) {
+    if (lower == tier_name(tier)) {
+      return tier;
+    }
+  }
+  throw std::invalid_argument("CpuDispatch: Unknown tier " + name);
+}
+
+SimdTier CpuDispatch::startup_tier() {
+  SimdTier detected = detect_tier();
+  const char *requested = std::getenv("MML_SIMD_TIER");
+  if (!requested || !*requested) {
+    return detected;
+  }
+
+  try {
+    SimdTier tier = parse_tier(requested);
+    if (tier > detected) {
+      std::cerr << "MML_SIMD_TIER: The CPU does not support " << requested
+                << ", using " << tier_name(detected) << std::endl;
+      return detected;
+    }
+    return tier;
+  } catch (const std::invalid_argument &e) {
+    std::cerr << "MML_SIMD_TIER: " << e.what() << ", using "
+              << tier_name(detected) << std::endl;
+    return detected;
+  }
+}
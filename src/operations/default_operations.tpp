@@ -4,32 +4,97 @@
 #include "datastructures/tensor_concept.hpp"
 #include "operations/default_operations.hpp"
 
+// Minimum number of elements handled by one chunk of an elementwise kernel
+static constexpr size_t mml_parallel_grain = 16384;
+
+// Minimum number of multiply-adds handled by one tile of a GEMM kernel
+static constexpr size_t mml_gemm_min_tile_work = 32768;
+
+// Minimum number of columns of a GEMM tile when the columns are split
+static constexpr size_t mml_gemm_min_tile_cols = 64;
+
+/**
+ * Checks that kernels may loop over the data of all the tensors directly and
+ * that each holds at least size elements. Otherwise they take the indexed path,
+ * which reports out of range accesses.
+ */
+template <typename... Tensors>
+static bool mml_raw_access(size_t size, const Tensors&... tensors) {
+  return ((tensors->raw_access() && tensors->get_size() >= size) && ...);
+}
+
+/**
+ * Splits the M x N output of a GEMM in tiles computed in parallel. Rows are
+ * split first, the columns are only split as well when there are fewer rows
+ * than threads. tile_f is called with the row and column ranges of each tile
+ * and every output element belongs to exactly one tile.
+ */
+template <typename F>
+static void mml_gemm_parallel_tiles(int M, int N, int K, const F& tile_f) {
+  if (M <= 0 || N <= 0) return;
+  const size_t rows = static_cast<size_t>(M);
+  const size_t cols = static_cast<size_t>(N);
+  const size_t threads = ThreadPool::global()->get_thread_count();
+
+  size_t col_tiles = 1;
+  if (rows < threads) {
+    col_tiles = std::min((threads + rows - 1) / rows,
+                         (cols + mml_gemm_min_tile_cols - 1) /
+                             mml_gemm_min_tile_cols);
+    col_tiles = std::max<size_t>(col_tiles, 1);
+  }
+  const size_t tile_cols = (cols + col_tiles - 1) / col_tiles;
+  col_tiles = (cols + tile_cols - 1) / tile_cols;
+
+  const size_t row_work = tile_cols * static_cast<size_t>(std::max(K, 1));
+  const size_t grain = std::max<size_t>(1, mml_gemm_min_tile_work / row_work);
+
+  parallel_for(0, rows * col_tiles, grain, [&](size_t begin, size_t end) {
+    if (col_tiles == 1) {
+      // Whole rows, hand the chunk over as a single tile
+      tile_f(static_cast<int>(begin), static_cast<int>(end), 0, N);
+      return;
+    }
+    for (size_t tile = begin; tile < end; tile++) {
+      const size_t i = tile / col_tiles;
+      const size_t j_begin = (tile % col_tiles) * tile_cols;
+      const size_t j_end = std::min(j_begin + tile_cols, cols);
+      tile_f(static_cast<int>(i), static_cast<int>(i + 1),
+             static_cast<int>(j_begin), static_cast<int>(j_end));
+    }
+  });
+}
+
 template <TensorConcept::Types T>
 static void mml_gemm_inner_product(int TA, int TB, int M, int N, int K, T ALPHA,
                                    std::shared_ptr<Tensor<T>> A, int lda,
                                    std::shared_ptr<Tensor<T>> B, int ldb,
                                    T BETA, std::shared_ptr<Tensor<T>> C,
                                    int ldc) {
-  int k_col;
-  int i_col_out;
-
   if (TA == 1) A->transpose();
   if (TB == 1) B->transpose();
 
-  for (int i = 0; i < M; i++) {
-    i_col_out = i * ldc;
+  mml_gemm_parallel_tiles(M, N, K, [&](int i_begin, int i_end, int j_begin,
+                                       int j_end) {
+    int k_col;
+    int i_col_out;
 
-    for (int j = 0; j < N; j++) {
-      (*C)[i_col_out + j] = ((T)BETA) * (*C)[i_col_out + j];
-    }
-    for (int k = 0; k < K; k++) {
-      k_col = k * ldb;
+    for (int i = i_begin; i < i_end; i++) {
+      i_col_out = i * ldc;
+
+      for (int j = j_begin; j < j_end; j++) {
+        (*C)[i_col_out + j] = ((T)BETA) * (*C)[i_col_out + j];
+      }
+      for (int k = 0; k < K; k++) {
+        k_col = k * ldb;
 
-      for (int j = 0; j < N; j++) {
-        (*C)[i_col_out + j] += ((T)ALPHA) * (*A)[i * lda + k] * (*B)[k_col + j];
+        for (int j = j_begin; j < j_end; j++) {
+          (*C)[i_col_out + j] +=
+              ((T)ALPHA) * (*A)[i * lda + k] * (*B)[k_col + j];
+        }
       }
     }
-  }
+  });
 
   return;
 }
@@ -40,33 +105,37 @@ static void mml_gemm_outer_product(int TA, int TB, int M, int N, int K, T ALPHA,
                                    std::shared_ptr<Tensor<T>> B, int ldb,
                                    T BETA, std::shared_ptr<Tensor<T>> C,
                                    int ldc) {
-  int i_col;
-  int k_col;
-  int i_col_out;
-
   if (TA == 1) A->transpose();
   if (TB == 1) B->transpose();
 
-  for (int i = 0; i < M; i++) {
-    i_col_out = i * ldc;
+  mml_gemm_parallel_tiles(M, N, K, [&](int i_begin, int i_end, int j_begin,
+                                       int j_end) {
+    int i_col;
+    int k_col;
+    int i_col_out;
+
+    for (int i = i_begin; i < i_end; i++) {
+      i_col_out = i * ldc;
 
-    for (int j = 0; j < N; j++) {
-      (*C)[i_col_out + j] = ((T)BETA) * (*C)[i_col_out + j];
+      for (int j = j_begin; j < j_end; j++) {
+        (*C)[i_col_out + j] = ((T)BETA) * (*C)[i_col_out + j];
+      }
     }
-  }
 
-  for (int k = 0; k < K; k++) {
-    k_col = k * ldb;
+    for (int k = 0; k < K; k++) {
+      k_col = k * ldb;
 
-    for (int i = 0; i < M; i++) {
-      i_col = i * lda;
-      i_col_out = i * ldc;
+      for (int i = i_begin; i < i_end; i++) {
+        i_col = i * lda;
+        i_col_out = i * ldc;
 
-      for (int j = 0; j < N; j++) {
-        (*C)[i_col_out + j] += ((T)ALPHA) * (*A)[i_col + k] * (*B)[k_col + j];
+        for (int j = j_begin; j < j_end; j++) {
+          (*C)[i_col_out + j] +=
+              ((T)ALPHA) * (*A)[i_col + k] * (*B)[k_col + j];
+        }
       }
     }
-  }
+  });
 
   return;
 }
@@ -77,29 +146,33 @@ static void mml_gemm_row_wise_product(int TA, int TB, int M, int N, int K,
                                       int lda, std::shared_ptr<Tensor<T>> B,
                                       int ldb, T BETA,
                                       std::shared_ptr<Tensor<T>> C, int ldc) {
-  int i_col;
-  int k_col;
-  int i_col_out;
-
   if (TA == 1) A->transpose();
   if (TB == 1) B->transpose();
 
-  for (int i = 0; i < M; i++) {
-    i_col = i * lda;
-    i_col_out = i * ldc;
+  mml_gemm_parallel_tiles(M, N, K, [&](int i_begin, int i_end, int j_begin,
+                                       int j_end) {
+    int i_col;
+    int k_col;
+    int i_col_out;
 
-    for (int j = 0; j < N; j++) {
-      (*C)[i_col_out + j] = ((T)BETA) * (*C)[i_col_out + j];
-    }
+    for (int i = i_begin; i < i_end; i++) {
+      i_col = i * lda;
+      i_col_out = i * ldc;
 
-    for (int k = 0; k < K; k++) {
-      k_col = k * ldb;
+      for (int j = j_begin; j < j_end; j++) {
+        (*C)[i_col_out + j] = ((T)BETA) * (*C)[i_col_out + j];
+      }
+
+      for (int k = 0; k < K; k++) {
+        k_col = k * ldb;
 
-      for (int j = 0; j < N; j++) {
-        (*C)[i_col_out + j] += ((T)ALPHA) * (*A)[i_col + k] * (*B)[k_col + j];
+        for (int j = j_begin; j < j_end; j++) {
+          (*C)[i_col_out + j] +=
+              ((T)ALPHA) * (*A)[i_col + k] * (*B)[k_col + j];
+        }
       }
     }
-  }
+  });
 
   return;
 }
@@ -110,29 +183,33 @@ static void mml_gemm_col_wise_product(int TA, int TB, int M, int N, int K,
                                       int lda, std::shared_ptr<Tensor<T>> B,
                                       int ldb, T BETA,
                                       std::shared_ptr<Tensor<T>> C, int ldc) {
-  int i_col;
-  int k_col;
-  int i_col_out;
-
   if (TA == 1) A->transpose();
   if (TB == 1) B->transpose();
 
-  for (int j = 0; j < N; j++) {
-    for (int i = 0; i < M; i++) {
-      i_col_out = i * ldc;
-      (*C)[i_col_out + j] = ((T)BETA) * (*C)[i_col_out + j];
-    }
-
-    for (int k = 0; k < K; k++) {
-      k_col = k * ldb;
+  mml_gemm_parallel_tiles(M, N, K, [&](int i_begin, int i_end, int j_begin,
+                                       int j_end) {
+    int i_col;
+    int k_col;
+    int i_col_out;
 
-      for (int i = 0; i < M; i++) {
-        i_col = i * lda;
+    for (int j = j_begin; j < j_end; j++) {
+      for (int i = i_begin; i < i_end; i++) {
         i_col_out = i * ldc;
-        (*C)[i_col_out + j] += ((T)ALPHA) * (*A)[i_col + k] * (*B)[k_col + j];
+        (*C)[i_col_out + j] = ((T)BETA) * (*C)[i_col_out + j];
+      }
+
+      for (int k = 0; k < K; k++) {
+        k_col = k * ldb;
+
+        for (int i = i_begin; i < i_end; i++) {
+          i_col = i * lda;
+          i_col_out = i * ldc;
+          (*C)[i_col_out + j] +=
+              ((T)ALPHA) * (*A)[i_col + k] * (*B)[k_col + j];
+        }
       }
     }
-  }
+  });
 
   return;
 }
@@ -145,32 +222,30 @@ static void mml_gemm_blocked(int TA, int TB, int M, int N, int K, T ALPHA,
   int block_size = 64;  // This depends on the CPU architecture - We can look
                         // into having the size of this be dynamically fetched
   if (!TA && !TB) {
-    int i;
-    int j;
-    int jj;
-    int k;
-    int kk;
-    int i_col;
-    int k_col;
-    int i_col_out;
-
-    for (jj = 0; jj < N; jj += block_size) {
-      for (kk = 0; kk < K; kk += block_size) {
-        for (i = 0; i < M; i++) {
-          i_col = i * lda;
-          i_col_out = i * ldc;
-          for (int j = jj; j < std::min(jj + block_size, N); j++) {
-            T acc =
-                (kk == 0 ? BETA * (*C)[i_col_out + j] : (*C)[i_col_out + j]);
-            for (int k = kk; k < std::min(kk + block_size, K); k++) {
-              k_col = k * ldb;
-              acc += ALPHA * (*A)[i_col + k] * (*B)[k_col + j];
+    mml_gemm_parallel_tiles(M, N, K, [&](int i_begin, int i_end, int j_begin,
+                                         int j_end) {
+      int i_col;
+      int k_col;
+      int i_col_out;
+
+      for (int jj = j_begin; jj < j_end; jj += block_size) {
+        for (int kk = 0; kk < K; kk += block_size) {
+          for (int i = i_begin; i < i_end; i++) {
+            i_col = i * lda;
+            i_col_out = i * ldc;
+            for (int j = jj; j < std::min(jj + block_size, j_end); j++) {
+              T acc = (kk == 0 ? BETA * (*C)[i_col_out + j]
+                               : (*C)[i_col_out + j]);
+              for (int k = kk; k < std::min(kk + block_size, K); k++) {
+                k_col = k * ldb;
+                acc += ALPHA * (*A)[i_col + k] * (*B)[k_col + j];
+              }
+              (*C)[i_col_out + j] = acc;
             }
-            (*C)[i_col_out + j] = acc;
           }
         }
       }
-    }
+    });
   } else if (TA && !TB) {
     throw std::invalid_argument(
         "Transposition not yet supported in GEMM blocked.");
@@ -363,29 +438,84 @@ template <TensorConcept::Types T>
 static void mml_add(const std::shared_ptr<const Tensor<T>> a,
                     const std::shared_ptr<const Tensor<T>> b,
                     std::shared_ptr<Tensor<T>> c) {
-  const auto size = a->get_size();
-  for (size_t i = 0; i < size; i++) {
-    (*c)[i] = (*a)[i] + (*b)[i];
+  const size_t size = a->get_size();
+  if (mml_raw_access(size, a, b, c)) {
+    const T* a_data = a->data();
+    const T* b_data = b->data();
+    T* c_data = c->data();
+    parallel_for(0, size, mml_parallel_grain, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        c_data[i] = a_data[i] + b_data[i];
+      }
+    });
+    return;
   }
+
+  // Views, broadcast ones included, are walked through their strides
+  if (a->get_shape() == c->get_shape() && b->get_shape() == c->get_shape()) {
+    mml_map_binary<T>(
+        a, b, [](T x, T y) { return static_cast<T>(x + y); }, c);
+    return;
+  }
+
+  parallel_for(0, size, mml_parallel_grain, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      (*c)[i] = (*a)[i] + (*b)[i];
+    }
+  });
 }
 
 template <TensorConcept::Types T>
 static void mml_subtract(const std::shared_ptr<Tensor<T>> a,
                          const std::shared_ptr<Tensor<T>> b,
                          std::shared_ptr<Tensor<T>> c) {
-  const auto size = a->get_size();
-  for (size_t i = 0; i < size; i++) {
-    (*c)[i] = (*a)[i] - (*b)[i];
+  const size_t size = a->get_size();
+  if (mml_raw_access(size, a, b, c)) {
+    const T* a_data = a->data();
+    const T* b_data = b->data();
+    T* c_data = c->data();
+    parallel_for(0, size, mml_parallel_grain, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        c_data[i] = a_data[i] - b_data[i];
+      }
+    });
+    return;
+  }
+
+  // Views, broadcast ones included, are walked through their strides
+  if (a->get_shape() == c->get_shape() && b->get_shape() == c->get_shape()) {
+    mml_map_binary<T>(
+        a, b, [](T x, T y) { return static_cast<T>(x - y); }, c);
+    return;
   }
+
+  parallel_for(0, size, mml_parallel_grain, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      (*c)[i] = (*a)[i] - (*b)[i];
+    }
+  });
 }
 
 template <TensorConcept::Types T>
 static void mml_multiply(const std::shared_ptr<Tensor<T>> a, const T b,
                          std::shared_ptr<Tensor<T>> c) {
-  const auto size = a->get_size();
-  for (size_t i = 0; i < size; i++) {
-    (*c)[i] = (*a)[i] * b;
+  const size_t size = a->get_size();
+  if (mml_raw_access(size, a, c)) {
+    const T* a_data = a->data();
+    T* c_data = c->data();
+    parallel_for(0, size, mml_parallel_grain, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        c_data[i] = a_data[i] * b;
+      }
+    });
+    return;
   }
+
+  parallel_for(0, size, mml_parallel_grain, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      (*c)[i] = (*a)[i] * b;
+    }
+  });
 }
 
 template <TensorConcept::Types T>
@@ -395,6 +525,9 @@ static bool mml_equals(const std::shared_ptr<Tensor<T>> a,
     return false;
   } else {
     const auto size = a->get_size();
+    if (mml_raw_access(size, a, b)) {
+      return std::equal(a->data(), a->data() + size, b->data());
+    }
     for (size_t i = 0; i < size; i++) {
       if ((*a)[i] != (*b)[i]) {
         return false;
@@ -408,56 +541,13 @@ template <TensorConcept::Types T>
 static void mml_elementwise(const std::shared_ptr<const Tensor<T>> a,
                             const std::function<T(T)>& f,
                             const std::shared_ptr<Tensor<T>> c) {
-  const auto shape = a->get_shape();
-  const auto num_dimensions = shape.size();
-
-  array_mml<size_t> indices(num_dimensions);
-  for (size_t i = 0; i < num_dimensions; ++i) {
-    indices[i] = 0;
-  }
-  const auto total_elements = a->get_size();
-
-  for (size_t linear_idx = 0; linear_idx < total_elements; ++linear_idx) {
-    // Apply std::function `f` from `a` to `c`
-    (*c)[indices] = f((*a)[indices]);
-
-    // Increment indices
-    size_t d = num_dimensions - 1;
-    do {
-      if (++indices[d] < shape[d]) {
-        break;  // No carry needed, continue iteration
-      }
-      indices[d] = 0;  // Carry over to the next dimension
-    } while (d-- > 0);
-  }
+  mml_map<T>(a, f, c);
 }
 
 template <TensorConcept::Types T>
 static void mml_elementwise_in_place(const std::shared_ptr<Tensor<T>> a,
                                      const std::function<T(T)>& f) {
-  const auto shape = a->get_shape();
-  const auto num_dimensions = shape.size();
-
-  array_mml<size_t> indices(num_dimensions);
-  for (size_t i = 0; i < num_dimensions; ++i) {
-    indices[i] = 0;
-  }
-
-  const auto total_elements = a->get_size();
-
-  for (size_t linear_idx = 0; linear_idx < total_elements; ++linear_idx) {
-    // Apply the std::function `f` to the current element
-    (*a)[indices] = f((*a)[indices]);
-
-    // Increment indices like a multi-dimensional counter
-    size_t d = num_dimensions - 1;
-    do {
-      if (++indices[d] < shape[d]) {
-        break;  // No carry needed, continue iteration
-      }
-      indices[d] = 0;  // Carry over to the next dimension
-    } while (d-- > 0);
-  }
+  mml_map_in_place<T>(a, f);
 }
 
 template <TensorConcept::Types T>
@@ -469,13 +559,26 @@ static int mml_arg_max(const std::shared_ptr<const Tensor<T>> a) {
 
   T max_value = (*a)[0];
   int max_index = 0;
+  std::mutex max_mutex;
+
+  parallel_for(0, size, mml_parallel_grain, [&](size_t begin, size_t end) {
+    T chunk_max = (*a)[begin];
+    int chunk_index = static_cast<int>(begin);
+    for (int i = static_cast<int>(begin) + 1; i < static_cast<int>(end); ++i) {
+      if ((*a)[i] > chunk_max) {
+        chunk_max = (*a)[i];
+        chunk_index = i;
+      }
+    }
 
-  for (int i = 1; i < static_cast<int>(size); ++i) {
-    if ((*a)[i] > max_value) {
-      max_value = (*a)[i];
-      max_index = i;
+    // Keep the first index of the maximum, whatever order chunks finish in
+    std::lock_guard<std::mutex> lock(max_mutex);
+    if (chunk_max > max_value ||
+        (chunk_max == max_value && chunk_index < max_index)) {
+      max_value = chunk_max;
+      max_index = chunk_index;
     }
-  }
+  });
 
   return max_index;
 }
@@ -491,56 +594,73 @@ static void mml_sliding_window(
   size_t total_rank = in_shape.size();
   size_t spatial_rank = kernel_shape.size();
 
-  std::vector<size_t> out_idx(total_rank, 0);
-
-  std::function<void(size_t)> recurse = [&](size_t dim) {
-    if (dim == total_rank) {  // Depth reached
-
-      std::vector<std::vector<size_t>> window_in_idx;
-      std::vector<int> kernel_pos(spatial_rank, 0);
-
-      std::function<void(size_t)> kernel_recurse = [&](size_t kdim) {
-        if (kdim == spatial_rank) {  // Depth reached
-          bool valid = true;
-          std::vector<size_t> in_idx(total_rank, 0);
-          in_idx[0] = out_idx[0];  // Batch
-          in_idx[1] = out_idx[1];  // Channel
-
-          for (size_t i = 0; i < spatial_rank; ++i) {
-            int out_coord = static_cast<int>(out_idx[i + 2]);
-            int start = out_coord * strides[i] - pads[i].first;
-            int offset = kernel_pos[i] * dilations[i];
-            int pos = start + offset;
+  // Every (batch, channel) plane of the output is independent
+  size_t plane_count = out_shape[0] * out_shape[1];
+  size_t plane_work = 1;
+  for (size_t dim = 2; dim < total_rank; ++dim) {
+    plane_work *= out_shape[dim];
+  }
+  for (int k : kernel_shape) {
+    plane_work *= static_cast<size_t>(std::max(k, 1));
+  }
+  size_t grain = std::max<size_t>(1, mml_parallel_grain / plane_work);
+
+  parallel_for(0, plane_count, grain, [&](size_t begin, size_t end) {
+    std::vector<size_t> out_idx(total_rank, 0);
+
+    std::function<void(size_t)> recurse = [&](size_t dim) {
+      if (dim == total_rank) {  // Depth reached
+
+        std::vector<std::vector<size_t>> window_in_idx;
+        std::vector<int> kernel_pos(spatial_rank, 0);
+
+        std::function<void(size_t)> kernel_recurse = [&](size_t kdim) {
+          if (kdim == spatial_rank) {  // Depth reached
+            bool valid = true;
+            std::vector<size_t> in_idx(total_rank, 0);
+            in_idx[0] = out_idx[0];  // Batch
+            in_idx[1] = out_idx[1];  // Channel
+
+            for (size_t i = 0; i < spatial_rank; ++i) {
+              int out_coord = static_cast<int>(out_idx[i + 2]);
+              int start = out_coord * strides[i] - pads[i].first;
+              int offset = kernel_pos[i] * dilations[i];
+              int pos = start + offset;
+
+              if (pos < 0 || pos >= static_cast<int>(in_shape[i + 2])) {
+                valid = false;
+                break;
+              }
+              in_idx[i + 2] = static_cast<size_t>(pos);
+            }
 
-            if (pos < 0 || pos >= static_cast<int>(in_shape[i + 2])) {
-              valid = false;
-              break;
+            if (valid) {
+              window_in_idx.push_back(in_idx);
             }
-            in_idx[i + 2] = static_cast<size_t>(pos);
+            return;
           }
 
-          if (valid) {
-            window_in_idx.push_back(in_idx);
+          for (int k = 0; k < kernel_shape[kdim]; ++k) {
+            kernel_pos[kdim] = k;
+            kernel_recurse(kdim + 1);
           }
-          return;
-        }
+        };
+        kernel_recurse(0);
 
-        for (int k = 0; k < kernel_shape[kdim]; ++k) {
-          kernel_pos[kdim] = k;
-          kernel_recurse(kdim + 1);
-        }
-      };
-      kernel_recurse(0);
+        window_f(window_in_idx, out_idx);
+        return;
+      }
 
-      window_f(window_in_idx, out_idx);
-      return;
-    }
+      for (size_t i = 0; i < out_shape[dim]; ++i) {
+        out_idx[dim] = i;
+        recurse(dim + 1);
+      }
+    };
 
-    for (size_t i = 0; i < out_shape[dim]; ++i) {
-      out_idx[dim] = i;
-      recurse(dim + 1);
+    for (size_t plane = begin; plane < end; ++plane) {
+      out_idx[0] = plane / out_shape[1];  // Batch
+      out_idx[1] = plane % out_shape[1];  // Channel
+      recurse(2);
     }
-  };
-
-  recurse(0);
+  });
 }
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <algorithm>
+
+#include "operations/depthwise_conv.hpp"
+#include "utility/thread_pool.hpp"
+
+// Minimum number of output elements per parallel chunk
+static constexpr size_t mml_depthwise_grain = 4096;
+
+template <TensorConcept::Types T>
+static void mml_depthwise_conv(const DepthwiseConvShape &shape, const T *input,
+                               const T *weights, const T *bias,
+                               const Activation &activation, T *output) {
+  const size_t out_channels = shape.channels * shape.multiplier;
+  const size_t kernel_size = shape.kernel_height * shape.kernel_width;
+  const size_t rows = shape.batch * out_channels * shape.out_height;
+  const ptrdiff_t height = static_cast<ptrdiff_t>(shape.height);
+  const ptrdiff_t width = static_cast<ptrdiff_t>(shape.width);
+  const ptrdiff_t stride_width = static_cast<ptrdiff_t>(shape.stride_width);
+  const size_t grain = std::max<size_t>(
+      1, mml_depthwise_grain / std::max<size_t>(shape.out_width, 1));
+
+  parallel_for(0, rows, grain, [&](size_t begin, size_t end) {
+    for (size_t row = begin; row < end; row++) {
+      const size_t oh = row % shape.out_height;
+      const size_t image_channel = row / shape.out_height;
+      const size_t n = image_channel / out_channels;
+      const size_t k = image_channel % out_channels;
+      const T *plane =
+          input + (n * shape.channels + k / shape.multiplier) * shape.height *
+                      shape.width;
+      const T *kernel = weights + k * kernel_size;
+      T *out = output + row * shape.out_width;
+      std::fill(out, out + shape.out_width, T(0));
+
+      for (size_t kh = 0; kh < shape.kernel_height; kh++) {
+        const ptrdiff_t ih =
+            static_cast<ptrdiff_t>(oh * shape.stride_height +
+                                   kh * shape.dilation_height) -
+            static_cast<ptrdiff_t>(shape.pad_top);
+        if (ih < 0 || ih >= height) {
+          continue;  // Padding row
+        }
+        const T *in = plane + ih * width;
+
+        for (size_t kw = 0; kw < shape.kernel_width; kw++) {
+          const T weight = kernel[kh * shape.kernel_width + kw];
+          // Input column of output column ow is ow * stride_width + offset,
+          // the output columns [ow_begin, ow_end) read inside the input
+          const ptrdiff_t offset =
+              static_cast<ptrdiff_t>(kw * shape.dilation_width) -
+              static_cast<ptrdiff_t>(shape.pad_left);
+          const ptrdiff_t ow_begin =
+              offset >= 0 ? 0 : (-offset + stride_width - 1) / stride_width;
+          const ptrdiff_t ow_end = std::min<ptrdiff_t>(
+              static_cast<ptrdiff_t>(shape.out_width),
+              width <= offset ? 0 : (width - 1 - offset) / stride_width + 1);
+
+          if (stride_width == 1) {
+            const T *src = in + (ow_begin + offset);
+            T *dst = out + ow_begin;
+            for (ptrdiff_t i = 0; i < ow_end - ow_begin; i++) {
+              dst[i] += weight * src[i];
+            }
+          } else {
+            for (ptrdiff_t ow = ow_begin; ow < ow_end; ow++) {
+              out[ow] += weight * in[ow * stride_width + offset];
+            }
+          }
+        }
+      }
+      mml_bias_activate(activation, bias ? bias[k] : T(0), out,
+                        shape.out_width);
+    }
+  });
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <algorithm>
+// IWYU pragma: no_include <__vector/vector.h>
+#include <vector>  // IWYU pragma: keep
+
+#include "datastructures/mml_array.hpp"
+#include "operations/cpu_dispatch.hpp"
+#include "operations/elementwise.hpp"
+#include "utility/thread_pool.hpp"
+
+// Minimum number of elements per parallel chunk
+static constexpr size_t mml_map_grain = 16384;
+
+/**
+ * Maps the elements of a into c, both laid out with their own strides over
+ * the given shape. Every chunk finds the offsets of its first element once,
+ * then maps whole runs of the last dimension and carries into the outer
+ * dimensions at the end of each run.
+ */
+template <typename T, typename F>
+static void mml_map_strided(const array_mml<size_t> &shape, const T *a,
+                            const array_mml<size_t> &a_strides, T *c,
+                            const array_mml<size_t> &c_strides, F &f) {
+  const size_t rank = shape.size();
+  if (rank == 0) {
+    c[0] = f(a[0]);
+    return;
+  }
+  size_t size = 1;
+  for (size_t d = 0; d < rank; d++) {
+    size *= shape[d];
+  }
+  const size_t width = shape[rank - 1];
+  const size_t a_step = a_strides[rank - 1];
+  const size_t c_step = c_strides[rank - 1];
+
+  // The runs are mapped by loops built for the current SIMD tier
+  auto chunk = [&](size_t begin, size_t end) {
+    std::vector<size_t> index(rank);
+    size_t a_offset = 0;
+    size_t c_offset = 0;
+    size_t remaining = begin;
+    for (size_t d = rank; d-- > 0;) {
+      index[d] = remaining % shape[d];
+      remaining /= shape[d];
+      a_offset += index[d] * a_strides[d];
+      c_offset += index[d] * c_strides[d];
+    }
+
+    for (size_t i = begin; i < end;) {
+      const size_t run = std::min(width - index[rank - 1], end - i);
+      const T *in = a + a_offset;
+      T *out = c + c_offset;
+      if (a_step == 1 && c_step == 1) {
+        for (size_t j = 0; j < run; j++) {
+          out[j] = f(in[j]);
+        }
+      } else {
+        for (size_t j = 0; j < run; j++) {
+          out[j * c_step] = f(in[j * a_step]);
+        }
+      }
+      i += run;
+
+      // Unsigned offsets wrap while carrying, their final values are exact
+      a_offset += run * a_step;
+      c_offset += run * c_step;
+      index[rank - 1] += run;
+      for (size_t d = rank - 1; d > 0 && index[d] == shape[d]; d--) {
+        a_offset += a_strides[d - 1] - shape[d] * a_strides[d];
+        c_offset += c_strides[d - 1] - shape[d] * c_strides[d];
+        index[d] = 0;
+        index[d - 1]++;
+      }
+    }
+  };
+  parallel_for(0, size, mml_map_grain, [&](size_t begin, size_t end) {
+    mml_dispatch_tier(chunk, begin, end);
+  });
+}
+
+template <TensorConcept::Types T, typename F>
+static void mml_map(const std::shared_ptr<const Tensor<T>> a, F f,
+                    const std::shared_ptr<Tensor<T>> c) {
+  const size_t size = a->get_size();
+  if (a->raw_access() && c->raw_access() && c->get_size() >= size) {
+    const T *a_data = a->data();
+    T *c_data = c->data();
+    // f is inlined into a loop built for the current SIMD tier
+    auto chunk = [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        c_data[i] = f(a_data[i]);
+      }
+    };
+    parallel_for(0, size, mml_map_grain, [&](size_t begin, size_t end) {
+      mml_dispatch_tier(chunk, begin, end);
+    });
+    return;
+  }
+
+#ifndef MML_CHECKED_ACCESS
+  if (a->get_shape() == c->get_shape()) {
+    mml_map_strided(a->get_shape(), a->data(), a->get_strides(), c->data(),
+                    c->get_strides(), f);
+    return;
+  }
+#endif
+
+  // Checked builds go through the bounds checked indexed access
+  parallel_for(0, size, mml_map_grain, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      (*c)[i] = f((*a)[i]);
+    }
+  });
+}
+
+template <TensorConcept::Types T, typename F>
+static void mml_map_in_place(const std::shared_ptr<Tensor<T>> a, F f) {
+  mml_map<T>(a, f, a);
+}
@@ -0,0 +1,516 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include "datastructures/mml_array.hpp"
+#include "datastructures/tensor_factory.hpp"
+#include "operations/cpu_dispatch.hpp"
+#include "operations/nchwc.hpp"
+#include "utility/thread_pool.hpp"
+
+#if MML_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+// Minimum number of elements reordered, padded or pooled per parallel chunk
+static constexpr size_t mml_nchwc_grain = 16384;
+
+// Output channel blocks of the register tile of the convolution kernels
+static constexpr int mml_nchwc_tile_blocks = 2;
+
+// Output columns of the register tile of the convolution kernels, so that the
+// accumulators and the weights of a tile fit in the registers
+static constexpr int mml_nchwc_tile_width_avx2 = 6;
+static constexpr int mml_nchwc_tile_width_avx512 = 12;
+static constexpr int mml_nchwc_tile_width_scalar = 8;
+
+/**
+ * Sizes and strides, in elements, of the operands of a convolution tile.
+ */
+struct mml_nchwc_tile_strides {
+  size_t in_blocks;            // Input channel blocks
+  size_t kernel_height;        // Kernel height
+  size_t kernel_width;         // Kernel width
+  size_t in_block_stride;      // Between two input channel blocks
+  size_t kh_stride;            // Between the input rows of two kernel rows
+  size_t kw_stride;            // Between the input pixels of two kernel columns
+  size_t ow_stride;            // Between the input pixels of two output columns
+  size_t weight_block_stride;  // Between the weights of two output blocks
+  size_t out_block_stride;     // Between two output channel blocks
+};
+
+template <TensorConcept::Types T>
+static size_t mml_nchwc_block() {
+  if constexpr (std::is_same_v<T, float>) {
+    if (CpuDispatch::get_tier() == SimdTier::AVX512) {
+      return 16;
+    }
+  }
+  return 8;
+}
+
+template <TensorConcept::Types T>
+static void mml_nchw_to_nchwc(size_t block, size_t batch, size_t channels,
+                              size_t spatial, const T *input, T *output) {
+  const size_t blocks = channels / block;
+  const size_t grain =
+      std::max<size_t>(1, mml_nchwc_grain / std::max<size_t>(spatial, 1));
+  parallel_for(0, batch * blocks, grain, [&](size_t begin, size_t end) {
+    for (size_t plane = begin; plane < end; plane++) {
+      const size_t n = plane / blocks;
+      const size_t cb = plane % blocks;
+      const T *src = input + (n * channels + cb * block) * spatial;
+      T *dst = output + plane * spatial * block;
+      for (size_t s = 0; s < spatial; s++) {
+        for (size_t j = 0; j < block; j++) {
+          dst[s * block + j] = src[j * spatial + s];
+        }
+      }
+    }
+  });
+}
+
+template <TensorConcept::Types T>
+static void mml_nchwc_to_nchw(size_t block, size_t batch, size_t channels,
+                              size_t spatial, const T *input, T *output) {
+  const size_t blocks = channels / block;
+  const size_t grain =
+      std::max<size_t>(1, mml_nchwc_grain / std::max<size_t>(spatial, 1));
+  parallel_for(0, batch * blocks, grain, [&](size_t begin, size_t end) {
+    for (size_t plane = begin; plane < end; plane++) {
+      const size_t n = plane / blocks;
+      const size_t cb = plane % blocks;
+      const T *src = input + plane * spatial * block;
+      T *dst = output + (n * channels + cb * block) * spatial;
+      for (size_t j = 0; j < block; j++) {
+        for (size_t s = 0; s < spatial; s++) {
+          dst[j * spatial + s] = src[s * block + j];
+        }
+      }
+    }
+  });
+}
+
+template <TensorConcept::Types T>
+static std::shared_ptr<Tensor<T>> mml_nchwc_conv_weights(
+    size_t block, const std::shared_ptr<Tensor<T>> &weights) {
+  const auto &shape = weights->get_shape();
+  const size_t out_channels = shape[0];
+  const size_t channels = shape[1];
+  const size_t kernel_size = shape[2] * shape[3];
+  auto values = weights->is_contiguous() ? weights : weights->contiguous();
+  const T *src = values->span().data();
+
+  auto reordered = TensorFactory::create_tensor<T>(
+      {out_channels / block, channels / block, shape[2], shape[3], block,
+       block});
+  T *dst = reordered->data();
+  for (size_t ob = 0; ob < out_channels / block; ob++) {
+    for (size_t ib = 0; ib < channels / block; ib++) {
+      for (size_t k = 0; k < kernel_size; k++) {
+        for (size_t i = 0; i < block; i++) {
+          for (size_t o = 0; o < block; o++) {
+            *dst++ = src[((ob * block + o) * channels + ib * block + i) *
+                             kernel_size +
+                         k];
+          }
+        }
+      }
+    }
+  }
+  return reordered;
+}
+
+/**
+ * Computes blocks output channel blocks of width consecutive output pixels.
+ * Portable kernel for any element type and block, accumulating in the output.
+ */
+template <typename T>
+static void mml_nchwc_conv_tile_scalar(size_t block, int blocks, int width,
+                                       const mml_nchwc_tile_strides &s,
+                                       const T *input, const T *weights,
+                                       const T *bias, T *output) {
+  for (int o = 0; o < blocks; o++) {
+    for (int r = 0; r < width; r++) {
+      T *out = output + o * s.out_block_stride + r * block;
+      for (size_t j = 0; j < block; j++) {
+        out[j] = bias ? bias[o * block + j] : T(0);
+      }
+    }
+  }
+
+  for (size_t icb = 0; icb < s.in_blocks; icb++) {
+    for (size_t kh = 0; kh < s.kernel_height; kh++) {
+      for (size_t kw = 0; kw < s.kernel_width; kw++) {
+        const T *in = input + icb * s.in_block_stride + kh * s.kh_stride +
+                      kw * s.kw_stride;
+        const T *w =
+            weights +
+            ((icb * s.kernel_height + kh) * s.kernel_width + kw) * block *
+                block;
+        for (int o = 0; o < blocks; o++) {
+          for (int r = 0; r < width; r++) {
+            const T *x = in + r * s.ow_stride;
+            T *out = output + o * s.out_block_stride + r * block;
+            for (size_t i = 0; i < block; i++) {
+              const T x_i = x[i];
+              const T *w_i = w + o * s.weight_block_stride + i * block;
+              for (size_t j = 0; j < block; j++) {
+                out[j] += x_i * w_i[j];
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+#if MML_X86_KERNELS
+/**
+ * AVX2 kernel for float and a block of 8, every output pixel of a block is
+ * one register. Each input value is broadcast once and multiplied with the
+ * weights of all the blocks.
+ */
+template <int BLOCKS, int WIDTH>
+MML_TARGET_AVX2 static void mml_nchwc_conv_tile_avx2(
+    const mml_nchwc_tile_strides &s, const float *input, const float *weights,
+    const float *bias, float *output) {
+  constexpr int lanes = 8;
+  __m256 acc[BLOCKS][WIDTH];
+  for (int o = 0; o < BLOCKS; o++) {
+    const __m256 start =
+        bias ? _mm256_loadu_ps(bias + o * lanes) : _mm256_setzero_ps();
+    for (int r = 0; r < WIDTH; r++) {
+      acc[o][r] = start;
+    }
+  }
+
+  for (size_t icb = 0; icb < s.in_blocks; icb++) {
+    for (size_t kh = 0; kh < s.kernel_height; kh++) {
+      for (size_t kw = 0; kw < s.kernel_width; kw++) {
+        const float *in = input + icb * s.in_block_stride + kh * s.kh_stride +
+                          kw * s.kw_stride;
+        const float *w =
+            weights +
+            ((icb * s.kernel_height + kh) * s.kernel_width + kw) * lanes *
+                lanes;
+        for (int i = 0; i < lanes; i++) {
+          __m256 w_row[BLOCKS];
+          for (int o = 0; o < BLOCKS; o++) {
+            w_row[o] = _mm256_loadu_ps(w + o * s.weight_block_stride +
+                                       i * lanes);
+          }
+          for (int r = 0; r < WIDTH; r++) {
+            const __m256 x = _mm256_broadcast_ss(in + r * s.ow_stride + i);
+            for (int o = 0; o < BLOCKS; o++) {
+              acc[o][r] = _mm256_fmadd_ps(x, w_row[o], acc[o][r]);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  for (int o = 0; o < BLOCKS; o++) {
+    for (int r = 0; r < WIDTH; r++) {
+      _mm256_storeu_ps(output + o * s.out_block_stride + r * lanes, acc[o][r]);
+    }
+  }
+}
+
+/**
+ * AVX-512 kernel for float and a block of 16, the AVX2 kernel with registers
+ * twice as wide.
+ */
+template <int BLOCKS, int WIDTH>
+MML_TARGET_AVX512 static void mml_nchwc_conv_tile_avx512(
+    const mml_nchwc_tile_strides &s, const float *input, const float *weights,
+    const float *bias, float *output) {
+  constexpr int lanes = 16;
+  __m512 acc[BLOCKS][WIDTH];
+  for (int o = 0; o < BLOCKS; o++) {
+    const __m512 start =
+        bias ? _mm512_loadu_ps(bias + o * lanes) : _mm512_setzero_ps();
+    for (int r = 0; r < WIDTH; r++) {
+      acc[o][r] = start;
+    }
+  }
+
+  for (size_t icb = 0; icb < s.in_blocks; icb++) {
+    for (size_t kh = 0; kh < s.kernel_height; kh++) {
+      for (size_t kw = 0; kw < s.kernel_width; kw++) {
+        const float *in = input + icb * s.in_block_stride + kh * s.kh_stride +
+                          kw * s.kw_stride;
+        const float *w =
+            weights +
+            ((icb * s.kernel_height + kh) * s.kernel_width + kw) * lanes *
+                lanes;
+        for (int i = 0; i < lanes; i++) {
+          __m512 w_row[BLOCKS];
+          for (int o = 0; o < BLOCKS; o++) {
+            w_row[o] = _mm512_loadu_ps(w + o * s.weight_block_stride +
+                                       i * lanes);
+          }
+          for (int r = 0; r < WIDTH; r++) {
+            const __m512 x = _mm512_set1_ps(in[r * s.ow_stride + i]);
+            for (int o = 0; o < BLOCKS; o++) {
+              acc[o][r] = _mm512_fmadd_ps(x, w_row[o], acc[o][r]);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  for (int o = 0; o < BLOCKS; o++) {
+    for (int r = 0; r < WIDTH; r++) {
+      _mm512_storeu_ps(output + o * s.out_block_stride + r * lanes, acc[o][r]);
+    }
+  }
+}
+
+// A convolution tile kernel for float
+using mml_nchwc_tile_kernel = void (*)(const mml_nchwc_tile_strides &,
+                                       const float *, const float *,
+                                       const float *, float *);
+
+/**
+ * Gets the kernels of the tiles of 1 to WIDTH columns, for the last tile of a
+ * row which may be narrower.
+ */
+template <int BLOCKS, bool AVX512, size_t... WIDTH>
+static constexpr std::array<mml_nchwc_tile_kernel, sizeof...(WIDTH)>
+mml_nchwc_tile_kernels(std::index_sequence<WIDTH...>) {
+  if constexpr (AVX512) {
+    return {&mml_nchwc_conv_tile_avx512<BLOCKS, WIDTH + 1>...};
+  } else {
+    return {&mml_nchwc_conv_tile_avx2<BLOCKS, WIDTH + 1>...};
+  }
+}
+#endif
+
+template <TensorConcept::Types T>
+static void mml_nchwc_conv(size_t block, const NchwcConvShape &shape,
+                           const T *input, const T *weights, const T *bias,
+                           const Activation &activation, T *output) {
+  const size_t in_blocks = shape.channels / block;
+  const size_t out_blocks = shape.out_channels / block;
+  if (shape.batch == 0 || out_blocks == 0 || shape.out_height == 0 ||
+      shape.out_width == 0) {
+    return;
+  }
+
+  // Extent of the padded input the output reads
+  const size_t padded_height =
+      (shape.out_height - 1) * shape.stride_height +
+      (shape.kernel_height - 1) * shape.dilation_height + 1;
+  const size_t padded_width = (shape.out_width - 1) * shape.stride_width +
+                              (shape.kernel_width - 1) * shape.dilation_width +
+                              1;
+
+  // The kernels never test for padding, the input is copied into a zero
+  // padded one unless the output only reads inside it
+  array_mml<T> padded;
+  const T *source = input;
+  size_t source_height = shape.height;
+  size_t source_width = shape.width;
+  if (shape.pad_top > 0 || shape.pad_left > 0 ||
+      padded_height > shape.height || padded_width > shape.width) {
+    padded = array_mml<T>(shape.batch * in_blocks * padded_height *
+                          padded_width * block);
+    const size_t left = std::min(shape.pad_left, padded_width);
+    const size_t copied = std::min(shape.width, padded_width - left);
+    const size_t rows = shape.batch * in_blocks * padded_height;
+    const size_t grain = std::max<size_t>(
+        1, mml_nchwc_grain / std::max<size_t>(padded_width * block, 1));
+    parallel_for(0, rows, grain, [&](size_t begin, size_t end) {
+      for (size_t row = begin; row < end; row++) {
+        const size_t plane = row / padded_height;
+        const ptrdiff_t ih = static_cast<ptrdiff_t>(row % padded_height) -
+                             static_cast<ptrdiff_t>(shape.pad_top);
+        T *dst = padded.get() + row * padded_width * block;
+        if (ih < 0 || ih >= static_cast<ptrdiff_t>(shape.height)) {
+          std::fill(dst, dst + padded_width * block, T(0));  // Padding row
+          continue;
+        }
+        const T *src =
+            input + ((plane * shape.height + ih) * shape.width) * block;
+        std::fill(dst, dst + left * block, T(0));
+        std::copy(src, src + copied * block, dst + left * block);
+        std::fill(dst + (left + copied) * block, dst + padded_width * block,
+                  T(0));
+      }
+    });
+    source = padded.get();
+    source_height = padded_height;
+    source_width = padded_width;
+  }
+
+  const mml_nchwc_tile_strides strides{
+      in_blocks,
+      shape.kernel_height,
+      shape.kernel_width,
+      source_height * source_width * block,
+      shape.dilation_height * source_width * block,
+      shape.dilation_width * block,
+      shape.stride_width * block,
+      in_blocks * shape.kernel_height * shape.kernel_width * block * block,
+      shape.out_height * shape.out_width * block};
+
+  // Applies the activation to a tile, still in L1
+  auto activate = [&](int blocks, size_t columns, T *out) {
+    if (activation.is_identity()) {
+      return;
+    }
+    for (int o = 0; o < blocks; o++) {
+      mml_bias_activate(activation, T(0), out + o * strides.out_block_stride,
+                        columns * block);
+    }
+  };
+
+  // Runs the tiles of a row of output pixels, for up to mml_nchwc_tile_blocks
+  // output channel blocks
+  auto run_row = [&](int blocks, const T *in, const T *w, const T *b,
+                     T *out) {
+#if MML_X86_KERNELS
+    if constexpr (std::is_same_v<T, float>) {
+      const SimdTier tier = CpuDispatch::get_tier();
+      if ((block == 16 && tier == SimdTier::AVX512) ||
+          (block == 8 && tier >= SimdTier::AVX2)) {
+        static constexpr auto avx2_tiles = std::array{
+            mml_nchwc_tile_kernels<1, false>(
+                std::make_index_sequence<mml_nchwc_tile_width_avx2>()),
+            mml_nchwc_tile_kernels<2, false>(
+                std::make_index_sequence<mml_nchwc_tile_width_avx2>())};
+        static constexpr auto avx512_tiles = std::array{
+            mml_nchwc_tile_kernels<1, true>(
+                std::make_index_sequence<mml_nchwc_tile_width_avx512>()),
+            mml_nchwc_tile_kernels<2, true>(
+                std::make_index_sequence<mml_nchwc_tile_width_avx512>())};
+        const bool avx512 = block == 16;
+        const size_t width = avx512 ? mml_nchwc_tile_width_avx512
+                                    : mml_nchwc_tile_width_avx2;
+        for (size_t ow = 0; ow < shape.out_width; ow += width) {
+          const size_t columns = std::min(width, shape.out_width - ow);
+          const auto kernel =
+              avx512 ? avx512_tiles[blocks - 1][columns - 1]
+                     : avx2_tiles[blocks - 1][columns - 1];
+          kernel(strides, in + ow * strides.ow_stride, w, b, out + ow * block);
+          activate(blocks, columns, out + ow * block);
+        }
+        return;
+      }
+    }
+#endif
+    for (size_t ow = 0; ow < shape.out_width;
+         ow += mml_nchwc_tile_width_scalar) {
+      const int columns = static_cast<int>(std::min<size_t>(
+          mml_nchwc_tile_width_scalar, shape.out_width - ow));
+      mml_nchwc_conv_tile_scalar(block, blocks, columns, strides,
+                                 in + ow * strides.ow_stride, w, b,
+                                 out + ow * block);
+      activate(blocks, columns, out + ow * block);
+    }
+  };
+
+  // One task per row of output pixels of a group of output channel blocks
+  const size_t groups =
+      (out_blocks + mml_nchwc_tile_blocks - 1) / mml_nchwc_tile_blocks;
+  const size_t tasks = shape.batch * groups * shape.out_height;
+  parallel_for(0, tasks, 1, [&](size_t begin, size_t end) {
+    for (size_t task = begin; task < end; task++) {
+      const size_t oh = task % shape.out_height;
+      const size_t group = task / shape.out_height % groups;
+      const size_t n = task / shape.out_height / groups;
+      const size_t first_block = group * mml_nchwc_tile_blocks;
+      const int blocks = static_cast<int>(std::min<size_t>(
+          mml_nchwc_tile_blocks, out_blocks - first_block));
+      const T *in = source + n * in_blocks * strides.in_block_stride +
+                    oh * shape.stride_height * source_width * block;
+      T *out = output + ((n * out_blocks + first_block) * shape.out_height +
+                         oh) *
+                            shape.out_width * block;
+      run_row(blocks, in, weights + first_block * strides.weight_block_stride,
+              bias ? bias + first_block * block : nullptr, out);
+    }
+  });
+}
+
+/**
+ * Pools the windows of a blocked input, whole blocks at a time. Every output
+ * pixel starts from start, is combined with the values of its window inside
+ * the input and finished with the number of these values.
+ */
+template <typename T, typename Combine, typename Finish>
+static void mml_nchwc_pool(size_t block, const NchwcPoolShape &shape,
+                           const T *input, T *output, T start,
+                           Combine &&combine, Finish &&finish) {
+  const size_t rows =
+      shape.batch * (shape.channels / block) * shape.out_height;
+  const size_t grain = std::max<size_t>(
+      1, mml_nchwc_grain / std::max<size_t>(shape.out_width * block, 1));
+  parallel_for(0, rows, grain, [&](size_t begin, size_t end) {
+    for (size_t row = begin; row < end; row++) {
+      const size_t oh = row % shape.out_height;
+      const T *plane =
+          input + row / shape.out_height * shape.height * shape.width * block;
+      for (size_t ow = 0; ow < shape.out_width; ow++) {
+        T *out = output + (row * shape.out_width + ow) * block;
+        std::fill(out, out + block, start);
+        size_t count = 0;
+        for (size_t kh = 0; kh < shape.kernel_height; kh++) {
+          const ptrdiff_t ih =
+              static_cast<ptrdiff_t>(oh * shape.stride_height +
+                                     kh * shape.dilation_height) -
+              static_cast<ptrdiff_t>(shape.pad_top);
+          if (ih < 0 || ih >= static_cast<ptrdiff_t>(shape.height)) {
+            continue;
+          }
+          for (size_t kw = 0; kw < shape.kernel_width; kw++) {
+            const ptrdiff_t iw =
+                static_cast<ptrdiff_t>(ow * shape.stride_width +
+                                       kw * shape.dilation_width) -
+                static_cast<ptrdiff_t>(shape.pad_left);
+            if (iw < 0 || iw >= static_cast<ptrdiff_t>(shape.width)) {
+              continue;
+            }
+            const T *x = plane + (ih * shape.width + iw) * block;
+            for (size_t j = 0; j < block; j++) {
+              out[j] = combine(out[j], x[j]);
+            }
+            count++;
+          }
+        }
+        finish(out, count);
+      }
+    }
+  });
+}
+
+template <TensorConcept::Types T>
+static void mml_nchwc_max_pool(size_t block, const NchwcPoolShape &shape,
+                               const T *input, T *output) {
+  mml_nchwc_pool(
+      block, shape, input, output, std::numeric_limits<T>::lowest(),
+      [](T a, T b) { return std::max(a, b); }, [](T *, size_t) {});
+}
+
+template <TensorConcept::Types T>
+static void mml_nchwc_avg_pool(size_t block, const NchwcPoolShape &shape,
+                               bool count_include_pad, const T *input,
+                               T *output) {
+  const size_t window = shape.kernel_height * shape.kernel_width;
+  mml_nchwc_pool(
+      block, shape, input, output, T(0), [](T a, T b) { return a + b; },
+      [&](T *out, size_t count) {
+        const T divisor = static_cast<T>(count_include_pad ? window : count);
+        for (size_t j = 0; j < block; j++) {
+          out[j] /= divisor;
+        }
+      });
+}
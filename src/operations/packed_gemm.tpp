@@ -0,0 +1,877 @@
+#pragma once
+
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "datastructures/tensor_factory.hpp"
+#include "operations/packed_gemm.hpp"
+#include "utility/allocator.hpp"
+
+#if MML_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+/**
+ * Blocking parameters of the packed GEMM for an element type and a tier. MR x
+ * NR is the register tile of the micro-kernel, KC the depth of the packed
+ * panels, MC the rows of A and NC the columns of B packed together. MC is a
+ * multiple of MR and NC a multiple of NR.
+ */
+template <typename T, SimdTier tier>
+struct mml_gemm_blocking {
+  static constexpr int MR = 4;
+  static constexpr int NR = 8;
+  static constexpr int KC = 256;
+  static constexpr int MC = 128;
+  static constexpr int NC = 4096;
+};
+
+template <>
+struct mml_gemm_blocking<float, SimdTier::AVX2> {
+  static constexpr int MR = 6;
+  static constexpr int NR = 16;
+  static constexpr int KC = 256;
+  static constexpr int MC = 144;
+  static constexpr int NC = 4096;
+};
+
+template <>
+struct mml_gemm_blocking<double, SimdTier::AVX2> {
+  static constexpr int MR = 6;
+  static constexpr int NR = 8;
+  static constexpr int KC = 256;
+  static constexpr int MC = 144;
+  static constexpr int NC = 2048;
+};
+
+template <>
+struct mml_gemm_blocking<float, SimdTier::AVX512> {
+  static constexpr int MR = 12;
+  static constexpr int NR = 32;
+  static constexpr int KC = 256;
+  static constexpr int MC = 144;
+  static constexpr int NC = 4096;
+};
+
+template <>
+struct mml_gemm_blocking<double, SimdTier::AVX512> {
+  static constexpr int MR = 12;
+  static constexpr int NR = 16;
+  static constexpr int KC = 256;
+  static constexpr int MC = 144;
+  static constexpr int NC = 2048;
+};
+
+// Gives the scratch buffers of the packed GEMM back to their allocator
+struct mml_gemm_scratch_deleter {
+  std::shared_ptr<Allocator> allocator;
+  size_t bytes = 0;
+  void operator()(void* ptr) const { allocator->deallocate(ptr, bytes); }
+};
+
+/**
+ * Allocates an uninitialized scratch buffer from Allocator::global(). The pack
+ * buffers are allocated on every call, the pool recycles them instead of
+ * asking the system each time.
+ */
+template <typename T>
+static std::unique_ptr<T[], mml_gemm_scratch_deleter> mml_gemm_scratch(
+    size_t count) {
+  auto allocator = Allocator::global();
+  const size_t bytes = count * sizeof(T);
+  T* ptr = static_cast<T*>(allocator->allocate(bytes));
+  return std::unique_ptr<T[], mml_gemm_scratch_deleter>(
+      ptr, mml_gemm_scratch_deleter{std::move(allocator), bytes});
+}
+
+/**
+ * Gets the address of the first element of a tensor kernels may access
+ * directly, or nullptr if they may not.
+ */
+template <typename T>
+static T* mml_gemm_contiguous_data(const std::shared_ptr<Tensor<T>>& tensor) {
+  return tensor->get_size() > 0 && tensor->raw_access() ? tensor->data()
+                                                        : nullptr;
+}
+
+/**
+ * Checks if a tensor is a view of contiguous matrices that kernels may access
+ * directly, with the last two dimensions transposed and read with its rows as
+ * the leading dimension. Its data is then the transposed matrices, with the
+ * rows of the view as leading dimension, at the same offsets as the matrices
+ * of the view in its contiguous layout.
+ */
+template <typename T>
+static bool mml_gemm_transposed_view(const std::shared_ptr<Tensor<T>>& tensor,
+                                     int ld) {
+  const auto& shape = tensor->get_shape();
+  const auto& strides = tensor->get_strides();
+  const size_t rank = shape.size();
+  if (rank < 2 || tensor->get_size() == 0 ||
+      static_cast<size_t>(ld) != shape[rank - 1] || strides[rank - 2] != 1 ||
+      strides[rank - 1] != shape[rank - 2]) {
+    return false;
+  }
+  return tensor->transpose(rank - 2, rank - 1)->raw_access();
+}
+
+/**
+ * Computes an MR x NR tile of the product of a packed A panel and a packed B
+ * panel and stores it, row-major, in tile. Portable kernel, the fixed size
+ * loops are left to the auto-vectorizer.
+ */
+template <typename T, int MR, int NR>
+static void mml_gemm_micro_kernel_scalar(int kc, const T* a, const T* b,
+                                         T* tile) {
+  T acc[MR][NR] = {};
+  for (int k = 0; k < kc; k++) {
+    for (int r = 0; r < MR; r++) {
+      const T a_r = a[r];
+      for (int c = 0; c < NR; c++) {
+        acc[r][c] += a_r * b[c];
+      }
+    }
+    a += MR;
+    b += NR;
+  }
+  for (int r = 0; r < MR; r++) {
+    for (int c = 0; c < NR; c++) {
+      tile[r * NR + c] = acc[r][c];
+    }
+  }
+}
+
+#if MML_X86_KERNELS
+// Vector registers of the SIMD micro-kernels for an element type
+template <typename T>
+struct mml_gemm_vectors;
+
+template <>
+struct mml_gemm_vectors<float> {
+  using avx2 = __m256;
+  using avx512 = __m512;
+};
+
+template <>
+struct mml_gemm_vectors<double> {
+  using avx2 = __m256d;
+  using avx512 = __m512d;
+};
+
+/**
+ * AVX2 micro-kernel, each row of the tile is held in NR / 8 (float) or NR / 4
+ * (double) registers and updated with FMA.
+ */
+template <typename T, int MR, int NR>
+MML_TARGET_AVX2 static void mml_gemm_micro_kernel_avx2(int kc, const T* a,
+                                                       const T* b, T* tile) {
+  using Vec = typename mml_gemm_vectors<T>::avx2;
+  constexpr int lanes = sizeof(Vec) / sizeof(T);
+  constexpr int vecs = NR / lanes;
+  static_assert(NR % lanes == 0);
+
+  Vec acc[MR][vecs];
+  Vec b_row[vecs];
+  for (int r = 0; r < MR; r++) {
+    for (int v = 0; v < vecs; v++) {
+      if constexpr (std::is_same_v<T, float>) {
+        acc[r][v] = _mm256_setzero_ps();
+      } else {
+        acc[r][v] = _mm256_setzero_pd();
+      }
+    }
+  }
+  for (int k = 0; k < kc; k++) {
+    for (int v = 0; v < vecs; v++) {
+      if constexpr (std::is_same_v<T, float>) {
+        b_row[v] = _mm256_loadu_ps(b + v * lanes);
+      } else {
+        b_row[v] = _mm256_loadu_pd(b + v * lanes);
+      }
+    }
+    for (int r = 0; r < MR; r++) {
+      for (int v = 0; v < vecs; v++) {
+        if constexpr (std::is_same_v<T, float>) {
+          acc[r][v] =
+              _mm256_fmadd_ps(_mm256_set1_ps(a[r]), b_row[v], acc[r][v]);
+        } else {
+          acc[r][v] =
+              _mm256_fmadd_pd(_mm256_set1_pd(a[r]), b_row[v], acc[r][v]);
+        }
+      }
+    }
+    a += MR;
+    b += NR;
+  }
+  for (int r = 0; r < MR; r++) {
+    for (int v = 0; v < vecs; v++) {
+      if constexpr (std::is_same_v<T, float>) {
+        _mm256_storeu_ps(tile + r * NR + v * lanes, acc[r][v]);
+      } else {
+        _mm256_storeu_pd(tile + r * NR + v * lanes, acc[r][v]);
+      }
+    }
+  }
+}
+
+/**
+ * AVX-512 micro-kernel, each row of the tile is held in NR / 16 (float) or
+ * NR / 8 (double) registers and updated with FMA.
+ */
+template <typename T, int MR, int NR>
+MML_TARGET_AVX512 static void mml_gemm_micro_kernel_avx512(int kc, const T* a,
+                                                           const T* b,
+                                                           T* tile) {
+  using Vec = typename mml_gemm_vectors<T>::avx512;
+  constexpr int lanes = sizeof(Vec) / sizeof(T);
+  constexpr int vecs = NR / lanes;
+  static_assert(NR % lanes == 0);
+
+  Vec acc[MR][vecs];
+  Vec b_row[vecs];
+  for (int r = 0; r < MR; r++) {
+    for (int v = 0; v < vecs; v++) {
+      if constexpr (std::is_same_v<T, float>) {
+        acc[r][v] = _mm512_setzero_ps();
+      } else {
+        acc[r][v] = _mm512_setzero_pd();
+      }
+    }
+  }
+  for (int k = 0; k < kc; k++) {
+    for (int v = 0; v < vecs; v++) {
+      if constexpr (std::is_same_v<T, float>) {
+        b_row[v] = _mm512_loadu_ps(b + v * lanes);
+      } else {
+        b_row[v] = _mm512_loadu_pd(b + v * lanes);
+      }
+    }
+    for (int r = 0; r < MR; r++) {
+      for (int v = 0; v < vecs; v++) {
+        if constexpr (std::is_same_v<T, float>) {
+          acc[r][v] =
+              _mm512_fmadd_ps(_mm512_set1_ps(a[r]), b_row[v], acc[r][v]);
+        } else {
+          acc[r][v] =
+              _mm512_fmadd_pd(_mm512_set1_pd(a[r]), b_row[v], acc[r][v]);
+        }
+      }
+    }
+    a += MR;
+    b += NR;
+  }
+  for (int r = 0; r < MR; r++) {
+    for (int v = 0; v < vecs; v++) {
+      if constexpr (std::is_same_v<T, float>) {
+        _mm512_storeu_ps(tile + r * NR + v * lanes, acc[r][v]);
+      } else {
+        _mm512_storeu_pd(tile + r * NR + v * lanes, acc[r][v]);
+      }
+    }
+  }
+}
+#endif
+
+/**
+ * Runs the micro-kernel of a tier, the SIMD tiers only have float and double
+ * kernels and fall back to the portable one for the other types.
+ */
+template <typename T, SimdTier tier>
+static void mml_gemm_micro_kernel(int kc, const T* a, const T* b, T* tile) {
+  constexpr int MR = mml_gemm_blocking<T, tier>::MR;
+  constexpr int NR = mml_gemm_blocking<T, tier>::NR;
+  constexpr bool simd_type =
+      std::is_same_v<T, float> || std::is_same_v<T, double>;
+#if MML_X86_KERNELS
+  if constexpr (simd_type && tier == SimdTier::AVX512) {
+    mml_gemm_micro_kernel_avx512<T, MR, NR>(kc, a, b, tile);
+    return;
+  } else if constexpr (simd_type && tier == SimdTier::AVX2) {
+    mml_gemm_micro_kernel_avx2<T, MR, NR>(kc, a, b, tile);
+    return;
+  }
+#endif
+  mml_gemm_micro_kernel_scalar<T, MR, NR>(kc, a, b, tile);
+}
+
+/**
+ * Packs the rows [0, mc) and columns [0, kc) of A, given by its row and column
+ * strides, in panels of MR rows. Each panel is stored column by column and the
+ * rows past mc are zero.
+ */
+template <int MR, typename T>
+static void mml_gemm_pack_a(int mc, int kc, const T* a, size_t row_stride,
+                            size_t col_stride, T* packed) {
+  for (int ir = 0; ir < mc; ir += MR) {
+    const int mr = std::min(MR, mc - ir);
+    for (int k = 0; k < kc; k++) {
+      for (int r = 0; r < mr; r++) {
+        packed[r] = a[(ir + r) * row_stride + k * col_stride];
+      }
+      for (int r = mr; r < MR; r++) {
+        packed[r] = T(0);
+      }
+      packed += MR;
+    }
+  }
+}
+
+/**
+ * Packs the rows [0, kc) and columns [0, nc) of B, given by its row and column
+ * strides, in panels of NR columns. Each panel is stored row by row and the
+ * columns past nc are zero.
+ */
+template <int NR, typename T>
+static void mml_gemm_pack_b(int kc, int nc, const T* b, size_t row_stride,
+                            size_t col_stride, T* packed) {
+  for (int jr = 0; jr < nc; jr += NR) {
+    const int nr = std::min(NR, nc - jr);
+    for (int k = 0; k < kc; k++) {
+      for (int c = 0; c < nr; c++) {
+        packed[c] = b[k * row_stride + (jr + c) * col_stride];
+      }
+      for (int c = nr; c < NR; c++) {
+        packed[c] = T(0);
+      }
+      packed += NR;
+    }
+  }
+}
+
+/**
+ * Copies the elements of a tensor whose elements are not contiguous.
+ */
+template <typename T>
+static std::vector<T> mml_gemm_gather(
+    const std::shared_ptr<Tensor<T>>& tensor) {
+  std::vector<T> values(tensor->get_size());
+  for (size_t i = 0; i < values.size(); i++) {
+    values[i] = (*tensor)[i];
+  }
+  return values;
+}
+
+/**
+ * Gets the elements of a GEMM operand for the kernels. Transposed views are
+ * read in place by transposing them back, which updates ld and trans, other
+ * operands whose elements are not contiguous are gathered into values. The
+ * flat index of every gathered element is kept so the leading dimension
+ * applies.
+ */
+template <typename T>
+static const T* mml_gemm_operand_data(const std::shared_ptr<Tensor<T>>& tensor,
+                                      int& ld, int& trans,
+                                      std::vector<T>& values) {
+  const T* data = mml_gemm_contiguous_data(tensor);
+  if (!data && mml_gemm_transposed_view(tensor, ld)) {
+    ld = static_cast<int>(tensor->get_shape()[tensor->get_shape().size() - 2]);
+    trans = !trans;
+    return tensor->data();
+  }
+  if (!data) {
+    values = mml_gemm_gather(tensor);
+    data = values.data();
+  }
+  return data;
+}
+
+/**
+ * Packed GEMM of a tier on raw operands. a_panels and b_panels are operands
+ * packed ahead of time by mml_gemm_prepack_a and mml_gemm_prepack_b for this
+ * tier, or null for operands packed block by block from a_data and b_data.
+ */
+template <typename T, SimdTier tier>
+static void mml_gemm_packed_run(int TA, int TB, int M, int N, int K, T ALPHA,
+                                const T* a_data, int lda, const T* a_panels,
+                                const T* b_data, int ldb, const T* b_panels,
+                                T BETA, T* c_data, int ldc,
+                                const GemmEpilogue<T>* epilogue) {
+  constexpr int MR = mml_gemm_blocking<T, tier>::MR;
+  constexpr int NR = mml_gemm_blocking<T, tier>::NR;
+  constexpr int KC = mml_gemm_blocking<T, tier>::KC;
+  constexpr int MC = mml_gemm_blocking<T, tier>::MC;
+  constexpr int NC = mml_gemm_blocking<T, tier>::NC;
+  static_assert(MC % MR == 0 && NC % NR == 0);
+
+  if (M <= 0 || N <= 0) return;
+
+  if (K <= 0) {
+    // Nothing to accumulate, C is only scaled
+    for (int i = 0; i < M; i++) {
+      for (int j = 0; j < N; j++) {
+        T& c = c_data[static_cast<size_t>(i) * ldc + j];
+        c = BETA == T(0) ? T(0) : BETA * c;
+      }
+    }
+    if (epilogue) {
+      mml_gemm_apply_epilogue(*epilogue, M, N, c_data, ldc);
+    }
+    return;
+  }
+
+  // Strides of the elements A(i, k) and B(k, j)
+  const size_t a_row_stride = TA ? 1 : lda;
+  const size_t a_col_stride = TA ? lda : 1;
+  const size_t b_row_stride = TB ? 1 : ldb;
+  const size_t b_col_stride = TB ? ldb : 1;
+
+  const int m_panels = (M + MR - 1) / MR;
+  const int mc_blocks = (M + MC - 1) / MC;
+  std::unique_ptr<T[], mml_gemm_scratch_deleter> a_packed;
+  std::unique_ptr<T[], mml_gemm_scratch_deleter> b_packed;
+  if (!a_panels) {
+    a_packed = mml_gemm_scratch<T>(static_cast<size_t>(m_panels) * MR *
+                                   std::min(K, KC));
+  }
+  if (!b_panels) {
+    b_packed = mml_gemm_scratch<T>(static_cast<size_t>(std::min(K, KC)) *
+                                   ((std::min(N, NC) + NR - 1) / NR * NR));
+  }
+
+  for (int jc = 0; jc < N; jc += NC) {
+    const int nc = std::min(NC, N - jc);
+    const int n_panels = (nc + NR - 1) / NR;
+
+    for (int pc = 0; pc < K; pc += KC) {
+      const int kc = std::min(KC, K - pc);
+      // C is only scaled by BETA once, later blocks accumulate onto it
+      const T beta = pc == 0 ? BETA : T(1);
+
+      // Prepacked B holds the column blocks one after the other, each with
+      // its depth blocks one after the other
+      const T* b_block =
+          b_panels ? b_panels + static_cast<size_t>(jc) * K +
+                         static_cast<size_t>(pc) * n_panels * NR
+                   : b_packed.get();
+      if (!b_panels) {
+        parallel_for(0, n_panels, 1, [&](size_t begin, size_t end) {
+          for (size_t panel = begin; panel < end; panel++) {
+            const int jr = static_cast<int>(panel) * NR;
+            mml_gemm_pack_b<NR>(
+                kc, std::min(NR, nc - jr),
+                b_data + pc * b_row_stride + (jc + jr) * b_col_stride,
+                b_row_stride, b_col_stride,
+                b_packed.get() + static_cast<size_t>(jr) * kc);
+          }
+        });
+      }
+
+      // A is packed whole for this depth, it is reused by every column block.
+      // Prepacked A holds its depth blocks one after the other
+      const T* a_block =
+          a_panels ? a_panels + static_cast<size_t>(pc) * m_panels * MR
+                   : a_packed.get();
+      if (!a_panels) {
+        parallel_for(0, m_panels, 1, [&](size_t begin, size_t end) {
+          for (size_t panel = begin; panel < end; panel++) {
+            const int ir = static_cast<int>(panel) * MR;
+            mml_gemm_pack_a<MR>(
+                std::min(MR, M - ir), kc,
+                a_data + ir * a_row_stride + pc * a_col_stride, a_row_stride,
+                a_col_stride, a_packed.get() + static_cast<size_t>(ir) * kc);
+          }
+        });
+      }
+
+      // One task per MC rows and NR columns, consecutive tasks share the MC
+      // block of A so it stays in L2 while the B panels stream through L1
+      const size_t tasks = static_cast<size_t>(mc_blocks) * n_panels;
+      parallel_for(0, tasks, 1, [&](size_t begin, size_t end) {
+        alignas(64) T tile[MR * NR];
+        for (size_t task = begin; task < end; task++) {
+          const int ic = static_cast<int>(task / n_panels) * MC;
+          const int jr = static_cast<int>(task % n_panels) * NR;
+          const int mc = std::min(MC, M - ic);
+          const int nr = std::min(NR, nc - jr);
+          const T* b_panel = b_block + static_cast<size_t>(jr) * kc;
+
+          for (int ir = 0; ir < mc; ir += MR) {
+            const int mr = std::min(MR, mc - ir);
+            mml_gemm_micro_kernel<T, tier>(
+                kc, a_block + static_cast<size_t>(ic + ir) * kc, b_panel,
+                tile);
+
+            T* c_tile = c_data + static_cast<size_t>(ic + ir) * ldc + jc + jr;
+            for (int r = 0; r < mr; r++) {
+              for (int c = 0; c < nr; c++) {
+                T& value = c_tile[static_cast<size_t>(r) * ldc + c];
+                value = beta == T(0) ? ALPHA * tile[r * NR + c]
+                                     : ALPHA * tile[r * NR + c] + beta * value;
+              }
+            }
+
+            // The last depth block gives the final values of the tile
+            if (epilogue && pc + kc == K) {
+              for (int r = 0; r < mr; r++) {
+                const size_t row = static_cast<size_t>(ic + ir + r);
+                mml_bias_activate(
+                    epilogue->activation,
+                    epilogue->row_bias ? epilogue->row_bias[row] : T(0),
+                    c_tile + static_cast<size_t>(r) * ldc, nr);
+              }
+            }
+          }
+        }
+      });
+    }
+  }
+}
+
+template <TensorConcept::Types T, SimdTier tier>
+static void mml_gemm_packed_tier(int TA, int TB, int M, int N, int K, T ALPHA,
+                                 std::shared_ptr<Tensor<T>> A, int lda,
+                                 std::shared_ptr<Tensor<T>> B, int ldb, T BETA,
+                                 std::shared_ptr<Tensor<T>> C, int ldc) {
+  if (M <= 0 || N <= 0) return;
+
+  std::vector<T> a_values;
+  std::vector<T> b_values;
+  std::vector<T> c_values;
+  const T* a_data = nullptr;
+  const T* b_data = nullptr;
+  if (K > 0) {
+    a_data = mml_gemm_operand_data(A, lda, TA, a_values);
+    b_data = mml_gemm_operand_data(B, ldb, TB, b_values);
+  }
+  T* c_data = mml_gemm_contiguous_data(C);
+  if (!c_data) {
+    c_values = mml_gemm_gather(C);
+    c_data = c_values.data();
+  }
+
+  mml_gemm_packed_run<T, tier>(TA, TB, M, N, K, ALPHA, a_data, lda, nullptr,
+                               b_data, ldb, nullptr, BETA, c_data, ldc,
+                               nullptr);
+
+  // Copies the result back if C had to be gathered
+  for (size_t i = 0; i < c_values.size(); i++) {
+    (*C)[i] = c_values[i];
+  }
+}
+
+/**
+ * Runs a function templated on a tier with the given tier. The SIMD tiers
+ * only have float and double kernels, the other types always run the portable
+ * ones.
+ */
+template <typename T, typename F>
+static void mml_gemm_with_tier(SimdTier tier, F&& function) {
+  if constexpr (!std::is_same_v<T, float> && !std::is_same_v<T, double>) {
+    function.template operator()<SimdTier::Scalar>();
+    return;
+  }
+
+  switch (tier) {
+    case SimdTier::AVX512:
+      function.template operator()<SimdTier::AVX512>();
+      break;
+    case SimdTier::AVX2:
+      function.template operator()<SimdTier::AVX2>();
+      break;
+    default:
+      function.template operator()<SimdTier::Scalar>();
+      break;
+  }
+}
+
+template <TensorConcept::Types T>
+static void mml_gemm_apply_epilogue(const GemmEpilogue<T>& epilogue, int M,
+                                    int N, T* C, int ldc) {
+  if (M <= 0 || N <= 0 ||
+      (!epilogue.row_bias && epilogue.activation.is_identity())) {
+    return;
+  }
+  parallel_for(0, M, 1, [&](size_t begin, size_t end) {
+    for (size_t row = begin; row < end; row++) {
+      mml_bias_activate(epilogue.activation,
+                        epilogue.row_bias ? epilogue.row_bias[row] : T(0),
+                        C + row * ldc, N);
+    }
+  });
+}
+
+template <TensorConcept::Types T>
+static SimdTier mml_gemm_tier() {
+  if constexpr (!std::is_same_v<T, float> && !std::is_same_v<T, double>) {
+    return SimdTier::Scalar;
+  }
+  return CpuDispatch::get_tier();
+}
+
+template <TensorConcept::Types T>
+static std::shared_ptr<const PackedGemmOperand<T>> mml_gemm_prepack_a(
+    int TA, int M, int K, std::shared_ptr<Tensor<T>> A, int lda) {
+  auto packed = std::make_shared<PackedGemmOperand<T>>();
+  packed->tier = mml_gemm_tier<T>();
+  packed->rows = M;
+  packed->cols = K;
+
+  std::vector<T> a_values;
+  const T* a_data =
+      M > 0 && K > 0 ? mml_gemm_operand_data(A, lda, TA, a_values) : nullptr;
+  mml_gemm_with_tier<T>(packed->tier, [&]<SimdTier tier>() {
+    constexpr int MR = mml_gemm_blocking<T, tier>::MR;
+    constexpr int KC = mml_gemm_blocking<T, tier>::KC;
+    const int m_panels = (std::max(M, 0) + MR - 1) / MR;
+    packed->panels = array_mml<T>(static_cast<size_t>(m_panels) * MR *
+                                  std::max(K, 0));
+    if (!a_data) return;
+
+    // The same panels mml_gemm_packed_run packs for each depth block
+    const size_t a_row_stride = TA ? 1 : lda;
+    const size_t a_col_stride = TA ? lda : 1;
+    for (int pc = 0; pc < K; pc += KC) {
+      const int kc = std::min(KC, K - pc);
+      T* block = packed->panels.get() + static_cast<size_t>(pc) * m_panels * MR;
+      parallel_for(0, m_panels, 1, [&](size_t begin, size_t end) {
+        for (size_t panel = begin; panel < end; panel++) {
+          const int ir = static_cast<int>(panel) * MR;
+          mml_gemm_pack_a<MR>(std::min(MR, M - ir), kc,
+                              a_data + ir * a_row_stride + pc * a_col_stride,
+                              a_row_stride, a_col_stride,
+                              block + static_cast<size_t>(ir) * kc);
+        }
+      });
+    }
+  });
+  return packed;
+}
+
+template <TensorConcept::Types T>
+static std::shared_ptr<const PackedGemmOperand<T>> mml_gemm_prepack_b(
+    int TB, int K, int N, std::shared_ptr<Tensor<T>> B, int ldb) {
+  auto packed = std::make_shared<PackedGemmOperand<T>>();
+  packed->tier = mml_gemm_tier<T>();
+  packed->rows = K;
+  packed->cols = N;
+
+  std::vector<T> b_values;
+  const T* b_data =
+      K > 0 && N > 0 ? mml_gemm_operand_data(B, ldb, TB, b_values) : nullptr;
+  mml_gemm_with_tier<T>(packed->tier, [&]<SimdTier tier>() {
+    constexpr int NR = mml_gemm_blocking<T, tier>::NR;
+    constexpr int KC = mml_gemm_blocking<T, tier>::KC;
+    constexpr int NC = mml_gemm_blocking<T, tier>::NC;
+    // Every column block but the last is a whole number of panels
+    const int padded_n =
+        N <= 0 ? 0 : N / NC * NC + ((N % NC) + NR - 1) / NR * NR;
+    packed->panels =
+        array_mml<T>(static_cast<size_t>(padded_n) * std::max(K, 0));
+    if (!b_data) return;
+
+    // The same panels mml_gemm_packed_run packs for each column and depth
+    // block
+    const size_t b_row_stride = TB ? 1 : ldb;
+    const size_t b_col_stride = TB ? ldb : 1;
+    for (int jc = 0; jc < N; jc += NC) {
+      const int nc = std::min(NC, N - jc);
+      const int n_panels = (nc + NR - 1) / NR;
+      for (int pc = 0; pc < K; pc += KC) {
+        const int kc = std::min(KC, K - pc);
+        T* block = packed->panels.get() + static_cast<size_t>(jc) * K +
+                   static_cast<size_t>(pc) * n_panels * NR;
+        parallel_for(0, n_panels, 1, [&](size_t begin, size_t end) {
+          for (size_t panel = begin; panel < end; panel++) {
+            const int jr = static_cast<int>(panel) * NR;
+            mml_gemm_pack_b<NR>(
+                kc, std::min(NR, nc - jr),
+                b_data + pc * b_row_stride + (jc + jr) * b_col_stride,
+                b_row_stride, b_col_stride,
+                block + static_cast<size_t>(jr) * kc);
+          }
+        });
+      }
+    }
+  });
+  return packed;
+}
+
+template <TensorConcept::Types T>
+static void mml_gemm_prepacked_a(const PackedGemmOperand<T>& A, int TB, int N,
+                                 T ALPHA, std::shared_ptr<Tensor<T>> B,
+                                 int ldb, T BETA, std::shared_ptr<Tensor<T>> C,
+                                 int ldc, const GemmEpilogue<T>* epilogue) {
+  const int M = A.rows;
+  const int K = A.cols;
+  if (M <= 0 || N <= 0) return;
+
+  std::vector<T> b_values;
+  std::vector<T> c_values;
+  const T* b_data =
+      K > 0 ? mml_gemm_operand_data(B, ldb, TB, b_values) : nullptr;
+  T* c_data = mml_gemm_contiguous_data(C);
+  if (!c_data) {
+    c_values = mml_gemm_gather(C);
+    c_data = c_values.data();
+  }
+
+  mml_gemm_with_tier<T>(A.tier, [&]<SimdTier tier>() {
+    mml_gemm_packed_run<T, tier>(0, TB, M, N, K, ALPHA, nullptr, 0,
+                                 A.panels.get(), b_data, ldb, nullptr, BETA,
+                                 c_data, ldc, epilogue);
+  });
+
+  for (size_t i = 0; i < c_values.size(); i++) {
+    (*C)[i] = c_values[i];
+  }
+}
+
+template <TensorConcept::Types T>
+static void mml_gemm_prepacked_b(int TA, int M, T ALPHA,
+                                 std::shared_ptr<Tensor<T>> A, int lda,
+                                 const PackedGemmOperand<T>& B, T BETA,
+                                 std::shared_ptr<Tensor<T>> C, int ldc) {
+  const int K = B.rows;
+  const int N = B.cols;
+  if (M <= 0 || N <= 0) return;
+
+  std::vector<T> a_values;
+  std::vector<T> c_values;
+  const T* a_data =
+      K > 0 ? mml_gemm_operand_data(A, lda, TA, a_values) : nullptr;
+  T* c_data = mml_gemm_contiguous_data(C);
+  if (!c_data) {
+    c_values = mml_gemm_gather(C);
+    c_data = c_values.data();
+  }
+
+  mml_gemm_with_tier<T>(B.tier, [&]<SimdTier tier>() {
+    mml_gemm_packed_run<T, tier>(TA, 0, M, N, K, ALPHA, a_data, lda, nullptr,
+                                 nullptr, 0, B.panels.get(), BETA, c_data,
+                                 ldc, nullptr);
+  });
+
+  for (size_t i = 0; i < c_values.size(); i++) {
+    (*C)[i] = c_values[i];
+  }
+}
+
+template <TensorConcept::Types T>
+static void mml_gemm_packed(int TA, int TB, int M, int N, int K, T ALPHA,
+                            std::shared_ptr<Tensor<T>> A, int lda,
+                            std::shared_ptr<Tensor<T>> B, int ldb, T BETA,
+                            std::shared_ptr<Tensor<T>> C, int ldc) {
+  mml_gemm_with_tier<T>(mml_gemm_tier<T>(), [&]<SimdTier tier>() {
+    mml_gemm_packed_tier<T, tier>(TA, TB, M, N, K, ALPHA, A, lda, B, ldb, BETA,
+                                  C, ldc);
+  });
+}
+
+template <TensorConcept::Types T>
+static void mml_gemm_strided_batched(
+    int TA, int TB, int M, int N, int K, T ALPHA, std::shared_ptr<Tensor<T>> A,
+    int lda, const std::vector<size_t>& a_batch_strides,
+    std::shared_ptr<Tensor<T>> B, int ldb,
+    const std::vector<size_t>& b_batch_strides, T BETA,
+    std::shared_ptr<Tensor<T>> C, int ldc,
+    const std::vector<size_t>& c_batch_strides,
+    const std::vector<size_t>& batch_shape) {
+  if (M <= 0 || N <= 0) return;
+
+  // Views with their matrices transposed are read in place by flipping the
+  // transposition, their batches keep the offsets of the contiguous layout
+  std::vector<T> a_values;
+  std::vector<T> b_values;
+  std::vector<T> c_values;
+  const T* a_data = nullptr;
+  const T* b_data = nullptr;
+  if (K > 0) {
+    a_data = mml_gemm_operand_data(A, lda, TA, a_values);
+    b_data = mml_gemm_operand_data(B, ldb, TB, b_values);
+  }
+  T* c_data = mml_gemm_contiguous_data(C);
+  if (!c_data) {
+    c_values = mml_gemm_gather(C);
+    c_data = c_values.data();
+  }
+
+  // Drop the batch dimensions of size 1 and merge every dimension into the
+  // previous one when all three tensors step over it as one longer dimension
+  std::vector<size_t> dims;
+  std::vector<size_t> a_strides;
+  std::vector<size_t> b_strides;
+  std::vector<size_t> c_strides;
+  for (size_t d = 0; d < batch_shape.size(); d++) {
+    if (batch_shape[d] == 0) return;
+    if (batch_shape[d] == 1) continue;
+    if (!dims.empty() &&
+        a_strides.back() == a_batch_strides[d] * batch_shape[d] &&
+        b_strides.back() == b_batch_strides[d] * batch_shape[d] &&
+        c_strides.back() == c_batch_strides[d] * batch_shape[d]) {
+      dims.back() *= batch_shape[d];
+      a_strides.back() = a_batch_strides[d];
+      b_strides.back() = b_batch_strides[d];
+      c_strides.back() = c_batch_strides[d];
+    } else {
+      dims.push_back(batch_shape[d]);
+      a_strides.push_back(a_batch_strides[d]);
+      b_strides.push_back(b_batch_strides[d]);
+      c_strides.push_back(c_batch_strides[d]);
+    }
+  }
+
+  // A batch sharing B whose rows of A and C follow each other from one matrix
+  // to the next is a single GEMM with all their rows
+  int rows = M;
+  if (dims.size() == 1 && !TA && b_strides[0] == 0 &&
+      a_strides[0] == static_cast<size_t>(M) * lda &&
+      c_strides[0] == static_cast<size_t>(M) * ldc) {
+    rows = static_cast<int>(M * dims[0]);
+    dims.clear();
+  }
+  size_t batch = 1;
+  for (size_t dim : dims) {
+    batch *= dim;
+  }
+
+  mml_gemm_with_tier<T>(mml_gemm_tier<T>(), [&]<SimdTier tier>() {
+    parallel_for(0, batch, 1, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; i++) {
+        size_t a_offset = 0;
+        size_t b_offset = 0;
+        size_t c_offset = 0;
+        size_t remaining = i;
+        for (size_t d = dims.size(); d-- > 0;) {
+          const size_t index = remaining % dims[d];
+          remaining /= dims[d];
+          a_offset += index * a_strides[d];
+          b_offset += index * b_strides[d];
+          c_offset += index * c_strides[d];
+        }
+        mml_gemm_packed_run<T, tier>(
+            TA, TB, rows, N, K, ALPHA, K > 0 ? a_data + a_offset : nullptr,
+            lda, nullptr, K > 0 ? b_data + b_offset : nullptr, ldb, nullptr,
+            BETA, c_data + c_offset, ldc, nullptr);
+      }
+    });
+  });
+
+  // Copies the result back if C had to be gathered
+  for (size_t i = 0; i < c_values.size(); i++) {
+    (*C)[i] = c_values[i];
+  }
+}
+
+template <TensorConcept::Types T>
+static std::shared_ptr<Tensor<T>> mml_onnx_gemm_packed(
+    std::shared_ptr<Tensor<T>> A, std::shared_ptr<Tensor<T>> B, float alpha,
+    float beta, int transA, int transB,
+    std::optional<std::shared_ptr<Tensor<T>>> C) {
+  const auto shape_A = A->get_shape();
+  const auto shape_B = B->get_shape();
+  const int M = (int)(transA ? shape_A[1] : shape_A[0]);
+  const int N = (int)(transB ? shape_B[0] : shape_B[1]);
+  const int K = (int)(transA ? shape_A[0] : shape_A[1]);
+  const int lda = (int)shape_A[1];
+  const int ldb = (int)shape_B[1];
+  const int ldc = N;
+  std::shared_ptr<Tensor<T>> C_p =
+      C.has_value() ? *C
+                    : TensorFactory::create_tensor<T>(
+                          {static_cast<size_t>(M), static_cast<size_t>(N)});
+  mml_gemm_packed(transA, transB, M, N, K, static_cast<T>(alpha), A, lda, B,
+                  ldb, static_cast<T>(beta), C_p, ldc);
+  return C_p;
+}
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+// IWYU pragma: no_include <__vector/vector.h>
+#include <vector>  // IWYU pragma: keep
+
+#include "operations/cpu_dispatch.hpp"
+#include "operations/pooling.hpp"
+#include "utility/thread_pool.hpp"
+
+// Minimum number of window elements visited per parallel chunk
+static constexpr size_t mml_pool_grain = 16384;
+
+/**
+ * Range [begin, end) of the positions of a window, along one dimension, that
+ * read inside the input.
+ */
+struct PoolRange {
+  size_t begin;
+  size_t end;
+
+  size_t count() const { return end - begin; }
+};
+
+/**
+ * Gets the positions of the window of output coordinate o inside an input
+ * dimension of the given size.
+ */
+static PoolRange mml_pool_window(size_t o, size_t size, size_t kernel,
+                                 size_t stride, size_t dilation, size_t pad) {
+  const ptrdiff_t start =
+      static_cast<ptrdiff_t>(o * stride) - static_cast<ptrdiff_t>(pad);
+  const ptrdiff_t d = static_cast<ptrdiff_t>(dilation);
+  const ptrdiff_t begin = start >= 0 ? 0 : (-start + d - 1) / d;
+  const ptrdiff_t end =
+      start >= static_cast<ptrdiff_t>(size)
+          ? 0
+          : std::min<ptrdiff_t>(static_cast<ptrdiff_t>(kernel),
+                                (static_cast<ptrdiff_t>(size) - 1 - start) / d +
+                                    1);
+  return {static_cast<size_t>(begin),
+          static_cast<size_t>(std::max(begin, end))};
+}
+
+/**
+ * Gets the output columns [begin, end) at which width position kw of the
+ * window reads inside the input, and the offset of the input column of output
+ * column ow, which is ow * stride_width + offset.
+ */
+static PoolRange mml_pool_columns(const PoolShape &shape, size_t kw,
+                                  ptrdiff_t &offset) {
+  const ptrdiff_t stride = static_cast<ptrdiff_t>(shape.stride_width);
+  const ptrdiff_t width = static_cast<ptrdiff_t>(shape.width);
+  offset = static_cast<ptrdiff_t>(kw * shape.dilation_width) -
+           static_cast<ptrdiff_t>(shape.pad_left);
+  const ptrdiff_t begin = offset >= 0 ? 0 : (-offset + stride - 1) / stride;
+  const ptrdiff_t end = std::min<ptrdiff_t>(
+      static_cast<ptrdiff_t>(shape.out_width),
+      width <= offset ? 0 : (width - 1 - offset) / stride + 1);
+  return {static_cast<size_t>(begin),
+          static_cast<size_t>(std::max(begin, end))};
+}
+
+/**
+ * Visits the windows of every output row, the rows in parallel. For every
+ * depth, height and width position of the windows, in this order, visit gets
+ * the offset of the input row read and the output columns reading inside it.
+ * start(row) is called before the first position of a row and finish(row,
+ * count) after the last one, count being the number of depth and height
+ * positions inside the input.
+ */
+template <typename Start, typename Visit, typename Finish>
+static void mml_pool_rows(const PoolShape &shape, Start &&start, Visit &&visit,
+                          Finish &&finish) {
+  const size_t rows = shape.planes * shape.out_depth * shape.out_height;
+  const size_t window =
+      shape.kernel_depth * shape.kernel_height * shape.kernel_width;
+  const size_t grain = std::max<size_t>(
+      1, mml_pool_grain / std::max<size_t>(shape.out_width * window, 1));
+
+  // The windows of the rows are visited by code built for the current SIMD
+  // tier
+  auto chunk = [&](size_t begin, size_t end) {
+    for (size_t row = begin; row < end; row++) {
+      const size_t oh = row % shape.out_height;
+      const size_t od = row / shape.out_height % shape.out_depth;
+      const size_t plane = row / (shape.out_height * shape.out_depth);
+      const PoolRange depths =
+          mml_pool_window(od, shape.depth, shape.kernel_depth,
+                          shape.stride_depth, shape.dilation_depth,
+                          shape.pad_front);
+      const PoolRange heights =
+          mml_pool_window(oh, shape.height, shape.kernel_height,
+                          shape.stride_height, shape.dilation_height,
+                          shape.pad_top);
+
+      start(row);
+      for (size_t kd = depths.begin; kd < depths.end; kd++) {
+        const size_t id =
+            od * shape.stride_depth + kd * shape.dilation_depth -
+            shape.pad_front;
+        for (size_t kh = heights.begin; kh < heights.end; kh++) {
+          const size_t ih =
+              oh * shape.stride_height + kh * shape.dilation_height -
+              shape.pad_top;
+          const size_t in_row =
+              ((plane * shape.depth + id) * shape.height + ih) * shape.width;
+          for (size_t kw = 0; kw < shape.kernel_width; kw++) {
+            ptrdiff_t offset;
+            const PoolRange columns = mml_pool_columns(shape, kw, offset);
+            visit(row, in_row, columns, offset);
+          }
+        }
+      }
+      finish(row, depths.count() * heights.count());
+    }
+  };
+  parallel_for(0, rows, grain, [&](size_t begin, size_t end) {
+    mml_dispatch_tier(chunk, begin, end);
+  });
+}
+
+static inline bool mml_pool_has_empty_window(const PoolShape &shape) {
+  auto empty = [](size_t out, size_t size, size_t kernel, size_t stride,
+                  size_t dilation, size_t pad) {
+    for (size_t o = 0; o < out; o++) {
+      if (mml_pool_window(o, size, kernel, stride, dilation, pad).count() ==
+          0) {
+        return true;
+      }
+    }
+    return false;
+  };
+  return shape.planes > 0 &&
+         (empty(shape.out_depth, shape.depth, shape.kernel_depth,
+                shape.stride_depth, shape.dilation_depth, shape.pad_front) ||
+          empty(shape.out_height, shape.height, shape.kernel_height,
+                shape.stride_height, shape.dilation_height, shape.pad_top) ||
+          empty(shape.out_width, shape.width, shape.kernel_width,
+                shape.stride_width, shape.dilation_width, shape.pad_left));
+}
+
+template <TensorConcept::Types T>
+static void mml_max_pool(const PoolShape &shape, const T *input, T *output,
+                         int64_t *indices) {
+  const ptrdiff_t stride = static_cast<ptrdiff_t>(shape.stride_width);
+  mml_pool_rows(
+      shape,
+      [&](size_t row) {
+        T *out = output + row * shape.out_width;
+        std::fill(out, out + shape.out_width, std::numeric_limits<T>::lowest());
+        if (indices) {
+          std::fill(indices + row * shape.out_width,
+                    indices + (row + 1) * shape.out_width, int64_t(-1));
+        }
+      },
+      [&](size_t row, size_t in_row, const PoolRange &columns,
+          ptrdiff_t offset) {
+        T *out = output + row * shape.out_width;
+        const T *in = input + in_row;
+        if (indices) {
+          // Strictly greater, the first maximum of the window is kept
+          int64_t *index = indices + row * shape.out_width;
+          for (size_t ow = columns.begin; ow < columns.end; ow++) {
+            const ptrdiff_t iw = static_cast<ptrdiff_t>(ow) * stride + offset;
+            if (in[iw] > out[ow]) {
+              out[ow] = in[iw];
+              index[ow] = static_cast<int64_t>(in_row) + iw;
+            }
+          }
+        } else if (stride == 1) {
+          const T *src = in + offset;
+          for (size_t ow = columns.begin; ow < columns.end; ow++) {
+            out[ow] = std::max(out[ow], src[ow]);
+          }
+        } else {
+          for (size_t ow = columns.begin; ow < columns.end; ow++) {
+            out[ow] = std::max(
+                out[ow], in[static_cast<ptrdiff_t>(ow) * stride + offset]);
+          }
+        }
+      },
+      [](size_t, size_t) {});
+}
+
+template <TensorConcept::Types T>
+static void mml_avg_pool(const PoolShape &shape, bool count_include_pad,
+                         const T *input, T *output) {
+  const ptrdiff_t stride = static_cast<ptrdiff_t>(shape.stride_width);
+
+  // Width positions of the window of every output column inside the input
+  std::vector<size_t> column_counts(shape.out_width);
+  for (size_t ow = 0; ow < shape.out_width; ow++) {
+    column_counts[ow] =
+        mml_pool_window(ow, shape.width, shape.kernel_width,
+                        shape.stride_width, shape.dilation_width,
+                        shape.pad_left)
+            .count();
+  }
+  const size_t window =
+      shape.kernel_depth * shape.kernel_height * shape.kernel_width;
+
+  mml_pool_rows(
+      shape,
+      [&](size_t row) {
+        T *out = output + row * shape.out_width;
+        std::fill(out, out + shape.out_width, T(0));
+      },
+      [&](size_t row, size_t in_row, const PoolRange &columns,
+          ptrdiff_t offset) {
+        T *out = output + row * shape.out_width;
+        const T *in = input + in_row;
+        if (stride == 1) {
+          const T *src = in + offset;
+          for (size_t ow = columns.begin; ow < columns.end; ow++) {
+            out[ow] += src[ow];
+          }
+        } else {
+          for (size_t ow = columns.begin; ow < columns.end; ow++) {
+            out[ow] += in[static_cast<ptrdiff_t>(ow) * stride + offset];
+          }
+        }
+      },
+      [&](size_t row, size_t row_count) {
+        T *out = output + row * shape.out_width;
+        if (count_include_pad) {
+          const T divisor = static_cast<T>(window);
+          for (size_t ow = 0; ow < shape.out_width; ow++) {
+            out[ow] /= divisor;
+          }
+        } else {
+          for (size_t ow = 0; ow < shape.out_width; ow++) {
+            out[ow] /= static_cast<T>(row_count * column_counts[ow]);
+          }
+        }
+      });
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "operations/cpu_dispatch.hpp"
+#include "operations/reduction.hpp"
+#include "utility/thread_pool.hpp"
+
+// Minimum number of input elements per parallel chunk
+static constexpr size_t mml_reduce_grain = 16384;
+
+// Independent accumulators of a contiguous row, enough to fill a SIMD
+// register of floats and to hide the latency of the combining instruction
+static constexpr size_t mml_reduce_lanes = 8;
+
+// Inner values combined by one parallel chunk of a strided pass
+static constexpr size_t mml_reduce_tile = 4096;
+
+/**
+ * Reduces the count rows of the [outer, count, inner] input into the
+ * [outer, inner] output, combining map of every value with combine.
+ */
+template <typename T, typename Map, typename Combine>
+static void mml_reduce_pass(size_t outer, size_t count, size_t inner, T init,
+                            const T *input, T *output, Map map,
+                            Combine combine) {
+  if (inner == 1) {
+    const size_t grain =
+        std::max<size_t>(1, mml_reduce_grain / std::max<size_t>(count, 1));
+    // The lanes of a row are combined by a loop built for the current tier
+    auto chunk = [&](size_t begin, size_t end) {
+      for (size_t o = begin; o < end; o++) {
+        const T *in = input + o * count;
+        T lanes[mml_reduce_lanes];
+        std::fill(lanes, lanes + mml_reduce_lanes, init);
+        size_t i = 0;
+        for (; i + mml_reduce_lanes <= count; i += mml_reduce_lanes) {
+          for (size_t l = 0; l < mml_reduce_lanes; l++) {
+            lanes[l] = combine(lanes[l], map(in[i + l]));
+          }
+        }
+        for (; i < count; i++) {
+          lanes[0] = combine(lanes[0], map(in[i]));
+        }
+        T result = lanes[0];
+        for (size_t l = 1; l < mml_reduce_lanes; l++) {
+          result = combine(result, lanes[l]);
+        }
+        output[o] = result;
+      }
+    };
+    parallel_for(0, outer, grain, [&](size_t begin, size_t end) {
+      mml_dispatch_tier(chunk, begin, end);
+    });
+    return;
+  }
+
+  // Every chunk owns a tile of the inner values of one outer index and
+  // combines the count rows into it one after the other, with the vector
+  // width of the selected tier
+  const size_t tiles = (inner + mml_reduce_tile - 1) / mml_reduce_tile;
+  const size_t tile = std::min(inner, mml_reduce_tile);
+  const size_t grain = std::max<size_t>(
+      1, mml_reduce_grain / std::max<size_t>(count * tile, 1));
+  auto chunk = [&](size_t begin, size_t end) {
+    for (size_t task = begin; task < end; task++) {
+      const size_t o = task / tiles;
+      const size_t first = (task % tiles) * mml_reduce_tile;
+      const size_t last = std::min(inner, first + mml_reduce_tile);
+      T *out = output + o * inner;
+      std::fill(out + first, out + last, init);
+      for (size_t r = 0; r < count; r++) {
+        const T *in = input + (o * count + r) * inner;
+        for (size_t i = first; i < last; i++) {
+          out[i] = combine(out[i], map(in[i]));
+        }
+      }
+    }
+  };
+  parallel_for(0, outer * tiles, grain, [&](size_t begin, size_t end) {
+    mml_dispatch_tier(chunk, begin, end);
+  });
+}
+
+/**
+ * Runs one pass per run of reduced dimensions, the innermost first. Map is
+ * only applied by the first pass, the later ones combine partial results.
+ */
+template <typename T, typename Map, typename Combine>
+static void mml_reduce_runs(std::vector<size_t> dims, std::vector<bool> flags,
+                            T init, const T *input, T *output, Map map,
+                            Combine combine) {
+  std::vector<T> buffers[2];
+  const T *source = input;
+  bool first = true;
+  for (size_t run = dims.size(); run-- > 0;) {
+    if (!flags[run]) {
+      continue;
+    }
+    size_t outer = 1;
+    size_t inner = 1;
+    bool last = true;
+    for (size_t d = 0; d < run; d++) {
+      outer *= dims[d];
+      last = last && !flags[d];
+    }
+    for (size_t d = run + 1; d < dims.size(); d++) {
+      inner *= dims[d];
+    }
+
+    T *target = output;
+    if (!last) {
+      std::vector<T> &buffer = buffers[source == buffers[0].data() ? 1 : 0];
+      buffer.resize(outer * inner);
+      target = buffer.data();
+    }
+    if (first) {
+      mml_reduce_pass(outer, dims[run], inner, init, source, target, map,
+                      combine);
+    } else {
+      mml_reduce_pass(
+          outer, dims[run], inner, init, source, target, [](T x) { return x; },
+          combine);
+    }
+    first = false;
+    source = target;
+    dims.erase(dims.begin() + run);
+    flags.erase(flags.begin() + run);
+  }
+}
+
+template <TensorConcept::Types T>
+static void mml_reduce(ReductionKind kind, const std::vector<size_t> &shape,
+                       const std::vector<bool> &reduced, const T *input,
+                       T *output) {
+  // Merge neighbouring dimensions of the same kind, size 1 ones change nothing
+  std::vector<size_t> dims;
+  std::vector<bool> flags;
+  size_t reduced_count = 1;
+  size_t kept_count = 1;
+  for (size_t i = 0; i < shape.size(); i++) {
+    (reduced[i] ? reduced_count : kept_count) *= shape[i];
+    if (shape[i] == 1) {
+      continue;
+    }
+    if (!dims.empty() && flags.back() == reduced[i]) {
+      dims.back() *= shape[i];
+    } else {
+      dims.push_back(shape[i]);
+      flags.push_back(reduced[i]);
+    }
+  }
+
+  const bool is_max = kind == ReductionKind::Max;
+  const bool is_min = kind == ReductionKind::Min;
+  const T init = is_max   ? std::numeric_limits<T>::lowest()
+                 : is_min ? std::numeric_limits<T>::max()
+                          : T(0);
+  if (reduced_count == 0 || kept_count == 0 ||
+      std::find(flags.begin(), flags.end(), true) == flags.end()) {
+    // Nothing to combine, every output is the initial value or its input
+    for (size_t i = 0; i < kept_count; i++) {
+      if (reduced_count == 0) {
+        output[i] = init;
+      } else if (kind == ReductionKind::L2) {
+        output[i] = static_cast<T>(input[i] * input[i]);
+      } else {
+        output[i] = input[i];
+      }
+    }
+  } else if (is_max) {
+    mml_reduce_runs(
+        dims, flags, init, input, output, [](T x) { return x; },
+        [](T a, T b) { return std::max(a, b); });
+  } else if (is_min) {
+    mml_reduce_runs(
+        dims, flags, init, input, output, [](T x) { return x; },
+        [](T a, T b) { return std::min(a, b); });
+  } else if (kind == ReductionKind::L2) {
+    mml_reduce_runs(
+        dims, flags, init, input, output, [](T x) { return x * x; },
+        [](T a, T b) { return static_cast<T>(a + b); });
+  } else {
+    mml_reduce_runs(
+        dims, flags, init, input, output, [](T x) { return x; },
+        [](T a, T b) { return static_cast<T>(a + b); });
+  }
+
+  if (kind == ReductionKind::Mean && reduced_count > 1) {
+    for (size_t i = 0; i < kept_count; i++) {
+      output[i] = static_cast<T>(output[i] / static_cast<T>(reduced_count));
+    }
+  } else if (kind == ReductionKind::L2 && reduced_count != 0) {
+    for (size_t i = 0; i < kept_count; i++) {
+      output[i] = static_cast<T>(std::sqrt(static_cast<double>(output[i])));
+    }
+  }
+}
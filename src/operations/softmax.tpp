@@ -0,0 +1,240 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+#include "operations/cpu_dispatch.hpp"
+#include "operations/softmax.hpp"
+#include "operations/vector_math.hpp"
+#include "utility/thread_pool.hpp"
+
+// Minimum number of input elements per parallel chunk
+static constexpr size_t mml_softmax_grain = 16384;
+
+// Values of a contiguous row exponentiated and summed together, small enough
+// for the block to stay in the L1 cache
+static constexpr size_t mml_softmax_block = 256;
+
+// Inner values of strided rows processed together by one parallel chunk
+static constexpr size_t mml_softmax_tile = 256;
+
+// Independent accumulators of the maxima and sums of a block, enough to fill a
+// SIMD register of floats
+static constexpr size_t mml_softmax_lanes = 8;
+
+/**
+ * Gets the largest of the n values of x, -infinity if n is 0.
+ */
+template <typename T>
+static T mml_softmax_max(const T *x, size_t n) {
+  T lanes[mml_softmax_lanes];
+  std::fill(lanes, lanes + mml_softmax_lanes,
+            -std::numeric_limits<T>::infinity());
+  size_t i = 0;
+  for (; i + mml_softmax_lanes <= n; i += mml_softmax_lanes) {
+    for (size_t l = 0; l < mml_softmax_lanes; l++) {
+      lanes[l] = x[i + l] > lanes[l] ? x[i + l] : lanes[l];
+    }
+  }
+  for (; i < n; i++) {
+    lanes[0] = x[i] > lanes[0] ? x[i] : lanes[0];
+  }
+  return *std::max_element(lanes, lanes + mml_softmax_lanes);
+}
+
+/**
+ * Writes exp(x[i] - shift) to y and returns their sum.
+ */
+template <typename T>
+static T mml_softmax_exp_sum(const T *x, T shift, T *y, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    y[i] = x[i] - shift;
+  }
+  mml_vexp(y, y, n);
+  T lanes[mml_softmax_lanes] = {};
+  size_t i = 0;
+  for (; i + mml_softmax_lanes <= n; i += mml_softmax_lanes) {
+    for (size_t l = 0; l < mml_softmax_lanes; l++) {
+      lanes[l] += y[i + l];
+    }
+  }
+  for (; i < n; i++) {
+    lanes[0] += y[i];
+  }
+  T sum = 0;
+  for (size_t l = 0; l < mml_softmax_lanes; l++) {
+    sum += lanes[l];
+  }
+  return sum;
+}
+
+/**
+ * Computes the softmax of the count contiguous values of x. block_max holds
+ * one value per block of the row, for the blocks to be rescaled once the
+ * maximum of the whole row is known.
+ */
+template <typename T>
+static void mml_softmax_row(SoftmaxKind kind, const T *x, T *y, size_t count,
+                            T *block_max) {
+  constexpr T lowest = -std::numeric_limits<T>::infinity();
+  T scratch[mml_softmax_block];
+  T max = lowest;
+  T sum = 0;
+  for (size_t start = 0, b = 0; start < count;
+       start += mml_softmax_block, b++) {
+    const size_t n = std::min(mml_softmax_block, count - start);
+    T *exp = kind == SoftmaxKind::Softmax ? y + start : scratch;
+    const T local_max = mml_softmax_max(x + start, n);
+    T local_sum = 0;
+    if (local_max == lowest) {
+      // Every value is -infinity, exp(-infinity - max) is 0 for any max
+      std::fill(exp, exp + n, T(0));
+    } else {
+      local_sum = mml_softmax_exp_sum(x + start, local_max, exp, n);
+    }
+
+    // Online rescaling, the sum is kept relative to the largest maximum
+    if (local_max > max) {
+      sum = sum * std::exp(max - local_max) + local_sum;
+      max = local_max;
+    } else if (local_sum != 0) {
+      sum += local_sum * std::exp(local_max - max);
+    }
+    block_max[b] = local_max;
+  }
+
+  if (kind == SoftmaxKind::LogSoftmax) {
+    const T shift = max + std::log(sum);
+    for (size_t i = 0; i < count; i++) {
+      y[i] = x[i] - shift;
+    }
+    return;
+  }
+
+  const T inverse = static_cast<T>(1) / sum;
+  for (size_t start = 0, b = 0; start < count;
+       start += mml_softmax_block, b++) {
+    const size_t n = std::min(mml_softmax_block, count - start);
+    const T scale = std::exp(block_max[b] - max) * inverse;
+    for (size_t i = start; i < start + n; i++) {
+      y[i] *= scale;
+    }
+  }
+}
+
+/**
+ * Computes the softmax of the strided rows of the inner values first to last
+ * of the [count, inner] input x.
+ */
+template <typename T>
+static void mml_softmax_tile_rows(SoftmaxKind kind, const T *x, T *y,
+                                  size_t count, size_t inner, size_t first,
+                                  size_t last) {
+  const size_t n = last - first;
+  T max[mml_softmax_tile];
+  T sum[mml_softmax_tile];
+  T scratch[mml_softmax_tile];
+  std::fill(max, max + n, -std::numeric_limits<T>::infinity());
+  std::fill(sum, sum + n, T(0));
+
+  for (size_t r = 0; r < count; r++) {
+    const T *in = x + r * inner + first;
+    for (size_t i = 0; i < n; i++) {
+      max[i] = in[i] > max[i] ? in[i] : max[i];
+    }
+  }
+
+  for (size_t r = 0; r < count; r++) {
+    const T *in = x + r * inner + first;
+    T *exp = kind == SoftmaxKind::Softmax ? y + r * inner + first : scratch;
+    for (size_t i = 0; i < n; i++) {
+      exp[i] = in[i] - max[i];
+    }
+    mml_vexp(exp, exp, n);
+    for (size_t i = 0; i < n; i++) {
+      sum[i] += exp[i];
+    }
+  }
+
+  if (kind == SoftmaxKind::LogSoftmax) {
+    mml_vlog(sum, sum, n);
+    for (size_t i = 0; i < n; i++) {
+      sum[i] += max[i];
+    }
+    for (size_t r = 0; r < count; r++) {
+      const T *in = x + r * inner + first;
+      T *out = y + r * inner + first;
+      for (size_t i = 0; i < n; i++) {
+        out[i] = in[i] - sum[i];
+      }
+    }
+    return;
+  }
+
+  for (size_t i = 0; i < n; i++) {
+    sum[i] = static_cast<T>(1) / sum[i];
+  }
+  for (size_t r = 0; r < count; r++) {
+    T *out = y + r * inner + first;
+    for (size_t i = 0; i < n; i++) {
+      out[i] *= sum[i];
+    }
+  }
+}
+
+template <typename T>
+static void mml_softmax(SoftmaxKind kind, const std::vector<size_t> &shape,
+                        size_t axis, const T *input, T *output) {
+  static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>,
+                "The softmax kernels take float or double");
+  size_t outer = 1;
+  size_t inner = 1;
+  for (size_t d = 0; d < axis; d++) {
+    outer *= shape[d];
+  }
+  for (size_t d = axis + 1; d < shape.size(); d++) {
+    inner *= shape[d];
+  }
+  const size_t count = shape[axis];
+  if (outer == 0 || count == 0 || inner == 0) {
+    return;
+  }
+
+  if (inner == 1) {
+    const size_t blocks = (count + mml_softmax_block - 1) / mml_softmax_block;
+    const size_t grain = std::max<size_t>(1, mml_softmax_grain / count);
+    // The row passes are inlined into clones built for every tier
+    auto chunk = [&](size_t begin, size_t end) {
+      std::vector<T> block_max(blocks);
+      for (size_t o = begin; o < end; o++) {
+        mml_softmax_row(kind, input + o * count, output + o * count, count,
+                        block_max.data());
+      }
+    };
+    parallel_for(0, outer, grain, [&](size_t begin, size_t end) {
+      mml_dispatch_tier(chunk, begin, end);
+    });
+    return;
+  }
+
+  const size_t tiles = (inner + mml_softmax_tile - 1) / mml_softmax_tile;
+  const size_t tile = std::min(inner, mml_softmax_tile);
+  const size_t grain = std::max<size_t>(
+      1, mml_softmax_grain / std::max<size_t>(count * tile, 1));
+  // A tile of columns runs through the rows at the width of the selected tier
+  auto chunk = [&](size_t begin, size_t end) {
+    for (size_t task = begin; task < end; task++) {
+      const size_t o = task / tiles;
+      const size_t first = (task % tiles) * mml_softmax_tile;
+      const size_t last = std::min(inner, first + mml_softmax_tile);
+      mml_softmax_tile_rows(kind, input + o * count * inner,
+                            output + o * count * inner, count, inner, first,
+                            last);
+    }
+  };
+  parallel_for(0, outer * tiles, grain, [&](size_t begin, size_t end) {
+    mml_dispatch_tier(chunk, begin, end);
+  });
+}
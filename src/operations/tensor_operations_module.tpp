@@ -37,6 +37,24 @@ void TensorOperations::set_elementwise_in_place_ptr(
 template <TensorConcept::Types... Ts>
 void TensorOperations::set_gemm_ptr(toft::gemm_func<Ts>... ptr) {
   (..., (gemm_ptr<Ts> = ptr));
+  (..., (packed_gemm<Ts> = false));
+}
+
+template <TensorConcept::Types... Ts>
+void TensorOperations::reset_gemm_ptr() {
+  (..., (gemm_ptr<Ts> = mml_gemm_packed<Ts>));
+  (..., (packed_gemm<Ts> = true));
+}
+
+template <TensorConcept::Types T>
+bool TensorOperations::has_packed_gemm() {
+  return packed_gemm<T>;
+}
+
+template <TensorConcept::Types... Ts>
+void TensorOperations::set_gemm_strided_batched_ptr(
+    toft::gemm_strided_batched_func<Ts>... ptr) {
+  (..., (gemm_strided_batched_ptr<Ts> = ptr));
 }
 
 template <TensorConcept::Types... Ts>
@@ -103,6 +121,20 @@ void TensorOperations::gemm(int TA, int TB, int M, int N, int K, T ALPHA,
   gemm_ptr<T>(TA, TB, M, N, K, ALPHA, A, lda, B, ldb, BETA, C, ldc);
 }
 
+template <TensorConcept::Types T>
+void TensorOperations::gemm_strided_batched(
+    int TA, int TB, int M, int N, int K, T ALPHA, std::shared_ptr<Tensor<T>> A,
+    int lda, const std::vector<size_t>& a_batch_strides,
+    std::shared_ptr<Tensor<T>> B, int ldb,
+    const std::vector<size_t>& b_batch_strides, T BETA,
+    std::shared_ptr<Tensor<T>> C, int ldc,
+    const std::vector<size_t>& c_batch_strides,
+    const std::vector<size_t>& batch_shape) {
+  gemm_strided_batched_ptr<T>(TA, TB, M, N, K, ALPHA, A, lda, a_batch_strides,
+                              B, ldb, b_batch_strides, BETA, C, ldc,
+                              c_batch_strides, batch_shape);
+}
+
 template <TensorConcept::Types T>
 std::shared_ptr<Tensor<T>> TensorOperations::gemm_onnx(
     std::shared_ptr<Tensor<T>> A, std::shared_ptr<Tensor<T>> B, float alpha,
@@ -0,0 +1,67 @@
+#include "operations/vector_math.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+// Current accuracy tier, -1 until it is first needed
+std::atomic<int> current_accuracy = -1;
+
+}  // namespace
+
+MathAccuracy VectorMath::get_accuracy() {
+  int accuracy = current_accuracy.load(std::memory_order_relaxed);
+  if (accuracy < 0) {
+    // Racing first calls all compute the same tier
+    accuracy = static_cast<int>(startup_accuracy());
+    current_accuracy.store(accuracy, std::memory_order_relaxed);
+  }
+  return static_cast<MathAccuracy>(accuracy);
+}
+
+void VectorMath::set_accuracy(MathAccuracy accuracy) {
+  current_accuracy.store(static_cast<int>(accuracy),
+                         std::memory_order_relaxed);
+}
+
+std::string VectorMath::accuracy_name(MathAccuracy accuracy) {
+  switch (accuracy) {
+    case MathAccuracy::Precise:
+      return "precise";
+    case MathAccuracy::Fast:
+      return "fast";
+  }
+  throw std::invalid_argument("VectorMath: Unknown accuracy");
+}
+
+MathAccuracy VectorMath::parse_accuracy(const std::string &name) {
+  std::string lower = name;
+  std::transform(lower.begin(), lower.end(), lower.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  for (MathAccuracy accuracy : {MathAccuracy::Precise, MathAccuracy::Fast}) {
+    if (lower == accuracy_name(accuracy)) {
+      return accuracy;
+    }
+  }
+  throw std::invalid_argument("VectorMath: Unknown accuracy " + name);
+}
+
+MathAccuracy VectorMath::startup_accuracy() {
+  const char *requested = std::getenv("MML_MATH_ACCURACY");
+  if (!requested || !*requested) {
+    return MathAccuracy::Precise;
+  }
+
+  try {
+    return parse_accuracy(requested);
+  } catch (const std::invalid_argument &e) {
+    std::cerr << "MML_MATH_ACCURACY: " << e.what() << ", using precise"
+              << std::endl;
+    return MathAccuracy::Precise;
+  }
+}
@@ -0,0 +1,507 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include "operations/cpu_dispatch.hpp"
+#include "operations/vector_math.hpp"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define MML_VECTOR_MATH 1
+#else
+#define MML_VECTOR_MATH 0
+#endif
+
+#if MML_VECTOR_MATH
+
+// The kernels are inlined into the loop of every tier, which gives them the
+// instruction set of the tier. They pass vectors through references, because
+// passing them by value from code built without that instruction set changes
+// their calling convention, which GCC warns about.
+#define MML_VMATH_INLINE inline __attribute__((always_inline))
+
+/**
+ * Vectors of Bytes bytes of T, and of the signed integers of the same width
+ * that comparisons return and the bit tricks work on.
+ */
+template <typename T, size_t Bytes>
+struct mml_vmath_vector;
+
+template <>
+struct mml_vmath_vector<float, 16> {
+  typedef float type __attribute__((vector_size(16)));
+  typedef int32_t bits __attribute__((vector_size(16)));
+};
+
+template <>
+struct mml_vmath_vector<float, 32> {
+  typedef float type __attribute__((vector_size(32)));
+  typedef int32_t bits __attribute__((vector_size(32)));
+};
+
+template <>
+struct mml_vmath_vector<float, 64> {
+  typedef float type __attribute__((vector_size(64)));
+  typedef int32_t bits __attribute__((vector_size(64)));
+};
+
+template <>
+struct mml_vmath_vector<double, 16> {
+  typedef double type __attribute__((vector_size(16)));
+  typedef int64_t bits __attribute__((vector_size(16)));
+};
+
+template <>
+struct mml_vmath_vector<double, 32> {
+  typedef double type __attribute__((vector_size(32)));
+  typedef int64_t bits __attribute__((vector_size(32)));
+};
+
+template <>
+struct mml_vmath_vector<double, 64> {
+  typedef double type __attribute__((vector_size(64)));
+  typedef int64_t bits __attribute__((vector_size(64)));
+};
+
+/**
+ * Constants of the floating point formats and polynomial lengths.
+ */
+template <typename T>
+struct mml_vmath_constants;
+
+template <>
+struct mml_vmath_constants<float> {
+  typedef int32_t integer;
+  static constexpr int mantissa_bits = 23;
+  static constexpr integer exponent_bias = 127;
+  static constexpr integer exponent_mask = 0xff;
+  static constexpr integer mantissa_mask = 0x7fffff;
+  static constexpr integer one_bits = 0x3f800000;
+  // Adding it rounds to an integer held in the low mantissa bits
+  static constexpr float round_magic = 12582912.0f;  // 1.5 * 2^23
+  // Scales subnormals up to normal numbers
+  static constexpr float subnormal_scale = 33554432.0f;  // 2^25
+  static constexpr integer subnormal_bits = 25;
+
+  // exp(x) overflows above exp_max and underflows below exp_min
+  static constexpr float exp_max = 89.0f;
+  static constexpr float exp_min = -104.0f;
+  // expm1(x) rounds to -1 below it
+  static constexpr float expm1_min = -30.0f;
+  // ln 2 with 9 significant bits, and the rest
+  static constexpr float exp_ln2_hi = 0.693359375f;
+  static constexpr float exp_ln2_lo = -2.12194440e-4f;
+  static constexpr float log_ln2_hi = 0.693359375f;
+  static constexpr float log_ln2_lo = -2.12194440e-4f;
+
+  static constexpr int exp_degree = 7;
+  static constexpr int exp_fast_degree = 5;
+  static constexpr int expm1_degree = 8;
+  static constexpr int expm1_fast_degree = 6;
+  static constexpr int log_terms = 4;
+  static constexpr int erf_series_terms = 7;
+
+  // Chebyshev coefficients of log(erfcx(x) / t) over t = 2 / (2 + x) in
+  // [0, 0.8], with erfcx(x) = exp(x^2) erfc(x). Maximum error 2.6e-9.
+  static constexpr std::array<float, 12> erfc_chebyshev = {
+      -7.831870727240600738028e-01f, 5.058947933173406630303e-01f,
+      2.016533229570118337937e-02f,  -4.150784270485571685050e-03f,
+      -6.929393033231204734532e-04f, 8.061304454470651472200e-05f,
+      2.585099955676822838465e-05f,  -2.453242742944732596161e-06f,
+      -1.066561125257902680139e-06f, 1.095859815952300201248e-07f,
+      4.610924009341390682554e-08f,  -6.703026249006154701490e-09f};
+};
+
+template <>
+struct mml_vmath_constants<double> {
+  typedef int64_t integer;
+  static constexpr int mantissa_bits = 52;
+  static constexpr integer exponent_bias = 1023;
+  static constexpr integer exponent_mask = 0x7ff;
+  static constexpr integer mantissa_mask = 0xfffffffffffffLL;
+  static constexpr integer one_bits = 0x3ff0000000000000LL;
+  // Adding it rounds to an integer held in the low mantissa bits
+  static constexpr double round_magic = 6755399441055744.0;  // 1.5 * 2^52
+  // Scales subnormals up to normal numbers
+  static constexpr double subnormal_scale = 18014398509481984.0;  // 2^54
+  static constexpr integer subnormal_bits = 54;
+
+  // exp(x) overflows above exp_max and underflows below exp_min
+  static constexpr double exp_max = 710.0;
+  static constexpr double exp_min = -746.0;
+  // expm1(x) rounds to -1 below it
+  static constexpr double expm1_min = -60.0;
+  // ln 2 with 21 and 32 significant bits, and the rests
+  static constexpr double exp_ln2_hi = 6.93145751953125e-1;
+  static constexpr double exp_ln2_lo = 1.42860682030941723212e-6;
+  static constexpr double log_ln2_hi = 6.93147180369123816490e-1;
+  static constexpr double log_ln2_lo = 1.90821492927058770002e-10;
+
+  static constexpr int exp_degree = 13;
+  static constexpr int exp_fast_degree = 10;
+  static constexpr int expm1_degree = 14;
+  static constexpr int expm1_fast_degree = 11;
+  static constexpr int log_terms = 10;
+  static constexpr int erf_series_terms = 13;
+
+  // Chebyshev coefficients of log(erfcx(x) / t) over t = 2 / (2 + x) in
+  // [0, 0.8], with erfcx(x) = exp(x^2) erfc(x). Maximum error 9.8e-18.
+  static constexpr std::array<double, 25> erfc_chebyshev = {
+      -7.831870727240599627805e-01, 5.058947933173406630303e-01,
+      2.016533229570041316214e-02,  -4.150784270483713796207e-03,
+      -6.929393033131828931806e-04, 8.061304448090166410463e-05,
+      2.585099951076617395113e-05,  -2.453241361936653774418e-06,
+      -1.066562894905651603204e-06, 1.095613620127264719180e-07,
+      4.618283721422925195829e-08,  -6.305089137369667068918e-09,
+      -1.963330987235359472160e-09, 3.979371116364941466189e-10,
+      7.359712081538185181029e-11,  -2.461958250376576177384e-11,
+      -1.769647748641225739543e-12, 1.381008080731900686413e-12,
+      -4.600206594399368408139e-14, -6.380483819632490211882e-14,
+      9.937707476237303063201e-15,  1.856965007826926826417e-15,
+      -7.706664034702890670208e-16, 3.106081841473968053832e-17,
+      3.460258399259602234056e-17};
+};
+
+/**
+ * The Taylor coefficients 1 / k! of exp for k from 0 to Degree.
+ */
+template <typename T, int Degree>
+static constexpr std::array<T, Degree + 1> mml_vmath_exp_taylor() {
+  std::array<T, Degree + 1> coefficients{};
+  double factorial = 1;
+  for (int k = 0; k <= Degree; k++) {
+    factorial *= k > 0 ? k : 1;
+    coefficients[k] = static_cast<T>(1 / factorial);
+  }
+  return coefficients;
+}
+
+/**
+ * The coefficients 2 / (2k + 1) of log((1 + s) / (1 - s)) = 2s + s * R(s^2)
+ * for k from 1 to Terms.
+ */
+template <typename T, int Terms>
+static constexpr std::array<T, Terms> mml_vmath_log_series() {
+  std::array<T, Terms> coefficients{};
+  for (int k = 1; k <= Terms; k++) {
+    coefficients[k - 1] = static_cast<T>(2.0 / (2 * k + 1));
+  }
+  return coefficients;
+}
+
+/**
+ * The Taylor coefficients of erf(x) / x in x^2, 2 / sqrt(pi) (-1)^n /
+ * (n! (2n + 1)) for n below Terms.
+ */
+template <typename T, int Terms>
+static constexpr std::array<T, Terms> mml_vmath_erf_series() {
+  std::array<T, Terms> coefficients{};
+  double term = 1.128379167095512573896;  // 2 / sqrt(pi)
+  for (int n = 0; n < Terms; n++) {
+    coefficients[n] = static_cast<T>(term / (2 * n + 1));
+    term = -term / (n + 1);
+  }
+  return coefficients;
+}
+
+/**
+ * Sets y to a where mask is set and to b elsewhere.
+ */
+template <typename V, typename I>
+static MML_VMATH_INLINE void mml_vmath_select(V &y, const I &mask, const V &a,
+                                              const V &b) {
+  y = (V)((mask & (I)a) | (~mask & (I)b));
+}
+
+/**
+ * Splits x into n * ln(2) + r with |r| <= ln(2) / 2 after clamping it to
+ * [low, exp_max], and sets scale and scale_rest to 2^(n / 2) and 2^(n - n / 2)
+ * so that neither overflows where 2^n does.
+ */
+template <typename T, typename V, typename I>
+static MML_VMATH_INLINE void mml_vmath_exp_reduce(const V &x, T low, V &r,
+                                                  V &scale, V &scale_rest) {
+  using C = mml_vmath_constants<T>;
+  V v = x;
+  // NaN fails both comparisons and is kept
+  mml_vmath_select(v, v < low, V{} + low, v);
+  mml_vmath_select(v, v > C::exp_max, V{} + C::exp_max, v);
+
+  const V magic = V{} + C::round_magic;
+  const V shifted = v * static_cast<T>(1.442695040888963407360) + magic;
+  const V n = shifted - magic;
+  r = (v - n * C::exp_ln2_hi) - n * C::exp_ln2_lo;
+
+  const I k = (I)shifted - (I)magic;
+  const I half = k >> 1;
+  scale = (V)((half + C::exponent_bias) << C::mantissa_bits);
+  scale_rest = (V)((k - half + C::exponent_bias) << C::mantissa_bits);
+}
+
+struct mml_vexp_kernel {
+  template <typename T, typename V, typename I, bool Fast>
+  static MML_VMATH_INLINE void apply(const V &x, V &y) {
+    using C = mml_vmath_constants<T>;
+    constexpr int degree = Fast ? C::exp_fast_degree : C::exp_degree;
+    static constexpr auto coefficients = mml_vmath_exp_taylor<T, degree>();
+
+    V r, scale, scale_rest;
+    mml_vmath_exp_reduce<T, V, I>(x, C::exp_min, r, scale, scale_rest);
+    V p = V{} + coefficients[degree];
+    for (int k = degree - 1; k >= 0; k--) {
+      p = p * r + coefficients[k];
+    }
+    y = p * scale * scale_rest;
+  }
+};
+
+struct mml_vexpm1_kernel {
+  template <typename T, typename V, typename I, bool Fast>
+  static MML_VMATH_INLINE void apply(const V &x, V &y) {
+    using C = mml_vmath_constants<T>;
+    constexpr int degree = Fast ? C::expm1_fast_degree : C::expm1_degree;
+    static constexpr auto coefficients = mml_vmath_exp_taylor<T, degree>();
+
+    V r, scale, scale_rest;
+    mml_vmath_exp_reduce<T, V, I>(x, C::expm1_min, r, scale, scale_rest);
+    // expm1(r) without its constant term, exact for x = r
+    V p = V{} + coefficients[degree];
+    for (int k = degree - 1; k >= 1; k--) {
+      p = p * r + coefficients[k];
+    }
+    const V q = p * r;
+    // 2^n expm1(r) + 2^n - 1
+    y = q * scale * scale_rest + (scale * scale_rest - static_cast<T>(1));
+  }
+};
+
+struct mml_vlog_kernel {
+  template <typename T, typename V, typename I, bool Fast>
+  static MML_VMATH_INLINE void apply(const V &x, V &y) {
+    using C = mml_vmath_constants<T>;
+    static constexpr auto coefficients =
+        mml_vmath_log_series<T, C::log_terms>();
+
+    // Subnormals are scaled up and their exponent corrected
+    V v = x;
+    const I subnormal = v < std::numeric_limits<T>::min();
+    mml_vmath_select(v, subnormal, v * C::subnormal_scale, v);
+    I e = (((I)v >> C::mantissa_bits) & C::exponent_mask) - C::exponent_bias;
+    e -= subnormal & C::subnormal_bits;
+
+    // x = 2^e m with m in [sqrt(2) / 2, sqrt(2)]
+    V m = (V)(((I)v & C::mantissa_mask) | C::one_bits);
+    const I above = m > static_cast<T>(1.414213562373095048802);
+    mml_vmath_select(m, above, m * static_cast<T>(0.5), m);
+    e -= above;
+
+    // log(m) = log((1 + s) / (1 - s)) with s = f / (2 + f) and f = m - 1
+    const V f = m - static_cast<T>(1);
+    const V s = f / (f + static_cast<T>(2));
+    const V z = s * s;
+    V series = V{} + coefficients[C::log_terms - 1];
+    for (int k = C::log_terms - 2; k >= 0; k--) {
+      series = series * z + coefficients[k];
+    }
+    series *= z;
+    const V half_square = static_cast<T>(0.5) * f * f;
+    const V dk = __builtin_convertvector(e, V);
+    y = dk * C::log_ln2_hi -
+        ((half_square - (s * (half_square + series) + dk * C::log_ln2_lo)) -
+         f);
+
+    mml_vmath_select(y, x < static_cast<T>(0),
+                     V{} + std::numeric_limits<T>::quiet_NaN(), y);
+    mml_vmath_select(y, x == static_cast<T>(0),
+                     V{} - std::numeric_limits<T>::infinity(), y);
+    mml_vmath_select(y, x == std::numeric_limits<T>::infinity(), x, y);
+    mml_vmath_select(y, x != x, x, y);
+  }
+};
+
+struct mml_vtanh_kernel {
+  template <typename T, typename V, typename I, bool Fast>
+  static MML_VMATH_INLINE void apply(const V &x, V &y) {
+    using C = mml_vmath_constants<T>;
+    const I sign = I{} + std::numeric_limits<typename C::integer>::min();
+    // tanh(|x|) rounds to 1 above 20
+    V a = (V)((I)x & ~sign);
+    mml_vmath_select(a, a > static_cast<T>(20), V{} + static_cast<T>(20), a);
+
+    // tanh(a) = expm1(2a) / (expm1(2a) + 2)
+    const V twice = a + a;
+    V e;
+    mml_vexpm1_kernel::apply<T, V, I, Fast>(twice, e);
+    const V t = e / (e + static_cast<T>(2));
+    y = (V)((I)t | ((I)x & sign));
+  }
+};
+
+struct mml_verf_kernel {
+  template <typename T, typename V, typename I, bool Fast>
+  static MML_VMATH_INLINE void apply(const V &x, V &y) {
+    using C = mml_vmath_constants<T>;
+    static constexpr auto series =
+        mml_vmath_erf_series<T, C::erf_series_terms>();
+    const I sign = I{} + std::numeric_limits<typename C::integer>::min();
+    const V a = (V)((I)x & ~sign);
+    const V z = x * x;
+
+    // Taylor series below 0.5
+    V p = V{} + series[C::erf_series_terms - 1];
+    for (int n = C::erf_series_terms - 2; n >= 0; n--) {
+      p = p * z + series[n];
+    }
+    const V small = x * p;
+
+    // erf(a) = 1 - t exp(c(t) - a^2) above it, where c is evaluated with the
+    // Clenshaw recurrence at u = 2.5t - 1 in [-1, 1]
+    constexpr auto &chebyshev = C::erfc_chebyshev;
+    const V t = static_cast<T>(2) / (a + static_cast<T>(2));
+    const V u = t * static_cast<T>(2.5) - static_cast<T>(1);
+    const V u2 = u + u;
+    V b1 = V{};
+    V b2 = V{};
+    for (size_t k = chebyshev.size() - 1; k >= 1; k--) {
+      const V b = u2 * b1 - b2 + chebyshev[k];
+      b2 = b1;
+      b1 = b;
+    }
+    const V exponent = u * b1 - b2 + chebyshev[0] - z;
+    V e;
+    mml_vexp_kernel::apply<T, V, I, false>(exponent, e);
+    V large = static_cast<T>(1) - t * e;
+    large = (V)((I)large | ((I)x & sign));
+
+    mml_vmath_select(y, a < static_cast<T>(0.5), small, large);
+  }
+};
+
+struct mml_vsigmoid_kernel {
+  template <typename T, typename V, typename I, bool Fast>
+  static MML_VMATH_INLINE void apply(const V &x, V &y) {
+    const V negated = -x;
+    V e;
+    mml_vexp_kernel::apply<T, V, I, Fast>(negated, e);
+    y = static_cast<T>(1) / (e + static_cast<T>(1));
+  }
+};
+
+/**
+ * Runs the kernel over whole vectors of Bytes bytes, then over the tail
+ * copied into a padded vector.
+ */
+template <typename Kernel, typename T, size_t Bytes, bool Fast>
+static MML_VMATH_INLINE void mml_vmath_loop(const T *x, T *y, size_t n) {
+  using V = typename mml_vmath_vector<T, Bytes>::type;
+  using I = typename mml_vmath_vector<T, Bytes>::bits;
+  constexpr size_t lanes = Bytes / sizeof(T);
+
+  size_t i = 0;
+  for (; i + lanes <= n; i += lanes) {
+    V v, r;
+    std::memcpy(&v, x + i, Bytes);
+    Kernel::template apply<T, V, I, Fast>(v, r);
+    std::memcpy(y + i, &r, Bytes);
+  }
+  if (i < n) {
+    V v = V{}, r;
+    std::memcpy(&v, x + i, (n - i) * sizeof(T));
+    Kernel::template apply<T, V, I, Fast>(v, r);
+    std::memcpy(y + i, &r, (n - i) * sizeof(T));
+  }
+}
+
+#if MML_X86_KERNELS
+template <typename Kernel, typename T, bool Fast>
+MML_TARGET_AVX512 static void mml_vmath_avx512(const T *x, T *y, size_t n) {
+  mml_vmath_loop<Kernel, T, 64, Fast>(x, y, n);
+}
+
+template <typename Kernel, typename T, bool Fast>
+MML_TARGET_AVX2 static void mml_vmath_avx2(const T *x, T *y, size_t n) {
+  mml_vmath_loop<Kernel, T, 32, Fast>(x, y, n);
+}
+#endif
+
+template <typename Kernel, typename T, bool Fast>
+static void mml_vmath_portable(const T *x, T *y, size_t n) {
+  mml_vmath_loop<Kernel, T, 16, Fast>(x, y, n);
+}
+
+/**
+ * Runs the kernel built for the current SIMD tier and accuracy.
+ */
+template <typename Kernel, typename T, bool Fast>
+static void mml_vmath_dispatch_tier(const T *x, T *y, size_t n) {
+#if MML_X86_KERNELS
+  switch (CpuDispatch::get_tier()) {
+    case SimdTier::AVX512:
+      mml_vmath_avx512<Kernel, T, Fast>(x, y, n);
+      return;
+    case SimdTier::AVX2:
+      mml_vmath_avx2<Kernel, T, Fast>(x, y, n);
+      return;
+    default:
+      break;
+  }
+#endif
+  mml_vmath_portable<Kernel, T, Fast>(x, y, n);
+}
+
+template <typename Kernel, typename T>
+static void mml_vmath_dispatch(const T *x, T *y, size_t n) {
+  static_assert(std::is_same_v<T, float> || std::is_same_v<T, double>,
+                "The vectorized math functions take float or double");
+  if (VectorMath::get_accuracy() == MathAccuracy::Fast) {
+    mml_vmath_dispatch_tier<Kernel, T, true>(x, y, n);
+  } else {
+    mml_vmath_dispatch_tier<Kernel, T, false>(x, y, n);
+  }
+}
+
+#define MML_VMATH_CALL(kernel, function) \
+  mml_vmath_dispatch<kernel, T>(x, y, n)
+#else
+#define MML_VMATH_CALL(kernel, function) \
+  for (size_t i = 0; i < n; i++) {       \
+    y[i] = function(x[i]);               \
+  }
+#endif
+
+template <typename T>
+static void mml_vexp(const T *x, T *y, size_t n) {
+  MML_VMATH_CALL(mml_vexp_kernel, std::exp);
+}
+
+template <typename T>
+static void mml_vexpm1(const T *x, T *y, size_t n) {
+  MML_VMATH_CALL(mml_vexpm1_kernel, std::expm1);
+}
+
+template <typename T>
+static void mml_vlog(const T *x, T *y, size_t n) {
+  MML_VMATH_CALL(mml_vlog_kernel, std::log);
+}
+
+template <typename T>
+static void mml_vtanh(const T *x, T *y, size_t n) {
+  MML_VMATH_CALL(mml_vtanh_kernel, std::tanh);
+}
+
+template <typename T>
+static void mml_verf(const T *x, T *y, size_t n) {
+  MML_VMATH_CALL(mml_verf_kernel, std::erf);
+}
+
+template <typename T>
+static void mml_vsigmoid(const T *x, T *y, size_t n) {
+  MML_VMATH_CALL(mml_vsigmoid_kernel,
+                 [](T v) { return 1 / (1 + std::exp(-v)); });
+}
+
+#undef MML_VMATH_CALL
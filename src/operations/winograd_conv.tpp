@@ -0,0 +1,321 @@
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "datastructures/mml_tensor.hpp"
+#include "operations/tensor_operations_module.hpp"
+#include "operations/winograd_conv.hpp"
+#include "utility/thread_pool.hpp"
+
+// Tiles transformed together by the tile transforms
+static constexpr int mml_winograd_lanes = 8;
+
+/**
+ * Transforms of F(m x m, 3 x 3), from Lavin and Gray, "Fast Algorithms for
+ * Convolutional Neural Networks". G transforms the weights, input applies B^T
+ * and output A^T to mml_winograd_lanes columns at once, the rows of in and out
+ * being in_stride and out_stride elements apart. The 2D transforms apply them
+ * to the columns of a tile, then to its rows.
+ */
+template <int m>
+struct mml_winograd_transforms;
+
+template <>
+struct mml_winograd_transforms<2> {
+  static constexpr int alpha = 4;
+  static constexpr double G[4][3] = {
+      {1, 0, 0}, {0.5, 0.5, 0.5}, {0.5, -0.5, 0.5}, {0, 0, 1}};
+
+  template <typename T>
+  static void input(const T *in, size_t in_stride, T *out, size_t out_stride) {
+    const T *d0 = in, *d1 = in + in_stride, *d2 = in + 2 * in_stride,
+            *d3 = in + 3 * in_stride;
+    for (int l = 0; l < mml_winograd_lanes; l++) {
+      out[l] = d0[l] - d2[l];
+      out[out_stride + l] = d1[l] + d2[l];
+      out[2 * out_stride + l] = d2[l] - d1[l];
+      out[3 * out_stride + l] = d1[l] - d3[l];
+    }
+  }
+
+  template <typename T>
+  static void output(const T *in, size_t in_stride, T *out,
+                     size_t out_stride) {
+    const T *s0 = in, *s1 = in + in_stride, *s2 = in + 2 * in_stride,
+            *s3 = in + 3 * in_stride;
+    for (int l = 0; l < mml_winograd_lanes; l++) {
+      out[l] = s0[l] + s1[l] + s2[l];
+      out[out_stride + l] = s1[l] - s2[l] - s3[l];
+    }
+  }
+};
+
+template <>
+struct mml_winograd_transforms<4> {
+  static constexpr int alpha = 6;
+  static constexpr double G[6][3] = {{1.0 / 4, 0, 0},
+                                     {-1.0 / 6, -1.0 / 6, -1.0 / 6},
+                                     {-1.0 / 6, 1.0 / 6, -1.0 / 6},
+                                     {1.0 / 24, 1.0 / 12, 1.0 / 6},
+                                     {1.0 / 24, -1.0 / 12, 1.0 / 6},
+                                     {0, 0, 1}};
+
+  template <typename T>
+  static void input(const T *in, size_t in_stride, T *out, size_t out_stride) {
+    const T *d0 = in, *d1 = in + in_stride, *d2 = in + 2 * in_stride,
+            *d3 = in + 3 * in_stride, *d4 = in + 4 * in_stride,
+            *d5 = in + 5 * in_stride;
+    for (int l = 0; l < mml_winograd_lanes; l++) {
+      const T a = d4[l] - T(4) * d2[l];
+      const T b = d3[l] - T(4) * d1[l];
+      const T c = d4[l] - d2[l];
+      const T d = T(2) * (d3[l] - d1[l]);
+      out[l] = T(4) * d0[l] - T(5) * d2[l] + d4[l];
+      out[out_stride + l] = a + b;
+      out[2 * out_stride + l] = a - b;
+      out[3 * out_stride + l] = c + d;
+      out[4 * out_stride + l] = c - d;
+      out[5 * out_stride + l] = T(4) * d1[l] - T(5) * d3[l] + d5[l];
+    }
+  }
+
+  template <typename T>
+  static void output(const T *in, size_t in_stride, T *out,
+                     size_t out_stride) {
+    const T *s0 = in, *s1 = in + in_stride, *s2 = in + 2 * in_stride,
+            *s3 = in + 3 * in_stride, *s4 = in + 4 * in_stride,
+            *s5 = in + 5 * in_stride;
+    for (int l = 0; l < mml_winograd_lanes; l++) {
+      const T a = s1[l] + s2[l];
+      const T b = s1[l] - s2[l];
+      const T c = s3[l] + s4[l];
+      const T d = s3[l] - s4[l];
+      out[l] = s0[l] + a + c;
+      out[out_stride + l] = b + T(2) * d;
+      out[2 * out_stride + l] = a + T(4) * c;
+      out[3 * out_stride + l] = b + T(8) * d + s5[l];
+    }
+  }
+};
+
+template <typename T, int m>
+static std::shared_ptr<Tensor<T>> mml_winograd_weights_tile(
+    const std::shared_ptr<Tensor<T>> &weights) {
+  using Transforms = mml_winograd_transforms<m>;
+  constexpr int alpha = Transforms::alpha;
+
+  const auto &shape = weights->get_shape();
+  if (shape.size() != 4 || shape[2] != 3 || shape[3] != 3) {
+    throw std::invalid_argument(
+        "Winograd convolution: The weights must be 3x3 kernels");
+  }
+  const size_t out_channels = shape[0];
+  const size_t channels = shape[1];
+
+  auto contiguous = weights->is_contiguous() ? weights : weights->contiguous();
+  const T *g = contiguous->span().data();
+  auto transformed = std::make_shared<Tensor_mml<T>>(
+      array_mml<size_t>({alpha * alpha, out_channels, channels}));
+  T *u = transformed->data();
+  const size_t plane = out_channels * channels;
+
+  parallel_for(0, plane, 64, [&](size_t begin, size_t end) {
+    for (size_t kc = begin; kc < end; kc++) {
+      const T *kernel = g + kc * 9;
+      // G g, then (G g) G^T
+      T tmp[alpha][3];
+      for (int i = 0; i < alpha; i++) {
+        for (int j = 0; j < 3; j++) {
+          tmp[i][j] = T(Transforms::G[i][0]) * kernel[j] +
+                      T(Transforms::G[i][1]) * kernel[3 + j] +
+                      T(Transforms::G[i][2]) * kernel[6 + j];
+        }
+      }
+      for (int i = 0; i < alpha; i++) {
+        for (int j = 0; j < alpha; j++) {
+          u[(i * alpha + j) * plane + kc] =
+              tmp[i][0] * T(Transforms::G[j][0]) +
+              tmp[i][1] * T(Transforms::G[j][1]) +
+              tmp[i][2] * T(Transforms::G[j][2]);
+        }
+      }
+    }
+  });
+  return transformed;
+}
+
+template <TensorConcept::Types T>
+static std::shared_ptr<Tensor<T>> mml_winograd_weights(
+    int m, const std::shared_ptr<Tensor<T>> &weights) {
+  switch (m) {
+    case 2:
+      return mml_winograd_weights_tile<T, 2>(weights);
+    case 4:
+      return mml_winograd_weights_tile<T, 4>(weights);
+  }
+  throw std::invalid_argument("Winograd convolution: Unsupported tile size " +
+                              std::to_string(m));
+}
+
+template <typename T, int m>
+static void mml_winograd_conv_tile(const WinogradConvShape &shape,
+                                   const T *input,
+                                   const std::shared_ptr<Tensor<T>> &weights,
+                                   const T *bias, const Activation &activation,
+                                   T *output) {
+  using Transforms = mml_winograd_transforms<m>;
+  constexpr int alpha = Transforms::alpha;
+  constexpr int L = mml_winograd_lanes;
+
+  const size_t tiles_h = (shape.out_height + m - 1) / m;
+  const size_t tiles_w = (shape.out_width + m - 1) / m;
+  const size_t image_tiles = tiles_h * tiles_w;
+  const size_t tiles = shape.batch * image_tiles;
+  const size_t blocks = (tiles + L - 1) / L;
+  const size_t C = shape.channels;
+  const size_t K = shape.out_channels;
+  if (tiles == 0 || K == 0) {
+    return;
+  }
+
+  // Transformed input tiles, [alpha^2, channels, tiles]
+  auto transformed = std::make_shared<Tensor_mml<T>>(
+      array_mml<size_t>({alpha * alpha, C, tiles}));
+  T *v = transformed->data();
+
+  parallel_for(0, C * blocks, 1, [&](size_t begin, size_t end) {
+    alignas(64) T d[alpha][alpha][L];
+    alignas(64) T t[alpha][alpha][L];
+    for (size_t task = begin; task < end; task++) {
+      const size_t c = task / blocks;
+      const size_t first = task % blocks * L;
+      const int lanes = static_cast<int>(std::min<size_t>(L, tiles - first));
+
+      // Gathers the input tiles, zero outside of the input. Missing tiles of
+      // the last block repeat its last tile
+      for (int l = 0; l < L; l++) {
+        const size_t tile = first + std::min(l, lanes - 1);
+        const size_t n = tile / image_tiles;
+        const ptrdiff_t y0 =
+            static_cast<ptrdiff_t>(tile % image_tiles / tiles_w * m) -
+            static_cast<ptrdiff_t>(shape.pad_top);
+        const ptrdiff_t x0 = static_cast<ptrdiff_t>(tile % tiles_w * m) -
+                             static_cast<ptrdiff_t>(shape.pad_left);
+        const T *plane = input + (n * C + c) * shape.height * shape.width;
+        const bool inside =
+            y0 >= 0 && x0 >= 0 &&
+            y0 + alpha <= static_cast<ptrdiff_t>(shape.height) &&
+            x0 + alpha <= static_cast<ptrdiff_t>(shape.width);
+        for (int i = 0; i < alpha; i++) {
+          const ptrdiff_t y = y0 + i;
+          const T *row = plane + y * static_cast<ptrdiff_t>(shape.width);
+          if (inside) {
+            for (int j = 0; j < alpha; j++) {
+              d[i][j][l] = row[x0 + j];
+            }
+            continue;
+          }
+          const bool row_inside =
+              y >= 0 && y < static_cast<ptrdiff_t>(shape.height);
+          for (int j = 0; j < alpha; j++) {
+            const ptrdiff_t x = x0 + j;
+            d[i][j][l] = row_inside && x >= 0 &&
+                                 x < static_cast<ptrdiff_t>(shape.width)
+                             ? row[x]
+                             : T(0);
+          }
+        }
+      }
+
+      // B^T d, then (B^T d) B
+      for (int j = 0; j < alpha; j++) {
+        Transforms::input(&d[0][j][0], alpha * L, &t[0][j][0], alpha * L);
+      }
+      for (int i = 0; i < alpha; i++) {
+        Transforms::input(&t[i][0][0], L, &d[i][0][0], L);
+      }
+      for (int i = 0; i < alpha; i++) {
+        for (int j = 0; j < alpha; j++) {
+          std::copy(d[i][j], d[i][j] + lanes,
+                    v + ((i * alpha + j) * C + c) * tiles + first);
+        }
+      }
+    }
+  });
+
+  // One [K, C] x [C, tiles] product per transform-domain position
+  auto products = std::make_shared<Tensor_mml<T>>(
+      array_mml<size_t>({alpha * alpha, K, tiles}));
+  for (size_t e = 0; e < alpha * alpha; e++) {
+    TensorOperations::gemm<T>(0, 0, K, tiles, C, T(1), weights->slice({e}), C,
+                              transformed->slice({e}), tiles, T(0),
+                              products->slice({e}), tiles);
+  }
+  const T *p = products->data();
+
+  parallel_for(0, K * blocks, 1, [&](size_t begin, size_t end) {
+    alignas(64) T s[alpha][alpha][L];
+    alignas(64) T t[m][alpha][L];
+    alignas(64) T y[m][m][L];
+    for (size_t task = begin; task < end; task++) {
+      const size_t k = task / blocks;
+      const size_t first = task % blocks * L;
+      const int lanes = static_cast<int>(std::min<size_t>(L, tiles - first));
+
+      for (int i = 0; i < alpha; i++) {
+        for (int j = 0; j < alpha; j++) {
+          const T *in = p + ((i * alpha + j) * K + k) * tiles + first;
+          std::copy(in, in + lanes, s[i][j]);
+          std::fill(s[i][j] + lanes, s[i][j] + L, T(0));
+        }
+      }
+
+      // A^T s, then (A^T s) A
+      for (int j = 0; j < alpha; j++) {
+        Transforms::output(&s[0][j][0], alpha * L, &t[0][j][0], alpha * L);
+      }
+      for (int a = 0; a < m; a++) {
+        Transforms::output(&t[a][0][0], L, &y[a][0][0], L);
+      }
+
+      // Scatters the output tiles, the last ones may be cut
+      for (int l = 0; l < lanes; l++) {
+        const size_t tile = first + l;
+        const size_t n = tile / image_tiles;
+        const size_t y0 = tile % image_tiles / tiles_w * m;
+        const size_t x0 = tile % tiles_w * m;
+        const size_t rows = std::min<size_t>(m, shape.out_height - y0);
+        const size_t cols = std::min<size_t>(m, shape.out_width - x0);
+        T *plane = output + (n * K + k) * shape.out_height * shape.out_width;
+        for (size_t a = 0; a < rows; a++) {
+          T *out = plane + (y0 + a) * shape.out_width + x0;
+          for (size_t b = 0; b < cols; b++) {
+            out[b] = y[a][b][l];
+          }
+          mml_bias_activate(activation, bias ? bias[k] : T(0), out, cols);
+        }
+      }
+    }
+  });
+}
+
+template <TensorConcept::Types T>
+static void mml_winograd_conv(int m, const WinogradConvShape &shape,
+                              const T *input,
+                              const std::shared_ptr<Tensor<T>> &weights,
+                              const T *bias, const Activation &activation,
+                              T *output) {
+  switch (m) {
+    case 2:
+      mml_winograd_conv_tile<T, 2>(shape, input, weights, bias, activation,
+                                   output);
+      return;
+    case 4:
+      mml_winograd_conv_tile<T, 4>(shape, input, weights, bias, activation,
+                                   output);
+      return;
+  }
+  throw std::invalid_argument("Winograd convolution: Unsupported tile size " +
+                              std::to_string(m));
+}
@@ -17,6 +17,8 @@
 #include "nodes/a_node.hpp"
 #include "nodes/add.hpp"
 #include "nodes/avg_pool.hpp"
+#include "nodes/batch_norm.hpp"
+#include "nodes/binary.hpp"
 #include "nodes/constant.hpp"
 #include "nodes/conv.hpp"
 #include "nodes/dropout.hpp"
@@ -26,13 +28,14 @@
 #include "nodes/gemm.hpp"
 #include "nodes/global_avg_pool.hpp"
 #include "nodes/leaky_relu.hpp"
-#include "nodes/log_softmax.hpp"
 #include "nodes/lrn.hpp"
 #include "nodes/matmul.hpp"
 #include "nodes/max_pool.hpp"
+#include "nodes/reduce.hpp"
 #include "nodes/relu.hpp"
 #include "nodes/reshape.hpp"
 #include "nodes/sigmoid.hpp"
+#include "nodes/softmax.hpp"
 #include "nodes/swish.hpp"
 #include "nodes/tanh.hpp"
 #include "nodes/transpose.hpp"
@@ -107,10 +110,15 @@ std::vector<std::shared_ptr<Node>> constructNodes(const nlohmann::json &graph) {
         nodes.push_back(std::make_shared<AddNode>(node));
       } else if (opType == "AveragePool") {
         nodes.push_back(std::make_shared<AvgPoolNode>(node));
+      } else if (opType == "BatchNormalization") {
+        nodes.push_back(std::make_shared<BatchNormalizationNode>(node));
       } else if (opType == "Constant") {
         nodes.push_back(std::make_shared<ConstantNode>(node));
       } else if (opType == "Conv") {
         nodes.push_back(std::make_shared<ConvNode>(node));
+      } else if (opType == "Div" || opType == "Max" || opType == "Min" ||
+                 opType == "Mul" || opType == "Pow" || opType == "Sub") {
+        nodes.push_back(std::make_shared<BinaryNode>(node));
       } else if (opType == "Dropout") {
         nodes.push_back(std::make_shared<DropoutNode>(node));
       } else if (opType == "Elu") {
@@ -123,18 +131,22 @@ std::vector<std::shared_ptr<Node>> constructNodes(const nlohmann::json &graph) {
         nodes.push_back(std::make_shared<GemmNode>(node));
       } else if (opType == "LeakyRelu") {
         nodes.push_back(std::make_shared<LeakyReLUNode>(node));
-      } else if (opType == "LogSoftmax") {
-        nodes.push_back(std::make_shared<LogSoftMaxNode>(node));
       } else if (opType == "LRN") {
         nodes.push_back(std::make_shared<LRNNode_mml>(node));
       } else if (opType == "MaxPool") {
         nodes.push_back(std::make_shared<MaxPoolNode>(node));
+      } else if (opType == "ReduceL2" || opType == "ReduceMax" ||
+                 opType == "ReduceMean" || opType == "ReduceMin" ||
+                 opType == "ReduceSum") {
+        nodes.push_back(std::make_shared<ReduceNode>(node));
       } else if (opType == "Relu") {
         nodes.push_back(std::make_shared<ReLUNode>(node));
       } else if (opType == "Reshape") {
         nodes.push_back(std::make_shared<reshapeNode>(node));
       } else if (opType == "Sigmoid") {
         nodes.push_back(std::make_shared<SigmoidNode>(node));
+      } else if (opType == "LogSoftmax" || opType == "Softmax") {
+        nodes.push_back(std::make_shared<SoftMaxNode>(node));
       } else if (opType == "Swish") {
         nodes.push_back(std::make_shared<SwishNode>(node));
       } else if (opType == "Tanh") {
@@ -185,8 +197,9 @@ std::unique_ptr<Model> Parser_mml::parse(const nlohmann::json &data) const {
   // Get the graph
   nlohmann::json graph = data["graph"];
 
-  // Get the tensors
-  std::unordered_map<std::string, GeneralDataTypes> iomap = mapTensors(graph);
+  // Load the weights once into a read-only store shared by every inference
+  auto weights =
+      std::make_shared<const Model_mml::WeightStore>(mapTensors(graph));
 
   // Construct the nodes
   std::vector<std::shared_ptr<Node>> nodes = constructNodes(graph);
@@ -197,6 +210,8 @@ std::unique_ptr<Model> Parser_mml::parse(const nlohmann::json &data) const {
   // Get the outputs
   std::vector<std::string> outputs = getOutputs(graph);
 
-  // Create the model
-  return std::make_unique<Model_mml>(nodes, iomap, inputs, outputs);
+  // Create the model and build its execution plan once
+  auto model = std::make_unique<Model_mml>(nodes, weights, inputs, outputs);
+  model->compile();
+  return model;
 }
\ No newline at end of file
@@ -0,0 +1,334 @@
+#include "utility/allocator.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+// Size classes of the pool, four per power of two from 64 bytes up to 2^63
+constexpr size_t min_class_bytes = Allocator::alignment;
+constexpr size_t min_class_log = std::countr_zero(min_class_bytes);
+constexpr size_t class_count = 1 + (64 - min_class_log) * 4;
+
+struct SizeClass {
+  size_t index;  // Index of the free list of the class
+  size_t bytes;  // Size of the blocks of the class
+};
+
+SizeClass size_class(size_t bytes) {
+  if (bytes <= min_class_bytes) {
+    return {0, min_class_bytes};
+  }
+  // 2^log < bytes <= 2^(log + 1), split into four steps of 2^(log - 2)
+  const size_t log = std::bit_width(bytes - 1) - 1;
+  const size_t step = size_t(1) << (log - 2);
+  const size_t steps = (bytes + step - 1) / step;
+  return {1 + (log - min_class_log) * 4 + (steps - 5), steps * step};
+}
+
+std::atomic<std::shared_ptr<Allocator>> &global_allocator() {
+  // Function local, tensors may be allocated by other static initializers
+  static std::atomic<std::shared_ptr<Allocator>> allocator{
+      std::make_shared<PoolAllocator>()};
+  return allocator;
+}
+
+}  // namespace
+
+Allocator::Stats Allocator::get_stats() const {
+  return {hits.load(std::memory_order_relaxed),
+          misses.load(std::memory_order_relaxed)};
+}
+
+void Allocator::reset_stats() {
+  hits.store(0, std::memory_order_relaxed);
+  misses.store(0, std::memory_order_relaxed);
+}
+
+std::shared_ptr<Allocator> Allocator::global() {
+  return global_allocator().load();
+}
+
+void Allocator::set_global(std::shared_ptr<Allocator> allocator) {
+  if (!allocator) {
+    allocator = std::make_shared<PoolAllocator>();
+  }
+  global_allocator().store(std::move(allocator));
+}
+
+void *Allocator::system_allocate(size_t bytes) {
+  void *ptr = nullptr;
+  if (posix_memalign(&ptr, alignment, std::max(bytes, alignment)) != 0) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void Allocator::system_deallocate(void *ptr) noexcept { free(ptr); }
+
+void *AlignedAllocator::allocate(size_t bytes) {
+  count_miss();
+  return system_allocate(bytes);
+}
+
+void AlignedAllocator::deallocate(void *ptr, size_t) noexcept {
+  system_deallocate(ptr);
+}
+
+struct PoolAllocator::Shared {
+  explicit Shared(size_t max_cached_bytes)
+      : free_lists(class_count), max_cached_bytes(max_cached_bytes) {}
+
+  ~Shared() { release(); }
+
+  void release() noexcept {
+    std::scoped_lock lock(mutex);
+    for (auto &free_list : free_lists) {
+      for (void *ptr : free_list) {
+        system_deallocate(ptr);
+      }
+      free_list.clear();
+    }
+    cached_bytes = 0;
+  }
+
+  // Takes a block of the class, nullptr if none is cached
+  void *pop(SizeClass size) {
+    std::scoped_lock lock(mutex);
+    auto &free_list = free_lists[size.index];
+    if (free_list.empty()) {
+      return nullptr;
+    }
+    void *ptr = free_list.back();
+    free_list.pop_back();
+    cached_bytes -= size.bytes;
+    return ptr;
+  }
+
+  // Caches a block of the class, false if the cache is full
+  bool push(void *ptr, SizeClass size) noexcept {
+    std::scoped_lock lock(mutex);
+    if (cached_bytes + size.bytes > max_cached_bytes) {
+      return false;
+    }
+    try {
+      free_lists[size.index].push_back(ptr);
+    } catch (const std::bad_alloc &) {
+      return false;
+    }
+    cached_bytes += size.bytes;
+    return true;
+  }
+
+  // Frees a block which could not be cached
+  static void system_deallocate(void *ptr) noexcept {
+    PoolAllocator::system_deallocate(ptr);
+  }
+
+  const uint64_t id = next_id.fetch_add(1, std::memory_order_relaxed);
+  mutable std::mutex mutex;                   // Guards the fields below
+  std::vector<std::vector<void *>> free_lists;  // Blocks of each class
+  size_t cached_bytes = 0;                      // Size of the cached blocks
+  const size_t max_cached_bytes;                // Limit of cached_bytes
+
+  static inline std::atomic<uint64_t> next_id = 0;
+};
+
+namespace {
+
+// Blocks cached by one thread for every pool it used, given back to the pools
+// when the thread exits
+struct ThreadCache {
+  struct Entry {
+    std::weak_ptr<PoolAllocator::Shared> shared;  // Pool of the blocks
+    std::vector<std::vector<void *>> free_lists;  // Blocks of each class
+  };
+
+  ~ThreadCache() {
+    for (auto &[id, entry] : entries) {
+      release(entry);
+    }
+    destroyed = true;
+  }
+
+  // Gets the entry of a pool, created on first use
+  Entry &entry(const std::shared_ptr<PoolAllocator::Shared> &shared) {
+    if (last && last_id == shared->id) {
+      return *last;
+    }
+    auto [it, inserted] = entries.try_emplace(shared->id);
+    if (inserted) {
+      it->second.shared = shared;
+      it->second.free_lists.resize(class_count);
+    }
+    last_id = shared->id;
+    last = &it->second;
+    return *last;
+  }
+
+  // Gives the blocks of an entry back to its pool, or to the system if the
+  // pool is gone
+  static void release(Entry &entry) noexcept {
+    auto shared = entry.shared.lock();
+    for (size_t index = 0; index < entry.free_lists.size(); ++index) {
+      for (void *ptr : entry.free_lists[index]) {
+        if (!shared || !shared->push(ptr, class_of(index))) {
+          PoolAllocator::Shared::system_deallocate(ptr);
+        }
+      }
+      entry.free_lists[index].clear();
+    }
+  }
+
+  // Size class of a free list index, the inverse of size_class
+  static SizeClass class_of(size_t index) {
+    if (index == 0) {
+      return {0, min_class_bytes};
+    }
+    const size_t log = (index - 1) / 4 + min_class_log;
+    const size_t steps = (index - 1) % 4 + 5;
+    return {index, steps << (log - 2)};
+  }
+
+  std::unordered_map<uint64_t, Entry> entries;
+  uint64_t last_id = 0;    // Pool of the last used entry
+  Entry *last = nullptr;   // Last used entry, entries are never erased
+  static inline thread_local bool destroyed = false;
+};
+
+thread_local ThreadCache thread_cache;
+
+}  // namespace
+
+PoolAllocator::PoolAllocator(size_t max_cached_bytes)
+    : shared(std::make_shared<Shared>(max_cached_bytes)) {}
+
+void *PoolAllocator::allocate(size_t bytes) {
+  const SizeClass size = size_class(bytes);
+  if (size.bytes > shared->max_cached_bytes) {
+    count_miss();
+    return system_allocate(bytes);
+  }
+
+  if (size.bytes <= thread_cache_max_bytes && !ThreadCache::destroyed) {
+    auto &free_list = thread_cache.entry(shared).free_lists[size.index];
+    if (!free_list.empty()) {
+      void *ptr = free_list.back();
+      free_list.pop_back();
+      count_hit();
+      return ptr;
+    }
+  }
+
+  if (void *ptr = shared->pop(size)) {
+    count_hit();
+    return ptr;
+  }
+  count_miss();
+  return system_allocate(size.bytes);
+}
+
+void PoolAllocator::deallocate(void *ptr, size_t bytes) noexcept {
+  const SizeClass size = size_class(bytes);
+  if (size.bytes > shared->max_cached_bytes) {
+    system_deallocate(ptr);
+    return;
+  }
+
+  if (size.bytes <= thread_cache_max_bytes && !ThreadCache::destroyed) {
+    try {
+      auto &free_list = thread_cache.entry(shared).free_lists[size.index];
+      if (free_list.size() < thread_cache_blocks) {
+        free_list.push_back(ptr);
+        return;
+      }
+    } catch (const std::bad_alloc &) {
+      // Falls back to the shared cache
+    }
+  }
+
+  if (!shared->push(ptr, size)) {
+    system_deallocate(ptr);
+  }
+}
+
+void PoolAllocator::release() {
+  if (!ThreadCache::destroyed) {
+    auto it = thread_cache.entries.find(shared->id);
+    if (it != thread_cache.entries.end()) {
+      for (auto &free_list : it->second.free_lists) {
+        for (void *ptr : free_list) {
+          system_deallocate(ptr);
+        }
+        free_list.clear();
+      }
+    }
+  }
+  shared->release();
+}
+
+size_t PoolAllocator::get_cached_bytes() const {
+  std::scoped_lock lock(shared->mutex);
+  return shared->cached_bytes;
+}
+
+ArenaAllocator::ArenaAllocator(size_t chunk_bytes)
+    : chunk_bytes(std::max(chunk_bytes, alignment)) {}
+
+ArenaAllocator::~ArenaAllocator() {
+  for (const Chunk &chunk : chunks) {
+    system_deallocate(chunk.data);
+  }
+}
+
+void *ArenaAllocator::allocate(size_t bytes) {
+  bytes = std::max((bytes + alignment - 1) / alignment * alignment, alignment);
+  std::scoped_lock lock(mutex);
+
+  // Bumps through the chunks kept by reset before allocating a new one
+  for (; current < chunks.size(); ++current, used = 0) {
+    if (chunks[current].bytes - used >= bytes) {
+      void *ptr = chunks[current].data + used;
+      used += bytes;
+      count_hit();
+      return ptr;
+    }
+  }
+
+  const size_t new_bytes = std::max(bytes, chunk_bytes);
+  auto *data = static_cast<std::byte *>(system_allocate(new_bytes));
+  try {
+    chunks.push_back({data, new_bytes});
+  } catch (...) {
+    system_deallocate(data);
+    throw;
+  }
+  current = chunks.size() - 1;
+  used = bytes;
+  count_miss();
+  return data;
+}
+
+void ArenaAllocator::deallocate(void *, size_t) noexcept {
+  // The memory is only reused after reset
+}
+
+void ArenaAllocator::reset() {
+  std::scoped_lock lock(mutex);
+  current = 0;
+  used = 0;
+}
+
+size_t ArenaAllocator::get_reserved_bytes() const {
+  std::scoped_lock lock(mutex);
+  size_t bytes = 0;
+  for (const Chunk &chunk : chunks) {
+    bytes += chunk.bytes;
+  }
+  return bytes;
+}
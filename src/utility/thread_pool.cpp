@@ -0,0 +1,185 @@
+#include "utility/thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <utility>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+// Chunks per participating thread, more chunks even out uneven work
+constexpr size_t chunks_per_thread = 4;
+
+std::mutex global_mutex;                  // Guards global_pool
+std::shared_ptr<ThreadPool> global_pool;  // The pool shared by the library
+
+size_t default_thread_count() {
+  return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+}  // namespace
+
+ThreadPool::ThreadPool(size_t thread_count, bool pin_threads) {
+  thread_count = std::max<size_t>(thread_count, 1);
+  workers.reserve(thread_count);
+  for (size_t i = 0; i < thread_count; ++i) {
+    workers.emplace_back([this] { work(); });
+  }
+
+#ifdef __linux__
+  if (pin_threads) {
+    const size_t cpu_count = default_thread_count();
+    pinned = true;
+    for (size_t i = 0; i < workers.size(); ++i) {
+      cpu_set_t cpu_set;
+      CPU_ZERO(&cpu_set);
+      CPU_SET(i % cpu_count, &cpu_set);
+      if (pthread_setaffinity_np(workers[i].native_handle(), sizeof(cpu_set),
+                                 &cpu_set) != 0) {
+        pinned = false;
+      }
+    }
+  }
+#endif
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(tasks_mutex);
+    stopping = true;
+  }
+  tasks_cv.notify_all();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(tasks_mutex);
+    tasks.push_back(std::move(task));
+  }
+  tasks_cv.notify_one();
+}
+
+void ThreadPool::parallel_for(size_t begin, size_t end, size_t grain,
+                              const std::function<void(size_t, size_t)> &fn) {
+  if (begin >= end) {
+    return;
+  }
+  const size_t size = end - begin;
+  grain = std::max<size_t>(grain, 1);
+  const size_t threads = workers.size();
+  const size_t chunk_count =
+      std::min((size + grain - 1) / grain, threads * chunks_per_thread);
+  if (threads == 1 || chunk_count <= 1) {
+    fn(begin, end);
+    return;
+  }
+  const size_t chunk_size = (size + chunk_count - 1) / chunk_count;
+
+  // Shared with the helpers, which may only start after the call returned
+  struct Loop {
+    const std::function<void(size_t, size_t)> *fn;
+    size_t begin, end, chunk_size, chunk_count;
+    std::atomic<size_t> next_chunk = 0;  // Next chunk to be claimed
+    std::atomic<bool> failed = false;    // Set once a chunk has thrown
+    std::mutex mutex;                    // Guards done_chunks and error
+    std::condition_variable done_cv;     // Signals the last chunk is done
+    size_t done_chunks = 0;              // Chunks finished or skipped
+    std::exception_ptr error;            // First exception thrown
+  };
+  auto loop = std::make_shared<Loop>();
+  loop->fn = &fn;
+  loop->begin = begin;
+  loop->end = end;
+  loop->chunk_size = chunk_size;
+  loop->chunk_count = chunk_count;
+
+  // Claims chunks until none is left, fn is only used for claimed chunks
+  auto run_chunks = [](Loop &loop) {
+    size_t chunk;
+    while ((chunk = loop.next_chunk.fetch_add(1)) < loop.chunk_count) {
+      std::exception_ptr chunk_error;
+      if (!loop.failed) {
+        const size_t chunk_begin = loop.begin + chunk * loop.chunk_size;
+        const size_t chunk_end =
+            std::min(chunk_begin + loop.chunk_size, loop.end);
+        try {
+          (*loop.fn)(chunk_begin, chunk_end);
+        } catch (...) {
+          chunk_error = std::current_exception();
+          loop.failed = true;
+        }
+      }
+
+      std::lock_guard<std::mutex> lock(loop.mutex);
+      if (chunk_error && !loop.error) {
+        loop.error = chunk_error;
+      }
+      if (++loop.done_chunks == loop.chunk_count) {
+        loop.done_cv.notify_all();
+      }
+    }
+  };
+
+  const size_t helpers = std::min(chunk_count, threads) - 1;
+  for (size_t i = 0; i < helpers; ++i) {
+    submit([loop, run_chunks] { run_chunks(*loop); });
+  }
+  run_chunks(*loop);
+
+  std::unique_lock<std::mutex> lock(loop->mutex);
+  loop->done_cv.wait(lock,
+                     [&] { return loop->done_chunks == loop->chunk_count; });
+  if (loop->error) {
+    std::rethrow_exception(loop->error);
+  }
+}
+
+std::shared_ptr<ThreadPool> ThreadPool::global() {
+  std::lock_guard<std::mutex> lock(global_mutex);
+  if (!global_pool) {
+    global_pool = std::make_shared<ThreadPool>(default_thread_count());
+  }
+  return global_pool;
+}
+
+void ThreadPool::configure_global(size_t thread_count, bool pin_threads) {
+  if (thread_count == 0) {
+    thread_count = default_thread_count();
+  }
+  auto pool = std::make_shared<ThreadPool>(thread_count, pin_threads);
+  std::shared_ptr<ThreadPool> previous;
+  {
+    std::lock_guard<std::mutex> lock(global_mutex);
+    previous = std::exchange(global_pool, std::move(pool));
+  }
+  // The previous pool, if unused, is joined here outside of the lock
+}
+
+void ThreadPool::work() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(tasks_mutex);
+      tasks_cv.wait(lock, [this] { return stopping || !tasks.empty(); });
+      if (tasks.empty()) {
+        return;  // Stopping and nothing left to run
+      }
+      task = std::move(tasks.front());
+      tasks.pop_front();
+    }
+    task();
+  }
+}
+
+void parallel_for(size_t begin, size_t end, size_t grain,
+                  const std::function<void(size_t, size_t)> &fn) {
+  ThreadPool::global()->parallel_for(begin, end, grain, fn);
+}
@@ -80,6 +80,26 @@ TEST(test_node, test_ReLU_int32) {
   ASSERT_EQ(*input_ptr, *original_X);  // Ensure the input tensor is intact
 }
 
+TEST(test_node, test_ReLU_output_of_other_shape) {
+  // A larger contiguous Y left from an earlier run is replaced, not partly
+  // overwritten
+  auto X =
+      TensorFactory::create_tensor<float>({2, 2}, {-1.0f, 2.0f, -3.0f, 4.0f});
+  auto stale = TensorFactory::create_tensor<float>({3, 3});
+  auto expected =
+      TensorFactory::create_tensor<float>({2, 2}, {0.0f, 2.0f, 0.0f, 4.0f});
+
+  std::unordered_map<std::string, GeneralDataTypes> iomap;
+  iomap["X"] = X;
+  iomap["Y"] = stale;
+
+  ReLUNode reluNode("X", "Y");
+  reluNode.forward(iomap);
+
+  auto result_ptr = std::get<std::shared_ptr<Tensor<float>>>(iomap["Y"]);
+  ASSERT_EQ(*result_ptr, *expected);
+}
+
 TEST(test_node, test_ReLU_double) {
   /**
    * @brief Expected Tensor after the ReLU function is applied to each element.
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <modularml>
+#include <thread>
+
+namespace {
+
+bool is_aligned(const void *ptr) {
+  return reinterpret_cast<uintptr_t>(ptr) % Allocator::alignment == 0;
+}
+
+}  // namespace
+
+TEST(test_allocator, test_blocks_are_aligned) {
+  AlignedAllocator aligned;
+  PoolAllocator pool;
+  ArenaAllocator arena(1024);
+  for (Allocator *allocator :
+       std::initializer_list<Allocator *>{&aligned, &pool, &arena}) {
+    for (size_t bytes : {0, 1, 63, 65, 1000, 3000, 1 << 20}) {
+      void *ptr = allocator->allocate(bytes);
+      EXPECT_TRUE(is_aligned(ptr));
+      allocator->deallocate(ptr, bytes);
+    }
+  }
+}
+
+TEST(test_allocator, test_pool_reuses_blocks) {
+  PoolAllocator pool;
+  void *first = pool.allocate(1000);
+  pool.deallocate(first, 1000);
+  // Same size class as 1000 bytes
+  void *second = pool.allocate(1020);
+  EXPECT_EQ(first, second);
+  pool.deallocate(second, 1020);
+
+  Allocator::Stats stats = pool.get_stats();
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.misses, 1u);
+
+  pool.reset_stats();
+  EXPECT_EQ(pool.get_stats().hits, 0u);
+  EXPECT_EQ(pool.get_stats().misses, 0u);
+}
+
+TEST(test_allocator, test_pool_shares_blocks_between_threads) {
+  PoolAllocator pool;
+  const size_t bytes = PoolAllocator::thread_cache_max_bytes * 2;
+  void *ptr = pool.allocate(bytes);
+  std::thread([&] { pool.deallocate(ptr, bytes); }).join();
+  EXPECT_GE(pool.get_cached_bytes(), bytes);
+
+  EXPECT_EQ(pool.allocate(bytes), ptr);
+  EXPECT_EQ(pool.get_stats().hits, 1u);
+  pool.deallocate(ptr, bytes);
+
+  pool.release();
+  EXPECT_EQ(pool.get_cached_bytes(), 0u);
+}
+
+TEST(test_allocator, test_pool_respects_cache_limit) {
+  PoolAllocator pool(4096);
+  void *ptr = pool.allocate(8192);
+  pool.deallocate(ptr, 8192);
+  EXPECT_EQ(pool.get_cached_bytes(), 0u);
+  ptr = pool.allocate(8192);
+  EXPECT_EQ(pool.get_stats().misses, 2u);
+  pool.deallocate(ptr, 8192);
+}
+
+TEST(test_allocator, test_arena_reset) {
+  ArenaAllocator arena(4096);
+  void *first = arena.allocate(1000);
+  void *second = arena.allocate(1000);
+  EXPECT_NE(first, second);
+  arena.allocate(10000);
+  EXPECT_EQ(arena.get_stats().misses, 2u);
+  EXPECT_EQ(arena.get_reserved_bytes(), 4096u + 10048u);
+
+  arena.reset();
+  EXPECT_EQ(arena.allocate(1000), first);
+  arena.allocate(10000);
+  EXPECT_EQ(arena.get_stats().misses, 2u);
+  EXPECT_EQ(arena.get_reserved_bytes(), 4096u + 10048u);
+}
+
+TEST(test_allocator, test_tensors_use_global_allocator) {
+  auto previous = TensorFactory::get_allocator();
+  auto pool = std::make_shared<PoolAllocator>();
+  TensorFactory::set_allocator(pool);
+
+  for (int i = 0; i < 3; ++i) {
+    auto tensor = TensorFactory::create_tensor<float>({3, 5, 7});
+    EXPECT_TRUE(is_aligned(tensor->data()));
+    auto copy = tensor->copy();
+    EXPECT_TRUE(is_aligned(copy->data()));
+  }
+  // Later iterations reuse the blocks of the first one
+  EXPECT_GT(pool->get_stats().hits, 0u);
+
+  TensorFactory::set_allocator(previous);
+  EXPECT_EQ(TensorFactory::get_allocator(), previous);
+}
+
+TEST(test_allocator, test_gemm_packs_through_global_allocator) {
+  auto a = TensorFactory::random_tensor<float>(array_mml<size_t>({64, 48}),
+                                               -1.0f, 1.0f);
+  auto b = TensorFactory::random_tensor<float>(array_mml<size_t>({48, 32}),
+                                               -1.0f, 1.0f);
+  auto c = TensorFactory::create_tensor<float>({64, 32});
+
+  auto previous = TensorFactory::get_allocator();
+  auto pool = std::make_shared<PoolAllocator>();
+  TensorFactory::set_allocator(pool);
+
+  TensorOperations::gemm<float>(0, 0, 64, 32, 48, 1.0f, a, 48, b, 32, 0.0f, c,
+                                32);
+  const auto first = pool->get_stats();
+  EXPECT_GT(first.misses, 0u);
+
+  // The pack buffers of the first call are reused by the second one
+  TensorOperations::gemm<float>(0, 0, 64, 32, 48, 1.0f, a, 48, b, 32, 0.0f, c,
+                                32);
+  const auto second = pool->get_stats();
+  EXPECT_EQ(second.misses, first.misses);
+  EXPECT_GT(second.hits, first.hits);
+
+  TensorFactory::set_allocator(previous);
+}
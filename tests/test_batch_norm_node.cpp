@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <modularml>
+
+namespace {
+
+std::unordered_map<std::string, GeneralDataTypes> batch_norm_parameters() {
+  std::unordered_map<std::string, GeneralDataTypes> parameters;
+  parameters["scale"] =
+      TensorFactory::create_tensor<float>({3}, {1.0f, 2.0f, -0.5f});
+  parameters["B"] =
+      TensorFactory::create_tensor<float>({3}, {0.0f, 1.0f, 3.0f});
+  parameters["mean"] =
+      TensorFactory::create_tensor<float>({3}, {1.0f, -2.0f, 0.5f});
+  parameters["var"] =
+      TensorFactory::create_tensor<float>({3}, {4.0f, 1.0f, 0.25f});
+  return parameters;
+}
+
+}  // namespace
+
+TEST(test_batch_norm, test_forward_matches_definition) {
+  const float epsilon = 1e-3f;
+  auto parameters = batch_norm_parameters();
+  const float scale[] = {1.0f, 2.0f, -0.5f};
+  const float bias[] = {0.0f, 1.0f, 3.0f};
+  const float mean[] = {1.0f, -2.0f, 0.5f};
+  const float var[] = {4.0f, 1.0f, 0.25f};
+
+  // Images with spatial dimensions and plain [batch, channels] rows
+  for (const auto &shape :
+       {array_mml<size_t>({2, 3, 4, 5}), array_mml<size_t>({4, 3})}) {
+    auto x = TensorFactory::random_tensor<float>(shape, -2.0f, 2.0f);
+    std::unordered_map<std::string, GeneralDataTypes> iomap = parameters;
+    iomap["X"] = x;
+
+    BatchNormalizationNode node("X", "scale", "B", "mean", "var", "Y",
+                                epsilon);
+    node.forward(iomap);
+
+    auto y = std::get<std::shared_ptr<Tensor<float>>>(iomap["Y"]);
+    ASSERT_EQ(y->get_shape(), shape);
+    const size_t spatial = x->get_size() / (shape[0] * shape[1]);
+    for (size_t i = 0; i < x->get_size(); ++i) {
+      const size_t c = i / spatial % 3;
+      const float expected =
+          ((*x)[i] - mean[c]) / std::sqrt(var[c] + epsilon) * scale[c] +
+          bias[c];
+      EXPECT_NEAR((*y)[i], expected, 1e-5) << "at " << i;
+    }
+  }
+}
+
+TEST(test_batch_norm, test_foldable_affine) {
+  auto parameters = batch_norm_parameters();
+  BatchNormalizationNode node("X", "scale", "B", "mean", "var", "Y", 0.0f);
+
+  auto affine = node.foldable_affine(parameters);
+  ASSERT_TRUE(affine.has_value());
+  ASSERT_EQ(affine->scale.size(), 3);
+  EXPECT_DOUBLE_EQ(affine->scale[0], 0.5);
+  EXPECT_DOUBLE_EQ(affine->shift[0], -0.5);
+  EXPECT_DOUBLE_EQ(affine->scale[1], 2.0);
+  EXPECT_DOUBLE_EQ(affine->shift[1], 5.0);
+  EXPECT_DOUBLE_EQ(affine->scale[2], -1.0);
+  EXPECT_DOUBLE_EQ(affine->shift[2], 3.5);
+
+  // Parameters computed by the graph can not be folded
+  parameters.erase("var");
+  EXPECT_FALSE(node.foldable_affine(parameters).has_value());
+}
+
+TEST(test_batch_norm, test_training_mode_throws) {
+  nlohmann::json node = {
+      {"input", {"X", "scale", "B", "mean", "var"}},
+      {"output", {"Y", "running_mean", "running_var"}},
+      {"attribute", {{{"name", "training_mode"}, {"i", "1"}}}}};
+  EXPECT_THROW(BatchNormalizationNode{node}, std::runtime_error);
+
+  node["attribute"] = {{{"name", "epsilon"}, {"f", 0.01f}}};
+  EXPECT_NO_THROW(BatchNormalizationNode{node});
+}
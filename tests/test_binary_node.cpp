@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <modularml>
+
+namespace {
+
+// Computes the operation of a and b broadcast to shape one element at a time
+std::vector<float> reference_binary(BinaryKind kind,
+                                    const array_mml<size_t> &shape,
+                                    const std::shared_ptr<Tensor<float>> &a,
+                                    const std::shared_ptr<Tensor<float>> &b) {
+  auto a_view = a->broadcast_reshape(shape);
+  auto b_view = b->broadcast_reshape(shape);
+  std::vector<float> result(a_view->get_size());
+  for (size_t i = 0; i < result.size(); ++i) {
+    const float x = (*a_view)[i];
+    const float y = (*b_view)[i];
+    switch (kind) {
+      case BinaryKind::Add:
+        result[i] = x + y;
+        break;
+      case BinaryKind::Sub:
+        result[i] = x - y;
+        break;
+      case BinaryKind::Mul:
+        result[i] = x * y;
+        break;
+      case BinaryKind::Div:
+        result[i] = x / y;
+        break;
+      case BinaryKind::Pow:
+        result[i] = std::pow(x, y);
+        break;
+      case BinaryKind::Min:
+        result[i] = std::min(x, y);
+        break;
+      case BinaryKind::Max:
+        result[i] = std::max(x, y);
+        break;
+    }
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST(test_binary_node, test_broadcasts_match_reference) {
+  // Same shapes, a per channel scale, a bias over the last axis, a scalar,
+  // an outer product and a rank mismatch broadcasting both ways
+  const std::vector<std::pair<std::vector<size_t>, std::vector<size_t>>>
+      shapes = {{{2, 3, 4, 5}, {2, 3, 4, 5}}, {{2, 3, 4, 5}, {1, 3, 1, 1}},
+                {{2, 3, 4, 5}, {5}},          {{2, 3, 4, 5}, {1}},
+                {{4, 1}, {1, 6}},             {{3, 1, 5}, {2, 1, 4, 1}}};
+  const std::vector<std::pair<BinaryKind, std::string>> kinds = {
+      {BinaryKind::Sub, "Sub"}, {BinaryKind::Mul, "Mul"},
+      {BinaryKind::Div, "Div"}, {BinaryKind::Pow, "Pow"},
+      {BinaryKind::Min, "Min"}, {BinaryKind::Max, "Max"}};
+
+  for (const auto &[a_shape, b_shape] : shapes) {
+    auto A = TensorFactory::random_tensor<float>(array_mml<size_t>(a_shape),
+                                                 0.5f, 2.0f);
+    auto B = TensorFactory::random_tensor<float>(array_mml<size_t>(b_shape),
+                                                 0.5f, 2.0f);
+    const auto shape = mml_broadcast_shape(A->get_shape(), B->get_shape());
+
+    for (const auto &[kind, name] : kinds) {
+      // Each operation both ways round
+      for (bool swapped : {false, true}) {
+        std::unordered_map<std::string, GeneralDataTypes> iomap;
+        iomap["A"] = swapped ? B : A;
+        iomap["B"] = swapped ? A : B;
+        BinaryNode node(kind, {"A", "B"}, "C");
+        node.forward(iomap);
+
+        auto C = std::get<std::shared_ptr<Tensor<float>>>(iomap["C"]);
+        ASSERT_EQ(C->get_shape(), shape) << name;
+        const auto expected =
+            swapped ? reference_binary(kind, shape, B, A)
+                    : reference_binary(kind, shape, A, B);
+        for (size_t i = 0; i < expected.size(); ++i) {
+          EXPECT_NEAR((*C)[i], expected[i], 1e-5f * std::abs(expected[i]))
+              << name;
+        }
+      }
+    }
+
+    // AddNode runs on the same kernels
+    std::unordered_map<std::string, GeneralDataTypes> iomap;
+    iomap["A"] = A;
+    iomap["B"] = B;
+    AddNode add("A", "B", "C");
+    add.forward(iomap);
+    auto C = std::get<std::shared_ptr<Tensor<float>>>(iomap["C"]);
+    ASSERT_EQ(C->get_shape(), shape);
+    const auto expected = reference_binary(BinaryKind::Add, shape, A, B);
+    for (size_t i = 0; i < expected.size(); ++i) {
+      EXPECT_FLOAT_EQ((*C)[i], expected[i]);
+    }
+  }
+}
+
+TEST(test_binary_node, test_strided_inputs) {
+  auto A = TensorFactory::random_tensor<float>(array_mml<size_t>({6, 4}),
+                                               -1.0f, 1.0f);
+  auto B = TensorFactory::random_tensor<float>(array_mml<size_t>({4, 6}),
+                                               -1.0f, 1.0f);
+  auto B_t = B->transpose();
+
+  std::unordered_map<std::string, GeneralDataTypes> iomap;
+  iomap["A"] = A;
+  iomap["B"] = B_t;
+  BinaryNode node(BinaryKind::Sub, {"A", "B"}, "C");
+  node.forward(iomap);
+
+  auto C = std::get<std::shared_ptr<Tensor<float>>>(iomap["C"]);
+  for (size_t i = 0; i < 6; ++i) {
+    for (size_t j = 0; j < 4; ++j) {
+      EXPECT_FLOAT_EQ((*C)[i * 4 + j], (*A)[i * 4 + j] - (*B)[j * 6 + i]);
+    }
+  }
+}
+
+TEST(test_binary_node, test_variadic_max) {
+  auto A = TensorFactory::create_tensor<int64_t>({2, 2}, {1, 8, 3, 4});
+  auto B = TensorFactory::create_tensor<int64_t>({2}, {5, 2});
+  auto C = TensorFactory::create_tensor<int64_t>({1}, {3});
+
+  std::unordered_map<std::string, GeneralDataTypes> iomap;
+  iomap["A"] = A;
+  iomap["B"] = B;
+  iomap["C"] = C;
+  BinaryNode node(BinaryKind::Max, {"A", "B", "C"}, "Y");
+  node.forward(iomap);
+
+  auto Y = std::get<std::shared_ptr<Tensor<int64_t>>>(iomap["Y"]);
+  const std::vector<int64_t> expected = {5, 8, 5, 4};
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ((*Y)[i], expected[i]);
+  }
+}
+
+TEST(test_binary_node, test_incompatible_shapes) {
+  std::unordered_map<std::string, GeneralDataTypes> iomap;
+  iomap["A"] = TensorFactory::create_tensor<float>(array_mml<size_t>({2, 3}));
+  iomap["B"] = TensorFactory::create_tensor<float>(array_mml<size_t>({2, 4}));
+  BinaryNode node(BinaryKind::Mul, {"A", "B"}, "C");
+  EXPECT_THROW(node.forward(iomap), std::runtime_error);
+  AddNode add("A", "B", "C");
+  EXPECT_THROW(add.forward(iomap), std::runtime_error);
+}
@@ -116,7 +116,7 @@ TEST(conv_node_test, test_forward_5x5input_2x2filter) {
 
   // Create ConvNode object
   ConvNode conv(x_string, w_string, y_string, dilations, padding, kernel_shape,
-                stride, B, 8);
+                stride, B, 1);
 
   conv.forward(iomap);
 
@@ -269,7 +269,7 @@ TEST(conv_node_test, test_forward_three_in_channels_eight_out_channels) {
 
   // Create ConvNode object
   ConvNode conv(x_string, w_string, y_string, dilations, padding, kernel_shape,
-                stride, B, 8);
+                stride, B, 1);
 
   conv.forward(iomap);
 
@@ -353,7 +353,7 @@ TEST(conv_node_test,
 
   // Create ConvNode object
   ConvNode conv(x_string, w_string, y_string, dilations, padding, kernel_shape,
-                stride, B, 8);
+                stride, B, 1);
 
   conv.forward(iomap);
 
@@ -611,7 +611,7 @@ TEST(conv_node_test, test_bias_multiple_out_channels) {
 
   // Create ConvNode object
   ConvNode conv(x_string, w_string, y_string, dilations, padding, kernel_shape,
-                stride, b_string, 8);
+                stride, b_string, 1);
 
   conv.forward(iomap);
 
@@ -694,4 +694,539 @@ TEST(conv_node_test, TestPadding) {
   // that the size is correct As we only add padding to the top and bottom we
   // would expect the height to be 4 and the output to be 2
   EXPECT_EQ(result_ptr->get_shape(), array_mml<size_t>({1, 1, 4, 2}));
-}
\ No newline at end of file
+}
+namespace {
+
+// Direct convolution, padding is [top, bottom, left, right]
+std::vector<float> reference_conv(const std::vector<float> &x, size_t batch,
+                                  size_t channels, size_t height, size_t width,
+                                  const std::vector<float> &w,
+                                  size_t out_channels, size_t kernel,
+                                  size_t stride, size_t dilation,
+                                  const std::vector<size_t> &pads,
+                                  size_t out_height, size_t out_width,
+                                  size_t group = 1) {
+  const size_t group_channels = channels / group;
+  std::vector<float> y(batch * out_channels * out_height * out_width, 0.0f);
+  for (size_t n = 0; n < batch; ++n) {
+    for (size_t m = 0; m < out_channels; ++m) {
+      const size_t first_channel = m / (out_channels / group) * group_channels;
+      for (size_t oh = 0; oh < out_height; ++oh) {
+        for (size_t ow = 0; ow < out_width; ++ow) {
+          float sum = 0.0f;
+          for (size_t c = 0; c < group_channels; ++c) {
+            for (size_t kh = 0; kh < kernel; ++kh) {
+              for (size_t kw = 0; kw < kernel; ++kw) {
+                long ih = static_cast<long>(oh * stride + kh * dilation) -
+                          static_cast<long>(pads[0]);
+                long iw = static_cast<long>(ow * stride + kw * dilation) -
+                          static_cast<long>(pads[2]);
+                if (ih < 0 || iw < 0 || ih >= static_cast<long>(height) ||
+                    iw >= static_cast<long>(width)) {
+                  continue;
+                }
+                sum += x[((n * channels + first_channel + c) * height + ih) *
+                             width +
+                         iw] *
+                       w[((m * group_channels + c) * kernel + kh) * kernel +
+                         kw];
+              }
+            }
+          }
+          y[((n * out_channels + m) * out_height + oh) * out_width + ow] = sum;
+        }
+      }
+    }
+  }
+  return y;
+}
+
+}  // namespace
+
+TEST(conv_node_test, test_batched_padded_strided_dilated) {
+  const size_t batch = 3;
+  const size_t channels = 2;
+  const size_t height = 9;
+  const size_t width = 7;
+  const size_t out_channels = 4;
+  const size_t kernel = 3;
+  auto x = generate_random_array_mml_real<float>(
+      batch * channels * height * width, batch * channels * height * width,
+      -1, 1);
+  auto w = generate_random_array_mml_real<float>(
+      out_channels * channels * kernel * kernel,
+      out_channels * channels * kernel * kernel, -1, 1);
+  std::vector<float> x_values(x.begin(), x.end());
+  std::vector<float> w_values(w.begin(), w.end());
+
+  struct Case {
+    size_t stride;
+    size_t dilation;
+    std::vector<size_t> pads;
+  };
+  for (const Case &test_case :
+       {Case{1, 1, {1, 1, 1, 1}}, Case{2, 1, {2, 0, 1, 3}},
+        Case{1, 2, {0, 2, 2, 0}}, Case{3, 2, {3, 3, 3, 3}}}) {
+    const auto &pads = test_case.pads;
+    const size_t extent = test_case.dilation * (kernel - 1) + 1;
+    const size_t out_height =
+        (height + pads[0] + pads[1] - extent) / test_case.stride + 1;
+    const size_t out_width =
+        (width + pads[2] + pads[3] - extent) / test_case.stride + 1;
+
+    std::unordered_map<std::string, GeneralDataTypes> iomap;
+    iomap["X"] = TensorFactory::create_tensor<float>(
+        {batch, channels, height, width}, x);
+    iomap["W"] = TensorFactory::create_tensor<float>(
+        {out_channels, channels, kernel, kernel}, w);
+
+    ConvNode conv("X", "W", "Y", {test_case.dilation, test_case.dilation},
+                  array_mml<size_t>(pads), {kernel, kernel},
+                  {test_case.stride, test_case.stride}, std::nullopt, 1);
+    conv.forward(iomap);
+
+    auto y = std::get<std::shared_ptr<Tensor<float>>>(iomap["Y"]);
+    ASSERT_EQ(y->get_shape(),
+              (array_mml<size_t>{batch, out_channels, out_height, out_width}));
+    auto expected =
+        reference_conv(x_values, batch, channels, height, width, w_values,
+                       out_channels, kernel, test_case.stride,
+                       test_case.dilation, pads, out_height, out_width);
+    for (size_t i = 0; i < expected.size(); ++i) {
+      EXPECT_NEAR((*y)[i], expected[i], 1e-4) << "at " << i;
+    }
+  }
+}
+
+TEST(conv_node_test, test_columns_beyond_scratch_limit) {
+  // Dilated, so it runs im2col, with column matrices larger than the scratch
+  // area a thread keeps
+  const size_t batch = 2;
+  const size_t channels = 16;
+  const size_t size = 128;
+  const size_t out_channels = 4;
+  const size_t kernel = 3;
+  const std::vector<size_t> pads = {2, 2, 2, 2};
+  ASSERT_GT(batch * channels * kernel * kernel * size * size * sizeof(float),
+            ConvNode::im2col_scratch_max_bytes);
+
+  auto x = generate_random_array_mml_real<float>(
+      batch * channels * size * size, batch * channels * size * size, -1, 1);
+  auto w = generate_random_array_mml_real<float>(
+      out_channels * channels * kernel * kernel,
+      out_channels * channels * kernel * kernel, -1, 1);
+  std::unordered_map<std::string, GeneralDataTypes> iomap;
+  iomap["X"] =
+      TensorFactory::create_tensor<float>({batch, channels, size, size}, x);
+  iomap["W"] = TensorFactory::create_tensor<float>(
+      {out_channels, channels, kernel, kernel}, w);
+
+  ConvNode conv("X", "W", "Y", {2, 2}, array_mml<size_t>(pads),
+                {kernel, kernel}, {1, 1}, std::nullopt, 1);
+  conv.forward(iomap);
+
+  auto y = std::get<std::shared_ptr<Tensor<float>>>(iomap["Y"]);
+  ASSERT_EQ(y->get_shape(),
+            (array_mml<size_t>{batch, out_channels, size, size}));
+  auto expected = reference_conv(std::vector<float>(x.begin(), x.end()), batch,
+                                 channels, size, size,
+                                 std::vector<float>(w.begin(), w.end()),
+                                 out_channels, kernel, 1, 2, pads, size, size);
+  for (size_t i = 0; i < expected.size(); ++i) {
+    ASSERT_NEAR((*y)[i], expected[i], 1e-4) << "at " << i;
+  }
+}
+
+TEST(conv_node_test, test_winograd_matches_im2col) {
+  const size_t batch = 2;
+  const size_t channels = 5;
+  const size_t out_channels = 7;
+
+  // 5x6 outputs use 2x2 tiles, 13x10 outputs 4x4 tiles, both with cut tiles
+  for (auto [height, width] : {std::pair<size_t, size_t>{5, 6}, {13, 10}}) {
+    for (const std::vector<size_t> &pads :
+         {std::vector<size_t>{0, 0, 0, 0}, {1, 1, 1, 1}, {2, 0, 0, 1}}) {
+      auto x = TensorFactory::random_tensor<float>(
+          {batch, channels, height, width}, -1, 1);
+      auto w =
+          TensorFactory::random_tensor<float>({out_channels, channels, 3, 3});
+      auto b = TensorFactory::random_tensor<float>({out_channels}, -1, 1);
+
+      std::vector<std::shared_ptr<Tensor<float>>> results;
+      for (bool winograd : {false, true}) {
+        ConvNode::set_winograd_enabled(winograd);
+        std::unordered_map<std::string, GeneralDataTypes> iomap;
+        iomap["X"] = x;
+        iomap["W"] = w;
+        iomap["B"] = b;
+        ConvNode conv("X", "W", "Y", {1, 1}, array_mml<size_t>(pads), {3, 3},
+                      {1, 1}, "B", 1);
+        // Both calls read the weights transformed by prepare
+        conv.prepare(iomap);
+        conv.forward(iomap);
+        conv.forward(iomap);
+        results.push_back(
+            std::get<std::shared_ptr<Tensor<float>>>(iomap["Y"]));
+      }
+      ConvNode::set_winograd_enabled(true);
+
+      ASSERT_EQ(results[0]->get_shape(), results[1]->get_shape());
+      for (size_t i = 0; i < results[0]->get_size(); ++i) {
+        EXPECT_NEAR((*results[1])[i], (*results[0])[i], 1e-4) << "at " << i;
+      }
+    }
+  }
+}
+
+TEST(conv_node_test, test_grouped_and_depthwise) {
+  const size_t batch = 2;
+  const size_t channels = 6;
+  const size_t height = 11;
+  const size_t width = 9;
+  const size_t kernel = 3;
+  auto x = generate_random_array_mml_real<float>(
+      batch * channels * height * width, batch * channels * height * width,
+      -1, 1);
+  std::vector<float> x_values(x.begin(), x.end());
+
+  struct Case {
+    size_t group;
+    size_t out_channels;
+    size_t stride;
+    size_t dilation;
+    std::vector<size_t> pads;
+  };
+  // Grouped, depthwise, depthwise with a multiplier of 2
+  for (const Case &test_case :
+       {Case{2, 4, 1, 1, {1, 1, 1, 1}}, Case{3, 6, 2, 1, {0, 1, 2, 0}},
+        Case{6, 6, 1, 1, {1, 1, 1, 1}}, Case{6, 6, 2, 2, {2, 0, 1, 3}},
+        Case{6, 12, 1, 1, {0, 0, 0, 0}}}) {
+    const size_t group_channels = channels / test_case.group;
+    auto w = generate_random_array_mml_real<float>(
+        test_case.out_channels * group_channels * kernel * kernel,
+        test_case.out_channels * group_channels * kernel * kernel, -1, 1);
+    std::vector<float> w_values(w.begin(), w.end());
+
+    const auto &pads = test_case.pads;
+    const size_t extent = test_case.dilation * (kernel - 1) + 1;
+    const size_t out_height =
+        (height + pads[0] + pads[1] - extent) / test_case.stride + 1;
+    const size_t out_width =
+        (width + pads[2] + pads[3] - extent) / test_case.stride + 1;
+
+    std::unordered_map<std::string, GeneralDataTypes> iomap;
+    iomap["X"] = TensorFactory::create_tensor<float>(
+        {batch, channels, height, width}, x);
+    iomap["W"] = TensorFactory::create_tensor<float>(
+        {test_case.out_channels, group_channels, kernel, kernel}, w);
+
+    ConvNode conv("X", "W", "Y", {test_case.dilation, test_case.dilation},
+                  array_mml<size_t>(pads), {kernel, kernel},
+                  {test_case.stride, test_case.stride}, std::nullopt,
+                  test_case.group);
+    conv.forward(iomap);
+
+    auto y = std::get<std::shared_ptr<Tensor<float>>>(iomap["Y"]);
+    ASSERT_EQ(y->get_shape(), (array_mml<size_t>{batch, test_case.out_channels,
+                                                 out_height, out_width}));
+    auto expected = reference_conv(
+        x_values, batch, channels, height, width, w_values,
+        test_case.out_channels, kernel, test_case.stride, test_case.dilation,
+        pads, out_height, out_width, test_case.group);
+    for (size_t i = 0; i < expected.size(); ++i) {
+      EXPECT_NEAR((*y)[i], expected[i], 1e-4)
+          << "group " << test_case.group << " at " << i;
+    }
+  }
+}
+
+TEST(conv_node_test, test_pointwise_with_bias) {
+  const size_t batch = 3;
+  const size_t channels = 4;
+  const size_t height = 5;
+  const size_t width = 7;
+  const size_t out_channels = 6;
+  auto x = generate_random_array_mml_real<float>(
+      batch * channels * height * width, batch * channels * height * width,
+      -1, 1);
+  auto b = generate_random_array_mml_real<float>(out_channels, out_channels,
+                                                 -1, 1);
+  std::vector<float> x_values(x.begin(), x.end());
+
+  for (size_t group : {1, 2}) {
+    const size_t group_channels = channels / group;
+    auto w = generate_random_array_mml_real<float>(
+        out_channels * group_channels, out_channels * group_channels, -1, 1);
+    std::vector<float> w_values(w.begin(), w.end());
+
+    std::unordered_map<std::string, GeneralDataTypes> iomap;
+    iomap["X"] = TensorFactory::create_tensor<float>(
+        {batch, channels, height, width}, x);
+    iomap["W"] = TensorFactory::create_tensor<float>(
+        {out_channels, group_channels, 1, 1}, w);
+    iomap["B"] = TensorFactory::create_tensor<float>({out_channels}, b);
+
+    ConvNode conv("X", "W", "Y", {1, 1}, {0, 0, 0, 0}, {1, 1}, {1, 1}, "B",
+                  group);
+    conv.forward(iomap);
+
+    auto y = std::get<std::shared_ptr<Tensor<float>>>(iomap["Y"]);
+    ASSERT_EQ(y->get_shape(),
+              (array_mml<size_t>{batch, out_channels, height, width}));
+    auto expected = reference_conv(x_values, batch, channels, height, width,
+                                   w_values, out_channels, 1, 1, 1,
+                                   {0, 0, 0, 0}, height, width, group);
+    for (size_t i = 0; i < expected.size(); ++i) {
+      const float bias = b[i / (height * width) % out_channels];
+      EXPECT_NEAR((*y)[i], expected[i] + bias, 1e-4)
+          << "group " << group << " at " << i;
+    }
+  }
+}
+
+TEST(conv_node_test, test_prepared_weights) {
+  TensorOperations::reset_gemm_ptr<float>();
+  const size_t batch = 2;
+  const size_t channels = 4;
+  const size_t height = 9;
+  const size_t width = 8;
+  auto x = generate_random_array_mml_real<float>(
+      batch * channels * height * width, batch * channels * height * width,
+      -1, 1);
+  std::vector<float> x_values(x.begin(), x.end());
+
+  struct Case {
+    size_t kernel;
+    size_t group;
+    std::vector<size_t> pads;
+  };
+  // Im2col, grouped im2col, pointwise and Winograd with tiles of 4 and,
+  // for an output smaller than 8x8, of 2
+  for (const Case &test_case :
+       {Case{5, 1, {2, 2, 2, 2}}, Case{3, 2, {0, 1, 1, 0}},
+        Case{1, 1, {0, 0, 0, 0}}, Case{3, 1, {1, 1, 1, 1}},
+        Case{3, 1, {0, 0, 0, 0}}}) {
+    const size_t kernel = test_case.kernel;
+    const size_t out_channels = 6;
+    const size_t group_channels = channels / test_case.group;
+    auto w = generate_random_array_mml_real<float>(
+        out_channels * group_channels * kernel * kernel,
+        out_channels * group_channels * kernel * kernel, -1, 1);
+    std::vector<float> w_values(w.begin(), w.end());
+
+    std::unordered_map<std::string, GeneralDataTypes> weights;
+    weights["W"] = TensorFactory::create_tensor<float>(
+        {out_channels, group_channels, kernel, kernel}, w);
+
+    const auto &pads = test_case.pads;
+    const size_t out_height = height + pads[0] + pads[1] - kernel + 1;
+    const size_t out_width = width + pads[2] + pads[3] - kernel + 1;
+
+    ConvNode conv("X", "W", "Y", {1, 1}, array_mml<size_t>(pads),
+                  {kernel, kernel}, {1, 1}, std::nullopt, test_case.group);
+    conv.prepare(weights);
+    // The second call reuses the prepared weights as well
+    for (int call = 0; call < 2; ++call) {
+      std::unordered_map<std::string, GeneralDataTypes> iomap = weights;
+      iomap["X"] = TensorFactory::create_tensor<float>(
+          {batch, channels, height, width}, x);
+      conv.forward(iomap);
+
+      auto y = std::get<std::shared_ptr<Tensor<float>>>(iomap["Y"]);
+      auto expected = reference_conv(
+          x_values, batch, channels, height, width, w_values, out_channels,
+          kernel, 1, 1, pads, out_height, out_width, test_case.group);
+      ASSERT_EQ(y->get_size(), expected.size());
+      for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_NEAR((*y)[i], expected[i], 1e-4)
+            << "kernel " << kernel << " call " << call << " at " << i;
+      }
+    }
+  }
+}
+
+TEST(conv_node_test, test_blocked_copy) {
+  auto blocked_name = [](const std::string &name) { return name + "#b"; };
+  const size_t batch = 2;
+  const size_t height = 9;
+  const size_t width = 15;
+  const size_t kernel = 3;
+
+  // The SIMD kernel of the selected tier and the portable one
+  for (size_t block : {mml_nchwc_block<float>(), size_t{4}}) {
+    const size_t channels = 2 * block;
+    const size_t out_channels = 3 * block;
+    auto x = generate_random_array_mml_real<float>(
+        batch * channels * height * width, batch * channels * height * width,
+        -1, 1);
+    auto w = generate_random_array_mml_real<float>(
+        out_channels * channels * kernel * kernel,
+        out_channels * channels * kernel * kernel, -1, 1);
+    auto b = generate_random_array_mml_real<float>(out_channels, out_channels,
+                                                   -1, 1);
+    std::vector<float> x_values(x.begin(), x.end());
+    std::vector<float> w_values(w.begin(), w.end());
+
+    std::unordered_map<std::string, GeneralDataTypes> weights;
+    weights["W"] = TensorFactory::create_tensor<float>(
+        {out_channels, channels, kernel, kernel}, w);
+    weights["B"] = TensorFactory::create_tensor<float>({out_channels}, b);
+
+    struct Case {
+      size_t stride;
+      size_t dilation;
+      std::vector<size_t> pads;
+    };
+    for (const Case &test_case :
+         {Case{1, 1, {1, 1, 1, 1}}, Case{2, 1, {2, 0, 1, 3}},
+          Case{1, 2, {0, 2, 2, 0}}, Case{3, 1, {0, 0, 0, 0}}}) {
+      const auto &pads = test_case.pads;
+      const size_t extent = test_case.dilation * (kernel - 1) + 1;
+      const size_t out_height =
+          (height + pads[0] + pads[1] - extent) / test_case.stride + 1;
+      const size_t out_width =
+          (width + pads[2] + pads[3] - extent) / test_case.stride + 1;
+
+      ConvNode conv("X", "W", "Y", {test_case.dilation, test_case.dilation},
+                    array_mml<size_t>(pads), {kernel, kernel},
+                    {test_case.stride, test_case.stride}, "B", 1);
+      auto blocked = conv.blocked_copy(block, weights, blocked_name);
+      ASSERT_NE(blocked, nullptr);
+      EXPECT_EQ(blocked->getInputs(),
+                (std::vector<std::string>{"X#b", "W", "B"}));
+      blocked->prepare(weights);
+
+      std::unordered_map<std::string, GeneralDataTypes> iomap = weights;
+      iomap["X"] = TensorFactory::create_tensor<float>(
+          {batch, channels, height, width}, x);
+      ReorderNode("X", "X#b", block, true).forward(iomap);
+      blocked->forward(iomap);
+      auto y_blocked = std::get<std::shared_ptr<Tensor<float>>>(iomap["Y#b"]);
+      ASSERT_EQ(y_blocked->get_shape(),
+                (array_mml<size_t>{batch, out_channels / block, out_height,
+                                   out_width, block}));
+      ReorderNode("Y#b", "Y", block, false).forward(iomap);
+
+      auto y = std::get<std::shared_ptr<Tensor<float>>>(iomap["Y"]);
+      auto expected =
+          reference_conv(x_values, batch, channels, height, width, w_values,
+                         out_channels, kernel, test_case.stride,
+                         test_case.dilation, pads, out_height, out_width);
+      const size_t spatial = out_height * out_width;
+      ASSERT_EQ(y->get_size(), expected.size());
+      for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_NEAR((*y)[i], expected[i] + b[i / spatial % out_channels], 1e-4)
+            << "block " << block << " at " << i;
+      }
+    }
+  }
+
+  // Grouped convolutions and channels that are not blocks stay plain
+  std::unordered_map<std::string, GeneralDataTypes> weights;
+  weights["W"] = TensorFactory::create_tensor<float>({16, 8, 3, 3});
+  ConvNode grouped("X", "W", "Y", {1, 1}, {0, 0, 0, 0}, {3, 3}, {1, 1},
+                   std::nullopt, 2);
+  EXPECT_EQ(grouped.blocked_copy(8, weights, blocked_name), nullptr);
+  ConvNode conv("X", "W", "Y", {1, 1}, {0, 0, 0, 0}, {3, 3}, {1, 1},
+                std::nullopt, 1);
+  EXPECT_NE(conv.blocked_copy(8, weights, blocked_name), nullptr);
+  EXPECT_EQ(conv.blocked_copy(16, weights, blocked_name), nullptr);
+}
+
+TEST(conv_node_test, test_fused_activation) {
+  const size_t batch = 2;
+  const size_t channels = 16;
+  const size_t height = 9;
+  const size_t width = 10;
+  const size_t out_channels = 16;
+  auto x = generate_random_array_mml_real<float>(
+      batch * channels * height * width, batch * channels * height * width,
+      -1, 1);
+  auto b = generate_random_array_mml_real<float>(out_channels, out_channels,
+                                                 -1, 1);
+  std::vector<float> x_values(x.begin(), x.end());
+
+  struct Case {
+    size_t kernel;
+    size_t group;
+    size_t block;  // 0 runs the plain node
+    bool packed;   // False runs another GEMM than the packed one
+  };
+  // Im2col, pointwise, Winograd, depthwise, blocked and the unpacked GEMM
+  for (const Case &test_case :
+       {Case{5, 1, 0, true}, Case{1, 2, 0, true}, Case{3, 1, 0, true},
+        Case{3, channels, 0, true}, Case{3, 1, mml_nchwc_block<float>(), true},
+        Case{5, 2, 0, false}}) {
+    const size_t kernel = test_case.kernel;
+    const size_t group_channels = channels / test_case.group;
+    auto w = generate_random_array_mml_real<float>(
+        out_channels * group_channels * kernel * kernel,
+        out_channels * group_channels * kernel * kernel, -1, 1);
+    std::vector<float> w_values(w.begin(), w.end());
+
+    std::unordered_map<std::string, GeneralDataTypes> weights;
+    weights["W"] = TensorFactory::create_tensor<float>(
+        {out_channels, group_channels, kernel, kernel}, w);
+    weights["B"] = TensorFactory::create_tensor<float>({out_channels}, b);
+
+    const size_t pad = kernel / 2;
+    const std::vector<size_t> pads = {pad, pad, pad, pad};
+    auto expected = reference_conv(x_values, batch, channels, height, width,
+                                   w_values, out_channels, kernel, 1, 1, pads,
+                                   height, width, test_case.group);
+
+    if (!test_case.packed) {
+      TensorOperations::set_gemm_ptr<float>(mml_gemm_inner_product<float>);
+    }
+    for (const Activation &activation :
+         {Activation{ActivationKind::LeakyRelu, 0.1f},
+          Activation{ActivationKind::Sigmoid}}) {
+      ConvNode conv("X", "W", "Y", {1, 1}, array_mml<size_t>(pads),
+                    {kernel, kernel}, {1, 1}, "B", test_case.group);
+      auto fused = conv.fused_copy(activation, "Z");
+      ASSERT_NE(fused, nullptr);
+      EXPECT_EQ(fused->getOutputs(), std::vector<std::string>{"Z"});
+      // A node applies a single activation
+      EXPECT_EQ(fused->fused_copy(activation, "Z2"), nullptr);
+
+      std::unordered_map<std::string, GeneralDataTypes> iomap = weights;
+      iomap["X"] = TensorFactory::create_tensor<float>(
+          {batch, channels, height, width}, x);
+      if (test_case.block != 0) {
+        auto blocked_name = [](const std::string &name) {
+          return name + "#b";
+        };
+        fused = fused->blocked_copy(test_case.block, weights, blocked_name);
+        ASSERT_NE(fused, nullptr);
+        ReorderNode("X", "X#b", test_case.block, true).forward(iomap);
+        fused->forward(iomap);
+        ReorderNode("Z#b", "Z", test_case.block, false).forward(iomap);
+      } else {
+        fused->forward(iomap);
+      }
+
+      auto z = std::get<std::shared_ptr<Tensor<float>>>(iomap["Z"]);
+      ASSERT_EQ(z->get_size(), expected.size());
+      const size_t spatial = height * width;
+      for (size_t i = 0; i < expected.size(); ++i) {
+        float value = expected[i] + b[i / spatial % out_channels];
+        value = activation.kind == ActivationKind::Sigmoid
+                    ? 1 / (1 + std::exp(-value))
+                    : (value < 0 ? 0.1f * value : value);
+        EXPECT_NEAR((*z)[i], value, 1e-4)
+            << "kernel " << kernel << " group " << test_case.group << " at "
+            << i;
+      }
+    }
+    TensorOperations::reset_gemm_ptr<float>();
+  }
+}
+
+TEST(conv_node_test, test_group_mismatch_throws) {
+  std::unordered_map<std::string, GeneralDataTypes> iomap;
+  iomap["X"] = TensorFactory::create_tensor<float>({1, 4, 5, 5});
+  iomap["W"] = TensorFactory::create_tensor<float>({4, 4, 3, 3});
+  ConvNode conv("X", "W", "Y", {1, 1}, {0, 0, 0, 0}, {3, 3}, {1, 1},
+                std::nullopt, 2);
+  EXPECT_THROW(conv.forward(iomap), std::runtime_error);
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <modularml>
+#include <stdexcept>
+
+TEST(test_cpu_dispatch, test_tier_names_round_trip) {
+  for (SimdTier tier : {SimdTier::Scalar, SimdTier::AVX2, SimdTier::AVX512}) {
+    EXPECT_EQ(CpuDispatch::parse_tier(CpuDispatch::tier_name(tier)), tier);
+  }
+  EXPECT_EQ(CpuDispatch::parse_tier("AVX2"), SimdTier::AVX2);
+  EXPECT_THROW(CpuDispatch::parse_tier("sse"), std::invalid_argument);
+}
+
+TEST(test_cpu_dispatch, test_set_tier) {
+  const SimdTier detected = CpuDispatch::detect_tier();
+  EXPECT_LE(CpuDispatch::get_tier(), detected);
+
+  CpuDispatch::set_tier(SimdTier::Scalar);
+  EXPECT_EQ(CpuDispatch::get_tier(), SimdTier::Scalar);
+  if (detected < SimdTier::AVX512) {
+    EXPECT_THROW(CpuDispatch::set_tier(SimdTier::AVX512),
+                 std::invalid_argument);
+  }
+
+  CpuDispatch::reset_tier();
+  EXPECT_LE(CpuDispatch::get_tier(), detected);
+}
+
+TEST(test_cpu_dispatch, test_gemm_tiers_agree) {
+  const int M = 29;
+  const int N = 70;
+  const int K = 45;
+  auto a = TensorFactory::create_tensor<float>(
+      {static_cast<size_t>(M), static_cast<size_t>(K)},
+      generate_random_array_mml_real<float>(M * K, M * K, -1, 1));
+  auto b = TensorFactory::create_tensor<float>(
+      {static_cast<size_t>(K), static_cast<size_t>(N)},
+      generate_random_array_mml_real<float>(K * N, K * N, -1, 1));
+
+  CpuDispatch::set_tier(SimdTier::Scalar);
+  auto expected = TensorFactory::create_tensor<float>(
+      {static_cast<size_t>(M), static_cast<size_t>(N)});
+  mml_gemm_packed<float>(0, 0, M, N, K, 1, a, K, b, N, 0, expected, N);
+
+  for (SimdTier tier : {SimdTier::AVX2, SimdTier::AVX512}) {
+    if (tier > CpuDispatch::detect_tier()) {
+      continue;
+    }
+    CpuDispatch::set_tier(tier);
+    auto c = TensorFactory::create_tensor<float>(
+        {static_cast<size_t>(M), static_cast<size_t>(N)});
+    mml_gemm_packed<float>(0, 0, M, N, K, 1, a, K, b, N, 0, c, N);
+    EXPECT_TRUE(tensors_are_close(*c, *expected, 1e-4f))
+        << CpuDispatch::tier_name(tier);
+  }
+
+  CpuDispatch::reset_tier();
+}
+
+TEST(test_cpu_dispatch, test_loop_kernel_tiers_agree) {
+  auto x = TensorFactory::create_tensor<float>(
+      {2, 3, 11, 13},
+      generate_random_array_mml_real<float>(2 * 3 * 11 * 13, 2 * 3 * 11 * 13,
+                                            -1, 1));
+  auto bias = TensorFactory::create_tensor<float>({3, 1, 1}, {0.5f, -1, 2});
+  auto w = TensorFactory::create_tensor<float>(
+      {4, 3, 3, 3}, generate_random_array_mml_real<float>(108, 108, -1, 1));
+  auto scale = TensorFactory::create_tensor<float>({3}, {1.5f, -0.5f, 2});
+  auto shift = TensorFactory::create_tensor<float>({3}, {0.25f, 1, -1});
+  auto mean = TensorFactory::create_tensor<float>({3}, {0.1f, -0.2f, 0});
+  auto var = TensorFactory::create_tensor<float>({3}, {1, 0.5f, 2});
+
+  // Elementwise, broadcast binary, pooling, a strided im2col convolution,
+  // reductions over the last and a middle axis, softmax over the last and a
+  // middle axis and batch normalization
+  auto run = [&] {
+    std::vector<std::shared_ptr<Tensor<float>>> results;
+    auto mapped = TensorFactory::create_tensor<float>(x->get_shape());
+    mml_map<float>(x, [](float v) { return v * v - 0.25f; }, mapped);
+    results.push_back(mapped);
+    auto added = TensorFactory::create_tensor<float>(x->get_shape());
+    mml_binary<float>(BinaryKind::Add, x, bias, added);
+    results.push_back(added);
+
+    std::unordered_map<std::string, GeneralDataTypes> iomap;
+    iomap["X"] = x;
+    iomap["W"] = w;
+    iomap["scale"] = scale;
+    iomap["shift"] = shift;
+    iomap["mean"] = mean;
+    iomap["var"] = var;
+    MaxPoolNode("X", "M", {3, 3}, std::nullopt, "NOTSET", 0, {1, 1},
+                {1, 1, 1, 1}, 0, {2, 2})
+        .forward(iomap);
+    AvgPoolNode("X", "A", {2, 3}).forward(iomap);
+    ConvNode("X", "W", "C", {1, 1}, {1, 1, 1, 1}, {3, 3}, {2, 2}, std::nullopt)
+        .forward(iomap);
+    ReduceNode(ReductionKind::Sum, "X", "R", {3}).forward(iomap);
+    ReduceNode(ReductionKind::Max, "X", "Q", {1}).forward(iomap);
+    SoftMaxNode("X", "S").forward(iomap);
+    SoftMaxNode("X", "L", 2, SoftmaxKind::LogSoftmax).forward(iomap);
+    BatchNormalizationNode("X", "scale", "shift", "mean", "var", "B")
+        .forward(iomap);
+    for (const char *name : {"M", "A", "C", "R", "Q", "S", "L", "B"}) {
+      results.push_back(std::get<std::shared_ptr<Tensor<float>>>(iomap[name]));
+    }
+    return results;
+  };
+
+  CpuDispatch::set_tier(SimdTier::Scalar);
+  const auto expected = run();
+  for (SimdTier tier : {SimdTier::AVX2, SimdTier::AVX512}) {
+    if (tier > CpuDispatch::detect_tier()) {
+      continue;
+    }
+    CpuDispatch::set_tier(tier);
+    const auto results = run();
+    for (size_t i = 0; i < expected.size(); ++i) {
+      EXPECT_TRUE(tensors_are_close(*results[i], *expected[i], 1e-4f))
+          << CpuDispatch::tier_name(tier) << " result " << i;
+    }
+  }
+
+  CpuDispatch::reset_tier();
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include <limits>
 #include <modularml>
 
 TEST(GemmNodeTest, ForwardMultiplication) {
@@ -53,4 +54,62 @@ TEST(GemmNodeTest, ForwardMultiplication) {
   for (int i = 0; i < expected.get_size(); i++) {
     EXPECT_FLOAT_EQ(expected[i], (*result_ptr)[i]);
   }
-}
\ No newline at end of file
+}
+TEST(GemmNodeTest, PreparedWeightsMatchUnpacked) {
+  TensorOperations::reset_gemm_ptr<float>();
+  auto A_ptr = TensorFactory::random_tensor<float>({5, 70}, -1, 1);
+  auto C_ptr = TensorFactory::random_tensor<float>({1, 33}, -1, 1);
+
+  for (int transB : {0, 1}) {
+    auto B_ptr = TensorFactory::random_tensor<float>(
+        transB ? array_mml<size_t>{33, 70} : array_mml<size_t>{70, 33}, -1,
+        1);
+    std::unordered_map<std::string, GeneralDataTypes> weights;
+    weights["B"] = B_ptr;
+    weights["C"] = C_ptr;
+
+    std::vector<std::shared_ptr<Tensor<float>>> results;
+    for (bool prepared : {false, true}) {
+      GemmNode node("A", "B", "Y", "C", 0.5f, 2.0f, 0, transB);
+      if (prepared) {
+        node.prepare(weights);
+      }
+      std::unordered_map<std::string, GeneralDataTypes> iomap = weights;
+      iomap["A"] = A_ptr;
+      node.forward(iomap);
+      results.push_back(std::get<std::shared_ptr<Tensor<float>>>(iomap["Y"]));
+    }
+
+    ASSERT_EQ(results[0]->get_shape(), results[1]->get_shape());
+    for (size_t i = 0; i < results[0]->get_size(); i++) {
+      EXPECT_NEAR((*results[1])[i], (*results[0])[i], 1e-4)
+          << "transB " << transB << " at " << i;
+    }
+  }
+}
+
+TEST(GemmNodeTest, WritesExistingOutputInPlace) {
+  auto A_ptr = TensorFactory::create_tensor<float>({2, 3}, {1, 2, 3, 4, 5, 6});
+  auto B_ptr =
+      TensorFactory::create_tensor<float>({3, 2}, {7, 8, 9, 10, 11, 12});
+  auto C_ptr = TensorFactory::create_tensor<float>({2}, {1, -1});
+  // Stale values in the output must not leak into the result
+  auto Y_ptr = TensorFactory::create_tensor<float>({2, 2});
+  Y_ptr->fill(std::numeric_limits<float>::quiet_NaN());
+
+  std::unordered_map<std::string, GeneralDataTypes> iomap;
+  iomap["A"] = A_ptr;
+  iomap["B"] = B_ptr;
+  iomap["C"] = C_ptr;
+  iomap["Y"] = Y_ptr;
+
+  GemmNode node("A", "B", "Y", "C", 1.0f, 1.0f, 0, 0);
+  node.forward(iomap);
+
+  auto result_ptr = std::get<std::shared_ptr<Tensor<float>>>(iomap["Y"]);
+  EXPECT_EQ(result_ptr, Y_ptr);
+  std::vector<float> expected = {59, 63, 140, 153};
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_FLOAT_EQ((*result_ptr)[i], expected[i]);
+  }
+}
@@ -139,3 +139,37 @@ TEST(ResNet18, Foxhound) {
   ASSERT_NO_THROW(cls = infer_and_get_class(tensor, model_json, labels_json));
   EXPECT_EQ(cls, "English_foxhound");
 }
+
+TEST(ResNet18, WinogradMatchesIm2col) {
+  const std::string model_json = "../resnet18.json";
+  if (!std::filesystem::exists(model_json)) {
+    GTEST_SKIP() << "Skipping because model JSON not found: " << model_json;
+  }
+
+  std::ifstream mf(model_json);
+  nlohmann::json j;
+  mf >> j;
+  Parser_mml parser;
+  auto mb = parser.parse(j);
+  auto model = dynamic_cast<Model_mml*>(mb.get());
+
+  for (const std::string image : {"foxhound.png", "American_egret.png"}) {
+    auto tensor = load_and_preprocess(
+        "../tests/data/alexnet/alexnet_pictures/" + image);
+    std::vector<std::shared_ptr<Tensor<float>>> outputs;
+    for (bool winograd : {false, true}) {
+      ConvNode::set_winograd_enabled(winograd);
+      std::unordered_map<std::string, GeneralDataTypes> in{{"input", tensor}};
+      auto out = model->infer(in);
+      outputs.push_back(
+          std::get<std::shared_ptr<Tensor<float>>>(out.at("output"))->copy());
+    }
+    ConvNode::set_winograd_enabled(true);
+
+    EXPECT_EQ(TensorOperations::arg_max<float>(outputs[0]),
+              TensorOperations::arg_max<float>(outputs[1]));
+    for (size_t i = 0; i < outputs[0]->get_size(); ++i) {
+      EXPECT_NEAR((*outputs[1])[i], (*outputs[0])[i], 1e-2) << image;
+    }
+  }
+}
@@ -1,6 +1,54 @@
 #include <gtest/gtest.h>
 
-#include "nodes/matmul.hpp"
+#include <modularml>
+
+namespace {
+
+// Multiplies the matrices of a and b broadcast to the batch shape one element
+// at a time, a 1D a being a row vector and a 1D b a column vector
+std::vector<float> reference_matmul(const std::shared_ptr<Tensor<float>> &a,
+                                    const std::shared_ptr<Tensor<float>> &b,
+                                    const std::vector<size_t> &batch_shape) {
+  const auto &a_shape = a->get_shape();
+  const auto &b_shape = b->get_shape();
+  const size_t M = a_shape.size() == 1 ? 1 : a_shape[a_shape.size() - 2];
+  const size_t K = a_shape[a_shape.size() - 1];
+  const size_t N = b_shape.size() == 1 ? 1 : b_shape[b_shape.size() - 1];
+
+  std::vector<size_t> a_target = batch_shape;
+  a_target.push_back(M);
+  a_target.push_back(K);
+  std::vector<size_t> b_target = batch_shape;
+  b_target.push_back(K);
+  b_target.push_back(N);
+  auto a_matrices =
+      (a_shape.size() == 1 ? a->reshape_view(array_mml<size_t>({1, K})) : a)
+          ->broadcast_reshape(array_mml<size_t>(a_target));
+  auto b_matrices =
+      (b_shape.size() == 1 ? b->reshape_view(array_mml<size_t>({K, 1})) : b)
+          ->broadcast_reshape(array_mml<size_t>(b_target));
+
+  size_t batch = 1;
+  for (size_t dim : batch_shape) {
+    batch *= dim;
+  }
+  std::vector<float> result(batch * M * N);
+  for (size_t p = 0; p < batch; p++) {
+    for (size_t i = 0; i < M; i++) {
+      for (size_t j = 0; j < N; j++) {
+        double sum = 0;
+        for (size_t k = 0; k < K; k++) {
+          sum += static_cast<double>((*a_matrices)[(p * M + i) * K + k]) *
+                 (*b_matrices)[(p * K + k) * N + j];
+        }
+        result[(p * M + i) * N + j] = static_cast<float>(sum);
+      }
+    }
+  }
+  return result;
+}
+
+}  // namespace
 
 TEST(MatMulNode_test, test_forward) {
   // Define dimensions: M = 2, K = 3, N = 2.
@@ -51,4 +99,121 @@ TEST(MatMulNode_test, test_forward) {
   for (int i = 0; i < expected->get_size(); i++) {
     EXPECT_FLOAT_EQ((*expected)[i], (*result_ptr)[i]);
   }
-}
\ No newline at end of file
+}
+TEST(MatMulNode_test, test_batched_broadcasts_match_reference) {
+  struct Case {
+    std::vector<size_t> a_shape;
+    std::vector<size_t> b_shape;
+    std::vector<size_t> batch_shape;
+    std::vector<size_t> y_shape;
+  };
+  // Batches of the same shape, broadcast both ways, a weight shared by a
+  // batch of sequences, a shared left matrix and the 1D promotions
+  const std::vector<Case> cases = {
+      {{2, 3, 4, 5}, {2, 3, 5, 6}, {2, 3}, {2, 3, 4, 6}},
+      {{2, 1, 4, 5}, {3, 5, 6}, {2, 3}, {2, 3, 4, 6}},
+      {{3, 7, 5}, {5, 6}, {3}, {3, 7, 6}},
+      {{4, 5}, {3, 5, 6}, {3}, {3, 4, 6}},
+      {{5}, {2, 5, 6}, {2}, {2, 6}},
+      {{2, 4, 5}, {5}, {2}, {2, 4}},
+      {{5}, {5, 6}, {}, {6}},
+      {{5}, {5}, {}, {}}};
+
+  for (const auto &test : cases) {
+    auto A = TensorFactory::random_tensor<float>(
+        array_mml<size_t>(test.a_shape), -1.0f, 1.0f);
+    auto B = TensorFactory::random_tensor<float>(
+        array_mml<size_t>(test.b_shape), -1.0f, 1.0f);
+
+    std::unordered_map<std::string, GeneralDataTypes> iomap;
+    iomap["A"] = A;
+    iomap["B"] = B;
+    MatMulNode node("A", "B", "Y");
+    node.forward(iomap);
+
+    auto Y = std::get<std::shared_ptr<Tensor<float>>>(iomap["Y"]);
+    ASSERT_EQ(Y->get_shape(), array_mml<size_t>(test.y_shape));
+    const auto expected = reference_matmul(A, B, test.batch_shape);
+    ASSERT_EQ(Y->get_size(), expected.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+      EXPECT_NEAR((*Y)[i], expected[i], 1e-4f);
+    }
+  }
+}
+
+TEST(MatMulNode_test, test_strided_input_and_output_in_place) {
+  // A transposed view of A is read in place, and an output of the right shape
+  // already in the iomap is written in place
+  auto A = TensorFactory::random_tensor<float>(array_mml<size_t>({2, 5, 4}),
+                                               -1.0f, 1.0f);
+  auto A_t = A->transpose(std::vector<int>{0, 2, 1});
+  auto B = TensorFactory::random_tensor<float>(array_mml<size_t>({5, 3}),
+                                               -1.0f, 1.0f);
+  auto Y = TensorFactory::create_tensor<float>(array_mml<size_t>({2, 4, 3}));
+
+  std::unordered_map<std::string, GeneralDataTypes> iomap;
+  iomap["A"] = A_t;
+  iomap["B"] = B;
+  iomap["Y"] = Y;
+  MatMulNode node("A", "B", "Y");
+  node.forward(iomap);
+
+  EXPECT_EQ(std::get<std::shared_ptr<Tensor<float>>>(iomap["Y"]), Y);
+  const auto expected = reference_matmul(A_t, B, {2});
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_NEAR((*Y)[i], expected[i], 1e-4f);
+  }
+}
+
+TEST(MatMulNode_test, test_transposed_views_are_not_gathered) {
+  // MatMul(X, Transpose(W)), batched and with a single W, and a batch of
+  // transposed right operands
+  auto X = TensorFactory::random_tensor<float>(array_mml<size_t>({2, 4, 5}),
+                                               -1.0f, 1.0f);
+  auto W = TensorFactory::random_tensor<float>(array_mml<size_t>({3, 5}),
+                                               -1.0f, 1.0f);
+  auto V = TensorFactory::random_tensor<float>(array_mml<size_t>({2, 3, 5}),
+                                               -1.0f, 1.0f);
+  auto W_t = W->transpose();
+  auto V_t = V->transpose(std::vector<int>{0, 2, 1});
+
+  // The GEMM reads their matrices in place, transposed back, when the
+  // tensors they view may be accessed directly
+  if (W->raw_access()) {
+    EXPECT_TRUE(mml_gemm_transposed_view(W_t, 3));
+    EXPECT_TRUE(mml_gemm_transposed_view(V_t, 3));
+  }
+  EXPECT_FALSE(mml_gemm_transposed_view(X, 5));
+
+  for (const auto &B : {W_t, V_t}) {
+    std::unordered_map<std::string, GeneralDataTypes> iomap;
+    iomap["A"] = X;
+    iomap["B"] = B;
+    MatMulNode node("A", "B", "Y");
+    node.forward(iomap);
+
+    auto Y = std::get<std::shared_ptr<Tensor<float>>>(iomap["Y"]);
+    ASSERT_EQ(Y->get_shape(), array_mml<size_t>({2, 4, 3}));
+    const auto expected = reference_matmul(X, B, {2});
+    for (size_t i = 0; i < expected.size(); i++) {
+      EXPECT_NEAR((*Y)[i], expected[i], 1e-4f);
+    }
+  }
+}
+
+TEST(MatMulNode_test, test_incompatible_shapes) {
+  std::unordered_map<std::string, GeneralDataTypes> iomap;
+  MatMulNode node("A", "B", "Y");
+
+  // Inner dimensions differ
+  iomap["A"] = TensorFactory::create_tensor<float>(array_mml<size_t>({2, 3}));
+  iomap["B"] = TensorFactory::create_tensor<float>(array_mml<size_t>({4, 2}));
+  EXPECT_THROW(node.forward(iomap), std::runtime_error);
+
+  // Batch dimensions do not broadcast
+  iomap["A"] =
+      TensorFactory::create_tensor<float>(array_mml<size_t>({2, 2, 3}));
+  iomap["B"] =
+      TensorFactory::create_tensor<float>(array_mml<size_t>({3, 3, 2}));
+  EXPECT_THROW(node.forward(iomap), std::runtime_error);
+}
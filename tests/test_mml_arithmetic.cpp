@@ -119,6 +119,31 @@ TEST(test_mml_arithmetic, test_elementwise_in_place_many_dimensions_4D) {
   ASSERT_EQ(*a, *b);
 }
 
+TEST(test_mml_arithmetic, test_map_strided_views) {
+  // Large enough for chunks to start in the middle of rows
+  auto base = TensorFactory::random_tensor<float>({6, 50, 70}, -2.0f, 2.0f);
+  auto expected_base = base->copy();
+  auto square_f = [](float x) { return x * x; };
+
+  const std::vector<std::shared_ptr<Tensor<float>>> views = {
+      base->transpose(std::vector<int>{2, 0, 1}),
+      base->slice({3})->broadcast_reshape(array_mml<size_t>({4, 50, 70}))};
+  for (const auto &view : views) {
+    ASSERT_FALSE(view->is_contiguous());
+    auto result = TensorFactory::create_tensor<float>(view->get_shape());
+    mml_map<float>(view, square_f, result);
+    for (size_t i = 0; i < view->get_size(); ++i) {
+      ASSERT_EQ((*result)[i], square((*view)[i])) << "at " << i;
+    }
+  }
+
+  // In place through a view writes the elements of the base tensor
+  mml_map_in_place<float>(views[0], square_f);
+  for (size_t i = 0; i < base->get_size(); ++i) {
+    ASSERT_EQ((*base)[i], square((*expected_base)[i])) << "at " << i;
+  }
+}
+
 TEST(test_mml_arithmetic, test_argmax_1) {
   const std::shared_ptr<Tensor<float>> a = TensorFactory::create_tensor<float>(
       {2, 3}, {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f});
@@ -227,3 +227,255 @@ TEST(test_mml_gemm, gemm_250x250_float) {
   ASSERT_TRUE(1);  // This test is here to be able to check the time it takes
                    // for different GEMM inplementations
 }
+
+TEST(test_mml_gemm, test_parallel_tiles_match_reference) {
+  // Fewer rows than threads, so the columns are split across tiles as well
+  ThreadPool::configure_global(4);
+  const int M = 2;
+  const int N = 300;
+  const int K = 17;
+
+  // Small integers keep every partial sum exact
+  array_mml<float> a_data(static_cast<size_t>(M * K));
+  for (size_t i = 0; i < a_data.size(); i++) {
+    a_data[i] = static_cast<float>(i % 7);
+  }
+  array_mml<float> b_data(static_cast<size_t>(K * N));
+  for (size_t i = 0; i < b_data.size(); i++) {
+    b_data[i] = static_cast<float>(i % 5) - 2;
+  }
+  auto a = TensorFactory::create_tensor<float>(
+      {static_cast<size_t>(M), static_cast<size_t>(K)}, a_data);
+  auto b = TensorFactory::create_tensor<float>(
+      {static_cast<size_t>(K), static_cast<size_t>(N)}, b_data);
+
+  auto expected = TensorFactory::create_tensor<float>(
+      {static_cast<size_t>(M), static_cast<size_t>(N)});
+  for (int i = 0; i < M; i++) {
+    for (int j = 0; j < N; j++) {
+      float sum = 0;
+      for (int k = 0; k < K; k++) {
+        sum += (*a)[i * K + k] * (*b)[k * N + j];
+      }
+      (*expected)[i * N + j] = sum;
+    }
+  }
+
+  const std::vector<toft::gemm_func<float>> variants = {
+      mml_gemm_inner_product<float>, mml_gemm_outer_product<float>,
+      mml_gemm_row_wise_product<float>, mml_gemm_col_wise_product<float>,
+      mml_gemm_blocked<float>};
+  for (const auto& variant : variants) {
+    auto c = TensorFactory::create_tensor<float>(
+        {static_cast<size_t>(M), static_cast<size_t>(N)});
+    variant(0, 0, M, N, K, 1, a, K, b, N, 0, c, N);
+    ASSERT_EQ(*c, *expected);
+  }
+
+  ThreadPool::configure_global(0);
+}
+
+TEST(test_mml_gemm, test_packed_matches_reference) {
+  // Sizes that leave partial register tiles and span several packed blocks
+  const int M = 37;
+  const int N = 131;
+  const int K = 300;
+  const float alpha = 0.5f;
+  const float beta = 2.0f;
+
+  for (int TA = 0; TA <= 1; TA++) {
+    for (int TB = 0; TB <= 1; TB++) {
+      auto a = TensorFactory::create_tensor<float>(
+          {static_cast<size_t>(M * K)},
+          generate_random_array_mml_real<float>(M * K, M * K, -1, 1));
+      auto b = TensorFactory::create_tensor<float>(
+          {static_cast<size_t>(K * N)},
+          generate_random_array_mml_real<float>(K * N, K * N, -1, 1));
+      auto c = TensorFactory::create_tensor<float>(
+          {static_cast<size_t>(M * N)},
+          generate_random_array_mml_real<float>(M * N, M * N, -1, 1));
+      const int lda = TA ? M : K;
+      const int ldb = TB ? K : N;
+
+      std::vector<double> expected(M * N);
+      for (int i = 0; i < M; i++) {
+        for (int j = 0; j < N; j++) {
+          double sum = 0;
+          for (int k = 0; k < K; k++) {
+            const float a_ik = TA ? (*a)[k * lda + i] : (*a)[i * lda + k];
+            const float b_kj = TB ? (*b)[j * ldb + k] : (*b)[k * ldb + j];
+            sum += static_cast<double>(a_ik) * b_kj;
+          }
+          expected[i * N + j] = alpha * sum + beta * (*c)[i * N + j];
+        }
+      }
+
+      mml_gemm_packed<float>(TA, TB, M, N, K, alpha, a, lda, b, ldb, beta, c,
+                             N);
+      for (int i = 0; i < M * N; i++) {
+        ASSERT_NEAR((*c)[i], expected[i], 1e-3)
+            << "TA " << TA << " TB " << TB << " index " << i;
+      }
+    }
+  }
+}
+
+TEST(test_mml_gemm, test_packed_integral_and_zero_beta) {
+  const std::shared_ptr<Tensor<int>> a =
+      TensorFactory::create_tensor<int>({2, 3}, {1, 2, 3, 4, 5, 6});
+  const std::shared_ptr<Tensor<int>> b =
+      TensorFactory::create_tensor<int>({3, 2}, {7, 8, 9, 10, 11, 12});
+  // With a zero beta, whatever C holds is ignored
+  const std::shared_ptr<Tensor<int>> c =
+      TensorFactory::create_tensor<int>({2, 2}, {-1, -1, -1, -1});
+  const std::shared_ptr<Tensor<int>> expected =
+      TensorFactory::create_tensor<int>({2, 2}, {58, 64, 139, 154});
+  mml_gemm_packed<int>(0, 0, 2, 2, 3, 1, a, 3, b, 2, 0, c, 2);
+  ASSERT_EQ(*c, *expected);
+}
+
+TEST(test_mml_gemm, test_packed_reads_views) {
+  const std::shared_ptr<Tensor<int>> a_t =
+      TensorFactory::create_tensor<int>({3, 2}, {1, 4, 2, 5, 3, 6});
+  const std::shared_ptr<Tensor<int>> b =
+      TensorFactory::create_tensor<int>({3, 2}, {7, 8, 9, 10, 11, 12});
+  const std::shared_ptr<Tensor<int>> expected =
+      TensorFactory::create_tensor<int>({2, 2}, {58, 64, 139, 154});
+
+  // A transposed view is read in place, with or without TA
+  auto c = TensorFactory::create_tensor<int>({2, 2});
+  mml_gemm_packed<int>(0, 0, 2, 2, 3, 1, a_t->transpose(), 3, b, 2, 0, c, 2);
+  ASSERT_EQ(*c, *expected);
+
+  c = TensorFactory::create_tensor<int>({2, 2});
+  auto b_t = b->transpose();
+  mml_gemm_packed<int>(1, 1, 2, 2, 3, 1, a_t, 2, b_t, 3, 0, c, 2);
+  ASSERT_EQ(*c, *expected);
+
+  // Broadcast views are gathered
+  c = TensorFactory::create_tensor<int>({2, 2});
+  auto ones = TensorFactory::create_tensor<int>({1}, {1})->broadcast_reshape(
+      array_mml<size_t>{3, 2});
+  auto sums = TensorFactory::create_tensor<int>({2, 2}, {6, 6, 15, 15});
+  mml_gemm_packed<int>(1, 0, 2, 2, 3, 1, a_t, 2, ones, 2, 0, c, 2);
+  ASSERT_EQ(*c, *sums);
+}
+
+TEST(test_mml_gemm, test_prepacked_operands) {
+  // More columns than a column block and a deeper K than a depth block
+  const int M = 37;
+  const int N = 4100;
+  const int K = 300;
+  const float alpha = 0.5f;
+  const float beta = 2.0f;
+
+  for (int trans = 0; trans <= 1; trans++) {
+    auto a = TensorFactory::random_tensor<float>(
+        {static_cast<size_t>(M * K)}, -1, 1);
+    auto b = TensorFactory::random_tensor<float>(
+        {static_cast<size_t>(K * N)}, -1, 1);
+    auto c = TensorFactory::random_tensor<float>(
+        {static_cast<size_t>(M * N)}, -1, 1);
+    const int lda = trans ? M : K;
+    const int ldb = trans ? K : N;
+
+    auto expected = c->copy();
+    mml_gemm_packed<float>(trans, trans, M, N, K, alpha, a, lda, b, ldb, beta,
+                           expected, N);
+
+    auto packed_a = mml_gemm_prepack_a<float>(trans, M, K, a, lda);
+    auto c_a = c->copy();
+    mml_gemm_prepacked_a<float>(*packed_a, trans, N, alpha, b, ldb, beta, c_a,
+                                N);
+
+    auto packed_b = mml_gemm_prepack_b<float>(trans, K, N, b, ldb);
+    auto c_b = c->copy();
+    mml_gemm_prepacked_b<float>(trans, M, alpha, a, lda, *packed_b, beta, c_b,
+                                N);
+
+    for (int i = 0; i < M * N; i++) {
+      ASSERT_NEAR((*c_a)[i], (*expected)[i], 1e-4)
+          << "trans " << trans << " index " << i;
+      ASSERT_NEAR((*c_b)[i], (*expected)[i], 1e-4)
+          << "trans " << trans << " index " << i;
+    }
+  }
+}
+
+TEST(test_mml_gemm, test_set_gemm_ptr_disables_prepacking) {
+  TensorOperations::set_gemm_ptr<float>(mml_gemm_inner_product<float>);
+  EXPECT_FALSE(TensorOperations::has_packed_gemm<float>());
+  TensorOperations::reset_gemm_ptr<float>();
+  EXPECT_TRUE(TensorOperations::has_packed_gemm<float>());
+}
+
+TEST(test_mml_gemm, test_strided_batched_matches_reference) {
+  // Batches [2, 3] with A broadcast over the second dimension and B over the
+  // first, then with B shared by the whole batch, which runs as one GEMM when
+  // A is not transposed
+  const int M = 19;
+  const int N = 23;
+  const int K = 29;
+  const float alpha = 0.5f;
+  const float beta = 2.0f;
+  const std::vector<size_t> batch_shape = {2, 3};
+  const size_t a_size = static_cast<size_t>(M) * K;
+  const size_t b_size = static_cast<size_t>(K) * N;
+  const size_t c_size = static_cast<size_t>(M) * N;
+  const std::vector<std::pair<std::vector<size_t>, std::vector<size_t>>>
+      operand_strides = {{{a_size, 0}, {0, b_size}},
+                         {{3 * a_size, a_size}, {0, 0}}};
+  const std::vector<size_t> c_strides = {3 * c_size, c_size};
+
+  for (const auto& [a_strides, b_strides] : operand_strides) {
+    for (int TA = 0; TA <= 1; TA++) {
+      for (int TB = 0; TB <= 1; TB++) {
+        auto a = TensorFactory::create_tensor<float>(
+            {6 * a_size},
+            generate_random_array_mml_real<float>(6 * a_size, 6 * a_size, -1,
+                                                  1));
+        auto b = TensorFactory::create_tensor<float>(
+            {6 * b_size},
+            generate_random_array_mml_real<float>(6 * b_size, 6 * b_size, -1,
+                                                  1));
+        auto c = TensorFactory::create_tensor<float>(
+            {6 * c_size},
+            generate_random_array_mml_real<float>(6 * c_size, 6 * c_size, -1,
+                                                  1));
+        const int lda = TA ? M : K;
+        const int ldb = TB ? K : N;
+
+        std::vector<double> expected(6 * c_size);
+        for (size_t p = 0; p < 2; p++) {
+          for (size_t q = 0; q < 3; q++) {
+            const size_t a_offset = p * a_strides[0] + q * a_strides[1];
+            const size_t b_offset = p * b_strides[0] + q * b_strides[1];
+            const size_t c_offset = p * c_strides[0] + q * c_strides[1];
+            for (int i = 0; i < M; i++) {
+              for (int j = 0; j < N; j++) {
+                double sum = 0;
+                for (int k = 0; k < K; k++) {
+                  const float a_ik = TA ? (*a)[a_offset + k * lda + i]
+                                        : (*a)[a_offset + i * lda + k];
+                  const float b_kj = TB ? (*b)[b_offset + j * ldb + k]
+                                        : (*b)[b_offset + k * ldb + j];
+                  sum += static_cast<double>(a_ik) * b_kj;
+                }
+                const size_t index = c_offset + i * N + j;
+                expected[index] = alpha * sum + beta * (*c)[index];
+              }
+            }
+          }
+        }
+
+        TensorOperations::gemm_strided_batched<float>(
+            TA, TB, M, N, K, alpha, a, lda, a_strides, b, ldb, b_strides, beta,
+            c, N, c_strides, batch_shape);
+        for (size_t i = 0; i < expected.size(); i++) {
+          ASSERT_NEAR((*c)[i], expected[i], 1e-3)
+              << "TA " << TA << " TB " << TB << " index " << i;
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,481 @@
+#include <gtest/gtest.h>
+
+#include <modularml>
+#include <thread>
+
+namespace {
+
+std::unique_ptr<Model_mml> make_conv_relu_model(
+    std::shared_ptr<Tensor<float>> W) {
+  std::vector<std::shared_ptr<Node>> nodes;
+  nodes.push_back(std::make_shared<ConvNode>(
+      "X", "W", "C", array_mml<size_t>({1, 1}),
+      array_mml<size_t>({0, 0, 0, 0}), array_mml<size_t>({2, 2}),
+      array_mml<size_t>({1, 1}), std::nullopt, 1));
+  nodes.push_back(std::make_shared<ReLUNode>("C", "Y"));
+
+  std::unordered_map<std::string, GeneralDataTypes> weights;
+  weights["W"] = W;
+
+  return std::make_unique<Model_mml>(nodes, weights,
+                                     std::vector<std::string>{"X"},
+                                     std::vector<std::string>{"Y"});
+}
+
+// Conv, Relu and a MaxPool and AvgPool with their default strides, pads and
+// dilations
+std::unique_ptr<Model_mml> make_conv_pool_model(
+    std::shared_ptr<Tensor<float>> W) {
+  std::vector<std::shared_ptr<Node>> nodes;
+  nodes.push_back(std::make_shared<ConvNode>(
+      "X", "W", "C", array_mml<size_t>({1, 1}),
+      array_mml<size_t>({0, 0, 0, 0}), array_mml<size_t>({2, 2}),
+      array_mml<size_t>({1, 1}), std::nullopt, 1));
+  nodes.push_back(std::make_shared<ReLUNode>("C", "R"));
+  nodes.push_back(std::make_shared<MaxPoolNode>("R", "M",
+                                                std::vector<int>{2, 2}));
+  nodes.push_back(std::make_shared<AvgPoolNode>("M", "Y",
+                                                std::vector<int>{2, 2}));
+
+  std::unordered_map<std::string, GeneralDataTypes> weights;
+  weights["W"] = W;
+
+  return std::make_unique<Model_mml>(nodes, weights,
+                                     std::vector<std::string>{"X"},
+                                     std::vector<std::string>{"Y"});
+}
+
+}  // namespace
+
+TEST(test_mml_model, test_infer_does_not_mutate_weights) {
+  auto W = TensorFactory::create_tensor<float>(
+      array_mml<size_t>({1, 1, 2, 2}),
+      array_mml<float>({1.0f, -1.0f, 1.0f, 1.0f}));
+  auto model = make_conv_relu_model(W);
+
+  auto X = TensorFactory::create_tensor<float>(
+      array_mml<size_t>({1, 1, 3, 3}),
+      array_mml<float>({1, 2, 3, 4, 5, 6, 7, 8, 9}));
+  std::unordered_map<std::string, GeneralDataTypes> inputs;
+  inputs["X"] = X;
+
+  auto first = model->infer(inputs);
+  auto second = model->infer(inputs);
+
+  auto expected = TensorFactory::create_tensor<float>(
+      array_mml<size_t>({1, 1, 2, 2}), array_mml<float>({8, 10, 14, 16}));
+
+  auto first_y = std::get<std::shared_ptr<Tensor<float>>>(first["Y"]);
+  auto second_y = std::get<std::shared_ptr<Tensor<float>>>(second["Y"]);
+  EXPECT_EQ(*first_y, *expected);
+  EXPECT_EQ(*second_y, *expected);
+
+  // Every call must produce its own output tensor
+  EXPECT_NE(first_y, second_y);
+
+  // The weight and input tensors are shared and must be left untouched
+  EXPECT_EQ(W->get_shape(), array_mml<size_t>({1, 1, 2, 2}));
+  EXPECT_EQ(*W, *TensorFactory::create_tensor<float>(
+                    array_mml<size_t>({1, 1, 2, 2}),
+                    array_mml<float>({1.0f, -1.0f, 1.0f, 1.0f})));
+  EXPECT_EQ(X->get_shape(), array_mml<size_t>({1, 1, 3, 3}));
+}
+
+TEST(test_mml_model, test_concurrent_first_calls) {
+  // Threads start on an uncompiled model at once, with inputs of two sizes so
+  // the Conv and pooling parameters inferred from them differ between calls
+  auto W = TensorFactory::random_tensor<float>(array_mml<size_t>({4, 3, 2, 2}),
+                                               -1.0f, 1.0f);
+  auto model = make_conv_pool_model(W);
+  auto reference = make_conv_pool_model(W);
+
+  const std::vector<std::vector<size_t>> shapes = {{1, 3, 6, 6},
+                                                   {2, 3, 9, 7}};
+  std::vector<std::unordered_map<std::string, GeneralDataTypes>> inputs(
+      shapes.size());
+  std::vector<std::shared_ptr<Tensor<float>>> expected;
+  for (size_t i = 0; i < shapes.size(); ++i) {
+    inputs[i]["X"] = TensorFactory::random_tensor<float>(
+        array_mml<size_t>(shapes[i]), -1.0f, 1.0f);
+    expected.push_back(std::get<std::shared_ptr<Tensor<float>>>(
+        reference->infer(inputs[i])["Y"]));
+  }
+
+  const size_t thread_count = 8;
+  const int calls = 5;
+  std::vector<int> mismatches(thread_count, 0);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < thread_count; ++t) {
+    threads.emplace_back([&, t] {
+      for (int call = 0; call < calls; ++call) {
+        const size_t i = (t + call) % shapes.size();
+        auto y = std::get<std::shared_ptr<Tensor<float>>>(
+            model->infer(inputs[i])["Y"]);
+        if (!(*y == *expected[i])) {
+          ++mismatches[t];
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (size_t t = 0; t < thread_count; ++t) {
+    EXPECT_EQ(mismatches[t], 0) << "thread " << t;
+  }
+}
+
+TEST(test_mml_model, test_infer_only_returns_outputs) {
+  auto W = TensorFactory::create_tensor<float>(
+      array_mml<size_t>({1, 1, 2, 2}), array_mml<float>({1, 1, 1, 1}));
+  auto model = make_conv_relu_model(W);
+
+  std::unordered_map<std::string, GeneralDataTypes> inputs;
+  inputs["X"] = TensorFactory::create_tensor<float>(
+      array_mml<size_t>({1, 1, 3, 3}),
+      array_mml<float>({1, 2, 3, 4, 5, 6, 7, 8, 9}));
+
+  auto outputs = model->infer(inputs);
+
+  ASSERT_EQ(outputs.size(), 1);
+  EXPECT_NE(outputs.find("Y"), outputs.end());
+}
+
+TEST(test_mml_model, test_compile_builds_execution_plan) {
+  auto W = TensorFactory::create_tensor<float>(
+      array_mml<size_t>({1, 1, 2, 2}), array_mml<float>({1, 1, 1, 1}));
+  auto model = make_conv_relu_model(W);
+  model->setActivationFusion(false);
+
+  model->compile();
+  const auto &plan = model->getPlan();
+
+  // Conv must run before the ReLU consuming its output
+  ASSERT_EQ(plan.steps.size(), 2);
+  ASSERT_EQ(plan.layers.size(), 2);
+  EXPECT_NE(dynamic_cast<ConvNode *>(plan.steps[plan.layers[0][0]].node.get()),
+            nullptr);
+  EXPECT_NE(dynamic_cast<ReLUNode *>(plan.steps[plan.layers[1][0]].node.get()),
+            nullptr);
+
+  // The intermediate tensor shares a slot between producer and consumer
+  const auto &conv = plan.steps[plan.layers[0][0]];
+  const auto &relu = plan.steps[plan.layers[1][0]];
+  EXPECT_EQ(conv.output_slots[0], relu.input_slots[0]);
+  EXPECT_EQ(plan.slot_names[conv.output_slots[0]], "C");
+
+  // The weight is bound to its slot once, at compile time
+  size_t w_slot = plan.slot_ids.at("W");
+  ASSERT_TRUE(plan.constants[w_slot].has_value());
+  EXPECT_EQ(std::get<std::shared_ptr<Tensor<float>>>(*plan.constants[w_slot]),
+            W);
+  EXPECT_FALSE(plan.constants[plan.slot_ids.at("X")].has_value());
+
+  ASSERT_EQ(plan.output_slots.size(), 1);
+  EXPECT_EQ(plan.slot_names[plan.output_slots[0]], "Y");
+}
+
+TEST(test_mml_model, test_memory_plan_reuses_arena) {
+  std::vector<std::shared_ptr<Node>> nodes;
+  nodes.push_back(std::make_shared<ReLUNode>("X", "A"));
+  nodes.push_back(std::make_shared<ReLUNode>("A", "B"));
+  nodes.push_back(std::make_shared<ReLUNode>("B", "C"));
+  nodes.push_back(std::make_shared<ReLUNode>("C", "Y"));
+  Model_mml model(nodes, std::unordered_map<std::string, GeneralDataTypes>{},
+                  {"X"}, {"Y"});
+
+  std::unordered_map<std::string, GeneralDataTypes> inputs;
+  inputs["X"] = TensorFactory::create_tensor<float>(
+      array_mml<size_t>({2, 2}), array_mml<float>({-1, 2, -3, 4}));
+  auto expected = TensorFactory::create_tensor<float>(
+      array_mml<size_t>({2, 2}), array_mml<float>({0, 2, 0, 4}));
+
+  // The first call records the intermediate tensors
+  EXPECT_EQ(model.getMemoryPlan(inputs), nullptr);
+  auto first = model.infer(inputs);
+  auto memory = model.getMemoryPlan(inputs);
+  ASSERT_NE(memory, nullptr);
+
+  // A and C are never alive at the same time and share their bytes
+  const auto &plan = model.getPlan();
+  ASSERT_TRUE(memory->is_planned(plan.slot_ids.at("A")));
+  ASSERT_TRUE(memory->is_planned(plan.slot_ids.at("B")));
+  ASSERT_TRUE(memory->is_planned(plan.slot_ids.at("C")));
+  EXPECT_FALSE(memory->is_planned(plan.slot_ids.at("Y")));
+  EXPECT_EQ(memory->get_offset(plan.slot_ids.at("A")),
+            memory->get_offset(plan.slot_ids.at("C")));
+  EXPECT_NE(memory->get_offset(plan.slot_ids.at("A")),
+            memory->get_offset(plan.slot_ids.at("B")));
+  EXPECT_EQ(memory->get_arena_size(), 2 * MemoryPlan::alignment);
+
+  // Later calls run in the arena and give the same results
+  auto second = model.infer(inputs);
+  auto third = model.infer(inputs);
+  EXPECT_EQ(*std::get<std::shared_ptr<Tensor<float>>>(first["Y"]), *expected);
+  EXPECT_EQ(*std::get<std::shared_ptr<Tensor<float>>>(second["Y"]), *expected);
+  EXPECT_EQ(*std::get<std::shared_ptr<Tensor<float>>>(third["Y"]), *expected);
+
+  // Other input shapes get their own plan
+  std::unordered_map<std::string, GeneralDataTypes> other_inputs;
+  other_inputs["X"] = TensorFactory::create_tensor<float>(
+      array_mml<size_t>({4}), array_mml<float>({-1, 2, -3, 4}));
+  EXPECT_EQ(model.getMemoryPlan(other_inputs), nullptr);
+}
+
+TEST(test_mml_model, test_memory_plan_skips_replaced_outputs) {
+  std::vector<std::shared_ptr<Node>> nodes;
+  nodes.push_back(std::make_shared<ConstantNode>(
+      "K", TensorFactory::create_tensor<float>({2, 3}, {1, 2, 3, 4, 5, 6})));
+  nodes.push_back(std::make_shared<AddNode>("X", "K", "S"));
+  nodes.push_back(std::make_shared<SoftMaxNode>("S", "P"));
+  nodes.push_back(std::make_shared<FlattenNode>("P", "F", 0));
+  nodes.push_back(std::make_shared<ReLUNode>("F", "Y"));
+  Model_mml model(nodes, std::unordered_map<std::string, GeneralDataTypes>{},
+                  {"X"}, {"Y"});
+
+  std::unordered_map<std::string, GeneralDataTypes> inputs;
+  inputs["X"] = TensorFactory::random_tensor<float>(array_mml<size_t>({2, 3}),
+                                                    -1.0f, 1.0f);
+  auto first = model.infer(inputs);
+  auto memory = model.getMemoryPlan(inputs);
+  ASSERT_NE(memory, nullptr);
+
+  // The constant and the view hand out tensors of their own, only the
+  // outputs written in place take arena space
+  const auto &plan = model.getPlan();
+  EXPECT_FALSE(memory->is_planned(plan.slot_ids.at("K")));
+  EXPECT_TRUE(memory->is_planned(plan.slot_ids.at("S")));
+  EXPECT_FALSE(memory->is_planned(plan.slot_ids.at("P")));
+  EXPECT_FALSE(memory->is_planned(plan.slot_ids.at("F")));
+
+  auto second = model.infer(inputs);
+  EXPECT_EQ(*std::get<std::shared_ptr<Tensor<float>>>(second["Y"]),
+            *std::get<std::shared_ptr<Tensor<float>>>(first["Y"]));
+}
+
+TEST(test_mml_model, test_parallel_branches_match_sequential) {
+  std::vector<std::shared_ptr<Node>> nodes;
+  nodes.push_back(std::make_shared<ReLUNode>("X", "A"));
+  nodes.push_back(std::make_shared<TanHNode>("X", "B"));
+  nodes.push_back(std::make_shared<SigmoidNode>("X", "C"));
+  nodes.push_back(std::make_shared<AddNode>("A", "B", "AB"));
+  nodes.push_back(std::make_shared<AddNode>("AB", "C", "Y"));
+  Model_mml model(nodes, std::unordered_map<std::string, GeneralDataTypes>{},
+                  {"X"}, {"Y"});
+
+  std::unordered_map<std::string, GeneralDataTypes> inputs;
+  inputs["X"] = TensorFactory::random_tensor<float>(
+      array_mml<size_t>({16, 16}), -1.0f, 1.0f);
+
+  model.setMaxConcurrency(1);
+  auto sequential = model.infer(inputs);
+
+  model.setMaxConcurrency(4);
+  EXPECT_EQ(model.getMaxConcurrency(), 4);
+  auto expected = std::get<std::shared_ptr<Tensor<float>>>(sequential["Y"]);
+  for (int i = 0; i < 5; i++) {
+    auto parallel = model.infer(inputs);
+    EXPECT_EQ(*std::get<std::shared_ptr<Tensor<float>>>(parallel["Y"]),
+              *expected);
+  }
+
+  // The branches may run at the same time and must not share bytes
+  const auto &plan = model.getPlan();
+  auto memory = model.getMemoryPlan(inputs);
+  ASSERT_NE(memory, nullptr);
+  std::vector<size_t> offsets;
+  for (const auto *name : {"A", "B", "C"}) {
+    offsets.push_back(memory->get_offset(plan.slot_ids.at(name)));
+  }
+  std::ranges::sort(offsets);
+  EXPECT_EQ(std::ranges::adjacent_find(offsets), offsets.end());
+}
+
+TEST(test_mml_model, test_channel_blocking_matches_plain) {
+  const size_t block = mml_nchwc_block<float>();
+  const size_t channels = 2 * block;
+  std::unordered_map<std::string, GeneralDataTypes> weights;
+  weights["W1"] = TensorFactory::random_tensor<float>(
+      array_mml<size_t>({channels, block, 3, 3}), -1.0f, 1.0f);
+  weights["B1"] = TensorFactory::random_tensor<float>(
+      array_mml<size_t>({channels}), -1.0f, 1.0f);
+  weights["W2"] = TensorFactory::random_tensor<float>(
+      array_mml<size_t>({channels, channels, 1, 1}), -1.0f, 1.0f);
+
+  // Conv, ReLU, MaxPool, Conv and Add run blocked, Flatten does not
+  std::vector<std::shared_ptr<Node>> nodes;
+  nodes.push_back(std::make_shared<ConvNode>(
+      "X", "W1", "C1", array_mml<size_t>({1, 1}),
+      array_mml<size_t>({1, 1, 1, 1}), array_mml<size_t>({3, 3}),
+      array_mml<size_t>({1, 1}), "B1", 1));
+  nodes.push_back(std::make_shared<ReLUNode>("C1", "R"));
+  nodes.push_back(std::make_shared<MaxPoolNode>(
+      "R", "P", std::vector<int>{2, 2}, std::nullopt, "NOTSET", 0,
+      std::vector<int>{1, 1}, std::vector<int>{0, 0, 0, 0}, 0,
+      std::vector<int>{2, 2}));
+  nodes.push_back(std::make_shared<ConvNode>(
+      "P", "W2", "C2", array_mml<size_t>({1, 1}),
+      array_mml<size_t>({0, 0, 0, 0}), array_mml<size_t>({1, 1}),
+      array_mml<size_t>({1, 1}), std::nullopt, 1));
+  nodes.push_back(std::make_shared<AddNode>("C2", "P", "Y"));
+  nodes.push_back(std::make_shared<FlattenNode>("R", "F"));
+  Model_mml model(nodes, weights, {"X"}, {"Y", "F"});
+
+  std::unordered_map<std::string, GeneralDataTypes> inputs;
+  inputs["X"] = TensorFactory::random_tensor<float>(
+      array_mml<size_t>({2, block, 6, 10}), -1.0f, 1.0f);
+  auto plain = model.infer(inputs);
+
+  EXPECT_FALSE(model.getChannelBlocking());
+  model.setChannelBlocking(true);
+  EXPECT_TRUE(model.getChannelBlocking());
+  // The second call runs with the memory plan
+  for (int call = 0; call < 2; ++call) {
+    auto blocked = model.infer(inputs);
+    for (const auto *name : {"Y", "F"}) {
+      auto expected = std::get<std::shared_ptr<Tensor<float>>>(plain[name]);
+      auto output = std::get<std::shared_ptr<Tensor<float>>>(blocked[name]);
+      ASSERT_EQ(output->get_shape(), expected->get_shape()) << name;
+      for (size_t i = 0; i < expected->get_size(); ++i) {
+        EXPECT_NEAR((*output)[i], (*expected)[i], 1e-4)
+            << name << " at " << i;
+      }
+    }
+  }
+
+  // Reorders block X and unblock R for Flatten and Y for the caller, the ReLU
+  // is fused into the first Conv
+  const auto &plan = model.getPlan();
+  size_t reorders = 0;
+  for (const auto &step : plan.steps) {
+    if (dynamic_cast<ReorderNode *>(step.node.get())) {
+      ++reorders;
+    }
+  }
+  EXPECT_EQ(reorders, 3);
+  EXPECT_EQ(plan.steps.size(), nodes.size() + 3 - 1);
+}
+
+TEST(test_mml_model, test_activation_fusion_matches_unfused) {
+  std::unordered_map<std::string, GeneralDataTypes> weights;
+  for (const auto *name : {"W1", "W2", "W3"}) {
+    weights[name] = TensorFactory::random_tensor<float>(
+        array_mml<size_t>({4, 4, 3, 3}), -1.0f, 1.0f);
+  }
+  weights["B1"] = TensorFactory::random_tensor<float>(array_mml<size_t>({4}),
+                                                      -1.0f, 1.0f);
+
+  auto conv = [](const std::string &x, const std::string &w,
+                 const std::string &y, std::optional<std::string> b) {
+    return std::make_shared<ConvNode>(
+        x, w, y, array_mml<size_t>({1, 1}), array_mml<size_t>({1, 1, 1, 1}),
+        array_mml<size_t>({3, 3}), array_mml<size_t>({1, 1}), b, 1);
+  };
+  // The ReLU and the Gelu are fused. C2 is also read by the Add and C3 is a
+  // model output, so their activations run as nodes
+  std::vector<std::shared_ptr<Node>> nodes;
+  nodes.push_back(conv("X", "W1", "C1", "B1"));
+  nodes.push_back(std::make_shared<ReLUNode>("C1", "R1"));
+  nodes.push_back(conv("R1", "W2", "C2", std::nullopt));
+  nodes.push_back(std::make_shared<SigmoidNode>("C2", "S"));
+  nodes.push_back(std::make_shared<AddNode>("C2", "S", "A"));
+  nodes.push_back(conv("A", "W3", "C3", std::nullopt));
+  nodes.push_back(std::make_shared<TanHNode>("C3", "T"));
+  nodes.push_back(conv("T", "W1", "C4", "B1"));
+  nodes.push_back(std::make_shared<GeluNode>("C4", "Y"));
+  Model_mml model(nodes, weights, {"X"}, {"Y", "C3"});
+
+  std::unordered_map<std::string, GeneralDataTypes> inputs;
+  inputs["X"] = TensorFactory::random_tensor<float>(
+      array_mml<size_t>({2, 4, 7, 9}), -1.0f, 1.0f);
+
+  EXPECT_TRUE(model.getActivationFusion());
+  auto fused = model.infer(inputs);
+  EXPECT_EQ(model.getPlan().steps.size(), nodes.size() - 2);
+  for (const auto &step : model.getPlan().steps) {
+    EXPECT_EQ(dynamic_cast<ReLUNode *>(step.node.get()), nullptr);
+    EXPECT_EQ(dynamic_cast<GeluNode *>(step.node.get()), nullptr);
+  }
+
+  model.setActivationFusion(false);
+  EXPECT_FALSE(model.getActivationFusion());
+  auto unfused = model.infer(inputs);
+  EXPECT_EQ(model.getPlan().steps.size(), nodes.size());
+  for (const auto *name : {"Y", "C3"}) {
+    auto expected = std::get<std::shared_ptr<Tensor<float>>>(unfused[name]);
+    auto output = std::get<std::shared_ptr<Tensor<float>>>(fused[name]);
+    ASSERT_EQ(output->get_shape(), expected->get_shape()) << name;
+    for (size_t i = 0; i < expected->get_size(); ++i) {
+      EXPECT_NEAR((*output)[i], (*expected)[i], 1e-4) << name << " at " << i;
+    }
+  }
+}
+
+TEST(test_mml_model, test_batch_norm_folding_matches_unfolded) {
+  std::unordered_map<std::string, GeneralDataTypes> weights;
+  weights["W1"] = TensorFactory::random_tensor<float>(
+      array_mml<size_t>({8, 4, 3, 3}), -1.0f, 1.0f);
+  weights["B1"] = TensorFactory::random_tensor<float>(array_mml<size_t>({8}),
+                                                      -1.0f, 1.0f);
+  weights["W2"] = TensorFactory::random_tensor<float>(
+      array_mml<size_t>({8, 8, 1, 1}), -1.0f, 1.0f);
+  weights["WG"] = TensorFactory::random_tensor<float>(
+      array_mml<size_t>({5, 8 * 6 * 6}), -0.1f, 0.1f);
+  weights["CG"] = TensorFactory::random_tensor<float>(
+      array_mml<size_t>({1, 5}), -1.0f, 1.0f);
+  auto batch_norm = [&](const std::string &x, const std::string &y,
+                        size_t channels) {
+    for (const auto *parameter : {"scale", "B", "mean"}) {
+      weights[y + parameter] = TensorFactory::random_tensor<float>(
+          array_mml<size_t>({channels}), -1.0f, 1.0f);
+    }
+    weights[y + "var"] = TensorFactory::random_tensor<float>(
+        array_mml<size_t>({channels}), 0.5f, 2.0f);
+    return std::make_shared<BatchNormalizationNode>(
+        x, y + "scale", y + "B", y + "mean", y + "var", y);
+  };
+
+  // N1 and G are folded into the Conv and the Gemm. C2 is also read by a
+  // second BatchNormalization, so neither is folded
+  std::vector<std::shared_ptr<Node>> nodes;
+  nodes.push_back(std::make_shared<ConvNode>(
+      "X", "W1", "C1", array_mml<size_t>({1, 1}),
+      array_mml<size_t>({1, 1, 1, 1}), array_mml<size_t>({3, 3}),
+      array_mml<size_t>({1, 1}), "B1", 1));
+  nodes.push_back(batch_norm("C1", "N1", 8));
+  nodes.push_back(std::make_shared<ReLUNode>("N1", "R"));
+  nodes.push_back(std::make_shared<ConvNode>(
+      "R", "W2", "C2", array_mml<size_t>({1, 1}),
+      array_mml<size_t>({0, 0, 0, 0}), array_mml<size_t>({1, 1}),
+      array_mml<size_t>({1, 1}), std::nullopt, 1));
+  nodes.push_back(batch_norm("C2", "N2", 8));
+  nodes.push_back(batch_norm("C2", "Z", 8));
+  nodes.push_back(std::make_shared<FlattenNode>("N2", "F"));
+  nodes.push_back(
+      std::make_shared<GemmNode>("F", "WG", "G", "CG", 1.0f, 0.5f, 0, 1));
+  nodes.push_back(batch_norm("G", "Y", 5));
+  Model_mml model(nodes, weights, {"X"}, {"Y", "Z"});
+
+  std::unordered_map<std::string, GeneralDataTypes> inputs;
+  inputs["X"] = TensorFactory::random_tensor<float>(
+      array_mml<size_t>({2, 4, 6, 6}), -1.0f, 1.0f);
+
+  EXPECT_TRUE(model.getBatchNormFolding());
+  auto folded = model.infer(inputs);
+  // The ReLU is fused into the folded Conv as well
+  EXPECT_EQ(model.getPlan().steps.size(), nodes.size() - 3);
+
+  model.setBatchNormFolding(false);
+  EXPECT_FALSE(model.getBatchNormFolding());
+  auto unfolded = model.infer(inputs);
+  // The ReLU reads the output of a BatchNormalization, which fuses nothing
+  EXPECT_EQ(model.getPlan().steps.size(), nodes.size());
+  for (const auto *name : {"Y", "Z"}) {
+    auto expected = std::get<std::shared_ptr<Tensor<float>>>(unfolded[name]);
+    auto output = std::get<std::shared_ptr<Tensor<float>>>(folded[name]);
+    ASSERT_EQ(output->get_shape(), expected->get_shape()) << name;
+    for (size_t i = 0; i < expected->get_size(); ++i) {
+      EXPECT_NEAR((*output)[i], (*expected)[i], 1e-4) << name << " at " << i;
+    }
+  }
+}
@@ -554,3 +554,206 @@ TEST(test_mml_pooling, test_avg_pool_custom_pad) {
 
   ASSERT_EQ(*output_ptr, *exp_output);
 }
+
+TEST(test_mml_pooling, test_blocked_copies_match_plain) {
+  auto blocked_name = [](const std::string &name) { return name + "#b"; };
+  const size_t block = 4;
+  const size_t batch = 2;
+  const size_t channels = 8;
+  const size_t height = 7;
+  const size_t width = 6;
+  auto x = generate_random_array_mml_real<float>(
+      batch * channels * height * width, batch * channels * height * width,
+      -1, 1);
+
+  std::vector<std::shared_ptr<Node>> pools = {
+      std::make_shared<MaxPoolNode>("X", "Y", std::vector<int>{3, 3},
+                                    std::nullopt, "SAME_UPPER", 0,
+                                    std::vector<int>{1, 1},
+                                    std::vector<int>{},
+                                    0, std::vector<int>{2, 2}),
+      std::make_shared<MaxPoolNode>("X", "Y", std::vector<int>{2, 3},
+                                    std::nullopt, "NOTSET", 1,
+                                    std::vector<int>{2, 1},
+                                    std::vector<int>{1, 0, 1, 1},
+                                    0, std::vector<int>{2, 2}),
+      std::make_shared<AvgPoolNode>("X", "Y", std::vector<int>{3, 3},
+                                    "NOTSET", 0, 0, std::vector<int>{1, 1},
+                                    std::vector<int>{1, 1, 1, 1},
+                                    std::vector<int>{1, 1}),
+      std::make_shared<AvgPoolNode>("X", "Y", std::vector<int>{3, 2},
+                                    "SAME_LOWER", 0, 1,
+                                    std::vector<int>{1, 1},
+                                    std::vector<int>{},
+                                    std::vector<int>{2, 1})};
+
+  for (size_t p = 0; p < pools.size(); ++p) {
+    std::unordered_map<std::string, GeneralDataTypes> plain;
+    plain["X"] = TensorFactory::create_tensor<float>(
+        {batch, channels, height, width}, x);
+    pools[p]->forward(plain);
+    auto expected = std::get<std::shared_ptr<Tensor<float>>>(plain["Y"]);
+
+    auto blocked = pools[p]->blocked_copy(block, {}, blocked_name);
+    ASSERT_NE(blocked, nullptr);
+    std::unordered_map<std::string, GeneralDataTypes> iomap;
+    iomap["X"] = plain["X"];
+    ReorderNode("X", "X#b", block, true).forward(iomap);
+    blocked->forward(iomap);
+    ReorderNode("Y#b", "Y", block, false).forward(iomap);
+
+    auto output = std::get<std::shared_ptr<Tensor<float>>>(iomap["Y"]);
+    ASSERT_EQ(output->get_shape(), expected->get_shape()) << "pool " << p;
+    for (size_t i = 0; i < expected->get_size(); ++i) {
+      EXPECT_NEAR((*output)[i], (*expected)[i], 1e-5)
+          << "pool " << p << " at " << i;
+    }
+  }
+
+  // Indices are only computed by the plain kernel
+  MaxPoolNode with_indices("X", "Y", {2, 2}, "I");
+  EXPECT_EQ(with_indices.blocked_copy(block, {}, blocked_name), nullptr);
+}
+
+TEST(test_mml_pooling, test_blocked_copies_reject_empty_windows) {
+  // Padding of two rows and columns around a 2x2 window leaves the corner
+  // windows without a value, in the plain and in the blocked layout alike
+  auto blocked_name = [](const std::string &name) { return name + "#b"; };
+  const size_t block = 4;
+  std::vector<std::shared_ptr<Node>> pools = {
+      std::make_shared<MaxPoolNode>("X", "Y", std::vector<int>{2, 2},
+                                    std::nullopt, "NOTSET", 0,
+                                    std::vector<int>{1, 1},
+                                    std::vector<int>{2, 2, 2, 2}, 0,
+                                    std::vector<int>{1, 1}),
+      std::make_shared<AvgPoolNode>("X", "Y", std::vector<int>{2, 2},
+                                    "NOTSET", 0, 0, std::vector<int>{1, 1},
+                                    std::vector<int>{2, 2, 2, 2},
+                                    std::vector<int>{1, 1})};
+
+  for (size_t p = 0; p < pools.size(); ++p) {
+    std::unordered_map<std::string, GeneralDataTypes> plain;
+    plain["X"] = TensorFactory::create_tensor<float>({1, block, 3, 3});
+    EXPECT_THROW(pools[p]->forward(plain), std::runtime_error) << "pool " << p;
+
+    auto blocked = pools[p]->blocked_copy(block, {}, blocked_name);
+    ASSERT_NE(blocked, nullptr);
+    std::unordered_map<std::string, GeneralDataTypes> iomap;
+    iomap["X"] = plain["X"];
+    ReorderNode("X", "X#b", block, true).forward(iomap);
+    EXPECT_THROW(blocked->forward(iomap), std::runtime_error) << "pool " << p;
+    EXPECT_EQ(iomap.count("Y#b"), 0u) << "pool " << p;
+  }
+}
+
+TEST(test_mml_pooling, test_1d_and_3d_pools_match_reference) {
+  // Spatial shapes of rank 1 and 3 are padded to depth, height and width
+  struct Case {
+    std::vector<size_t> spatial;
+    std::vector<int> kernel, strides, dilations, pads;
+  };
+  const std::vector<Case> cases = {
+      {{11}, {3}, {2}, {2}, {1, 2}},
+      {{5, 6, 7}, {2, 3, 2}, {1, 2, 2}, {2, 1, 1}, {1, 0, 1, 0, 1, 1}}};
+  const size_t batch = 2;
+  const size_t channels = 3;
+
+  for (const auto &c : cases) {
+    const size_t rank = c.spatial.size();
+    std::array<size_t, 3> in = {1, 1, 1}, out = {1, 1, 1};
+    std::array<int, 3> k = {1, 1, 1}, s = {1, 1, 1}, d = {1, 1, 1};
+    std::array<int, 3> begin = {0, 0, 0};
+    std::vector<size_t> x_shape = {batch, channels};
+    std::vector<size_t> y_shape = {batch, channels};
+    for (size_t i = 0; i < rank; ++i) {
+      const size_t j = 3 - rank + i;
+      in[j] = c.spatial[i];
+      k[j] = c.kernel[i];
+      s[j] = c.strides[i];
+      d[j] = c.dilations[i];
+      begin[j] = c.pads[i];
+      const int padded = static_cast<int>(in[j]) + c.pads[i] +
+                         c.pads[i + rank] - d[j] * (k[j] - 1) - 1;
+      out[j] = static_cast<size_t>(padded / s[j] + 1);
+      x_shape.push_back(in[j]);
+      y_shape.push_back(out[j]);
+    }
+    const size_t planes = batch * channels;
+    const size_t plane_size = in[0] * in[1] * in[2];
+    auto x = generate_random_array_mml_real<float>(
+        planes * plane_size, planes * plane_size, -1, 1);
+
+    // Naive reference over every window position
+    std::vector<float> max_ref, avg_ref, avg_pad_ref;
+    std::vector<int64_t> index_ref;
+    for (size_t p = 0; p < planes; ++p) {
+      for (size_t od = 0; od < out[0]; ++od) {
+        for (size_t oh = 0; oh < out[1]; ++oh) {
+          for (size_t ow = 0; ow < out[2]; ++ow) {
+            float best = std::numeric_limits<float>::lowest();
+            int64_t best_index = -1;
+            float sum = 0;
+            size_t count = 0;
+            for (int kd = 0; kd < k[0]; ++kd) {
+              for (int kh = 0; kh < k[1]; ++kh) {
+                for (int kw = 0; kw < k[2]; ++kw) {
+                  const int id = static_cast<int>(od) * s[0] + kd * d[0] -
+                                 begin[0];
+                  const int ih = static_cast<int>(oh) * s[1] + kh * d[1] -
+                                 begin[1];
+                  const int iw = static_cast<int>(ow) * s[2] + kw * d[2] -
+                                 begin[2];
+                  if (id < 0 || ih < 0 || iw < 0 ||
+                      id >= static_cast<int>(in[0]) ||
+                      ih >= static_cast<int>(in[1]) ||
+                      iw >= static_cast<int>(in[2])) {
+                    continue;
+                  }
+                  const size_t index =
+                      p * plane_size + (id * in[1] + ih) * in[2] + iw;
+                  if (x[index] > best) {
+                    best = x[index];
+                    best_index = static_cast<int64_t>(index);
+                  }
+                  sum += x[index];
+                  ++count;
+                }
+              }
+            }
+            max_ref.push_back(best);
+            index_ref.push_back(best_index);
+            avg_ref.push_back(sum / count);
+            avg_pad_ref.push_back(sum / (k[0] * k[1] * k[2]));
+          }
+        }
+      }
+    }
+
+    std::unordered_map<std::string, GeneralDataTypes> iomap;
+    iomap["X"] = TensorFactory::create_tensor<float>(array_mml<size_t>(x_shape),
+                                                     x);
+    MaxPoolNode("X", "Y", c.kernel, "I", "NOTSET", 0, c.dilations, c.pads, 0,
+                c.strides)
+        .forward(iomap);
+    auto y = std::get<std::shared_ptr<Tensor<float>>>(iomap["Y"]);
+    auto indices = std::get<std::shared_ptr<Tensor<int64_t>>>(iomap["I"]);
+    ASSERT_EQ(y->get_shape(), array_mml<size_t>(y_shape));
+    for (size_t i = 0; i < max_ref.size(); ++i) {
+      EXPECT_EQ((*y)[i], max_ref[i]) << "rank " << rank << " at " << i;
+      EXPECT_EQ((*indices)[i], index_ref[i]) << "rank " << rank << " at " << i;
+    }
+
+    for (int include_pad = 0; include_pad < 2; ++include_pad) {
+      AvgPoolNode("X", "Y", c.kernel, "NOTSET", 0, include_pad, c.dilations,
+                  c.pads, c.strides)
+          .forward(iomap);
+      y = std::get<std::shared_ptr<Tensor<float>>>(iomap["Y"]);
+      const auto &expected = include_pad ? avg_pad_ref : avg_ref;
+      ASSERT_EQ(y->get_shape(), array_mml<size_t>(y_shape));
+      for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_NEAR((*y)[i], expected[i], 1e-5)
+            << "rank " << rank << " at " << i;
+      }
+    }
+  }
+}
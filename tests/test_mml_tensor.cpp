@@ -590,4 +590,111 @@ TEST(test_mml_tensor, transpose_high_rank_dims) {
       TensorFactory::create_tensor<int>({3, 1, 2}, {1, 4, 2, 5, 3, 6});
 
   ASSERT_EQ(*transposed, *expected);
-}
\ No newline at end of file
+}
+
+TEST(test_mml_tensor, raw_data_access) {
+  auto tensor =
+      TensorFactory::create_tensor<int>({2, 1, 3}, {1, 2, 3, 4, 5, 6});
+
+  ASSERT_TRUE(tensor->is_contiguous());
+  ASSERT_EQ(tensor->get_strides(), (array_mml<size_t>{3, 3, 1}));
+  ASSERT_EQ(tensor->data(), &(*tensor)[0]);
+
+  auto span = tensor->span();
+  ASSERT_EQ(span.size(), 6);
+  span[4] = 50;
+  ASSERT_EQ(((*tensor)[{1, 0, 1}]), 50);
+}
+
+TEST(test_mml_tensor, raw_data_access_column_slice) {
+  std::shared_ptr<Tensor<float>> t1 = TensorFactory::create_tensor(
+      {3, 3}, {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f});
+  std::shared_ptr<Tensor<float>> column = t1->slice({1});
+
+  ASSERT_FALSE(column->is_contiguous());
+  ASSERT_FALSE(column->raw_access());
+  ASSERT_EQ(column->get_strides(), (array_mml<size_t>{3}));
+  for (size_t i = 0; i < column->get_size(); i++) {
+    ASSERT_EQ(&column->data()[i * column->get_strides()[0]], &(*column)[i]);
+  }
+  EXPECT_THROW(column->span(), std::logic_error);
+}
+
+TEST(test_mml_tensor, raw_data_access_slice) {
+  std::shared_ptr<Tensor<float>> t1 =
+      TensorFactory::create_tensor<float>({2, 2, 2}, {1, 2, 3, 4, 5, 6, 7, 8});
+  std::shared_ptr<Tensor<float>> t2 = t1->slice({1});
+
+  ASSERT_TRUE(t2->is_contiguous());
+  ASSERT_EQ(t2->get_strides(), (array_mml<size_t>{2, 1}));
+  const auto span = std::as_const(*t2).span();
+  ASSERT_EQ(std::vector<float>(span.begin(), span.end()),
+            (std::vector<float>{5, 6, 7, 8}));
+}
+
+TEST(test_mml_tensor, views_share_data) {
+  auto tensor = TensorFactory::create_tensor<int>({2, 3}, {1, 2, 3, 4, 5, 6});
+
+  auto transposed = tensor->transpose();
+  auto permuted = tensor->transpose(std::vector<int>{1, 0});
+  auto reshaped = tensor->reshape_view({3, 2});
+  auto column = tensor->slice({2});
+  ASSERT_EQ(transposed->data(), tensor->data());
+  ASSERT_EQ(reshaped->data(), tensor->data());
+  ASSERT_FALSE(transposed->is_contiguous());
+  ASSERT_TRUE(reshaped->is_contiguous());
+  ASSERT_EQ(transposed->get_strides(), (array_mml<size_t>{1, 3}));
+
+  (*transposed)[{2, 1}] = 60;
+  ASSERT_EQ(((*tensor)[{1, 2}]), 60);
+  ASSERT_EQ(((*permuted)[{2, 1}]), 60);
+  ASSERT_EQ(((*reshaped)[{2, 1}]), 60);
+  ASSERT_EQ(((*column)[{1}]), 60);
+}
+
+TEST(test_mml_tensor, contiguous_copies_views_only) {
+  auto tensor = TensorFactory::create_tensor<int>({2, 3}, {1, 2, 3, 4, 5, 6});
+
+  ASSERT_EQ(tensor->contiguous()->data(), tensor->data());
+
+  auto transposed = tensor->transpose()->contiguous();
+  ASSERT_TRUE(transposed->is_contiguous());
+  ASSERT_NE(transposed->data(), tensor->data());
+  auto expected = TensorFactory::create_tensor<int>({3, 2}, {1, 4, 2, 5, 3, 6});
+  ASSERT_EQ(*transposed, *expected);
+
+  // Reshaping a view that is not contiguous copies it first
+  auto flat = tensor->transpose()->reshape_view({6});
+  auto expected_flat =
+      TensorFactory::create_tensor<int>({6}, {1, 4, 2, 5, 3, 6});
+  ASSERT_EQ(*flat, *expected_flat);
+}
+
+TEST(test_mml_tensor, broadcast_reshape_view) {
+  auto tensor = TensorFactory::create_tensor<int>({3, 1}, {1, 2, 3});
+  auto broadcasted = tensor->broadcast_reshape({2, 3, 2});
+
+  ASSERT_EQ(broadcasted->get_strides(), (array_mml<size_t>{0, 1, 0}));
+  ASSERT_EQ(broadcasted->data(), tensor->data());
+  auto expected = TensorFactory::create_tensor<int>(
+      {2, 3, 2}, {1, 1, 2, 2, 3, 3, 1, 1, 2, 2, 3, 3});
+  ASSERT_EQ(*broadcasted, *expected);
+  ASSERT_EQ(*broadcasted->copy(), *expected);
+}
+
+TEST(test_mml_tensor, unsqueeze_and_squeeze) {
+  auto tensor = TensorFactory::create_tensor<int>({2, 3}, {1, 2, 3, 4, 5, 6});
+
+  auto unsqueezed = tensor->unsqueeze(1);
+  ASSERT_EQ(unsqueezed->get_shape(), (array_mml<size_t>{2, 1, 3}));
+  ASSERT_TRUE(unsqueezed->is_contiguous());
+  ASSERT_EQ(((*unsqueezed)[{1, 0, 2}]), 6);
+
+  auto last = tensor->unsqueeze(2);
+  ASSERT_EQ(last->get_shape(), (array_mml<size_t>{2, 3, 1}));
+
+  ASSERT_EQ(unsqueezed->squeeze()->get_shape(), (array_mml<size_t>{2, 3}));
+  ASSERT_EQ(last->squeeze(2)->get_shape(), (array_mml<size_t>{2, 3}));
+  EXPECT_THROW(last->squeeze(0), std::invalid_argument);
+  EXPECT_THROW(tensor->unsqueeze(3), std::invalid_argument);
+}
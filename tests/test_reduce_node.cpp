@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <modularml>
+
+namespace {
+
+// Reduces x of the given shape over the flagged axes one value at a time
+std::vector<double> reference_reduce(ReductionKind kind,
+                                     const std::vector<size_t> &shape,
+                                     const std::vector<bool> &reduced,
+                                     const Tensor<float> &x) {
+  size_t kept = 1;
+  size_t count = 1;
+  for (size_t i = 0; i < shape.size(); ++i) {
+    (reduced[i] ? count : kept) *= shape[i];
+  }
+  double init = 0;
+  if (kind == ReductionKind::Max) {
+    init = std::numeric_limits<double>::lowest();
+  } else if (kind == ReductionKind::Min) {
+    init = std::numeric_limits<double>::max();
+  }
+  std::vector<double> result(kept, init);
+
+  for (size_t i = 0; i < x.get_size(); ++i) {
+    // Index of the output, the kept coordinates of i in row-major order
+    size_t remaining = i;
+    size_t out = 0;
+    size_t stride = 1;
+    for (size_t d = shape.size(); d-- > 0;) {
+      const size_t coordinate = remaining % shape[d];
+      remaining /= shape[d];
+      if (!reduced[d]) {
+        out += coordinate * stride;
+        stride *= shape[d];
+      }
+    }
+    const double value = x[i];
+    switch (kind) {
+      case ReductionKind::Max:
+        result[out] = std::max(result[out], value);
+        break;
+      case ReductionKind::Min:
+        result[out] = std::min(result[out], value);
+        break;
+      case ReductionKind::L2:
+        result[out] += value * value;
+        break;
+      default:
+        result[out] += value;
+    }
+  }
+
+  for (double &value : result) {
+    if (kind == ReductionKind::Mean) {
+      value /= count;
+    } else if (kind == ReductionKind::L2) {
+      value = std::sqrt(value);
+    }
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST(test_reduce, test_reductions_match_reference) {
+  const std::vector<size_t> shape = {2, 3, 4, 5};
+  auto x = TensorFactory::random_tensor<float>(array_mml<size_t>(shape), -2.0f,
+                                               2.0f);
+  const std::vector<std::vector<int>> axes_list = {
+      {1}, {-1}, {0, 2}, {1, 3}, {0, 1, 2, 3}, {}};
+  const std::vector<ReductionKind> kinds = {
+      ReductionKind::Sum, ReductionKind::Mean, ReductionKind::Max,
+      ReductionKind::Min, ReductionKind::L2};
+
+  for (const auto &axes : axes_list) {
+    std::vector<bool> reduced(shape.size(), axes.empty());
+    for (int axis : axes) {
+      reduced[axis < 0 ? axis + shape.size() : axis] = true;
+    }
+    for (ReductionKind kind : kinds) {
+      const auto expected = reference_reduce(kind, shape, reduced, *x);
+      for (int keepdims = 0; keepdims < 2; ++keepdims) {
+        std::unordered_map<std::string, GeneralDataTypes> iomap;
+        iomap["X"] = x;
+        ReduceNode(kind, "X", "Y", axes, keepdims).forward(iomap);
+
+        auto y = std::get<std::shared_ptr<Tensor<float>>>(iomap["Y"]);
+        std::vector<size_t> y_shape;
+        for (size_t i = 0; i < shape.size(); ++i) {
+          if (!reduced[i]) {
+            y_shape.push_back(shape[i]);
+          } else if (keepdims) {
+            y_shape.push_back(1);
+          }
+        }
+        ASSERT_EQ(y->get_shape(), array_mml<size_t>(y_shape));
+        ASSERT_EQ(y->get_size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+          EXPECT_NEAR((*y)[i], expected[i], 1e-4)
+              << "kind " << static_cast<int>(kind) << " at " << i;
+        }
+      }
+    }
+  }
+}
+
+TEST(test_reduce, test_axes_input_and_noop) {
+  auto x = TensorFactory::create_tensor<int32_t>({2, 3},
+                                                 {4, -1, 7, 2, 9, -3});
+  std::unordered_map<std::string, GeneralDataTypes> iomap;
+  iomap["X"] = x;
+  iomap["axes"] = TensorFactory::create_tensor<int64_t>({1}, {-1});
+
+  ReduceNode(ReductionKind::Max, "X", "Y", {}, 0, 0, "axes").forward(iomap);
+  auto y = std::get<std::shared_ptr<Tensor<int32_t>>>(iomap["Y"]);
+  EXPECT_EQ(y->get_shape(), array_mml<size_t>({2}));
+  EXPECT_EQ((*y)[0], 7);
+  EXPECT_EQ((*y)[1], 9);
+
+  ReduceNode(ReductionKind::Min, "X", "Y", {}, 1).forward(iomap);
+  y = std::get<std::shared_ptr<Tensor<int32_t>>>(iomap["Y"]);
+  EXPECT_EQ(y->get_shape(), array_mml<size_t>({1, 1}));
+  EXPECT_EQ((*y)[0], -3);
+
+  // Without axes the input is passed through
+  ReduceNode(ReductionKind::Sum, "X", "Y", {}, 1, 1).forward(iomap);
+  y = std::get<std::shared_ptr<Tensor<int32_t>>>(iomap["Y"]);
+  EXPECT_EQ(y->get_shape(), x->get_shape());
+  EXPECT_EQ((*y)[4], 9);
+
+  EXPECT_THROW(ReduceNode(ReductionKind::Sum, "X", "Y", {2}).forward(iomap),
+               std::runtime_error);
+}
+
+TEST(test_reduce, test_json_constructor) {
+  nlohmann::json node = {
+      {"opType", "ReduceMean"},
+      {"input", {"X"}},
+      {"output", {"Y"}},
+      {"attribute",
+       {{{"name", "axes"}, {"ints", {"1"}}},
+        {{"name", "keepdims"}, {"i", "0"}}}}};
+  ReduceNode reduce(node);
+  EXPECT_EQ(reduce.getInputs(), std::vector<std::string>({"X"}));
+
+  std::unordered_map<std::string, GeneralDataTypes> iomap;
+  iomap["X"] = TensorFactory::create_tensor<float>({2, 2}, {1, 3, 5, 9});
+  reduce.forward(iomap);
+  auto y = std::get<std::shared_ptr<Tensor<float>>>(iomap["Y"]);
+  EXPECT_EQ(y->get_shape(), array_mml<size_t>({2}));
+  EXPECT_FLOAT_EQ((*y)[0], 2.0f);
+  EXPECT_FLOAT_EQ((*y)[1], 7.0f);
+
+  node["opType"] = "ReduceProd";
+  EXPECT_THROW(ReduceNode{node}, std::runtime_error);
+}
+
+TEST(test_reduce, test_global_avg_pool) {
+  const std::vector<size_t> shape = {2, 3, 7, 9};
+  auto x = TensorFactory::random_tensor<float>(array_mml<size_t>(shape), -2.0f,
+                                               2.0f);
+  const auto expected = reference_reduce(ReductionKind::Mean, shape,
+                                         {false, false, true, true}, *x);
+
+  std::unordered_map<std::string, GeneralDataTypes> iomap;
+  iomap["X"] = x;
+  GlobalAvgPoolNode("X", "Y").forward(iomap);
+  auto y = std::get<std::shared_ptr<Tensor<float>>>(iomap["Y"]);
+  EXPECT_EQ(y->get_shape(), array_mml<size_t>({2, 3, 1, 1}));
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_NEAR((*y)[i], expected[i], 1e-5) << "at " << i;
+  }
+}
@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <modularml>
+
+namespace {
+
+// Computes the softmax of x along axis one row at a time, in double
+std::vector<double> reference_softmax(SoftmaxKind kind,
+                                      const std::vector<size_t> &shape,
+                                      size_t axis, const Tensor<float> &x) {
+  size_t outer = 1;
+  size_t inner = 1;
+  for (size_t d = 0; d < axis; ++d) {
+    outer *= shape[d];
+  }
+  for (size_t d = axis + 1; d < shape.size(); ++d) {
+    inner *= shape[d];
+  }
+  const size_t count = shape[axis];
+
+  std::vector<double> result(x.get_size());
+  for (size_t o = 0; o < outer; ++o) {
+    for (size_t i = 0; i < inner; ++i) {
+      auto at = [&](size_t c) { return (o * count + c) * inner + i; };
+      double max = -std::numeric_limits<double>::infinity();
+      for (size_t c = 0; c < count; ++c) {
+        max = std::max(max, static_cast<double>(x[at(c)]));
+      }
+      double sum = 0;
+      for (size_t c = 0; c < count; ++c) {
+        sum += std::exp(x[at(c)] - max);
+      }
+      for (size_t c = 0; c < count; ++c) {
+        result[at(c)] = kind == SoftmaxKind::Softmax
+                            ? std::exp(x[at(c)] - max) / sum
+                            : x[at(c)] - max - std::log(sum);
+      }
+    }
+  }
+  return result;
+}
+
+std::shared_ptr<Tensor<float>> run_softmax(Node &node,
+                                           std::shared_ptr<Tensor<float>> x) {
+  std::unordered_map<std::string, GeneralDataTypes> iomap;
+  iomap["X"] = x;
+  node.forward(iomap);
+  return std::get<std::shared_ptr<Tensor<float>>>(iomap["Y"]);
+}
+
+}  // namespace
+
+TEST(test_softmax_node, test_forward_basic) {
+  auto X = TensorFactory::create_tensor<float>({2, 3},
+                                               {1.0f, 2.0f, 3.0f, 0.0f, 0.0f,
+                                                0.0f});
+  SoftMaxNode softmax("X", "Y");
+  auto Y = run_softmax(softmax, X);
+
+  ASSERT_EQ(Y->get_shape(), X->get_shape());
+  const float e1 = std::exp(1.0f), e2 = std::exp(2.0f), e3 = std::exp(3.0f);
+  const float sum = e1 + e2 + e3;
+  EXPECT_NEAR((*Y)[0], e1 / sum, 1e-6);
+  EXPECT_NEAR((*Y)[1], e2 / sum, 1e-6);
+  EXPECT_NEAR((*Y)[2], e3 / sum, 1e-6);
+  for (size_t c = 0; c < 3; ++c) {
+    EXPECT_NEAR((*Y)[3 + c], 1.0f / 3.0f, 1e-6);
+  }
+}
+
+TEST(test_softmax_node, test_every_axis_matches_reference) {
+  const std::vector<size_t> shape = {2, 3, 4, 5};
+  auto X = TensorFactory::random_tensor<float>(array_mml<size_t>(shape),
+                                               -10.0f, 10.0f);
+
+  for (int axis = -4; axis < 4; ++axis) {
+    const size_t positive = axis < 0 ? axis + 4 : axis;
+    SoftMaxNode softmax("X", "Y", axis);
+    LogSoftMaxNode log_softmax("X", "Y", axis);
+    auto Y = run_softmax(softmax, X);
+    auto log_Y = run_softmax(log_softmax, X);
+
+    const auto expected =
+        reference_softmax(SoftmaxKind::Softmax, shape, positive, *X);
+    const auto log_expected =
+        reference_softmax(SoftmaxKind::LogSoftmax, shape, positive, *X);
+    for (size_t i = 0; i < expected.size(); ++i) {
+      EXPECT_NEAR((*Y)[i], expected[i], 1e-6) << "axis " << axis;
+      EXPECT_NEAR((*log_Y)[i], log_expected[i], 1e-5) << "axis " << axis;
+    }
+  }
+}
+
+TEST(test_softmax_node, test_long_rows_rescale_the_sum) {
+  // Rows spanning several blocks, with the maximum growing from block to
+  // block and one row that starts with its maximum
+  const std::vector<size_t> shape = {3, 2000};
+  std::vector<float> values(6000);
+  for (size_t i = 0; i < 2000; ++i) {
+    values[i] = static_cast<float>(i) * 0.05f;
+    values[2000 + i] = static_cast<float>(2000 - i) * 0.05f;
+    values[4000 + i] = std::sin(static_cast<float>(i)) * 30.0f;
+  }
+  auto X = TensorFactory::create_tensor<float>(array_mml<size_t>(shape),
+                                               array_mml<float>(values));
+
+  SoftMaxNode softmax("X", "Y");
+  LogSoftMaxNode log_softmax("X", "Y");
+  auto Y = run_softmax(softmax, X);
+  auto log_Y = run_softmax(log_softmax, X);
+
+  const auto expected = reference_softmax(SoftmaxKind::Softmax, shape, 1, *X);
+  const auto log_expected =
+      reference_softmax(SoftmaxKind::LogSoftmax, shape, 1, *X);
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_NEAR((*Y)[i], expected[i], 1e-6 + 1e-5 * expected[i]);
+    EXPECT_NEAR((*log_Y)[i], log_expected[i], 1e-4);
+  }
+}
+
+TEST(test_softmax_node, test_negative_infinity) {
+  const float inf = std::numeric_limits<float>::infinity();
+  auto X = TensorFactory::create_tensor<float>({2, 3},
+                                               {-inf, 0.0f, -inf, 1.0f, -inf,
+                                                1.0f});
+  SoftMaxNode softmax("X", "Y");
+  auto Y = run_softmax(softmax, X);
+
+  EXPECT_EQ((*Y)[0], 0.0f);
+  EXPECT_NEAR((*Y)[1], 1.0f, 1e-6);
+  EXPECT_EQ((*Y)[2], 0.0f);
+  EXPECT_NEAR((*Y)[3], 0.5f, 1e-6);
+  EXPECT_EQ((*Y)[4], 0.0f);
+  EXPECT_NEAR((*Y)[5], 0.5f, 1e-6);
+}
+
+TEST(test_softmax_node, test_strided_input) {
+  auto X = TensorFactory::random_tensor<float>(array_mml<size_t>({4, 6}),
+                                               -3.0f, 3.0f);
+  auto transposed = X->transpose(0, 1);
+  SoftMaxNode softmax("X", "Y", 0);
+  auto Y = run_softmax(softmax, transposed);
+
+  auto expected = reference_softmax(SoftmaxKind::Softmax, {4, 6}, 1, *X);
+  for (size_t i = 0; i < 6; ++i) {
+    for (size_t j = 0; j < 4; ++j) {
+      EXPECT_NEAR((*Y)[i * 4 + j], expected[j * 6 + i], 1e-6);
+    }
+  }
+}
+
+TEST(test_softmax_node, test_invalid_axis) {
+  auto X = TensorFactory::create_tensor<float>({2, 2}, {1, 2, 3, 4});
+  SoftMaxNode softmax("X", "Y", 2);
+  EXPECT_THROW(run_softmax(softmax, X), std::runtime_error);
+}
+
+TEST(test_softmax_node, test_json_constructor) {
+  nlohmann::json node = {{"opType", "LogSoftmax"},
+                         {"input", {"X"}},
+                         {"output", {"Y"}},
+                         {"attribute", {{{"name", "axis"}, {"i", "0"}}}}};
+  auto X = TensorFactory::random_tensor<float>(array_mml<size_t>({3, 4}),
+                                               -3.0f, 3.0f);
+  SoftMaxNode log_softmax(node);
+  auto log_Y = run_softmax(log_softmax, X);
+
+  auto expected = reference_softmax(SoftmaxKind::LogSoftmax, {3, 4}, 0, *X);
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_NEAR((*log_Y)[i], expected[i], 1e-5);
+  }
+
+  node["opType"] = "Softplus";
+  EXPECT_THROW(SoftMaxNode{node}, std::runtime_error);
+}
+
+TEST(test_softmax_node, test_writes_existing_output_in_place) {
+  auto X = TensorFactory::random_tensor<float>(array_mml<size_t>({3, 5}),
+                                               -3.0f, 3.0f);
+  auto existing = TensorFactory::create_tensor<float>({3, 5});
+  std::unordered_map<std::string, GeneralDataTypes> iomap;
+  iomap["X"] = X;
+  iomap["Y"] = existing;
+  LogSoftMaxNode log_softmax("X", "Y");
+  log_softmax.forward(iomap);
+
+  auto Y = std::get<std::shared_ptr<Tensor<float>>>(iomap["Y"]);
+  EXPECT_EQ(Y, existing);
+  auto expected = reference_softmax(SoftmaxKind::LogSoftmax, {3, 5}, 1, *X);
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_NEAR((*Y)[i], expected[i], 1e-5);
+  }
+
+  // An output of another shape is replaced
+  iomap["Y"] = TensorFactory::create_tensor<float>({5, 3});
+  SoftMaxNode softmax("X", "Y");
+  softmax.forward(iomap);
+  EXPECT_EQ(std::get<std::shared_ptr<Tensor<float>>>(iomap["Y"])->get_shape(),
+            X->get_shape());
+}
@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <modularml>
+#include <stdexcept>
+
+TEST(test_thread_pool, test_parallel_for_covers_range_once) {
+  ThreadPool pool(4);
+  std::vector<std::atomic<int>> visits(10007);
+
+  pool.parallel_for(3, visits.size(), 7, [&](size_t begin, size_t end) {
+    EXPECT_LT(begin, end);
+    for (size_t i = begin; i < end; ++i) {
+      visits[i]++;
+    }
+  });
+
+  for (size_t i = 0; i < visits.size(); ++i) {
+    ASSERT_EQ(visits[i].load(), i < 3 ? 0 : 1) << "index " << i;
+  }
+}
+
+TEST(test_thread_pool, test_parallel_for_rethrows) {
+  ThreadPool pool(4);
+
+  EXPECT_THROW(pool.parallel_for(0, 1000, 1,
+                                 [](size_t begin, size_t) {
+                                   if (begin >= 500) {
+                                     throw std::runtime_error("chunk failed");
+                                   }
+                                 }),
+               std::runtime_error);
+}
+
+TEST(test_thread_pool, test_nested_parallel_for) {
+  ThreadPool pool(2);
+  std::atomic<size_t> total = 0;
+
+  // Every worker is busy with an outer chunk while the inner loops run
+  pool.parallel_for(0, 8, 1, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      pool.parallel_for(0, 100, 1, [&](size_t inner_begin, size_t inner_end) {
+        total += inner_end - inner_begin;
+      });
+    }
+  });
+
+  EXPECT_EQ(total.load(), 800);
+}
+
+TEST(test_thread_pool, test_configure_global) {
+  ThreadPool::configure_global(3);
+  EXPECT_EQ(ThreadPool::global()->get_thread_count(), 3);
+
+  ThreadPool::configure_global(0);
+  EXPECT_EQ(ThreadPool::global()->get_thread_count(),
+            std::max<size_t>(std::thread::hardware_concurrency(), 1));
+}
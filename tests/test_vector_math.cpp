@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <modularml>
+#include <random>
+#include <string>
+
+namespace {
+
+// Size of the last place of the value of type T closest to the reference
+template <typename T>
+long double ulp(long double reference) {
+  T value = static_cast<T>(reference);
+  if (value == 0 || !std::isfinite(value)) {
+    value = std::numeric_limits<T>::min();
+  }
+  const int exponent = std::max(std::ilogb(value),
+                                std::numeric_limits<T>::min_exponent - 1);
+  return std::ldexp(1.0L, exponent - std::numeric_limits<T>::digits + 1);
+}
+
+// Maximum error of f in units in the last place, over random arguments in
+// [low, high]
+template <typename T, typename F, typename R>
+double max_ulp_error(F f, R reference, double low, double high) {
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<double> distribution(low, high);
+  std::vector<T> x(20011);
+  for (T &value : x) {
+    value = static_cast<T>(distribution(generator));
+  }
+  std::vector<T> y(x.size());
+  f(x.data(), y.data(), x.size());
+
+  double error = 0;
+  for (size_t i = 0; i < x.size(); i++) {
+    const long double expected = reference(static_cast<long double>(x[i]));
+    error = std::max(error, static_cast<double>(std::fabs(y[i] - expected) /
+                                                ulp<T>(expected)));
+  }
+  return error;
+}
+
+// Checks the errors of every function of type T against the bounds
+// documented in vector_math.hpp
+template <typename T>
+void check_errors(const std::string &context, bool fast) {
+  const bool is_float = std::is_same_v<T, float>;
+  const double exp_bound = fast ? (is_float ? 40 : 1901) : 1.2;
+  const double expm1_bound = fast ? (is_float ? 9.3 : 221) : 2.5;
+  const double tanh_bound = fast ? (is_float ? 6.7 : 151) : 3.2;
+  const double exp_limit = is_float ? 87 : 708;
+
+  EXPECT_LE(max_ulp_error<T>(mml_vexp<T>, [](long double x) { return expl(x); },
+                             -exp_limit, exp_limit),
+            exp_bound)
+      << context;
+  EXPECT_LE(max_ulp_error<T>(mml_vexpm1<T>,
+                             [](long double x) { return expm1l(x); }, -1, 1),
+            expm1_bound)
+      << context;
+  EXPECT_LE(max_ulp_error<T>(mml_vexpm1<T>,
+                             [](long double x) { return expm1l(x); }, -40, 80),
+            expm1_bound)
+      << context;
+  EXPECT_LE(max_ulp_error<T>(mml_vlog<T>, [](long double x) { return logl(x); },
+                             1e-30, 1e30),
+            0.9)
+      << context;
+  EXPECT_LE(max_ulp_error<T>(mml_vlog<T>, [](long double x) { return logl(x); },
+                             0.5, 2),
+            0.9)
+      << context;
+  EXPECT_LE(max_ulp_error<T>(mml_vtanh<T>,
+                             [](long double x) { return tanhl(x); }, -10, 10),
+            tanh_bound)
+      << context;
+  EXPECT_LE(max_ulp_error<T>(mml_verf<T>, [](long double x) { return erfl(x); },
+                             -6, 6),
+            3.5)
+      << context;
+  EXPECT_LE(max_ulp_error<T>(
+                mml_vsigmoid<T>,
+                [](long double x) { return 1 / (1 + expl(-x)); }, -80, 80),
+            fast ? exp_bound : 2.4)
+      << context;
+}
+
+}  // namespace
+
+TEST(test_vector_math, test_errors_within_documented_bounds) {
+  for (SimdTier tier : {SimdTier::Scalar, SimdTier::AVX2, SimdTier::AVX512}) {
+    if (tier > CpuDispatch::detect_tier()) {
+      continue;
+    }
+    CpuDispatch::set_tier(tier);
+    for (MathAccuracy accuracy : {MathAccuracy::Precise, MathAccuracy::Fast}) {
+      VectorMath::set_accuracy(accuracy);
+      const std::string context = CpuDispatch::tier_name(tier) + " " +
+                                  VectorMath::accuracy_name(accuracy);
+      check_errors<float>(context + " float", accuracy == MathAccuracy::Fast);
+      check_errors<double>(context + " double",
+                           accuracy == MathAccuracy::Fast);
+    }
+  }
+  CpuDispatch::reset_tier();
+  VectorMath::set_accuracy(MathAccuracy::Precise);
+}
+
+TEST(test_vector_math, test_special_values) {
+  const float inf = std::numeric_limits<float>::infinity();
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  const float denormal = std::numeric_limits<float>::denorm_min();
+  const std::vector<float> x = {0.0f, -0.0f, inf, -inf, nan, 100.0f, -200.0f,
+                                denormal, -1.0f};
+  std::vector<float> y(x.size());
+
+  mml_vexp(x.data(), y.data(), x.size());
+  EXPECT_EQ(y[0], 1.0f);
+  EXPECT_EQ(y[2], inf);
+  EXPECT_EQ(y[3], 0.0f);
+  EXPECT_TRUE(std::isnan(y[4]));
+  EXPECT_EQ(y[5], inf);
+  EXPECT_EQ(y[6], 0.0f);
+
+  mml_vexpm1(x.data(), y.data(), x.size());
+  EXPECT_EQ(y[3], -1.0f);
+  EXPECT_EQ(y[7], denormal);
+
+  mml_vlog(x.data(), y.data(), x.size());
+  EXPECT_EQ(y[0], -inf);
+  EXPECT_EQ(y[1], -inf);
+  EXPECT_EQ(y[2], inf);
+  EXPECT_TRUE(std::isnan(y[3]));
+  EXPECT_TRUE(std::isnan(y[4]));
+  EXPECT_FLOAT_EQ(y[7], std::log(denormal));
+  EXPECT_TRUE(std::isnan(y[8]));
+
+  mml_vtanh(x.data(), y.data(), x.size());
+  EXPECT_TRUE(std::signbit(y[1]));
+  EXPECT_EQ(y[2], 1.0f);
+  EXPECT_EQ(y[3], -1.0f);
+  EXPECT_TRUE(std::isnan(y[4]));
+
+  mml_verf(x.data(), y.data(), x.size());
+  EXPECT_EQ(y[2], 1.0f);
+  EXPECT_EQ(y[3], -1.0f);
+  EXPECT_TRUE(std::isnan(y[4]));
+
+  mml_vsigmoid(x.data(), y.data(), x.size());
+  EXPECT_EQ(y[0], 0.5f);
+  EXPECT_EQ(y[2], 1.0f);
+  EXPECT_EQ(y[3], 0.0f);
+
+  // In place
+  std::vector<double> z = {-2.5, 0.25, 3.0};
+  mml_vexp(z.data(), z.data(), z.size());
+  EXPECT_DOUBLE_EQ(z[0], std::exp(-2.5));
+  EXPECT_DOUBLE_EQ(z[2], std::exp(3.0));
+}
+
+TEST(test_vector_math, test_fast_gelu_uses_tanh) {
+  auto x = TensorFactory::random_tensor<float>({3, 1000}, -4.0f, 4.0f);
+  std::unordered_map<std::string, GeneralDataTypes> iomap;
+  iomap["X"] = x;
+
+  VectorMath::set_accuracy(MathAccuracy::Fast);
+  GeluNode("X", "Fast").forward(iomap);
+  auto fast = std::get<std::shared_ptr<Tensor<float>>>(iomap["Fast"]);
+  VectorMath::set_accuracy(MathAccuracy::Precise);
+  GeluNode("X", "Precise").forward(iomap);
+  auto precise = std::get<std::shared_ptr<Tensor<float>>>(iomap["Precise"]);
+
+  for (size_t i = 0; i < x->get_size(); i++) {
+    const double v = (*x)[i];
+    const double erf_form = 0.5 * v * (1 + std::erf(v / std::sqrt(2.0)));
+    const double tanh_form =
+        0.5 * v *
+        (1 + std::tanh(std::sqrt(2 / M_PI) * (v + 0.044715 * v * v * v)));
+    EXPECT_NEAR((*precise)[i], erf_form, 2e-6) << "at " << i;
+    EXPECT_NEAR((*fast)[i], tanh_form, 1e-5) << "at " << i;
+  }
+  EXPECT_EQ(VectorMath::parse_accuracy("FAST"), MathAccuracy::Fast);
+  EXPECT_THROW(VectorMath::parse_accuracy("exact"), std::invalid_argument);
+}